@@ -93,6 +93,15 @@ if(MSVC)
     set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} /arch:SSE2")
   endif()
 
+  # Adds support for AVX2 instructions (8-wide soa path)
+  string(REGEX REPLACE " /arch:AVX[0-9]?" "" CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS}")
+  string(REGEX REPLACE " /arch:AVX[0-9]?" "" CMAKE_C_FLAGS "${CMAKE_C_FLAGS}")
+  if(ozz_build_avx2)
+    message("OZZ_HAS_AVX2 is enabled")
+    set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} /arch:AVX2")
+    set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} /arch:AVX2")
+  endif()
+
   # Adds support for multiple processes builds
   if(NOT ${CMAKE_CXX_FLAGS} MATCHES "/MP")
     set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} /MP")
@@ -140,6 +149,13 @@ else()
     set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -Wall")
   endif()
 
+  # Adds support for AVX2 instructions (8-wide soa path)
+  if(ozz_build_avx2 AND NOT CMAKE_CXX_FLAGS MATCHES "-mavx2")
+    message("OZZ_HAS_AVX2 is enabled")
+    set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -mavx2")
+    set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -mavx2")
+  endif()
+
   # Automatically selects native architecture optimizations (sse...)
   #if(NOT CMAKE_CXX_FLAGS MATCHES "-march")
   #  set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -march=native")
@@ -232,3 +248,24 @@ set(CMAKE_DEBUG_POSTFIX "_d")
 set(CMAKE_RELEASE_POSTFIX "_r")
 set(CMAKE_MINSIZEREL_POSTFIX "_rs")
 set(CMAKE_RELWITHDEBINFO_POSTFIX "_rd")
+
+#--------------------------------------
+# Sets compilation flags of runtime job kernels built for higher instructions
+# sets, which are selected at runtime according to cpu support (see
+# ozz/base/cpu.h). Kernels are only built on x64 targets, where SSE2 baseline
+# is guaranteed.
+set(ozz_sse4_1_kernels_flags "")
+set(ozz_avx2_kernels_flags "")
+if(ozz_build_simd_dispatch AND
+   CMAKE_SYSTEM_PROCESSOR MATCHES "^(x86_64|AMD64|amd64)$" AND
+   CMAKE_SIZEOF_VOID_P EQUAL 8)
+  message("Runtime SIMD dispatch is enabled")
+  if(MSVC)
+    # MSVC has no SSE4.1 specific option.
+    set(ozz_sse4_1_kernels_flags "/DOZZ_HAS_SSE4_1")
+    set(ozz_avx2_kernels_flags "/arch:AVX2")
+  else()
+    set(ozz_sse4_1_kernels_flags "-msse4.1")
+    set(ozz_avx2_kernels_flags "-mavx2")
+  endif()
+endif()
@@ -0,0 +1,76 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_ADDITIVE_ANIMATION_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_ADDITIVE_ANIMATION_BUILDER_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace math { struct Transform; }
+namespace animation {
+namespace offline {
+
+// Forward declare offline animation type.
+struct RawAnimation;
+
+// Defines the class responsible of building additive (delta) animations, that
+// can be applied with BlendingJob additive layers.
+// Every key of the additive animation is the delta from a reference pose to
+// the matching key of the input animation: translations are subtracted,
+// rotations are multiplied by the conjugate of the reference rotation, and
+// scales are divided. Applying the delta to the reference pose thus gives the
+// input animation back.
+class AdditiveAnimationBuilder {
+ public:
+  // Builds an additive animation from _input, using the first key of each
+  // track as the reference pose. Tracks without key remain without key, which
+  // is an identity delta.
+  // Returns true on success and fills _output with the additive animation.
+  // *_output must be a valid RawAnimation instance.
+  // Returns false on failure and resets _output to an empty animation.
+  // See RawAnimation::Validate() for more details about failure reasons.
+  bool operator()(const RawAnimation& _input, RawAnimation* _output) const;
+
+  // Builds an additive animation from _input, using _reference_pose as the
+  // reference pose, with one transform per track. Tracks without key are
+  // considered to be at identity, which is then compared to the reference.
+  // Returns true on success and fills _output with the additive animation.
+  // Returns false on failure and resets _output to an empty animation, which
+  // happens if _input isn't valid, or if _reference_pose is smaller than the
+  // number of tracks of _input.
+  bool operator()(const RawAnimation& _input,
+                  const Range<const math::Transform>& _reference_pose,
+                  RawAnimation* _output) const;
+};
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_ADDITIVE_ANIMATION_BUILDER_H_
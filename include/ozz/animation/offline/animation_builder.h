@@ -44,15 +44,49 @@ struct RawAnimation;
 
 // Defines the class responsible of building runtime animation instances from
 // offline raw animations.
-// No optimization at all is performed on the raw animation.
+// No optimization at all is performed on the raw animation, except that
+// constant tracks (tracks with less than 2 keys, or whose keys all have the
+// same value) are stored without any key frame.
 class AnimationBuilder {
  public:
+  // Initializes the builder with default parameters.
+  AnimationBuilder();
+
   // Creates an Animation based on _raw_animation and *this builder parameters.
   // Returns a valid Animation on success
   // The returned animation will then need to be deleted using the default 
   // allocator Delete() function.
   // See RawAnimation::Validate() for more details about failure reasons.
+  // Key times are quantized to 16 bits fractions of the animation duration.
+  // If two keys of an animated track are too close to remain distinct once
+  // quantized (less than duration / 65535 apart), key times of the whole
+  // animation are quantized to 24 bits instead, which costs an extra byte per
+  // key (see Animation::wide_key_times()). Building only fails if keys are
+  // still not distinct on 24 bits, aka less than duration / 16777215 apart.
   Animation* operator()(const RawAnimation& _raw_animation) const;
+
+  // Time interval between two consecutive entries of the animation seek index.
+  // Seek index allows the sampling job to jump directly close to any time,
+  // which speeds up backward and random access sampling at the cost of some
+  // memory. A value of 0 (or less) disables seek index, which is the default
+  // as it's only worth it for animations that are sampled backward or
+  // randomly.
+  // The index is limited to kMaxSeeks entries: the interval is enlarged for
+  // longer animations.
+  float seek_interval;
+
+  // Maximum number of entries of the seek index.
+  enum { kMaxSeeks = 256 };
+
+  // Number of bits used to quantize and store translation and scale key frames
+  // components, in range [1,16]. Components are quantized to fixed point
+  // integers, normalized in the range of values of their track, and bit-packed
+  // so a key value takes 3 * bits bits. Building fails if translation_bits or
+  // scale_bits is out of range [1,16].
+  // Quantization ranges take 24 bytes per track (if the animation has any
+  // key), which fewer bits recover as soon as tracks have a few keys.
+  int translation_bits;
+  int scale_bits;
 };
 }  // offline
 }  // animation
@@ -0,0 +1,86 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_COMPRESSOR_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_COMPRESSOR_H_
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime types.
+class CompressedAnimation;
+class Skeleton;
+
+namespace offline {
+
+// Forward declares the offline animation type.
+struct RawAnimation;
+
+// Defines the class responsible of building runtime compressed animation
+// instances from offline raw animations.
+// The raw animation is uniformly sampled at sample_rate, then each track
+// translation, rotation and scale values are quantized with the smallest number
+// of bits that keeps the object-space error under tolerance. The error budget
+// is shared between all the joints of the longest hierarchy chain each joint
+// belongs to. Rotation and scale errors of a joint are scaled by the distance
+// to its farthest descendant joint (plus distance), as they displace all of its
+// children.
+class AnimationCompressor {
+ public:
+  // Initializes the compressor with default parameters.
+  AnimationCompressor();
+
+  // Creates a CompressedAnimation based on _raw_animation, the joint hierarchy
+  // of _skeleton and *this compressor parameters.
+  // Returns a valid CompressedAnimation on success, or NULL if _raw_animation
+  // isn't valid, if its number of tracks doesn't match _skeleton's number of
+  // joints, or if a compressor parameter is invalid.
+  // The returned animation will then need to be deleted using the default
+  // allocator Delete() function.
+  CompressedAnimation* operator()(const RawAnimation& _raw_animation,
+                                  const Skeleton& _skeleton) const;
+
+  // Maximum object-space error, in meters, allowed for any joint (or any
+  // point distant of distance from a joint). Must be greater than 0.
+  float tolerance;
+
+  // Distance, in meters, from a joint at which the error is measured. It
+  // stands for the skin vertices influenced by the joint, and prevents leaf
+  // joints rotations from being considered error free. Must be greater than 0.
+  float distance;
+
+  // Number of frames per second used to sample the raw animation. Must be
+  // greater than 0.
+  float sample_rate;
+};
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_ANIMATION_COMPRESSOR_H_
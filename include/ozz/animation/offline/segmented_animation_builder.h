@@ -0,0 +1,79 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_OFFLINE_SEGMENTED_ANIMATION_BUILDER_H_
+#define OZZ_OZZ_ANIMATION_OFFLINE_SEGMENTED_ANIMATION_BUILDER_H_
+
+#include "ozz/animation/offline/animation_builder.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the runtime segmented animation type.
+class SegmentedAnimation;
+
+namespace offline {
+
+// Forward declares the offline animation type.
+struct RawAnimation;
+
+// Defines the class responsible of building runtime segmented animations from
+// offline raw animations.
+// The raw animation time line is split in segments of segment_duration
+// seconds. Each segment is built as an independent Animation, made of the raw
+// keys within the segment, shifted to segment local time, plus keys sampled
+// at segment boundaries. Tracks without any key remain without key in every
+// segment, so they keep their identity value.
+class SegmentedAnimationBuilder {
+ public:
+  // Initializes the builder with default parameters.
+  SegmentedAnimationBuilder();
+
+  // Creates a SegmentedAnimation based on _raw_animation and *this builder
+  // parameters.
+  // Returns a valid SegmentedAnimation, whose segments are all loaded, on
+  // success, or NULL if _raw_animation isn't valid or segment_duration isn't
+  // greater than 0.
+  // The returned animation will then need to be deleted using the default
+  // allocator Delete() function.
+  SegmentedAnimation* operator()(const RawAnimation& _raw_animation) const;
+
+  // Duration of a segment, in seconds. The last segment is extended if the
+  // remaining time is too short to make a segment on its own. Defaults to 5
+  // seconds.
+  float segment_duration;
+
+  // Builder used to build every segment.
+  AnimationBuilder builder;
+};
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_OFFLINE_SEGMENTED_ANIMATION_BUILDER_H_
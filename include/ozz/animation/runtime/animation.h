@@ -32,10 +32,12 @@
 #define OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_H_
 
 #include "ozz/base/platform.h"
+#include "ozz/base/endianness.h"
 #include "ozz/base/io/archive_traits.h"
 
 namespace ozz {
 namespace io { class IArchive; class OArchive; }
+namespace math { struct SoaFloat3; struct SoaQuaternion; }
 namespace animation {
 
 // Forward declares the AnimationBuilder, used to instantiate an Animation.
@@ -55,7 +57,19 @@ struct ScaleKey;
 // required to animate all the joints of a skeleton, matching breadth-first
 // joints order of the runtime skeleton structure. In order to optimize cache
 // coherency when sampling the animation, Keyframes in this array are sorted by
-// time, then by track number.
+// time, then by track number. Keyframe times are stored on 16 bits, as a
+// fraction of the animation duration, or on 24 bits for animations whose keys
+// are too close to be distinct on 16 bits (see wide_key_times()). Translation
+// and scale keyframe values are quantized to fixed point integers, normalized
+// in the range of values of their track, and bit-packed with a configurable
+// number of bits per component. Rotations are compressed using their smallest three components.
+// Animation can also store a seek index (see AnimationBuilder::seek_interval),
+// made of snapshots of the sampling state (keys cursor and keys used by every
+// track) taken at regular time intervals. It allows the SamplingJob to jump
+// close to any time without iterating through all the preceding keys.
+// Tracks whose value doesn't change along the animation (constant tracks) have
+// no keyframe. Their values are stored separately, already decompressed to SoA
+// format, so the SamplingJob can output them without any key processing.
 class Animation {
  public:
 
@@ -65,6 +79,14 @@ class Animation {
   // Declares the public non-virtual destructor.
   ~Animation();
 
+  // Gets *this animation generation id, which uniquely identifies its content
+  // in the process. It changes whenever the animation is (re)loaded, so unlike
+  // its address, it can't be reused by another animation. SamplingCache relies
+  // on it to detect that it's used with a different animation.
+  uint32_t generation() const {
+    return generation_;
+  }
+
   // Gets the animation clip duration.
   float duration() const {
     return duration_;
@@ -96,6 +118,114 @@ class Animation {
     return scales_;
   }
 
+  // Returns true if key times are quantized on 24 bits rather than 16. The 8
+  // high bits of every key time are then stored in the time highs buffers.
+  bool wide_key_times() const {
+    return wide_key_times_;
+  }
+
+  // Gets the high bits of translations, rotations and scales key times, with an
+  // element per key. Buffers are empty if key times aren't wide.
+  ozz::Range<const uint8_t> translation_time_highs() const {
+    return translation_time_highs_;
+  }
+  ozz::Range<const uint8_t> rotation_time_highs() const {
+    return rotation_time_highs_;
+  }
+  ozz::Range<const uint8_t> scale_time_highs() const {
+    return scale_time_highs_;
+  }
+
+  // Gets the time interval between two consecutive seek index entries, or 0 if
+  // the animation has no seek index.
+  float seek_interval() const {
+    return seek_interval_;
+  }
+
+  // Gets the quantization ranges of translations and scales keys, in soa
+  // format with 2 elements per soa track: tracks minimum values, followed by
+  // the values step between two consecutive quantized integers. A key value is
+  // restored as minimum + quantized * step. Buffers are empty if there's no
+  // key.
+  ozz::Range<const math::SoaFloat3> translation_ranges() const {
+    return translation_ranges_;
+  }
+  ozz::Range<const math::SoaFloat3> scale_ranges() const {
+    return scale_ranges_;
+  }
+
+  // Gets the buffers of translations and scales keys quantized values, packed
+  // with translation_bits() / scale_bits() bits per component, with 3
+  // components per key. Buffers are padded with a few bytes so that any value
+  // can be read with a single load. Buffers are empty if there's no key.
+  ozz::Range<const uint8_t> translation_values() const {
+    return translation_values_;
+  }
+  ozz::Range<const uint8_t> scale_values() const {
+    return scale_values_;
+  }
+
+  // Gets the number of bits per component of translations and scales keys
+  // quantized values, in range [1,16].
+  int translation_bits() const {
+    return translation_bits_;
+  }
+  int scale_bits() const {
+    return scale_bits_;
+  }
+
+  // Gets the seek index buffers of translations, rotations and scales keys.
+  // Entry n of a buffer is the sampling state at time (n + 1) * seek_interval:
+  // keys cursor, followed by left and right keys indices of every track.
+  ozz::Range<const int> translation_seeks() const {
+    return translation_seeks_;
+  }
+  ozz::Range<const int> rotation_seeks() const {
+    return rotation_seeks_;
+  }
+  ozz::Range<const int> scale_seeks() const {
+    return scale_seeks_;
+  }
+
+  // Gets the number of animated translation/rotation/scale tracks, aka tracks
+  // that aren't constant. The first two sets of key frames of each keys buffer
+  // are made of a key per animated track, sorted by track.
+  int num_animated_translations() const {
+    return num_animated_translations_;
+  }
+  int num_animated_rotations() const {
+    return num_animated_rotations_;
+  }
+  int num_animated_scales() const {
+    return num_animated_scales_;
+  }
+
+  // Gets the constant tracks flags of translations, rotations and scales, with
+  // an element per soa track. Bit n of an element is set if its nth track is
+  // constant. Buffers are empty if no track is constant.
+  ozz::Range<const uint8_t> translation_constant_flags() const {
+    return translation_constant_flags_;
+  }
+  ozz::Range<const uint8_t> rotation_constant_flags() const {
+    return rotation_constant_flags_;
+  }
+  ozz::Range<const uint8_t> scale_constant_flags() const {
+    return scale_constant_flags_;
+  }
+
+  // Gets the values of constant translations, rotations and scales, with an
+  // element per soa track. Values of animated tracks are undefined. Buffers
+  // are empty if no track is constant.
+  ozz::Range<const math::SoaFloat3> translation_constants() const {
+    return translation_constants_;
+  }
+  ozz::Range<const math::SoaQuaternion> rotation_constants() const {
+    return rotation_constants_;
+  }
+  ozz::Range<const math::SoaFloat3> scale_constants() const {
+    return scale_constants_;
+  }
+
   // Get the estimated animation's size in bytes.
   size_t size() const;
 
@@ -104,6 +234,19 @@ class Animation {
   void Save(ozz::io::OArchive& _archive) const;
   void Load(ozz::io::IArchive& _archive, uint32_t _version);
 
+  // Relocatable image functions, see ozz/base/io/image.h.
+  // Writes *this animation image to _image buffer of _size bytes, with
+  // _endianness. _image must be aligned to 16 bytes. Returns the image size,
+  // or 0 if _size is too small. If _image is NULL, returns the required size.
+  size_t SaveImage(void* _image, size_t _size, Endianness _endianness) const;
+
+  // Initializes *this animation as a view over _image buffer of _size bytes,
+  // without copying anything. _image must be aligned to 16 bytes, and must
+  // outlive *this animation. It's swapped in-place if its endianness isn't
+  // native. Returns false if _image isn't a valid animation image, in which
+  // case *this animation is left empty and _image content is undefined.
+  bool LoadImage(void* _image, size_t _size);
+
  protected:
  private:
 
@@ -117,22 +260,72 @@ class Animation {
   // Internal destruction function.
   void Destroy();
 
+  // Generation id of *this animation content.
+  uint32_t generation_;
+
   // Stores all translation/rotation/scale keys begin and end of buffers.
   ozz::Range<TranslationKey> translations_;
   ozz::Range<RotationKey> rotations_;
   ozz::Range<ScaleKey> scales_;
 
+  // Stores translation/rotation/scale keys time high bits begin and end of
+  // buffers.
+  ozz::Range<uint8_t> translation_time_highs_;
+  ozz::Range<uint8_t> rotation_time_highs_;
+  ozz::Range<uint8_t> scale_time_highs_;
+
+  // Stores translation/scale quantization ranges begin and end of buffers.
+  ozz::Range<math::SoaFloat3> translation_ranges_;
+  ozz::Range<math::SoaFloat3> scale_ranges_;
+
+  // Stores translation/scale packed values begin and end of buffers.
+  ozz::Range<uint8_t> translation_values_;
+  ozz::Range<uint8_t> scale_values_;
+
+  // Number of bits per component of translation/scale packed values.
+  int translation_bits_;
+  int scale_bits_;
+
+  // Stores translation/rotation/scale seek index begin and end of buffers.
+  ozz::Range<int> translation_seeks_;
+  ozz::Range<int> rotation_seeks_;
+  ozz::Range<int> scale_seeks_;
+
+  // Stores translation/rotation/scale constant tracks flags and values begin
+  // and end of buffers.
+  ozz::Range<uint8_t> translation_constant_flags_;
+  ozz::Range<uint8_t> rotation_constant_flags_;
+  ozz::Range<uint8_t> scale_constant_flags_;
+  ozz::Range<math::SoaFloat3> translation_constants_;
+  ozz::Range<math::SoaQuaternion> rotation_constants_;
+  ozz::Range<math::SoaFloat3> scale_constants_;
+
+  // Number of animated translation/rotation/scale tracks.
+  int num_animated_translations_;
+  int num_animated_rotations_;
+  int num_animated_scales_;
+
+  // Time interval between two consecutive seek index entries.
+  float seek_interval_;
+
   // Duration of the animation clip.
   float duration_;
 
+  // True if key times are quantized on 24 bits.
+  bool wide_key_times_;
+
   // The number of joint tracks. Can differ from the data stored in translation/
   // rotation/scale buffers because of SoA requirements.
   int num_tracks_;
+
+  // True if *this animation is a view over an image, in which case it doesn't
+  // own its buffers.
+  bool image_view_;
 };
 }  // animation
 
 namespace io {
-OZZ_IO_TYPE_VERSION(2, animation::Animation)
+OZZ_IO_TYPE_VERSION(10, animation::Animation)
 OZZ_IO_TYPE_TAG("ozz-animation", animation::Animation)
 }  // io
 }  // ozz
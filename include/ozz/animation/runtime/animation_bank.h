@@ -0,0 +1,162 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_BANK_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_BANK_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/io/archive_traits.h"
+
+namespace ozz {
+namespace io { class IArchive; class OArchive; class Stream; }
+namespace animation {
+
+// Forward declares the runtime animation type.
+class Animation;
+
+// Defines a bank of animations, stored in a single archive. A bank starts with
+// an index, made of the hash, name, offset and size of every animation, which
+// is followed by serialized animations. Each of them is stored as a standalone
+// archive, exactly as it would be in its own file.
+// Loading a bank (from an IArchive) only reads its index. Animations are then
+// individually loaded and unloaded on demand, by seeking to their offset in
+// the archive stream. This stream must thus remain valid and opened as long as
+// animations need to be loaded.
+// Index is sorted by name hash, so an animation is found by name with a binary
+// search. An animation id is its index in the bank, which is stable for a
+// given bank file.
+// AnimationBank isn't thread safe, as loading an animation changes the stream
+// position indicator.
+class AnimationBank {
+ public:
+  // Describes an animation to write to a bank.
+  struct Entry {
+    // Animation name, which must be unique in the bank.
+    const char* name;
+
+    // The animation, which mustn't be NULL.
+    const Animation* animation;
+  };
+
+  // Writes to _archive a bank made of the animations described by _entries.
+  // Animations are serialized with _archive endianness.
+  // Returns false if an entry is invalid, or if names aren't unique, in which
+  // case nothing is written to _archive.
+  static bool Write(ozz::io::OArchive& _archive, Range<const Entry> _entries);
+
+  // Computes the hash of an animation name, as used by the bank index.
+  static uint32_t Hash(const char* _name);
+
+  // Builds an empty bank.
+  AnimationBank();
+
+  // Unloads all animations.
+  ~AnimationBank();
+
+  // Gets the number of animations in the bank.
+  int num_animations() const {
+    return num_animations_;
+  }
+
+  // Finds an animation from its name. Returns its id, or -1 if no animation
+  // has this name.
+  int Find(const char* _name) const;
+
+  // Gets the name of animation _id.
+  const char* name(int _id) const;
+
+  // Loads animation _id from the bank stream, if it isn't already loaded.
+  // Returns the animation, or NULL if it couldn't be loaded.
+  const Animation* Load(int _id);
+
+  // Gets animation _id, or NULL if it isn't loaded.
+  const Animation* animation(int _id) const;
+
+  // Unloads animation _id, if it's loaded.
+  void Unload(int _id);
+
+  // Unloads all animations.
+  void UnloadAll();
+
+  // Serialization function.
+  // Should not be called directly but through io::Archive >> operator.
+  // Only the index is loaded. Load keeps a reference to the archive stream,
+  // from which animations are loaded.
+  // There's no matching Save function, as a bank can't be written without its
+  // animations: Write() is the only way to write a bank.
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+  // Disables copy and assignation.
+  AnimationBank(AnimationBank const&);
+  void operator=(AnimationBank const&);
+
+  // Internal destruction function.
+  void Destroy();
+
+  // Describes an animation of the bank.
+  struct Clip {
+    // Name hash, used to sort the index.
+    uint32_t hash;
+
+    // Offset of the animation archive, from the end of the index.
+    uint32_t offset;
+
+    // Size of the animation archive.
+    uint32_t size;
+
+    // Animation name, stored in names_ buffer.
+    const char* name;
+
+    // Loaded animation, or NULL.
+    Animation* animation;
+  };
+
+  // Index of the animations, sorted by hash.
+  Clip* clips_;
+  int num_animations_;
+
+  // Buffer of all animation names.
+  char* names_;
+  size_t names_size_;
+
+  // The stream animations are loaded from, and the position of the end of the
+  // index in this stream.
+  ozz::io::Stream* stream_;
+  int base_;
+};
+}  // animation
+
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::AnimationBank)
+OZZ_IO_TYPE_TAG("ozz-animation_bank", animation::AnimationBank)
+}  // io
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_ANIMATION_BANK_H_
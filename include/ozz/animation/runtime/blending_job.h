@@ -46,20 +46,41 @@ namespace animation {
 // buffers must be at least as big as the bind pose buffer.
 // Partial animation blending is supported through optional joint weights that
 // can be specified with layers joint_weights buffer. Unspecified joint weights
-// are considered as a unit weight of 1.f.
+// are considered as a unit weight of 1.f. Soa joints (4 joints) whose weights
+// are all less than or equal to 0 are skipped, so that the cost of a partial
+// layer is proportional to the number of joints it affects. Joints that aren't
+// affected by any layer are set to the bind pose.
+// Additive layers are applied once all the layers are blended and normalized.
+// Additive layer transforms are deltas, usually built with the offline
+// AdditiveAnimationBuilder, which are applied on top of the blended posture
+// according to their weights.
+// The job can be restricted to a range of soa joints with from and to members,
+// so that a posture can be blended by multiple jobs, possibly concurrently.
+// The job needs a weight per joint to accumulate layers weights. It can be
+// provided by the user with the scratch buffer, otherwise a stack buffer is
+// used, limiting the number of joints to kMaxStackSoAJoints soa joints.
 // The job does not owned any buffers (input/output) and will thus not delete
 // them during job's destruction.
 struct BlendingJob {
+  // Maximum number of soa joints the job can blend without a scratch buffer.
+  // This is 4KB of stack.
+  enum { kMaxStackSoAJoints = 256 };
+
   // Default constructor, initializes default values.
   BlendingJob();
 
   // Validates job parameters.
   // Returns true for a valid job, false otherwise:
   // -if layer range is not valid.
-  // -if any layer is not valid.
+  // -if any layer or additive layer is not valid.
   // -if output range is not valid.
   // -if any buffer (including layers' content : transform, joint weights...) is
   // smaller than the bind pose buffer.
+  // -if from is negative or to is less than from.
+  // -if scratch buffer is specified but smaller than the bind pose buffer, or
+  // if it isn't while the range of soa joints to blend is bigger than
+  // kMaxStackSoAJoints.
+  // -if the bind pose has more than Skeleton::kMaxSoAJoints soa joints.
   // -if the threshold value is less than or equal to 0.f.
   bool Validate() const;
 
@@ -113,6 +134,16 @@ struct BlendingJob {
   // The range of layers that must be blended.
   Range<const Layer> layers;
 
+  // Job input additive layers.
+  // The range of additive layers that are applied to the blended output, in
+  // order. Each additive layer costs a single pass over the output joints.
+  // For an additive layer, weight is the fraction of the delta transform that
+  // is applied: 0 leaves the output unchanged and 1 applies the full delta.
+  // Rotation deltas are weighted with a normalized lerp from identity.
+  // Unlike normal layers, weights aren't normalized. This range is optional,
+  // and empty by default.
+  Range<const Layer> additive_layers;
+
   // The skeleton bind pose. The size of this buffer defines the number of
   // transforms to blend. This is the reference because this buffer is defined
   // by the skeleton that all the animations belongs to.
@@ -120,12 +151,31 @@ struct BlendingJob {
   // less than the threshold value, in order to fall back on valid transforms.
   Range<const ozz::math::SoaTransform> bind_pose;
 
+  // The range of soa joints [from,to[ to blend. Other soa joints of the output
+  // aren't modified. Note that the non-partial threshold and normalization
+  // only depend on layers weights, so blending a posture by ranges gives the
+  // same output as blending it at once.
+  // Default range [0,Skeleton::kMaxSoAJoints[ blends all soa joints, as to is
+  // clamped to the bind pose size.
+  int from;
+  int to;
+
   // Job output.
   // The range of output transforms to be filled with blended layer
   // transforms during job execution.
   // Must be at least as big as the bind pose buffer, but only the number of
   // transforms defined by the bind pose buffer size will be processed.
   Range<ozz::math::SoaTransform> output;
+
+  // Optional scratch buffer used by the job to accumulate per-joint weights,
+  // and its number of elements.
+  // Its content doesn't need to be initialized and is undefined after the job
+  // has run. If scratch is NULL (default case), a stack buffer is used, which
+  // is only possible for ranges up to kMaxStackSoAJoints soa joints. Otherwise
+  // scratch_size must be at least as big as the bind pose buffer. Jobs
+  // blending different ranges of the same posture can share it.
+  math::SimdFloat4* scratch;
+  int scratch_size;
 };
 }  // animation
 }  // ozz
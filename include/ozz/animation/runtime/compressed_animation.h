@@ -0,0 +1,207 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_COMPRESSED_ANIMATION_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_COMPRESSED_ANIMATION_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/io/archive_traits.h"
+
+namespace ozz {
+namespace io { class IArchive; class OArchive; }
+namespace math { struct SoaFloat3; struct SoaFloat4; }
+namespace animation {
+
+// Forward declares the AnimationCompressor, used to instantiate a
+// CompressedAnimation.
+namespace offline { class AnimationCompressor; }
+
+// Defines a runtime skeletal animation clip, compressed with a variable bit
+// rate per track.
+// As opposed to the Animation, which stores key frames, CompressedAnimation
+// stores the animation uniformly sampled at num_frames() frames. Each frame
+// stores the translation, rotation and scale values of every track, quantized
+// with a number of bits specific to each track and transformation type. These
+// bit depths are chosen by the AnimationCompressor according to an object-space
+// error budget, so a value that doesn't change along the animation uses no bit
+// at all. Values are quantized in the range of their track and bit-packed,
+// track after track, in a frame. Frames are grouped in fixed-size blocks of
+// kBlockFrames frames, so any frame can be addressed without decoding the
+// preceding ones. Such an animation is sampled by the CompressedSamplingJob,
+// which doesn't require any cache.
+class CompressedAnimation {
+ public:
+
+  // Defines CompressedAnimation constant values.
+  enum Constants {
+    // Number of frames in a block.
+    kBlockFrames = 16,
+
+    // Maximum number of bits used to quantize a value component.
+    kMaxBits = 16,
+
+    // Number of padding bytes at the end of the blocks buffer, allowing to
+    // read any value using a 24 bits load.
+    kPaddingBytes = 2,
+  };
+
+  // Builds a default animation.
+  CompressedAnimation();
+
+  // Declares the public non-virtual destructor.
+  ~CompressedAnimation();
+
+  // Gets the animation clip duration.
+  float duration() const {
+    return duration_;
+  }
+
+  // Gets the number of animated tracks.
+  int num_tracks() const {
+    return num_tracks_;
+  }
+
+  // Returns the number of SoA elements matching the number of tracks of *this
+  // animation. This value is useful to allocate SoA runtime data structures.
+  int num_soa_tracks() const {
+    return (num_tracks_ + 3) / 4;
+  }
+
+  // Gets the number of frames, uniformly distributed in range [0,duration].
+  // There are at least 2 frames, the first one at time 0 and the last one at
+  // time duration.
+  int num_frames() const {
+    return num_frames_;
+  }
+
+  // Gets the number of bits used to quantize each component of translations,
+  // rotations and scales values, with an element per track (including soa
+  // padding tracks). A track using 0 bit has a constant value.
+  ozz::Range<const uint8_t> translation_bits() const {
+    return translation_bits_;
+  }
+  ozz::Range<const uint8_t> rotation_bits() const {
+    return rotation_bits_;
+  }
+  ozz::Range<const uint8_t> scale_bits() const {
+    return scale_bits_;
+  }
+
+  // Gets the quantization ranges of translations, rotations and scales, in soa
+  // format with 2 elements per soa track: tracks minimum values, followed by
+  // the values step between two consecutive quantized integers. A value is
+  // restored as minimum + quantized * step.
+  ozz::Range<const math::SoaFloat3> translation_ranges() const {
+    return translation_ranges_;
+  }
+  ozz::Range<const math::SoaFloat4> rotation_ranges() const {
+    return rotation_ranges_;
+  }
+  ozz::Range<const math::SoaFloat3> scale_ranges() const {
+    return scale_ranges_;
+  }
+
+  // Gets the number of bits of a frame, that is the sum of the bits used by
+  // all tracks values.
+  int frame_bits() const {
+    return frame_bits_;
+  }
+
+  // Gets the size of a block in bytes, which stores kBlockFrames frames.
+  int block_size() const {
+    return block_size_;
+  }
+
+  // Gets the buffer of blocks, followed by kPaddingBytes bytes.
+  ozz::Range<const uint8_t> blocks() const {
+    return blocks_;
+  }
+
+  // Get the estimated animation's size in bytes.
+  size_t size() const;
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+
+  // Disables copy and assignation.
+  CompressedAnimation(CompressedAnimation const&);
+  void operator=(CompressedAnimation const&);
+
+  // AnimationCompressor class is allowed to instantiate a CompressedAnimation.
+  friend class offline::AnimationCompressor;
+
+  // Internal destruction function.
+  void Destroy();
+
+  // Computes frame_bits_ and block_size_ from tracks bit depths.
+  void ComputeFrameLayout();
+
+  // Stores translation/rotation/scale bit depths begin and end of buffers.
+  ozz::Range<uint8_t> translation_bits_;
+  ozz::Range<uint8_t> rotation_bits_;
+  ozz::Range<uint8_t> scale_bits_;
+
+  // Stores translation/rotation/scale quantization ranges begin and end of
+  // buffers.
+  ozz::Range<math::SoaFloat3> translation_ranges_;
+  ozz::Range<math::SoaFloat4> rotation_ranges_;
+  ozz::Range<math::SoaFloat3> scale_ranges_;
+
+  // Stores blocks begin and end of buffer.
+  ozz::Range<uint8_t> blocks_;
+
+  // Number of bits of a frame.
+  int frame_bits_;
+
+  // Size of a block in bytes.
+  int block_size_;
+
+  // Number of frames.
+  int num_frames_;
+
+  // Duration of the animation clip.
+  float duration_;
+
+  // The number of joint tracks. Can differ from the data stored in bits and
+  // ranges buffers because of SoA requirements.
+  int num_tracks_;
+};
+}  // animation
+
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::CompressedAnimation)
+OZZ_IO_TYPE_TAG("ozz-compressed_animation", animation::CompressedAnimation)
+}  // io
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_COMPRESSED_ANIMATION_H_
@@ -0,0 +1,92 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_COMPRESSED_SAMPLING_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_COMPRESSED_SAMPLING_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math { struct SoaTransform; }
+
+namespace animation {
+
+// Forward declares the animation type to sample.
+class CompressedAnimation;
+
+// Samples a compressed animation at a given time, to output the corresponding
+// posture in local-space.
+// The job locates the two frames surrounding the sampling time, unpacks their
+// values from the animation blocks, restores them from their quantization
+// ranges and interpolates them, 4 tracks at a time using SoA math. As any
+// frame can be addressed directly, CompressedSamplingJob doesn't need any
+// cache and costs the same whatever the sampling time or the time of the
+// previous sampling.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct CompressedSamplingJob {
+  // Default constructor, initializes default values.
+  CompressedSamplingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any input pointer is NULL
+  // -if output range is invalid.
+  bool Validate() const;
+
+  // Runs job's sampling task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Time used to sample animation, clamped in range [0,duration] before
+  // job execution. If loop is enabled, time is wrapped in range [0,duration]
+  // instead.
+  float time;
+
+  // Enables looping, in which case time isn't clamped but wrapped in animation
+  // range [0,duration]. Time can then be any value, including a negative one.
+  // Defaults to false.
+  bool loop;
+
+  // The animation to sample.
+  const CompressedAnimation* animation;
+
+  // Job output.
+  // The output range to be filled with sampled joints during job execution.
+  // If there are more SoaTransform in the output range than soa tracks in the
+  // animation, then remaining SoaTransform are left unchanged.
+  Range<ozz::math::SoaTransform> output;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_COMPRESSED_SAMPLING_JOB_H_
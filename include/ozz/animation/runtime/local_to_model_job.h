@@ -53,11 +53,15 @@ class Skeleton;
 // ordered like skeleton's joints. Output are matrices, because the combination
 // of affine transformations can contain shearing or complex transformation
 // that cannot be represented as Transform object.
+// The job can be restricted to a range of joints with from and to members, so
+// that a skeleton can be processed by multiple jobs, possibly concurrently.
+// See SplitJoints() in skeleton_utils.h for dependency-safe ranges.
+// The job can also be restricted to the subtree of a root joint, in order to
+// only update the model-space matrices affected by a local-space change (IK,
+// procedural adjustments...). Other matrices of the output are left untouched.
 struct LocalToModelJob {
   // Default constructor, initializes default values.
-  LocalToModelJob() :
-    skeleton(NULL) {
-  }
+  LocalToModelJob();
 
   // Validates job parameters. Returns true for a valid job, or false otherwise:
   // -if any input pointer, including ranges, is NULL.
@@ -65,6 +69,8 @@ struct LocalToModelJob {
   // Note that this input has a SoA format.
   // -if the size of of the output is smaller than the skeleton's number of
   // joints.
+  // -if from is negative or to is less than from.
+  // -if root isn't Skeleton::kNoParentIndex nor a valid joint index.
   bool Validate() const;
 
   // Runs job's local-to-model task.
@@ -81,6 +87,27 @@ struct LocalToModelJob {
   // The input range that store local transforms.
   Range<const ozz::math::SoaTransform> input;
 
+  // The range of joints [from,to[ to process. Joints are processed in the
+  // skeleton order, which guarantees that a parent is processed before its
+  // children. Model-space matrices of the parents of the range's joints that
+  // aren't part of the range are read from the output, so they must have been
+  // computed already.
+  // Default range [0,Skeleton::kMaxJoints[ processes all skeleton joints, as
+  // to is clamped to the number of skeleton joints.
+  int from;
+  int to;
+
+  // The root joint of the subtree to process. Only this joint and its
+  // descendants that are within [from,to[ range are processed, and the
+  // model-space matrix of root's parent is read from the output. The default
+  // value Skeleton::kNoParentIndex processes all joints of the range.
+  // As all descendants of a joint are stored contiguously, matrices are only
+  // computed for the subtree. Finding the subtree range is done by scanning
+  // joint properties forward from root though, so its cost is linear in the
+  // number of joints between root and its last descendant, which includes the
+  // subtrees of root's previous siblings.
+  int root;
+
   // Job output.
   // The output range to be filled with model matrices.
   Range<ozz::math::Float4x4> output;
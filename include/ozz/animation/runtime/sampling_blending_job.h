@@ -0,0 +1,141 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_SAMPLING_BLENDING_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_SAMPLING_BLENDING_JOB_H_
+
+#include "ozz/base/maths/simd_math.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math { struct SoaTransform; }
+
+namespace animation {
+
+// Forward declares the animation type to sample, and the cache.
+class Animation;
+class SamplingCache;
+
+// Samples and blends multiple animation layers to a single output, which is
+// equivalent to running a SamplingJob per layer followed by a BlendingJob.
+// Each layer is interpolated in small batches of joints that are immediately
+// blended to the output, so no intermediate posture buffer is needed and the
+// output is the only large buffer the job writes. Soa joints that a partial
+// layer doesn't affect (see BlendingJob) are neither decompressed, nor
+// interpolated nor blended.
+// As for the BlendingJob, the number of transforms/joints blended by the job is
+// defined by the number of transforms of the bind pose (note that this is a SoA
+// format). This means that all animations must have at least as many soa
+// tracks, and all buffers must be at least as big as the bind pose buffer.
+// Per-joint weights are accumulated in the optional scratch buffer, see
+// BlendingJob::scratch.
+// The job does not owned any buffers (input/output) and will thus not delete
+// them during job's destruction.
+struct SamplingBlendingJob {
+  // Default constructor, initializes default values.
+  SamplingBlendingJob();
+
+  // Validates job parameters.
+  // Returns true for a valid job, false otherwise:
+  // -if layer range is not valid.
+  // -if any layer is not valid: NULL animation or cache, cache too small, or
+  // animation with less soa tracks than the bind pose.
+  // -if output range is not valid.
+  // -if any buffer (output, layers' joint weights) is smaller than the bind
+  // pose buffer.
+  // -if scratch buffer is not valid, see BlendingJob::scratch.
+  // -if the threshold value is less than or equal to 0.f.
+  bool Validate() const;
+
+  // Runs job's sampling and blending task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Defines a layer of blending input data (animation to sample) and
+  // parameters (weights).
+  struct Layer {
+    // Default constructor, initializes default values.
+    Layer();
+
+    // The animation to sample.
+    const Animation* animation;
+
+    // A cache object that must be big enough to sample *this animation. Each
+    // layer should use its own cache, see SamplingJob::cache.
+    SamplingCache* cache;
+
+    // Time used to sample animation, see SamplingJob::time.
+    float time;
+
+    // Enables looping, see SamplingJob::loop. Defaults to false.
+    bool loop;
+
+    // Blending weight of this layer, see BlendingJob::Layer::weight.
+    // Layers whose weight is less than or equal to 0 aren't sampled at all.
+    float weight;
+
+    // Optional blending weight for each joint in this layer, and its number
+    // of elements, see BlendingJob::Layer::joint_weights. Per joint weight
+    // blending is disabled if joint_weights is NULL (default case).
+    const math::SimdFloat4* joint_weights;
+    int joint_weights_size;
+  };
+
+  // The job blends the bind pose to the output when the accumulated weight of
+  // all layers is less than this threshold value.
+  // Must be greater than 0.f.
+  float threshold;
+
+  // Job input layers.
+  // The range of layers that must be sampled and blended.
+  Range<const Layer> layers;
+
+  // The skeleton bind pose. The size of this buffer defines the number of
+  // transforms to blend, see BlendingJob::bind_pose.
+  Range<const ozz::math::SoaTransform> bind_pose;
+
+  // Job output.
+  // The range of output transforms to be filled with blended layer
+  // transforms during job execution.
+  // Must be at least as big as the bind pose buffer, but only the number of
+  // transforms defined by the bind pose buffer size will be processed.
+  Range<ozz::math::SoaTransform> output;
+
+  // Optional scratch buffer used to accumulate per-joint weights, and its
+  // number of elements, see BlendingJob::scratch.
+  math::SimdFloat4* scratch;
+  int scratch_size;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_SAMPLING_BLENDING_JOB_H_
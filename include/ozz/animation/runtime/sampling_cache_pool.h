@@ -0,0 +1,133 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_SAMPLING_CACHE_POOL_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_SAMPLING_CACHE_POOL_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+
+// Forward declares the cache type.
+class SamplingCache;
+
+// Manages a fixed number of SamplingCache shared by any number of instances
+// (aka characters), as most of them don't need to be sampled every frame.
+// An instance acquires a cache every time it needs to sample an animation. It
+// gets back the same cache as long as this cache wasn't assigned to another
+// instance meanwhile, which preserves frame coherency. Otherwise, the least
+// recently used cache is invalidated and assigned to the instance.
+// Each instance keeps a Handle, which identifies the cache assigned to it.
+// SamplingCachePool isn't thread safe.
+class SamplingCachePool {
+ public:
+  // Identifies the cache assigned to an instance.
+  struct Handle {
+    // Default constructor, the handle is assigned no cache.
+    Handle()
+        : cache(-1),
+          assignment(0) {
+    }
+
+    // Index of the assigned cache in the pool, or -1.
+    int cache;
+
+    // Assignment number of the cache when it was assigned to this handle. The
+    // cache is still assigned to this handle as long as its assignment number
+    // didn't change.
+    uint32_t assignment;
+  };
+
+  // Constructs a pool of _num_caches caches, each one able to sample an
+  // animation with at most _max_tracks tracks.
+  SamplingCachePool(int _num_caches, int _max_tracks);
+
+  // Deallocates caches.
+  ~SamplingCachePool();
+
+  // Gets the number of caches of the pool.
+  int num_caches() const {
+    return num_caches_;
+  }
+
+  // Gets the maximum number of tracks that pool caches can handle.
+  int max_tracks() const;
+
+  // Gets the cache assigned to _handle, or assigns it the least recently used
+  // cache if it has none. The returned cache is the most recently used one.
+  // It must be used before the next call to Acquire, as it can then be
+  // assigned to another handle.
+  SamplingCache* Acquire(Handle* _handle);
+
+  // Tells whether _handle is still assigned a cache, in which case Acquire
+  // will return the same cache.
+  bool assigned(const Handle& _handle) const;
+
+  // Releases the cache assigned to _handle, if any, which becomes the first
+  // one to be assigned again. _handle is reset.
+  void Release(Handle* _handle);
+
+ private:
+  // Disables copy and assignation.
+  SamplingCachePool(SamplingCachePool const&);
+  void operator=(SamplingCachePool const&);
+
+  // Moves cache _index to the front (most recently used) or to the back
+  // (least recently used) of the list.
+  void MoveToFront(int _index);
+  void MoveToBack(int _index);
+
+  // Removes cache _index from the list.
+  void Unlink(int _index);
+
+  // Describes a cache of the pool.
+  struct Entry {
+    // The cache.
+    SamplingCache* cache;
+
+    // Incremented every time the cache is assigned or released.
+    uint32_t assignment;
+
+    // Previous (more recently used) and next (less recently used) caches
+    // indices, or -1.
+    int previous;
+    int next;
+  };
+
+  // Caches, linked from the most recently used to the least recently used.
+  Entry* entries_;
+  int num_caches_;
+  int front_;
+  int back_;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_SAMPLING_CACHE_POOL_H_
@@ -51,8 +51,11 @@ class SamplingCache;
 // SamplingJob uses a cache (aka SamplingCache) to store intermediate values
 // (decompressed animation keyframes...) while sampling. This cache also stores
 // pre-computed values that allows drastic optimization while playing/sampling
-// the animation forward. Backward sampling works, but isn't optimized through
-// the cache.
+// the animation forward or backward, as only the keys that changed since the
+// last sampling are updated. Jumps in time rely on the animation seek index to
+// restart sampling from the closest seek entry, instead of from the beginning
+// of the animation. This is also the case when a looping animation wraps
+// around.
 // The job does not owned the buffers (in/output) and will thus not delete them
 // during job's destruction.
 struct SamplingJob {
@@ -62,6 +65,7 @@ struct SamplingJob {
   // Validates job parameters. Returns true for a valid job, or false otherwise:
   // -if any input pointer is NULL
   // -if output range is invalid.
+  // -if mask is specified but its range is invalid.
   bool Validate() const;
 
   // Runs job's sampling task.
@@ -72,14 +76,30 @@ struct SamplingJob {
 
   // Time used to sample animation, clamped in range [0,duration] before
   // job execution. This resolves approximations issues on range bounds.
+  // If loop is enabled, time is wrapped in range [0,duration] instead.
   float time;
 
+  // Enables looping, in which case time isn't clamped but wrapped in animation
+  // range [0,duration]. Time can then be any value, including a negative one.
+  // Defaults to false.
+  bool loop;
+
   // The animation to sample.
   const Animation* animation;
 
   // A cache object that must be big enough to sample *this animation.
   SamplingCache* cache;
 
+  // Optional mask, with one entry per soa track (4 joints) of the animation.
+  // Only the tracks whose mask entry is true are decompressed and
+  // interpolated, which allows to save cpu when only a subset of the joints is
+  // required (partial body layers, skeleton level of details...). Output of
+  // masked out tracks is left unchanged. Keys of masked out tracks are still
+  // fetched, but aren't decompressed until these tracks are enabled again.
+  // If the range is empty (default), all tracks are sampled. Otherwise it must
+  // be at least as big as the number of soa tracks of the animation.
+  Range<const bool> mask;
+
   // Job output.
   // The output range to be filled with sampled joints during job execution.
   // If there are less joints in the animation compared to the output range,
@@ -89,6 +109,63 @@ struct SamplingJob {
   Range<ozz::math::SoaTransform> output;
 };
 
+// Samples the same animation for multiple instances (aka characters), each one
+// having its own time, cache and output.
+// Instances whose times fall in the same key frame interval (for all the
+// tracks) share key frame lookups and decompression: only the first instance
+// of such a group updates its cache, others are directly interpolated from it.
+// The cache of an instance that was interpolated from another instance's cache
+// is left unchanged. Sorting instances by increasing time maximizes the number
+// of instances that can share the same cache, as only consecutive instances
+// are compared.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct BatchSamplingJob {
+  // Default constructor, initializes default values.
+  BatchSamplingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if animation pointer is NULL.
+  // -if instances range is invalid.
+  // -if any instance is not valid, see SamplingJob::Validate() for
+  // instance validation rules.
+  bool Validate() const;
+
+  // Runs job's sampling task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid.
+  bool Run() const;
+
+  // Defines a sampling instance.
+  struct Instance {
+    // Default constructor, initializes default values.
+    Instance();
+
+    // Time used to sample animation, clamped (or wrapped if loop is enabled)
+    // in range [0,duration] before job execution.
+    float time;
+
+    // A cache object that must be big enough to sample the animation. Each
+    // instance should use its own cache, even though sharing the same cache
+    // between multiple instances is valid.
+    SamplingCache* cache;
+
+    // The output range to be filled with sampled joints during job execution.
+    // See SamplingJob::output for more details.
+    Range<ozz::math::SoaTransform> output;
+  };
+
+  // The animation to sample, shared by all instances.
+  const Animation* animation;
+
+  // Enables looping for all instances, see SamplingJob::loop.
+  bool loop;
+
+  // The range of instances to sample.
+  Range<const Instance> instances;
+};
+
 namespace internal {
   // Soa hot data to interpolate.
   struct InterpSoaTranslation;
@@ -111,11 +188,10 @@ class SamplingCache {
   // Invalidate the cache.
   // The SamplingJob automatically invalidates a cache when required
   // during sampling. This automatic mechanism is based on the animation
-  // address and sampling time. The weak point is that it can result in a
-  // crash if ever the address of an animation is used again with another
-  // animation (could be the result of successive call to delete / new).
-  // Therefore it is recommended to manually invalidate a cache when it is
-  // known that this cache will not be used for with an animation again.
+  // generation id (see Animation::generation()), which changes whenever an
+  // animation is (re)loaded, so it's safe even if the address of an animation
+  // is used again by another animation. Invalidating manually only forces
+  // keys to be fetched again on next sampling.
   void Invalidate();
 
   // The maximum number of tracks that the cache can handle.
@@ -129,18 +205,31 @@ class SamplingCache {
   void operator=(SamplingCache const&);
 
   friend struct SamplingJob;
+  friend struct BatchSamplingJob;
+  friend struct SamplingBlendingJob;
+
+  // Steps the cache in order to use it for a potentially new animation. If the
+  // _animation is different from the animation currently cached, then the
+  // cache is invalidated and reseted for the new _animation. Keys are then
+  // restored from _animation seek index during the update.
+  void Step(const Animation& _animation);
 
-  // Steps the cache in order to use it for a potentially new animation and
-  // time. If the _animation is different from the animation currently cached,
-  // or if the _time shows that the animation is played backward, then the
-  // cache is invalidated and reseted for the new _animation and _time.
-  void Step(const Animation& _animation, float _time);
+  // Steps the cache to _animation and _time, then fetches and decompresses
+  // all the keys required to interpolate _animation at _time.
+  // _time must be in range [0,duration]. Only the soa tracks enabled in _mask
+  // are decompressed, or all of them if _mask is NULL.
+  void Update(const Animation& _animation, float _time, const bool* _mask);
 
-  // The animation this cache refers to. NULL means that the cache is invalid.
-  const Animation* animation_;
+  // Returns the time up to which (excluded) the cache remains valid without
+  // requiring any further key update, assuming the cache was updated with
+  // _animation. The returned time is in _animation key time units, aka a
+  // fraction of its duration quantized on 16 bits, or 24 bits if its key
+  // times are wide (see Animation::wide_key_times()).
+  float valid_until(const Animation& _animation) const;
 
-  // The current time in the animation.
-  float time_;
+  // The generation id of the animation this cache refers to. 0 means that the
+  // cache is invalid.
+  uint32_t animation_;
 
   // The number of soa tracks that can store this cache.
   int max_soa_tracks_;
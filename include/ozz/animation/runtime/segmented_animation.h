@@ -0,0 +1,185 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_SEGMENTED_ANIMATION_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_SEGMENTED_ANIMATION_H_
+
+#include "ozz/base/platform.h"
+#include "ozz/base/io/archive_traits.h"
+
+namespace ozz {
+namespace io { class IArchive; class OArchive; class Stream; }
+namespace animation {
+
+// Forward declares the SegmentedAnimationBuilder, used to instantiate a
+// SegmentedAnimation.
+namespace offline { class SegmentedAnimationBuilder; }
+
+// Forward declares the runtime animation type.
+class Animation;
+
+// Defines a long animation (cinematics...) split in time segments that are
+// loaded and unloaded independently, so that only a few of them need to be
+// resident in memory at a time.
+// Every segment is a self-contained Animation that covers segment_duration
+// seconds (the last one can be slightly longer) of the whole animation. It
+// starts and ends with keys sampled at its boundaries, so it can be sampled
+// without any other segment. Segment n local time 0 matches time
+// n * segment_duration of the whole animation.
+// A segmented animation starts with an index, made of the offset and size of
+// every segment, which is followed by serialized segments. Each of them is
+// stored as a standalone Animation archive. Loading a segmented animation
+// (from an IArchive) only reads its index. Segments are then loaded on demand
+// by seeking to their offset in the archive stream, which must thus remain
+// valid and opened as long as segments need to be loaded.
+// SegmentedSamplingJob reports the segment it requires, and the one that
+// follows, so the application can prefetch it before it's needed.
+// SegmentedAnimation isn't thread safe, as loading a segment changes the
+// stream position indicator.
+class SegmentedAnimation {
+ public:
+  // Builds an empty segmented animation.
+  SegmentedAnimation();
+
+  // Unloads all segments.
+  ~SegmentedAnimation();
+
+  // Gets the whole animation duration.
+  float duration() const {
+    return duration_;
+  }
+
+  // Gets the number of animated tracks.
+  int num_tracks() const {
+    return num_tracks_;
+  }
+
+  // Returns the number of SoA elements matching the number of tracks of *this
+  // animation.
+  int num_soa_tracks() const {
+    return (num_tracks_ + 3) / 4;
+  }
+
+  // Gets the duration of a segment. The last segment covers the remaining
+  // time, which can be slightly longer.
+  float segment_duration() const {
+    return segment_duration_;
+  }
+
+  // Gets the number of segments.
+  int num_segments() const {
+    return num_segments_;
+  }
+
+  // Finds the segment that must be sampled at _time, clamped in range
+  // [0,duration], or wrapped if _loop is true. Returns -1 if *this animation
+  // has no segment.
+  int FindSegment(float _time, bool _loop) const;
+
+  // Gets the time, in the whole animation time line, at which segment _id
+  // starts.
+  float segment_start(int _id) const;
+
+  // Loads segment _id from the animation stream, if it isn't already loaded.
+  // Returns false if it couldn't be loaded.
+  bool LoadSegment(int _id);
+
+  // Gets segment _id, or NULL if it isn't loaded.
+  const Animation* segment(int _id) const;
+
+  // Unloads segment _id, if it's loaded.
+  void UnloadSegment(int _id);
+
+  // Unloads all segments.
+  void UnloadAll();
+
+  // Get the estimated size in bytes of the index and the loaded segments.
+  size_t size() const;
+
+  // Serialization functions.
+  // Should not be called directly but through io::Archive << and >> operators.
+  // Save requires all segments to be loaded. Load only reads the index, and
+  // keeps a reference to the archive stream, from which segments are loaded.
+  void Save(ozz::io::OArchive& _archive) const;
+  void Load(ozz::io::IArchive& _archive, uint32_t _version);
+
+ private:
+  // Disables copy and assignation.
+  SegmentedAnimation(SegmentedAnimation const&);
+  void operator=(SegmentedAnimation const&);
+
+  // SegmentedAnimationBuilder class is allowed to instantiate a
+  // SegmentedAnimation.
+  friend class offline::SegmentedAnimationBuilder;
+
+  // Internal destruction function.
+  void Destroy();
+
+  // Allocates the index of _num_segments segments, all unloaded.
+  void Allocate(int _num_segments);
+
+  // Describes a segment.
+  struct Segment {
+    // Offset of the segment archive, from the end of the index.
+    uint32_t offset;
+
+    // Size of the segment archive.
+    uint32_t size;
+
+    // Loaded segment, or NULL.
+    Animation* animation;
+  };
+
+  // Whole animation duration.
+  float duration_;
+
+  // The number of joint tracks.
+  int num_tracks_;
+
+  // Duration of every segment, but the last one.
+  float segment_duration_;
+
+  // Index of the segments.
+  Segment* segments_;
+  int num_segments_;
+
+  // The stream segments are loaded from, and the position of the end of the
+  // index in this stream.
+  ozz::io::Stream* stream_;
+  int base_;
+};
+}  // animation
+
+namespace io {
+OZZ_IO_TYPE_VERSION(1, animation::SegmentedAnimation)
+OZZ_IO_TYPE_TAG("ozz-segmented_animation", animation::SegmentedAnimation)
+}  // io
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_SEGMENTED_ANIMATION_H_
@@ -0,0 +1,110 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_ANIMATION_RUNTIME_SEGMENTED_SAMPLING_JOB_H_
+#define OZZ_OZZ_ANIMATION_RUNTIME_SEGMENTED_SAMPLING_JOB_H_
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+
+// Forward declaration of math structures.
+namespace math { struct SoaTransform; }
+
+namespace animation {
+
+// Forward declares the animation type to sample, and the cache.
+class SegmentedAnimation;
+class SamplingCache;
+
+// Samples a segmented animation at a given time, to output the corresponding
+// posture in local-space.
+// The job finds the segment that covers the sampling time, and samples it with
+// a SamplingJob at the matching segment local time. This segment must be
+// loaded, which the job doesn't do as it would block on the animation stream.
+// Instead, the job reports the segment it requires, and the one that follows
+// during forward playback, so the application can load it before it's needed
+// and unload segments that aren't needed anymore.
+// The job does not owned the buffers (in/output) and will thus not delete them
+// during job's destruction.
+struct SegmentedSamplingJob {
+  // Default constructor, initializes default values.
+  SegmentedSamplingJob();
+
+  // Validates job parameters. Returns true for a valid job, or false otherwise:
+  // -if any input pointer is NULL
+  // -if output range is invalid.
+  // -if cache isn't big enough.
+  // Note that the job is valid even if the required segment isn't loaded.
+  bool Validate() const;
+
+  // Runs job's sampling task.
+  // The job is validated before any operation is performed, see Validate() for
+  // more details.
+  // Returns false if *this job is not valid, or if the required segment isn't
+  // loaded, in which case output is left unchanged. segment and next_segment
+  // outputs are filled in both cases as long as the job is valid.
+  bool Run() const;
+
+  // Time used to sample animation, clamped in range [0,duration] before
+  // job execution. If loop is enabled, time is wrapped in range [0,duration]
+  // instead.
+  float time;
+
+  // Enables looping, in which case time isn't clamped but wrapped in animation
+  // range [0,duration]. Time can then be any value, including a negative one.
+  // Defaults to false.
+  bool loop;
+
+  // The animation to sample.
+  const SegmentedAnimation* animation;
+
+  // A cache object that must be big enough to sample *this animation. Cache
+  // is automatically invalidated when the sampled segment changes.
+  SamplingCache* cache;
+
+  // Job output.
+  // The output range to be filled with sampled joints during job execution.
+  // If there are less joints in the animation compared to the output range,
+  // then remaining SoaTransform are left unchanged.
+  Range<ozz::math::SoaTransform> output;
+
+  // Optional output, receives the id of the segment required to sample time.
+  int* segment;
+
+  // Optional output, receives the id of the segment that follows the required
+  // one during forward playback, which should be prefetched. It's the first
+  // segment if the required one is the last and loop is enabled, or -1 if
+  // there's no following segment.
+  int* next_segment;
+};
+}  // animation
+}  // ozz
+#endif  // OZZ_OZZ_ANIMATION_RUNTIME_SEGMENTED_SAMPLING_JOB_H_
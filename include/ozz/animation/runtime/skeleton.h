@@ -32,6 +32,7 @@
 #define OZZ_OZZ_ANIMATION_RUNTIME_SKELETON_H_
 
 #include "ozz/base/platform.h"
+#include "ozz/base/endianness.h"
 #include "ozz/base/io/archive_traits.h"
 
 namespace ozz {
@@ -59,16 +60,17 @@ class Skeleton {
   // Defines Skeleton constant values.
   enum Constants {
     // Limits the number of joints in order to control the number of bits
-    // required to store a joint index. Limiting the number of joints also helps
-    // handling worst size cases, like when it is required to allocate an array
-    // of joints on the stack.
-    // The definitive value isn't decided yet, it'll depend on the number of
-    // bits available in the runtime animation key frame structure once it'll be
-    // compressed.
-    kMaxJointsNumBits = 10,
+    // required to store a joint index. This value matches the number of bits
+    // available to store the track index of runtime animation rotation key
+    // frames. Jobs don't allocate arrays of the maximum number of joints on
+    // the stack, they rely on caller provided buffers instead.
+    kMaxJointsNumBits = 14,
 
     // Defines the maximum number of joints.
     // Reserves one index (the last) for kNoParentIndex value.
+    // Note that BlendingJob and SamplingBlendingJob can only blend up to
+    // BlendingJob::kMaxStackSoAJoints soa joints (1024 joints) without a
+    // caller provided scratch buffer.
     kMaxJoints = (1<<kMaxJointsNumBits) - 1,
 
     // Defines the maximum number of SoA elements required to store the maximum
@@ -124,6 +126,20 @@ class Skeleton {
   void Save(ozz::io::OArchive& _archive) const;
   void Load(ozz::io::IArchive& _archive, uint32_t _version);
 
+  // Relocatable image functions, see ozz/base/io/image.h.
+  // Writes *this skeleton image to _image buffer of _size bytes, with
+  // _endianness. _image must be aligned to 16 bytes. Returns the image size,
+  // or 0 if _size is too small. If _image is NULL, returns the required size.
+  size_t SaveImage(void* _image, size_t _size, Endianness _endianness) const;
+
+  // Initializes *this skeleton as a view over _image buffer of _size bytes.
+  // Only the array of joint names pointers is allocated, everything else
+  // references _image memory, which must be aligned to 16 bytes and must
+  // outlive *this skeleton. It's swapped in-place if its endianness isn't
+  // native. Returns false if _image isn't a valid skeleton image, in which
+  // case *this skeleton is left empty and _image content is undefined.
+  bool LoadImage(void* _image, size_t _size);
+
  private:
 
   // Disables copy and assignation.
@@ -151,11 +167,15 @@ class Skeleton {
 
   // The number of joints.
   int num_joints_;
+
+  // True if *this skeleton is a view over an image, in which case joint names,
+  // properties and bind pose belong to the image.
+  bool image_view_;
 };
 }  // animation
 
 namespace io {
-OZZ_IO_TYPE_VERSION(1, animation::Skeleton)
+OZZ_IO_TYPE_VERSION(2, animation::Skeleton)
 OZZ_IO_TYPE_TAG("ozz-skeleton", animation::Skeleton)
 }  // io
 }  // ozz
@@ -33,6 +33,8 @@
 
 #include "skeleton.h"
 
+#include <cassert>
+
 #include "ozz/base/maths/transform.h"
 
 namespace ozz {
@@ -43,8 +45,18 @@ ozz::math::Transform GetJointBindPose(const Skeleton& _skeleton, int _joint);
 
 // Defines the iterator structure used by IterateJointsDF to traverse joint
 // hierarchy.
+// Note that joints buffer used to be a fixed size array of Skeleton::kMaxJoints
+// indices, which doesn't fit on the stack anymore since the maximum number of
+// joints was raised. Callers must now provide it.
 struct JointsIterator {
-  uint16_t joints[Skeleton::kMaxJoints];
+  // The buffer of joint indices, provided by the caller. It's filled in
+  // depth-first order with the traversed joints, which are at most the number
+  // of joints of the skeleton. The traversal is truncated to the size of the
+  // buffer: joints that don't fit in the buffer are not output.
+  Range<uint16_t> joints;
+
+  // The number of joints output to joints buffer, which is never more than
+  // the size of the joints buffer.
   int num_joints;
 };
 
@@ -53,13 +65,39 @@ struct JointsIterator {
 // _from indicates the join from which the joint hierarchy traversal begins. Use
 // Skeleton::kNoParentIndex to traverse the whole hierarchy, even if there are
 // multiple joints.
-// This function does not use a recursive implementation, to enforce a
-// predictable stack usage, independent off the data (joint hierarchy) being
-// processed.
+// This function does not use a recursive implementation nor any stack, to
+// enforce a predictable memory usage, independent off the data (joint
+// hierarchy) being processed. See the functor variant below.
 void IterateJointsDF(const Skeleton& _skeleton,
                      int _from,
                      JointsIterator* _iterator);
 
+// Defines a range of joints [begin,end[ that can be processed by a job, as
+// output by SplitJoints.
+struct JointsChunk {
+  // The range of joints of the chunk. begin is always a multiple of 4, so that
+  // the chunk matches the range of soa joints [begin/4,(end+3)/4[.
+  int begin;
+  int end;
+
+  // The stage of the chunk. Chunks of a stage only depend on (have parent
+  // joints in) chunks of previous stages, so all chunks of a stage can be
+  // processed concurrently once previous stages are done. Chunks are ordered
+  // by joint index, not by stage.
+  int stage;
+};
+
+// Splits _skeleton joints into chunks of at most _max_joints joints (rounded up
+// to a multiple of 4), to be processed by LocalToModelJob and BlendingJob
+// ranges. Stage of each chunk is computed from joints hierarchy, see
+// JointsChunk.
+// _chunks must be big enough to store all chunks, ie
+// (num_joints + max_joints - 1) / max_joints, with max_joints rounded up.
+// Returns the number of chunks written to _chunks, or 0 if it's too small.
+int SplitJoints(const Skeleton& _skeleton,
+                int _max_joints,
+                Range<JointsChunk> _chunks);
+
 // Applies a specified functor to each joint in a depth-first order.
 // _Fct is of type void(int _current, int _parent) where the first argument is
 // the child of the second argument. _parent is kNoParentIndex if the _current
@@ -67,22 +105,85 @@ void IterateJointsDF(const Skeleton& _skeleton,
 // _from indicates the join from which the joint hierarchy traversal begins. Use
 // Skeleton::kNoParentIndex to traverse the whole hierarchy, even if there are
 // multiple joints.
-// This implementation is based on IterateJointsDF(*, *, JointsIterator$)
-// variant.
+// The traversal doesn't require any memory. Its cost is linear in the number
+// of traversed joints, plus a single forward search for the first child of
+// _from joint. It relies on joints order: the children of a joint are
+// contiguous, and follow the subtrees of the joint's previous siblings, as
+// output by RawSkeleton::IterHierarchyBF. So while traversing depth-first, the
+// children of the next joint with children are always right after the last
+// joint of all the children groups met so far. The hierarchy is rewound using
+// parent indices.
 template<typename _Fct>
 inline _Fct IterateJointsDF(const Skeleton& _skeleton, int _from, _Fct _fct) {
-  // Iterates and fills iterator.
-  JointsIterator iterator;
-  IterateJointsDF(_skeleton, _from, &iterator);
-
-  // Consumes iterator and call _fct.
-  Range<const Skeleton::JointProperties> properties =
-    _skeleton.joint_properties();
-  for (int i = 0; i < iterator.num_joints; ++i) {
-    const int joint = iterator.joints[i];
-    _fct(joint, properties.begin[joint].parent);
+  const int num_joints = _skeleton.num_joints();
+  const Skeleton::JointProperties* properties =
+    _skeleton.joint_properties().begin;
+
+  // Validates input range first.
+  if (num_joints == 0) {
+    return _fct;
+  }
+  if ((_from < 0 || _from >= num_joints) &&
+      _from != Skeleton::kNoParentIndex) {
+    return _fct;
+  }
+
+  // Finds the first children group to traverse. When traversing the whole
+  // hierarchy, roots are the first group, so the next one follows. When
+  // traversing from a joint, its siblings aren't traversed, so the next group
+  // is its children one, which is searched once.
+  int joint;
+  int next_group;
+  if (_from == Skeleton::kNoParentIndex) {
+    joint = 0;
+    for (next_group = 1;
+         next_group < num_joints &&
+           properties[next_group].parent == Skeleton::kNoParentIndex;
+         ++next_group) {
+    }
+  } else {
+    joint = _from;
+    for (next_group = _from + 1;
+         next_group < num_joints && properties[next_group].parent != _from;
+         ++next_group) {
+    }
+  }
+
+  for (;;) {
+    _fct(joint, properties[joint].parent);
+
+    // Processes the first child, if any. Its group starts at next_group, and
+    // is skipped so next_group points to the next children group.
+    if (!properties[joint].is_leaf) {
+      assert(next_group < num_joints &&
+             properties[next_group].parent == joint);
+      const int parent = joint;
+      joint = next_group;
+      for (++next_group;
+           next_group < num_joints && properties[next_group].parent == parent;
+           ++next_group) {
+      }
+      continue;
+    }
+
+    // Rewinds the hierarchy up to the first joint with a sibling, which is
+    // processed next. Traversal ends when rewinding reaches _from joint, or
+    // the root.
+    for (;;) {
+      if (joint == _from) {
+        return _fct;
+      }
+      if (joint + 1 < num_joints &&
+          properties[joint + 1].parent == properties[joint].parent) {
+        ++joint;  // The brother is the next joint in its children group.
+        break;
+      }
+      joint = properties[joint].parent;
+      if (joint == Skeleton::kNoParentIndex) {
+        return _fct;
+      }
+    }
   }
-  return _fct;
 }
 }  // animation
 }  // ozz
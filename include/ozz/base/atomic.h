@@ -0,0 +1,47 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_ATOMIC_H_
+#define OZZ_OZZ_BASE_ATOMIC_H_
+
+// Proposes atomic operations on integers, for counters shared by multiple
+// threads. They rely on compiler intrinsics, so no lock is involved.
+
+namespace ozz {
+namespace atomic {
+
+// Atomically increments *_value and returns its new value.
+long Increment(volatile long* _value);
+
+// Atomically decrements *_value and returns its new value.
+long Decrement(volatile long* _value);
+}  // atomic
+}  // ozz
+#endif  // OZZ_OZZ_BASE_ATOMIC_H_
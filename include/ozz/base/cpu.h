@@ -0,0 +1,76 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_CPU_H_
+#define OZZ_OZZ_BASE_CPU_H_
+
+// Proposes an interface to query host cpu instruction sets, used to dispatch
+// runtime jobs to the kernels compiled for the fastest instruction set
+// supported by the cpu. Kernels are compiled once per instruction set, so a
+// single library build runs on every cpu.
+// The instruction set is detected automatically (using CPUID instruction on
+// x86 cpus). It can be overridden with ozz::cpu::SetInstructionSet function,
+// which is mainly intended for testing purpose.
+
+namespace ozz {
+namespace cpu {
+
+// Instruction sets job kernels can be compiled for, sorted from the lowest to
+// the highest.
+enum InstructionSet {
+  kBaseline,  // Instruction set the library is built with (SSE2, ref...).
+  kSSE4_1,  // SSE4.1 instruction set.
+  kAVX2,  // AVX2 instruction set, allows 8-wide soa kernels.
+  kInstructionSetCount,  // Number of instruction sets, not a valid set.
+};
+
+// Tests if host cpu supports instruction set _set. kBaseline is always
+// supported.
+bool IsSupported(InstructionSet _set);
+
+// Detects the highest instruction set supported by the host cpu.
+InstructionSet Detect();
+
+// Gets the instruction set job kernels are dispatched to. Defaults to the
+// result of Detect() function, which is called during static initialization.
+// This function is thread safe.
+// Jobs use kernels of the highest instruction set, up to this one, they were
+// compiled for.
+InstructionSet GetInstructionSet();
+
+// Overrides the instruction set job kernels are dispatched to.
+// Returns false if _set is not supported by the host cpu, in which case the
+// current instruction set is left unchanged. Use SetInstructionSet(Detect())
+// to restore automatic selection.
+// This function isn't thread safe, it must not be called while jobs are run.
+bool SetInstructionSet(InstructionSet _set);
+}  // cpu
+}  // ozz
+#endif  // OZZ_OZZ_BASE_CPU_H_
@@ -36,6 +36,10 @@
 #include "ozz/base/platform.h"
 #include <cstddef>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif  // __SSE2__
+
 namespace ozz {
 
 // Declares supported endianness.
@@ -89,7 +93,17 @@ template <typename _Ty>
 struct EndianSwapper<_Ty, 2> {
   OZZ_INLINE static void Swap(_Ty* _ty, size_t _count) {
     char* alias = reinterpret_cast<char*>(_ty);
-    for (size_t i = 0; i < _count * 2; i += 2) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    // Swaps 8 elements at a time, as large arrays are swapped while loading.
+    for (; i + 16 <= _count * 2; i += 16) {
+      __m128i* block = reinterpret_cast<__m128i*>(alias + i);
+      const __m128i v = _mm_loadu_si128(block);
+      _mm_storeu_si128(
+        block, _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+    }
+#endif  // __SSE2__
+    for (; i < _count * 2; i += 2) {
       _OZZ_BYTE_SWAP(alias[i + 0], alias[i + 1]);
     }
   }
@@ -105,7 +119,19 @@ template <typename _Ty>
 struct EndianSwapper<_Ty, 4> {
   OZZ_INLINE static void Swap(_Ty* _ty, size_t _count) {
     char* alias = reinterpret_cast<char*>(_ty);
-    for (size_t i = 0; i < _count * 4; i += 4) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    // Swaps 4 elements at a time: swaps 16 bits halves, and then their bytes.
+    for (; i + 16 <= _count * 4; i += 16) {
+      __m128i* block = reinterpret_cast<__m128i*>(alias + i);
+      __m128i v = _mm_loadu_si128(block);
+      v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+      v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+      _mm_storeu_si128(
+        block, _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+    }
+#endif  // __SSE2__
+    for (; i < _count * 4; i += 4) {
       _OZZ_BYTE_SWAP(alias[i + 0], alias[i + 3]);
       _OZZ_BYTE_SWAP(alias[i + 1], alias[i + 2]);
     }
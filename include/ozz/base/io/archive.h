@@ -47,6 +47,10 @@
 // Arrays of struct/class or primitive types can be saved/loaded with the
 // helper function ozz::io::MakeArray() that is then streamed in or out using
 // << and >> archive operators: archive << ozz::io::MakeArray(my_array, count);
+// Arrays of POD (plain old data) structures can rather be saved/loaded as a
+// single contiguous block of memory with ozz::io::MakePodArray(). Endianness
+// conversion is then done in-place by ozz::io::PodSwapper, which must be
+// specialized for structures that aren't only made of 4 bytes words.
 //
 // Versioning can be done using OZZ_IO_TYPE_VERSION macros. Type version
 // is saved in the OArchive, and is given back to Load functions to allow to
@@ -80,6 +84,7 @@
 #include "ozz/base/io/stream.h"
 
 #include <cassert>
+#include <cstring>
 #include <stdint.h>
 
 #include "ozz/base/io/archive_traits.h"
@@ -360,6 +365,102 @@ _OZZ_IO_PRIMITIVE_TYPE(float)
 #undef _OZZ_IO_PRIMITIVE_TYPE
 }  // internal
 
+// Swaps _count POD structures of type _Ty in-place, from or to native
+// endianness according to _to_native. The default implementation swaps types
+// made of 4 bytes words (integers, floats and math structures). Types made of
+// mixed size members, or bit-fields, must specialize this template.
+template <typename _Ty, size_t _size = sizeof(_Ty)>
+struct PodSwapper {
+  static void Swap(_Ty* _values, size_t _count, bool _to_native) {
+    OZZ_STATIC_ASSERT(_size % 4 == 0);
+    (void)_to_native;
+    EndianSwapper<uint32_t>::Swap(reinterpret_cast<uint32_t*>(_values),
+                                  _count * _size / 4);
+  }
+};
+
+template <typename _Ty>
+struct PodSwapper<_Ty, 1> {
+  static void Swap(_Ty* /*_values*/, size_t /*_count*/, bool /*_to_native*/) {
+  }
+};
+
+template <typename _Ty>
+struct PodSwapper<_Ty, 2> {
+  static void Swap(_Ty* _values, size_t _count, bool /*_to_native*/) {
+    EndianSwapper<_Ty>::Swap(_values, _count);
+  }
+};
+
+namespace internal {
+// Saves and loads POD structures arrays as contiguous blocks of memory.
+template <typename _Ty>
+inline void SavePod(OArchive& _archive, const _Ty* _values, size_t _count) {
+  if (!_archive.endian_swap()) {
+    OZZ_IF_DEBUG(size_t size =) _archive.SaveBinary(_values,
+                                                    _count * sizeof(_Ty));
+    assert(size == _count * sizeof(_Ty));
+    return;
+  }
+  // Swaps a copy, as the array itself is const. Copies are done by chunks to
+  // keep the number of stream writes low.
+  _Ty chunk[(1024 + sizeof(_Ty) - 1) / sizeof(_Ty)];
+  for (size_t i = 0; i < _count; i += OZZ_ARRAY_SIZE(chunk)) {
+    const size_t count = _count - i < OZZ_ARRAY_SIZE(chunk) ?
+                           _count - i : OZZ_ARRAY_SIZE(chunk);
+    std::memcpy(chunk, _values + i, count * sizeof(_Ty));
+    PodSwapper<_Ty>::Swap(chunk, count, false);
+    OZZ_IF_DEBUG(size_t size =) _archive.SaveBinary(chunk,
+                                                    count * sizeof(_Ty));
+    assert(size == count * sizeof(_Ty));
+  }
+}
+
+template <typename _Ty>
+inline void LoadPod(IArchive& _archive, _Ty* _values, size_t _count) {
+  OZZ_IF_DEBUG(size_t size =) _archive.LoadBinary(_values,
+                                                  _count * sizeof(_Ty));
+  assert(size == _count * sizeof(_Ty));
+  if (_archive.endian_swap()) {  // Can swap in-place.
+    PodSwapper<_Ty>::Swap(_values, _count, true);
+  }
+}
+
+// Wrapper for POD structures array serialization.
+// Must be used through ozz::io::MakePodArray.
+template <typename _Ty>
+struct PodArray {
+  OZZ_INLINE void Save(OArchive& _archive) const {
+    SavePod(_archive, array, count);
+  }
+  OZZ_INLINE void Load(IArchive& _archive, uint32_t /*_version*/) const {
+    LoadPod(_archive, array, count);
+  }
+  _Ty* array;
+  size_t count;
+};
+
+// Arrays of POD structures are not versionable, their layout is versioned by
+// the object that contains them.
+template <typename _Ty> struct Version<const PodArray<_Ty> > {
+  enum { kValue = 0 };
+};
+}  // internal
+
+// Utility function that instantiates PodArray wrapper.
+template <typename _Ty>
+OZZ_INLINE const internal::PodArray<_Ty> MakePodArray(_Ty* _array,
+                                                      size_t _count) {
+  const internal::PodArray<_Ty> array = {_array, _count};
+  return array;
+}
+template <typename _Ty>
+OZZ_INLINE const internal::PodArray<const _Ty> MakePodArray(
+  const _Ty* _array, size_t _count) {
+  const internal::PodArray<const _Ty> array = {_array, _count};
+  return array;
+}
+
 // Utility function that instantiates Array wrapper.
 template <typename _Ty>
 OZZ_INLINE const internal::Array<_Ty> MakeArray(_Ty* _array,
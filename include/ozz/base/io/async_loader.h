@@ -0,0 +1,129 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_IO_ASYNC_LOADER_H_
+#define OZZ_OZZ_BASE_IO_ASYNC_LOADER_H_
+
+// Provides asynchronous loading of archive objects (skeletons, animations,
+// meshes...) from files, so that the calling thread never blocks on file
+// reading and deserialization.
+// Load requests are queued and processed in order by a small pool of worker
+// threads. Each request returns a handle that can be polled or waited on.
+// Any type that can be loaded from an IArchive (ie: that has a tag, see
+// OZZ_IO_TYPE_TAG) can be loaded asynchronously. Note that types that keep a
+// reference to the archive stream after loading (AnimationBank,
+// SegmentedAnimation) can't, as the file is closed once loaded.
+
+#include "ozz/base/platform.h"
+#include "ozz/base/io/archive.h"
+
+namespace ozz {
+namespace io {
+
+// Loads archive objects from files using a pool of worker threads.
+// All AsyncLoader functions can be called from any thread, but a handle must
+// only be used by a single thread at a time.
+class AsyncLoader {
+ private:
+  // Internal request and loader implementation.
+  struct Request;
+  struct Impl;
+
+ public:
+  // Status of a load request.
+  enum Status {
+    kPending,  // Request is queued or being processed.
+    kSucceeded,  // Object was loaded.
+    kFailed  // File couldn't be opened, or doesn't contain such an object.
+  };
+
+  // Identifies a load request, until it is released.
+  typedef Request* Handle;
+
+  // Constructs a loader that uses _num_threads worker threads. If _num_threads
+  // is 0 (or if threads can't be created), requests are processed
+  // synchronously by Load function.
+  explicit AsyncLoader(int _num_threads);
+
+  // Stops worker threads once requests being processed are completed.
+  // All handles must be released before the loader is destroyed.
+  ~AsyncLoader();
+
+  // Gets the number of worker threads.
+  int num_threads() const;
+
+  // Queues a request to load *_object from file _filename. _object must not be
+  // accessed until the request is completed (or released), and must outlive
+  // it. _filename is copied.
+  // Returns the request handle, which must be released with Release().
+  template<typename _Ty>
+  Handle Load(const char* _filename, _Ty* _object) {
+    return Push(_filename, _object, &LoadObject<_Ty>);
+  }
+
+  // Gets request _handle status, without blocking.
+  Status status(Handle _handle) const;
+
+  // Blocks until request _handle is completed, and returns its status.
+  Status Wait(Handle _handle);
+
+  // Releases request _handle, which can't be used anymore. A request that
+  // wasn't processed yet is canceled. If the request is being processed, the
+  // function blocks until it's completed, so the object can be safely
+  // destroyed after the request is released.
+  void Release(Handle _handle);
+
+ private:
+  // Disables copy and assignation.
+  AsyncLoader(AsyncLoader const&);
+  void operator=(AsyncLoader const&);
+
+  // Function type that loads an object from an archive.
+  typedef bool (*LoadFunction)(IArchive& _archive, void* _object);
+
+  // Loads a _Ty object from _archive.
+  template<typename _Ty>
+  static bool LoadObject(IArchive& _archive, void* _object) {
+    if (!_archive.TestTag<_Ty>()) {
+      return false;
+    }
+    _archive >> *static_cast<_Ty*>(_object);
+    return true;
+  }
+
+  // Queues a load request.
+  Handle Push(const char* _filename, void* _object, LoadFunction _load);
+
+  // Loader implementation, hides platform specific threading.
+  Impl* impl_;
+};
+}  // io
+}  // ozz
+#endif  // OZZ_OZZ_BASE_IO_ASYNC_LOADER_H_
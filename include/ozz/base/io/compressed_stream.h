@@ -0,0 +1,176 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_IO_COMPRESSED_STREAM_H_
+#define OZZ_OZZ_BASE_IO_COMPRESSED_STREAM_H_
+
+// Provides a Stream decorator that compresses data written to, or decompresses
+// data read from, another stream, using a built-in LZ77 codec.
+// Data are split in blocks that are compressed independently. The compressed
+// stream starts with a header (magic and block size), followed by blocks. Each
+// block is made of its uncompressed and compressed sizes, followed by
+// compressed data, or by raw data if compression didn't reduce block size.
+// Blocks are self-contained, so seeking only decompresses the block that
+// contains the target position.
+// The codec is byte oriented and favors decompression speed over compression
+// ratio: a block is a sequence of literal runs and back-references (offset and
+// length) to previously decompressed data, within a 64KB window.
+
+#include "ozz/base/io/stream.h"
+
+namespace ozz {
+namespace io {
+
+// Compresses or decompresses another stream, depending on its mode.
+// A compressing stream only supports writing (and Seek to its current
+// position), while a decompressing stream only supports reading and seeking.
+class CompressedStream : public Stream {
+ public:
+  // Stream modes.
+  enum Mode {
+    kCompress,  // Compresses data written to the stream.
+    kDecompress  // Decompresses data read from the stream.
+  };
+
+  // Defines the default size of an uncompressed block.
+  static const size_t kDefaultBlockSize;
+
+  // Decorates _stream, that must remain valid during *this CompressedStream
+  // lifetime. Compressed data start at _stream current position.
+  // In kCompress mode, the header is written immediately, and data are
+  // compressed in blocks of _block_size bytes (the block size is ignored in
+  // kDecompress mode, as it is read from the header).
+  // Use opened() function to test whether the header was successfully written
+  // or read.
+  CompressedStream(Stream* _stream, Mode _mode,
+                   size_t _block_size = kDefaultBlockSize);
+
+  // Flushes pending writes, and deallocates buffers.
+  virtual ~CompressedStream();
+
+  // Compresses and writes the pending block to the decorated stream. Next
+  // written data will start a new block.
+  // Returns false if the block couldn't be written, or if *this stream is in
+  // kDecompress mode.
+  bool Flush();
+
+  // Gets stream mode.
+  Mode mode() const {
+    return mode_;
+  }
+
+  // See Stream::opened for details.
+  virtual bool opened() const;
+
+  // See Stream::Read for details.
+  // Returns 0 if *this stream is in kCompress mode. Reading stops at the first
+  // corrupted block.
+  virtual size_t Read(void* _buffer, size_t _size);
+
+  // See Stream::Write for details.
+  // Returns 0 if *this stream is in kDecompress mode.
+  virtual size_t Write(const void* _buffer, size_t _size);
+
+  // See Stream::Seek for details.
+  // Seeking in kCompress mode only succeeds if target position is the current
+  // one. Seeking in kDecompress mode fails if target position is outside of
+  // the uncompressed data.
+  virtual int Seek(int _offset, Origin _origin);
+
+  // See Stream::Tell for details. Returns the position in uncompressed data.
+  virtual int Tell() const;
+
+  // Compresses _src of _src_size bytes to _dest of _dest_size bytes.
+  // Returns the compressed size, or 0 if _dest is too small. _dest_size must
+  // be at least CompressBound(_src_size) for compression to always succeed.
+  static size_t Compress(const void* _src, size_t _src_size,
+                         void* _dest, size_t _dest_size);
+
+  // Decompresses _src of _src_size bytes to _dest of _dest_size bytes.
+  // Returns the decompressed size, or 0 if _src is corrupted or _dest too
+  // small.
+  static size_t Decompress(const void* _src, size_t _src_size,
+                           void* _dest, size_t _dest_size);
+
+  // Gets the maximum compressed size of _size bytes.
+  static size_t CompressBound(size_t _size) {
+    return _size + _size / 255 + 16;
+  }
+
+ private:
+  // Disables copy and assignation.
+  CompressedStream(CompressedStream const&);
+  void operator=(CompressedStream const&);
+
+  // Loads the block that contains uncompressed position _position. Returns
+  // false if _position is outside of uncompressed data, or if the block is
+  // corrupted.
+  bool LoadBlock(int _position);
+
+  // Reads the header of the block at compressed position _block. Returns
+  // false if it couldn't be read.
+  bool ReadBlockHeader(int _block, size_t* _size, size_t* _packed_size);
+
+  // The decorated stream.
+  Stream* stream_;
+
+  // Stream mode.
+  Mode mode_;
+
+  // Uncompressed data of the current block, and its size.
+  char* block_;
+  size_t block_size_;
+
+  // Compressed data buffer.
+  char* packed_;
+  size_t packed_size_;
+
+  // Position of the first block in the decorated stream.
+  int base_;
+
+  // Position of the current block header in the decorated stream, and
+  // position of the current block first byte in uncompressed data.
+  int block_position_;
+  int block_begin_;
+
+  // Size of the current block uncompressed data, and cursor in this data.
+  size_t end_;
+  size_t cursor_;
+
+  // Position of the next block header in the decorated stream, in kDecompress
+  // mode.
+  int next_block_position_;
+
+  // True if the header was successfully written or read.
+  bool valid_;
+};
+}  // io
+}  // ozz
+#endif  // OZZ_OZZ_BASE_IO_COMPRESSED_STREAM_H_
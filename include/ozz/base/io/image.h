@@ -0,0 +1,270 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_IO_IMAGE_H_
+#define OZZ_OZZ_BASE_IO_IMAGE_H_
+
+// Provides relocatable binary images, which allow to use data directly from
+// a memory buffer (or a mapped file) instead of deserializing them through an
+// archive.
+// An image starts with a header (endianness, object tag, version and image
+// size), followed by the object scalar members and arrays, in the order they
+// were written. Arrays are stored as an element count, followed by the
+// elements aligned to 16 bytes. An image contains no pointer, so it can be
+// loaded at any address aligned to 16 bytes.
+// Loading an image is done in-place: the loaded object references the image
+// memory and doesn't copy anything. If the image endianness doesn't match the
+// native one, the image is swapped in-place, once, and marked native. Swapping
+// relies on PodSwapper, see ozz/base/io/archive.h.
+
+#include "ozz/base/platform.h"
+#include "ozz/base/endianness.h"
+#include "ozz/base/io/archive.h"
+
+#include <cstring>
+
+namespace ozz {
+namespace io {
+
+// Defines image constant values.
+enum ImageConstants {
+  // Alignment of the image buffer and of its arrays.
+  kImageAlignment = 16,
+};
+
+// Writes an object image to a memory buffer.
+// If the buffer is NULL, nothing is written and the writer only computes the
+// image size. This allows to compute the size of the buffer to allocate.
+class ImageWriter {
+ public:
+  // Constructs a writer that writes to _buffer of _size bytes, with
+  // _endianness. _buffer must be aligned to kImageAlignment bytes, or NULL.
+  ImageWriter(void* _buffer, size_t _size, Endianness _endianness);
+
+  // Writes image header for object type _Ty, using its tag and version.
+  template <typename _Ty>
+  void WriteHeader() {
+    WriteHeader(internal::Tag<const _Ty>::Get(),
+                internal::Version<const _Ty>::kValue);
+  }
+
+  // Writes a 4 bytes scalar value.
+  template <typename _Ty>
+  void Write(_Ty _value) {
+    OZZ_STATIC_ASSERT(sizeof(_Ty) == 4);
+    WriteArray(&_value, 1);
+  }
+
+  // Writes _range elements count, followed by its elements.
+  template <typename _Ty>
+  void Write(Range<const _Ty> _range) {
+    const size_t count = _range.end - _range.begin;
+    Write(static_cast<uint32_t>(count));
+    Align(kImageAlignment);
+    WriteArray(_range.begin, count);
+    Align(4);
+  }
+  template <typename _Ty>
+  void Write(Range<_Ty> _range) {
+    Write(Range<const _Ty>(_range.begin, _range.end));
+  }
+
+  // Finalizes the image, writing its size in the header.
+  // Returns image size, or 0 if the buffer was too small (or NULL).
+  size_t Finish();
+
+  // Gets the image size, which is valid once everything is written.
+  size_t size() const {
+    return cursor_;
+  }
+
+ private:
+  void WriteHeader(const char* _tag, uint32_t _version);
+
+  // Pads the image to _alignment bytes.
+  void Align(size_t _alignment);
+
+  // Copies _count elements of _values to the image, and swaps them if needed.
+  template <typename _Ty>
+  void WriteArray(const _Ty* _values, size_t _count) {
+    const size_t size = sizeof(_Ty) * _count;
+    if (buffer_ && cursor_ + size <= size_) {
+      _Ty* dest = reinterpret_cast<_Ty*>(buffer_ + cursor_);
+      std::memcpy(dest, _values, size);
+      if (swap_) {
+        PodSwapper<_Ty>::Swap(dest, _count, false);
+      }
+    }
+    cursor_ += size;
+  }
+
+  // Image buffer and size.
+  char* buffer_;
+  size_t size_;
+
+  // Current write position.
+  size_t cursor_;
+
+  // Image endianness, and swap requirement.
+  Endianness endianness_;
+  bool swap_;
+};
+
+// Reads an object image from a memory buffer, in-place.
+// Every Read function returns false if the image is invalid or too small.
+// Once a read has failed, all successive reads fail too.
+class ImageReader {
+ public:
+  // Constructs a reader of _image buffer of _size bytes. _image must be
+  // aligned to kImageAlignment bytes and remain valid as long as data read
+  // from it are used. It is swapped in-place if its endianness isn't native.
+  ImageReader(void* _image, size_t _size);
+
+  // Reads and validates image header for object type _Ty, and returns its
+  // version. Returns 0 if the image isn't a valid image of type _Ty.
+  template <typename _Ty>
+  uint32_t ReadHeader() {
+    return ReadHeader(internal::Tag<const _Ty>::Get());
+  }
+
+  // Reads a 4 bytes scalar value.
+  template <typename _Ty>
+  bool Read(_Ty* _value) {
+    OZZ_STATIC_ASSERT(sizeof(_Ty) == 4);
+    _Ty* value = ReadArray<_Ty>(1);
+    if (value) {
+      *_value = *value;
+    }
+    return value != NULL;
+  }
+
+  // Reads an array, and outputs the range of image memory it occupies.
+  template <typename _Ty>
+  bool Read(Range<_Ty>* _range) {
+    uint32_t count;
+    if (!Read(&count)) {
+      return false;
+    }
+    Align(kImageAlignment);
+    _Ty* values = ReadArray<_Ty>(count);
+    Align(4);
+    if (!values) {
+      return false;
+    }
+    *_range = Range<_Ty>(values, count);
+    return true;
+  }
+
+  // Finalizes reading, marking the image as native if it was swapped.
+  // Returns true if every read succeeded.
+  bool Finish();
+
+  // Tests whether all reads succeeded so far.
+  bool valid() const {
+    return valid_;
+  }
+
+ private:
+  uint32_t ReadHeader(const char* _tag);
+
+  // Moves read position to the next multiple of _alignment.
+  void Align(size_t _alignment);
+
+  // Returns the address of _count elements at the read position, swapped to
+  // native endianness if needed, and moves the read position after them.
+  // Returns NULL if the image is too small.
+  template <typename _Ty>
+  _Ty* ReadArray(size_t _count) {
+    const size_t size = sizeof(_Ty) * _count;
+    if (!valid_ || cursor_ + size > size_) {
+      valid_ = false;
+      return NULL;
+    }
+    _Ty* values = reinterpret_cast<_Ty*>(image_ + cursor_);
+    if (swap_) {
+      PodSwapper<_Ty>::Swap(values, _count, true);
+    }
+    cursor_ += size;
+    return values;
+  }
+
+  // Image buffer and size.
+  char* image_;
+  size_t size_;
+
+  // Current read position.
+  size_t cursor_;
+
+  // Image requires to be swapped.
+  bool swap_;
+
+  // Result of all the reads so far.
+  bool valid_;
+};
+
+// Maps a file to memory, to load images from it without copying them.
+// The mapping is private (copy-on-write), so the file is never modified, even
+// if an image needs to be swapped in-place.
+class MappedFile {
+ public:
+  // Maps file at path _filename. Use opened() function to test mapping result.
+  explicit MappedFile(const char* _filename);
+
+  // Unmaps the file.
+  ~MappedFile();
+
+  // Tests whether the file is mapped.
+  bool opened() const {
+    return data_ != NULL;
+  }
+
+  // Gets mapped memory, aligned to the system page size, and its size.
+  void* data() const {
+    return data_;
+  }
+  size_t size() const {
+    return size_;
+  }
+
+ private:
+  // Disables copy and assignation.
+  MappedFile(MappedFile const&);
+  void operator=(MappedFile const&);
+
+  // Mapped memory and its size.
+  void* data_;
+  size_t size_;
+
+  // Platform specific mapping handle.
+  void* handle_;
+};
+}  // io
+}  // ozz
+#endif  // OZZ_OZZ_BASE_IO_IMAGE_H_
@@ -170,6 +170,71 @@ class MemoryStream : public Stream {
   // The cursor position in the buffer of data.
   int tell_;
 };
+
+// Implements a Stream decorator that buffers reads and writes of another
+// stream. Reads are done ahead and writes are delayed, by blocks of the buffer
+// size, which reduces the number of accesses to the decorated stream (like
+// system calls of a File) when reading or writing small data.
+// The decorated stream must not be accessed directly while it's decorated, as
+// its position indicator isn't synchronized with the buffered stream one.
+// Pending writes are flushed when seeking, reading, or when the buffered
+// stream is destroyed. The decorated stream position is then restored to the
+// buffered stream position.
+class BufferedStream : public Stream {
+ public:
+  // Defines the default buffer size.
+  static const size_t kDefaultBufferSize;
+
+  // Decorates _stream, that must remain valid during *this BufferedStream
+  // lifetime, with a buffer of _buffer_size bytes.
+  explicit BufferedStream(Stream* _stream,
+                          size_t _buffer_size = kDefaultBufferSize);
+
+  // Flushes pending writes, and deallocates buffer.
+  virtual ~BufferedStream();
+
+  // Writes pending data to the decorated stream, and synchronizes its
+  // position indicator with *this stream one.
+  // Returns false if pending data couldn't be written entirely.
+  bool Flush();
+
+  // See Stream::opened for details.
+  virtual bool opened() const;
+
+  // See Stream::Read for details.
+  virtual size_t Read(void* _buffer, size_t _size);
+
+  // See Stream::Write for details.
+  virtual size_t Write(const void* _buffer, size_t _size);
+
+  // See Stream::Seek for details.
+  virtual int Seek(int _offset, Origin _origin);
+
+  // See Stream::Tell for details.
+  virtual int Tell() const;
+
+ private:
+  // Disables copy and assignation.
+  BufferedStream(BufferedStream const&);
+  void operator=(BufferedStream const&);
+
+  // The decorated stream.
+  Stream* stream_;
+
+  // The buffer and its size.
+  char* buffer_;
+  size_t buffer_size_;
+
+  // The effective size of the data in the buffer: data read ahead, or pending
+  // writes.
+  size_t end_;
+
+  // The cursor position in the read ahead data.
+  size_t cursor_;
+
+  // True if the buffer contains pending writes, rather than read ahead data.
+  bool writing_;
+};
 }  // io
 }  // ozz
 #endif  // OZZ_OZZ_BASE_IO_STREAM_H_
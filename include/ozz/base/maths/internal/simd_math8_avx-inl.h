@@ -0,0 +1,140 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_MATHS_INTERNAL_SIMD_MATH8_AVX_INL_H_
+#define OZZ_OZZ_BASE_MATHS_INTERNAL_SIMD_MATH8_AVX_INL_H_
+
+// AVX2 implementation of 8-wide simd math functions, see simd_math8.h.
+// Note that functions are implemented with separate multiplications and
+// additions (no fused multiply-add), so that results are the same as the
+// 4-wide implementation.
+
+namespace ozz {
+namespace math {
+
+namespace simd_float8 {
+
+OZZ_INLINE SimdFloat8 zero() {
+  return _mm256_setzero_ps();
+}
+
+OZZ_INLINE SimdFloat8 one() {
+  return _mm256_set1_ps(1.f);
+}
+
+OZZ_INLINE SimdFloat8 Load1(float _x) {
+  return _mm256_set1_ps(_x);
+}
+
+OZZ_INLINE SimdFloat8 Load(_SimdFloat4 _low, _SimdFloat4 _high) {
+  return _mm256_insertf128_ps(_mm256_castps128_ps256(_low), _high, 1);
+}
+}  // simd_float8
+
+OZZ_INLINE SimdFloat4 GetLow(_SimdFloat8 _v) {
+  return _mm256_castps256_ps128(_v);
+}
+
+OZZ_INLINE SimdFloat4 GetHigh(_SimdFloat8 _v) {
+  return _mm256_extractf128_ps(_v, 1);
+}
+
+OZZ_INLINE SimdFloat8 RcpEst(_SimdFloat8 _v) {
+  return _mm256_rcp_ps(_v);
+}
+
+OZZ_INLINE SimdFloat8 Sqrt(_SimdFloat8 _v) {
+  return _mm256_sqrt_ps(_v);
+}
+
+OZZ_INLINE SimdFloat8 RSqrtEst(_SimdFloat8 _v) {
+  return _mm256_rsqrt_ps(_v);
+}
+
+OZZ_INLINE SimdFloat8 RSqrtEstNR(_SimdFloat8 _v) {
+  const __m256 nr = _mm256_rsqrt_ps(_v);
+  // Do one more Newton-Raphson step to improve precision.
+  const __m256 muls = _mm256_mul_ps(_mm256_mul_ps(_v, nr), nr);
+  return _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(.5f), nr),
+                       _mm256_sub_ps(_mm256_set1_ps(3.f), muls));
+}
+
+OZZ_INLINE SimdFloat8 Lerp(_SimdFloat8 _a, _SimdFloat8 _b, _SimdFloat8 _alpha) {
+  return _mm256_add_ps(_mm256_mul_ps(_alpha, _mm256_sub_ps(_b, _a)), _a);
+}
+
+OZZ_INLINE SimdFloat8 Min(_SimdFloat8 _a, _SimdFloat8 _b) {
+  return _mm256_min_ps(_a, _b);
+}
+
+OZZ_INLINE SimdFloat8 Max(_SimdFloat8 _a, _SimdFloat8 _b) {
+  return _mm256_max_ps(_a, _b);
+}
+
+OZZ_INLINE SimdFloat8 Max0(_SimdFloat8 _v) {
+  return _mm256_max_ps(_mm256_setzero_ps(), _v);
+}
+
+OZZ_INLINE SimdInt8 Sign(_SimdFloat8 _v) {
+  return _mm256_slli_epi32(_mm256_srli_epi32(_mm256_castps_si256(_v), 31), 31);
+}
+
+OZZ_INLINE SimdFloat8 Xor(_SimdFloat8 _a, _SimdInt8 _b) {
+  return _mm256_xor_ps(_a, _mm256_castsi256_ps(_b));
+}
+}  // math
+}  // ozz
+
+#if !defined(__GNUC__)
+OZZ_INLINE ozz::math::SimdFloat8 operator+(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b) {
+  return _mm256_add_ps(_a, _b);
+}
+
+OZZ_INLINE ozz::math::SimdFloat8 operator-(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b) {
+  return _mm256_sub_ps(_a, _b);
+}
+
+OZZ_INLINE ozz::math::SimdFloat8 operator-(ozz::math::_SimdFloat8 _v) {
+  return _mm256_sub_ps(_mm256_setzero_ps(), _v);
+}
+
+OZZ_INLINE ozz::math::SimdFloat8 operator*(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b) {
+  return _mm256_mul_ps(_a, _b);
+}
+
+OZZ_INLINE ozz::math::SimdFloat8 operator/(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b) {
+  return _mm256_div_ps(_a, _b);
+}
+#endif  // !defined(__GNUC__)
+#endif  // OZZ_OZZ_BASE_MATHS_INTERNAL_SIMD_MATH8_AVX_INL_H_
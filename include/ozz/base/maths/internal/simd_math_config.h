@@ -34,6 +34,14 @@
 #include "ozz/base/platform.h"
 
 // Try to match a SSE version
+#if defined(__AVX2__) || defined(OZZ_HAS_AVX2)
+#include <immintrin.h>
+#ifndef OZZ_HAS_AVX2
+#define OZZ_HAS_AVX2
+#endif  // OZZ_HAS_AVX2
+#define OZZ_HAS_AVX
+#endif
+
 #if defined(__AVX__)  || defined(OZZ_HAS_AVX)
 #include <immintrin.h>
 #ifndef OZZ_HAS_AVX
@@ -97,6 +105,20 @@ typedef __m128i SimdInt4;
 
 // Argument type for Int4.
 typedef const __m128i _SimdInt4;
+
+#ifdef OZZ_HAS_AVX2
+// Vector of eight floating point values.
+typedef __m256 SimdFloat8;
+
+// Argument type for Float8.
+typedef const __m256 _SimdFloat8;
+
+// Vector of eight integer values.
+typedef __m256i SimdInt8;
+
+// Argument type for Int8.
+typedef const __m256i _SimdInt8;
+#endif  // OZZ_HAS_AVX2
 }  // math
 }  // ozz
 
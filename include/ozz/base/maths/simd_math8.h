@@ -0,0 +1,126 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_MATHS_SIMD_MATH8_H_
+#define OZZ_OZZ_BASE_MATHS_SIMD_MATH8_H_
+
+// Declares 8-wide simd math functions, operating on SimdFloat8 vectors.
+// They are only available if AVX2 instruction set is enabled (OZZ_HAS_AVX2
+// defined), and are meant to process 2 SimdFloat4 (or 2 soa structures) at a
+// time.
+
+#include "ozz/base/maths/simd_math.h"
+
+#ifdef OZZ_HAS_AVX2
+
+namespace ozz {
+namespace math {
+
+namespace simd_float8 {
+// Returns a SimdFloat8 vector with all components set to 0.
+OZZ_INLINE SimdFloat8 zero();
+
+// Returns a SimdFloat8 vector with all components set to 1.
+OZZ_INLINE SimdFloat8 one();
+
+// Loads _x to the all the components of the returned vector.
+OZZ_INLINE SimdFloat8 Load1(float _x);
+
+// Loads _low to the first 4 components of the returned vector, and _high to
+// the last 4.
+OZZ_INLINE SimdFloat8 Load(_SimdFloat4 _low, _SimdFloat4 _high);
+}  // simd_float8
+
+// Returns the first 4 components of _v.
+OZZ_INLINE SimdFloat4 GetLow(_SimdFloat8 _v);
+
+// Returns the last 4 components of _v.
+OZZ_INLINE SimdFloat4 GetHigh(_SimdFloat8 _v);
+
+// Returns the per component estimated reciprocal of _v.
+OZZ_INLINE SimdFloat8 RcpEst(_SimdFloat8 _v);
+
+// Returns the per component square root of _v.
+OZZ_INLINE SimdFloat8 Sqrt(_SimdFloat8 _v);
+
+// Returns the per component estimated reciprocal square root of _v.
+OZZ_INLINE SimdFloat8 RSqrtEst(_SimdFloat8 _v);
+
+// Returns the per component estimated reciprocal square root of _v, where
+// approximation is improved with one more new Newton-Raphson step.
+OZZ_INLINE SimdFloat8 RSqrtEstNR(_SimdFloat8 _v);
+
+// Returns the linear interpolation of _a and _b with coefficient _alpha.
+// _alpha is not limited to range [0,1].
+OZZ_INLINE SimdFloat8 Lerp(_SimdFloat8 _a, _SimdFloat8 _b, _SimdFloat8 _alpha);
+
+// Returns the minimum of each element of _a and _b.
+OZZ_INLINE SimdFloat8 Min(_SimdFloat8 _a, _SimdFloat8 _b);
+
+// Returns the maximum of each element of _a and _b.
+OZZ_INLINE SimdFloat8 Max(_SimdFloat8 _a, _SimdFloat8 _b);
+
+// Returns the maximum of zero and each element of _v.
+OZZ_INLINE SimdFloat8 Max0(_SimdFloat8 _v);
+
+// Returns per element of _v, 0x80000000 if negative, 0 otherwise.
+OZZ_INLINE SimdInt8 Sign(_SimdFloat8 _v);
+
+// Returns per element binary logical xor operation of _a and _b.
+// _v[0...255] = _a[0...255] ^ _b[0...255]
+OZZ_INLINE SimdFloat8 Xor(_SimdFloat8 _a, _SimdInt8 _b);
+}  // math
+}  // ozz
+
+#if !defined(__GNUC__)
+// Returns per element addition of _a and _b.
+OZZ_INLINE ozz::math::SimdFloat8 operator+(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b);
+
+// Returns per element subtraction of _a and _b.
+OZZ_INLINE ozz::math::SimdFloat8 operator-(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b);
+
+// Returns per element negation of _v.
+OZZ_INLINE ozz::math::SimdFloat8 operator-(ozz::math::_SimdFloat8 _v);
+
+// Returns per element multiplication of _a and _b.
+OZZ_INLINE ozz::math::SimdFloat8 operator*(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b);
+
+// Returns per element division of _a and _b.
+OZZ_INLINE ozz::math::SimdFloat8 operator/(
+  ozz::math::_SimdFloat8 _a, ozz::math::_SimdFloat8 _b);
+#endif  // !defined(__GNUC__)
+
+#include "ozz/base/maths/internal/simd_math8_avx-inl.h"
+
+#endif  // OZZ_HAS_AVX2
+#endif  // OZZ_OZZ_BASE_MATHS_SIMD_MATH8_H_
@@ -0,0 +1,246 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_OZZ_BASE_MATHS_SOA_TRANSFORM8_H_
+#define OZZ_OZZ_BASE_MATHS_SOA_TRANSFORM8_H_
+
+// Declares 8-wide soa structures, that store 2 soa structures (aka 8 elements)
+// in SimdFloat8 vectors. They are only available if AVX2 instruction set is
+// enabled (OZZ_HAS_AVX2 defined).
+// 8-wide soa structures are meant to be used as temporaries: they are loaded
+// from, and stored to, 2 consecutive 4-wide soa structures.
+
+#include "ozz/base/maths/simd_math8.h"
+#include "ozz/base/maths/soa_float4x4.h"
+#include "ozz/base/maths/soa_transform.h"
+
+#ifdef OZZ_HAS_AVX2
+
+namespace ozz {
+namespace math {
+
+// 8-wide version of SoaFloat3.
+struct SoaFloat3_8 {
+  SimdFloat8 x, y, z;
+
+  // Loads _low SoaFloat3 to the first 4 elements, and _high to the last 4.
+  static OZZ_INLINE SoaFloat3_8 Load(const SoaFloat3& _low,
+                                     const SoaFloat3& _high) {
+    const SoaFloat3_8 r = {simd_float8::Load(_low.x, _high.x),
+                           simd_float8::Load(_low.y, _high.y),
+                           simd_float8::Load(_low.z, _high.z)};
+    return r;
+  }
+};
+
+// 8-wide version of SoaQuaternion.
+struct SoaQuaternion8 {
+  SimdFloat8 x, y, z, w;
+
+  // Loads _low SoaQuaternion to the first 4 elements, and _high to the last 4.
+  static OZZ_INLINE SoaQuaternion8 Load(const SoaQuaternion& _low,
+                                        const SoaQuaternion& _high) {
+    const SoaQuaternion8 r = {simd_float8::Load(_low.x, _high.x),
+                              simd_float8::Load(_low.y, _high.y),
+                              simd_float8::Load(_low.z, _high.z),
+                              simd_float8::Load(_low.w, _high.w)};
+    return r;
+  }
+};
+
+// 8-wide version of SoaTransform.
+struct SoaTransform8 {
+  SoaFloat3_8 translation;
+  SoaQuaternion8 rotation;
+  SoaFloat3_8 scale;
+
+  // Loads _low SoaTransform to the first 4 elements, and _high to the last 4.
+  static OZZ_INLINE SoaTransform8 Load(const SoaTransform& _low,
+                                       const SoaTransform& _high) {
+    const SoaTransform8 r = {SoaFloat3_8::Load(_low.translation,
+                                               _high.translation),
+                             SoaQuaternion8::Load(_low.rotation,
+                                                  _high.rotation),
+                             SoaFloat3_8::Load(_low.scale, _high.scale)};
+    return r;
+  }
+};
+
+// Returns the first 4 elements of _v.
+OZZ_INLINE SoaFloat3 GetLow(const SoaFloat3_8& _v) {
+  const SoaFloat3 r = {GetLow(_v.x), GetLow(_v.y), GetLow(_v.z)};
+  return r;
+}
+
+// Returns the last 4 elements of _v.
+OZZ_INLINE SoaFloat3 GetHigh(const SoaFloat3_8& _v) {
+  const SoaFloat3 r = {GetHigh(_v.x), GetHigh(_v.y), GetHigh(_v.z)};
+  return r;
+}
+
+// Returns the first 4 elements of _q.
+OZZ_INLINE SoaQuaternion GetLow(const SoaQuaternion8& _q) {
+  const SoaQuaternion r = {
+    GetLow(_q.x), GetLow(_q.y), GetLow(_q.z), GetLow(_q.w)};
+  return r;
+}
+
+// Returns the last 4 elements of _q.
+OZZ_INLINE SoaQuaternion GetHigh(const SoaQuaternion8& _q) {
+  const SoaQuaternion r = {
+    GetHigh(_q.x), GetHigh(_q.y), GetHigh(_q.z), GetHigh(_q.w)};
+  return r;
+}
+
+// Returns the first 4 elements of _t.
+OZZ_INLINE SoaTransform GetLow(const SoaTransform8& _t) {
+  const SoaTransform r = {
+    GetLow(_t.translation), GetLow(_t.rotation), GetLow(_t.scale)};
+  return r;
+}
+
+// Returns the last 4 elements of _t.
+OZZ_INLINE SoaTransform GetHigh(const SoaTransform8& _t) {
+  const SoaTransform r = {
+    GetHigh(_t.translation), GetHigh(_t.rotation), GetHigh(_t.scale)};
+  return r;
+}
+
+// Returns the linear interpolation of SoaFloat3_8 _a and _b with coefficient
+// _f.
+OZZ_INLINE SoaFloat3_8 Lerp(const SoaFloat3_8& _a, const SoaFloat3_8& _b,
+                            _SimdFloat8 _f) {
+  const SoaFloat3_8 r = {(_b.x - _a.x) * _f + _a.x,
+                         (_b.y - _a.y) * _f + _a.y,
+                         (_b.z - _a.z) * _f + _a.z};
+  return r;
+}
+
+// Returns the estimated linear interpolation of SoaQuaternion8 _a and _b with
+// coefficient _f, see SoaQuaternion NLerpEst.
+OZZ_INLINE SoaQuaternion8 NLerpEst(const SoaQuaternion8& _a,
+                                   const SoaQuaternion8& _b,
+                                   _SimdFloat8 _f) {
+  const SoaQuaternion8 lerp = {(_b.x - _a.x) * _f + _a.x,
+                               (_b.y - _a.y) * _f + _a.y,
+                               (_b.z - _a.z) * _f + _a.z,
+                               (_b.w - _a.w) * _f + _a.w};
+  const SimdFloat8 len2 =
+    lerp.x * lerp.x + lerp.y * lerp.y + lerp.z * lerp.z + lerp.w * lerp.w;
+  // Uses RSqrtEstNR (with one more Newton-Raphson step) as quaternions loose
+  // much precision due to normalization.
+  const SimdFloat8 inv_len = RSqrtEstNR(len2);
+  const SoaQuaternion8 r = {
+    lerp.x * inv_len, lerp.y * inv_len, lerp.z * inv_len, lerp.w * inv_len};
+  return r;
+}
+
+// Computes the affine transformation matrices built from _transform
+// translation, rotation and scale. _low receives the matrices of the first 4
+// elements, _high the last 4. See SoaFloat4x4::FromAffine.
+OZZ_INLINE void ToAffine(const SoaTransform8& _transform,
+                         SoaFloat4x4* _low, SoaFloat4x4* _high) {
+  const SoaQuaternion8& q = _transform.rotation;
+  const SoaFloat3_8& s = _transform.scale;
+  const SoaFloat3_8& t = _transform.translation;
+
+  const SimdFloat8 one = simd_float8::one();
+  const SimdFloat8 two = one + one;
+
+  const SimdFloat8 xx = q.x * q.x;
+  const SimdFloat8 xy = q.x * q.y;
+  const SimdFloat8 xz = q.x * q.z;
+  const SimdFloat8 xw = q.x * q.w;
+  const SimdFloat8 yy = q.y * q.y;
+  const SimdFloat8 yz = q.y * q.z;
+  const SimdFloat8 yw = q.y * q.w;
+  const SimdFloat8 zz = q.z * q.z;
+  const SimdFloat8 zw = q.z * q.w;
+
+  const SimdFloat8 m[12] = {s.x * (one - two * (yy + zz)),
+                            s.x * two * (xy + zw),
+                            s.x * two * (xz - yw),
+                            s.y * two * (xy - zw),
+                            s.y * (one - two * (xx + zz)),
+                            s.y * two * (yz + xw),
+                            s.z * two * (xz + yw),
+                            s.z * two * (yz - xw),
+                            s.z * (one - two * (xx + yy)),
+                            t.x, t.y, t.z};
+
+  const SimdFloat4 zero4 = simd_float4::zero();
+  const SimdFloat4 one4 = simd_float4::one();
+  for (int c = 0; c < 4; ++c) {
+    SoaFloat4& low = _low->cols[c];
+    SoaFloat4& high = _high->cols[c];
+    low.x = GetLow(m[c * 3 + 0]);
+    low.y = GetLow(m[c * 3 + 1]);
+    low.z = GetLow(m[c * 3 + 2]);
+    low.w = c == 3 ? one4 : zero4;
+    high.x = GetHigh(m[c * 3 + 0]);
+    high.y = GetHigh(m[c * 3 + 1]);
+    high.z = GetHigh(m[c * 3 + 2]);
+    high.w = low.w;
+  }
+}
+}  // math
+}  // ozz
+
+// Returns the addition of _a and _b.
+OZZ_INLINE ozz::math::SoaFloat3_8 operator+(const ozz::math::SoaFloat3_8& _a,
+                                            const ozz::math::SoaFloat3_8& _b) {
+  const ozz::math::SoaFloat3_8 r = {_a.x + _b.x, _a.y + _b.y, _a.z + _b.z};
+  return r;
+}
+
+// Returns the multiplication of _v and scalar value _f.
+OZZ_INLINE ozz::math::SoaFloat3_8 operator*(const ozz::math::SoaFloat3_8& _v,
+                                            ozz::math::_SimdFloat8 _f) {
+  const ozz::math::SoaFloat3_8 r = {_v.x * _f, _v.y * _f, _v.z * _f};
+  return r;
+}
+
+// Returns the addition of _a and _b.
+OZZ_INLINE ozz::math::SoaQuaternion8 operator+(
+  const ozz::math::SoaQuaternion8& _a, const ozz::math::SoaQuaternion8& _b) {
+  const ozz::math::SoaQuaternion8 r = {
+    _a.x + _b.x, _a.y + _b.y, _a.z + _b.z, _a.w + _b.w};
+  return r;
+}
+
+// Returns the multiplication of _q and scalar value _f.
+OZZ_INLINE ozz::math::SoaQuaternion8 operator*(
+  const ozz::math::SoaQuaternion8& _q, ozz::math::_SimdFloat8 _f) {
+  const ozz::math::SoaQuaternion8 r = {
+    _q.x * _f, _q.y * _f, _q.z * _f, _q.w * _f};
+  return r;
+}
+#endif  // OZZ_HAS_AVX2
+#endif  // OZZ_OZZ_BASE_MATHS_SOA_TRANSFORM8_H_
@@ -174,7 +174,8 @@ bool LoadSkeleton(const char* _filename,
       << std::endl;
     return false;
   }
-  ozz::io::IArchive archive(&file);
+  ozz::io::BufferedStream stream(&file);
+  ozz::io::IArchive archive(&stream);
   if (!archive.TestTag<ozz::animation::Skeleton>()) {
     ozz::log::Err() << "Failed to load skeleton instance from file " <<
       _filename << "." << std::endl;
@@ -198,7 +199,8 @@ bool LoadAnimation(const char* _filename,
       "." << std::endl;
     return false;
   }
-  ozz::io::IArchive archive(&file);
+  ozz::io::BufferedStream stream(&file);
+  ozz::io::IArchive archive(&stream);
   if (!archive.TestTag<ozz::animation::Animation>()) {
     ozz::log::Err() << "Failed to load animation instance from file " <<
       _filename << "." << std::endl;
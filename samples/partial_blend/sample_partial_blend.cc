@@ -236,7 +236,9 @@ class PartialBlendSampleApplication : public ozz::sample::Application {
     }
 
     // Extracts the list of children of the shoulder.
+    ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
     ozz::animation::JointsIterator it;
+    it.joints = allocator->AllocateRange<uint16_t>(skeleton_.num_joints());
     ozz::animation::IterateJointsDF(skeleton_, upper_body_root_, &it);
 
     // Sets the weight_setting of all the joints children of the arm to 1. Note
@@ -256,6 +258,7 @@ class PartialBlendSampleApplication : public ozz::sample::Application {
           weight_setting, joint_id %4, upper_body_sampler.joint_weight_setting);
       }
     }
+    allocator->Deallocate(it.joints);
   }
 
   virtual void OnDestroy() {
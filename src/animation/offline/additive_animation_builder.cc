@@ -0,0 +1,169 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/additive_animation_builder.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/transform.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+
+namespace {
+
+// Computes the delta from _reference to _value, for each key type.
+math::Float3 MakeDelta(const math::Float3& _reference,
+                       const math::Float3& _value,
+                       const RawAnimation::TranslationKey*) {
+  return _value - _reference;
+}
+
+math::Quaternion MakeDelta(const math::Quaternion& _reference,
+                           const math::Quaternion& _value,
+                           const RawAnimation::RotationKey*) {
+  // The delta is applied by pre-multiplication. Its w component is kept
+  // positive, so it can be weighted from identity along the shortest path.
+  const math::Quaternion delta = _value * Conjugate(_reference);
+  return delta.w < 0.f ? -delta : delta;
+}
+
+math::Float3 MakeDelta(const math::Float3& _reference,
+                       const math::Float3& _value,
+                       const RawAnimation::ScaleKey*) {
+  return _value / _reference;
+}
+
+// Fills _dest track with the deltas of _src keys from _reference value. An
+// empty _src track is considered to be at identity, in which case a single key
+// is pushed if _identity_delta is true.
+template<typename _Key, typename _Value>
+void MakeDeltaTrack(const typename ozz::Vector<_Key>::Std& _src,
+                    const _Value& _reference,
+                    bool _identity_delta,
+                    typename ozz::Vector<_Key>::Std* _dest) {
+  _dest->resize(_src.size());
+  for (size_t i = 0; i < _src.size(); ++i) {
+    _Key& key = (*_dest)[i];
+    key.time = _src[i].time;
+    key.value = MakeDelta(_reference, _src[i].value,
+                          static_cast<const _Key*>(NULL));
+  }
+  if (_src.empty() && _identity_delta) {
+    const _Key key = {0.f, MakeDelta(_reference, _Key::identity(),
+                                     static_cast<const _Key*>(NULL))};
+    _dest->push_back(key);
+  }
+}
+}  // namespace
+
+bool AdditiveAnimationBuilder::operator()(const RawAnimation& _input,
+                                          RawAnimation* _output) const {
+  if (!_output) {
+    return false;
+  }
+  // Reset output animation to default.
+  *_output = RawAnimation();
+
+  // Validate animation.
+  if (!_input.Validate()) {
+    return false;
+  }
+
+  // Rebuilds output animation.
+  _output->duration = _input.duration;
+  _output->tracks.resize(_input.tracks.size());
+
+  for (size_t i = 0; i < _input.tracks.size(); ++i) {
+    const RawAnimation::JointTrack& src = _input.tracks[i];
+    RawAnimation::JointTrack& dest = _output->tracks[i];
+
+    // First keys are the reference. Empty tracks remain empty.
+    const math::Float3 translation = src.translations.empty() ?
+      RawAnimation::TranslationKey::identity() : src.translations[0].value;
+    const math::Quaternion rotation = src.rotations.empty() ?
+      RawAnimation::RotationKey::identity() : src.rotations[0].value;
+    const math::Float3 scale = src.scales.empty() ?
+      RawAnimation::ScaleKey::identity() : src.scales[0].value;
+
+    MakeDeltaTrack<RawAnimation::TranslationKey>(
+      src.translations, translation, false, &dest.translations);
+    MakeDeltaTrack<RawAnimation::RotationKey>(
+      src.rotations, rotation, false, &dest.rotations);
+    MakeDeltaTrack<RawAnimation::ScaleKey>(
+      src.scales, scale, false, &dest.scales);
+  }
+
+  // Output animation is always valid though.
+  return _output->Validate();
+}
+
+bool AdditiveAnimationBuilder::operator()(
+  const RawAnimation& _input,
+  const Range<const math::Transform>& _reference_pose,
+  RawAnimation* _output) const {
+  if (!_output) {
+    return false;
+  }
+  // Reset output animation to default.
+  *_output = RawAnimation();
+
+  // Validate animation and reference pose.
+  if (!_input.Validate() ||
+      _reference_pose.Count() < _input.tracks.size()) {
+    return false;
+  }
+
+  // Rebuilds output animation.
+  _output->duration = _input.duration;
+  _output->tracks.resize(_input.tracks.size());
+
+  for (size_t i = 0; i < _input.tracks.size(); ++i) {
+    const RawAnimation::JointTrack& src = _input.tracks[i];
+    RawAnimation::JointTrack& dest = _output->tracks[i];
+    const math::Transform& reference = _reference_pose.begin[i];
+
+    MakeDeltaTrack<RawAnimation::TranslationKey>(
+      src.translations, reference.translation, true, &dest.translations);
+    MakeDeltaTrack<RawAnimation::RotationKey>(
+      src.rotations, reference.rotation, true, &dest.rotations);
+    MakeDeltaTrack<RawAnimation::ScaleKey>(
+      src.scales, reference.scale, true, &dest.scales);
+  }
+
+  // Output animation is always valid though.
+  return _output->Validate();
+}
+}  // offline
+}  // animation
+}  // ozz
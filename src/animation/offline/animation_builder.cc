@@ -32,13 +32,18 @@
 
 #include <cstddef>
 #include <cassert>
+#include <cmath>
+#include <cstring>
 #include <algorithm>
 #include <limits>
 
 #include "ozz/base/containers/vector.h"
 #include "ozz/base/memory/allocator.h"
 
+#include "ozz/base/maths/math_ex.h"
 #include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/maths/soa_quaternion.h"
 
 #include "ozz/animation/offline/raw_animation.h"
 
@@ -47,6 +52,7 @@
 // Internal include file
 #define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
 #include "animation/runtime/animation_keyframe.h"
+#include "animation/runtime/packed_bits.h"
 
 namespace ozz {
 namespace animation {
@@ -79,111 +85,283 @@ bool SortingKeyLess(const _Key& _left, const _Key& _right) {
              && _left.track < _right.track);
 }
 
-template<typename _SrcKey, typename _DestTrack>
-void PushBackIdentityKey(uint16_t _track, float _time, _DestTrack* _dest) {
-  typedef typename _DestTrack::value_type DestKey;
-  float prev_time = -1.f;
-  if (!_dest->empty() && _dest->back().track == _track) {
-    prev_time =  _dest->back().key.time;
+// Tests whether track _src is constant, aka it has less than 2 keys or all its
+// keys have the same value.
+template<typename _SrcTrack>
+bool IsConstant(const _SrcTrack& _src) {
+  for (size_t k = 1; k < _src.size(); ++k) {
+    if (!(_src[k].value == _src.front().value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Tests whether track _src is constant. If so, outputs its value to _value.
+template<typename _SrcTrack, typename _Value>
+bool IsConstant(const _SrcTrack& _src, _Value* _value) {
+  typedef typename _SrcTrack::value_type SrcKey;
+  if (!IsConstant(_src)) {
+    return false;
   }
-  const DestKey key = {_track, prev_time, {_time, _SrcKey::identity()}};
-  _dest->push_back(key);
+  *_value = _src.empty() ? SrcKey::identity() : _src.front().value;
+  return true;
 }
 
-// Copies a track from a RawAnimation to an Animation.
-// Also fixes up the front (t = 0) and back keys (t = duration).
+// Quantizes _time to key time units, see animation_keyframe.h. The result is
+// returned as a float, as it's used as a key time in sorting structures.
+float QuantizeKeyTime(float _time, float _duration, bool _wide) {
+  const float time = std::floor(ToKeyTime(_time, _duration, _wide) + .5f);
+  const int max_key_time = _wide ? kMaxWideKeyTime : kMaxKeyTime;
+  return math::Clamp(0.f, time, static_cast<float>(max_key_time));
+}
+
+// Tests that all keys of track _src have a different quantized time, so that
+// none would be silently merged or dropped by quantization. Constant tracks
+// always pass, as their keys are dropped.
+template<typename _Track>
+bool HasDistinctKeyTimes(const _Track& _src, float _duration, bool _wide) {
+  if (IsConstant(_src)) {
+    return true;
+  }
+  for (size_t k = 1; k < _src.size(); ++k) {
+    if (QuantizeKeyTime(_src[k - 1].time, _duration, _wide) ==
+        QuantizeKeyTime(_src[k].time, _duration, _wide)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Tests that all keys of all tracks of _input have a different quantized time,
+// when key times are _wide or not.
+bool HasDistinctKeyTimes(const RawAnimation& _input, bool _wide) {
+  for (int i = 0; i < _input.num_tracks(); ++i) {
+    const RawAnimation::JointTrack& raw_track = _input.tracks[i];
+    if (!HasDistinctKeyTimes(raw_track.translations, _input.duration, _wide) ||
+        !HasDistinctKeyTimes(raw_track.rotations, _input.duration, _wide) ||
+        !HasDistinctKeyTimes(raw_track.scales, _input.duration, _wide)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Copies a non-constant track from a RawAnimation to an Animation.
+// Key times are quantized, and are expected to be distinct (see
+// HasDistinctKeyTimes()). Also fixes up the front (t = 0) and back keys
+// (t = duration).
 template<typename _SrcTrack, typename _DestTrack>
 void CopyRaw(const _SrcTrack& _src, uint16_t _track, float _duration,
-             _DestTrack* _dest) {
+             bool _wide, _DestTrack* _dest) {
   typedef typename _SrcTrack::value_type SrcKey;
   typedef typename _DestTrack::value_type DestKey;
 
-  if (_src.size() == 0) {  // Adds 2 new keys.
-    PushBackIdentityKey<SrcKey, _DestTrack>(_track, 0.f, _dest);
-    PushBackIdentityKey<SrcKey, _DestTrack>(_track, _duration, _dest);
-  } else if (_src.size() == 1) {  // Adds 1 new key.
-    const SrcKey& raw_key = _src.front();
+  // Constant tracks aren't copied, so there are at least 2 keys.
+  assert(_src.size() >= 2);
+
+  // Copies all keys, and fixes up first and last keys.
+  float prev_time = -1.f;
+  if (QuantizeKeyTime(_src.front().time, _duration, _wide) != 0.f) {
+    // Needs a key at t = 0.f.
+    const DestKey first = {_track, prev_time, {0.f, _src.front().value}};
+    _dest->push_back(first);
+    prev_time = 0.f;
+  }
+  for (size_t k = 0; k < _src.size(); ++k) {  // Copies all keys.
+    const SrcKey& raw_key = _src[k];
     assert(raw_key.time >= 0 && raw_key.time <= _duration);
-    const DestKey first = {_track, -1.f, {0.f, raw_key.value}};
-      _dest->push_back(first);
-    const DestKey last = {_track, 0.f, {_duration, raw_key.value}};
-      _dest->push_back(last);
-  } else {  // Copies all keys, and fixes up first and last keys.
-    float prev_time = -1.f;
-    if (_src.front().time != 0.f) {  // Needs a key at t = 0.f.
-      const DestKey first = {_track, prev_time, {0.f, _src.front().value}};
-      _dest->push_back(first);
-      prev_time = 0.f;
-    }
-    for (size_t k = 0; k < _src.size(); ++k) {  // Copies all keys.
-      const SrcKey& raw_key = _src[k];
-      assert(raw_key.time >= 0 && raw_key.time <= _duration);
-      const DestKey key = {_track, prev_time, {raw_key.time, raw_key.value}};
-      _dest->push_back(key);
-      prev_time = raw_key.time;
-    }
-    if (_src.back().time != _duration) {  // Needs a key at t = _duration.
-      const DestKey last = {
-        _track, prev_time, {_duration, _src.back().value}};
-      _dest->push_back(last);
-    }
+    const float time = QuantizeKeyTime(raw_key.time, _duration, _wide);
+    assert(time > prev_time);
+    const DestKey key = {_track, prev_time, {time, raw_key.value}};
+    _dest->push_back(key);
+    prev_time = time;
   }
-  assert(_dest->front().key.time == 0.f && _dest->back().key.time == _duration);
+  const float max_time =
+    static_cast<float>(_wide ? kMaxWideKeyTime : kMaxKeyTime);
+  if (prev_time != max_time) {  // Needs a key at t = _duration.
+    const DestKey last = {_track, prev_time, {max_time, _src.back().value}};
+    _dest->push_back(last);
+  }
+  assert(_dest->back().key.time == max_time);
 }
 
-ozz::Range<TranslationKey> CopyToAnimation(
-  ozz::Vector<SortingTranslationKey>::Std* _src) {
-  const size_t src_count = _src->size();
-  if (!src_count) {
-    return ozz::Range<TranslationKey>();
+// Copies track _src to _dest if it isn't constant. Otherwise sets _track flag
+// and value in constant tracks _flags and _values.
+// Returns true if the track is animated.
+template<typename _SrcTrack, typename _DestTrack, typename _Values>
+bool CopyTrack(const _SrcTrack& _src, uint16_t _track, float _duration,
+               bool _wide, _DestTrack* _dest,
+               ozz::Vector<uint8_t>::Std* _flags,
+               _Values* _values) {
+  if (IsConstant(_src, &(*_values)[_track])) {
+    (*_flags)[_track / 4] |= 1 << (_track & 3);
+    return false;
   }
+  CopyRaw(_src, _track, _duration, _wide, _dest);
+  return true;
+}
 
-  // Sort animation keys to favor cache coherency.
-  std::sort(&_src->front(), (&_src->back()) + 1, &SortingKeyLess<SortingTranslationKey>);
+// Copies constant tracks flags and values to an Animation, with an element per
+// soa track. Output buffers are left empty if no track is constant.
+void CopyToAnimation(const ozz::Vector<uint8_t>::Std& _flags,
+                     const ozz::Vector<math::Float3>::Std& _values,
+                     ozz::Range<uint8_t>* _dest_flags,
+                     ozz::Range<math::SoaFloat3>* _dest_values) {
+  if (std::count(_flags.begin(), _flags.end(), 0) ==
+      static_cast<ptrdiff_t>(_flags.size())) {
+    return;
+  }
+  const size_t num_soa_tracks = _flags.size();
+  memory::Allocator* allocator = memory::default_allocator();
+  *_dest_flags = allocator->AllocateRange<uint8_t>(num_soa_tracks);
+  *_dest_values = allocator->AllocateRange<math::SoaFloat3>(num_soa_tracks);
+  for (size_t i = 0; i < num_soa_tracks; ++i) {
+    const math::Float3* v = &_values[i * 4];
+    _dest_flags->begin[i] = _flags[i];
+    _dest_values->begin[i] = math::SoaFloat3::Load(
+      math::simd_float4::Load(v[0].x, v[1].x, v[2].x, v[3].x),
+      math::simd_float4::Load(v[0].y, v[1].y, v[2].y, v[3].y),
+      math::simd_float4::Load(v[0].z, v[1].z, v[2].z, v[3].z));
+  }
+}
 
-  // Fills output.
-  ozz::Range<TranslationKey> dest =
-    memory::default_allocator()->AllocateRange<TranslationKey>(src_count);
-  const SortingTranslationKey* src = &_src->front();
-  for (size_t i = 0; i < src_count; ++i) {
-    TranslationKey& key = dest.begin[i];
-    key.time = src[i].key.time;
-    key.track = src[i].track;
-    key.value[0] = ozz::math::FloatToHalf(src[i].key.value.x);
-    key.value[1] = ozz::math::FloatToHalf(src[i].key.value.y);
-    key.value[2] = ozz::math::FloatToHalf(src[i].key.value.z);
+// Specialize for rotations in order to normalize quaternions.
+void CopyToAnimation(const ozz::Vector<uint8_t>::Std& _flags,
+                     const ozz::Vector<math::Quaternion>::Std& _values,
+                     ozz::Range<uint8_t>* _dest_flags,
+                     ozz::Range<math::SoaQuaternion>* _dest_values) {
+  if (std::count(_flags.begin(), _flags.end(), 0) ==
+      static_cast<ptrdiff_t>(_flags.size())) {
+    return;
   }
-  return dest;
+  const size_t num_soa_tracks = _flags.size();
+  memory::Allocator* allocator = memory::default_allocator();
+  *_dest_flags = allocator->AllocateRange<uint8_t>(num_soa_tracks);
+  *_dest_values =
+    allocator->AllocateRange<math::SoaQuaternion>(num_soa_tracks);
+  const math::Quaternion identity = math::Quaternion::identity();
+  for (size_t i = 0; i < num_soa_tracks; ++i) {
+    math::Quaternion q[4];
+    for (int j = 0; j < 4; ++j) {
+      q[j] = NormalizeSafe(_values[i * 4 + j], identity);
+      if (q[j].w < 0.f) {  // .w eq to a dot with identity quaternion.
+        q[j] = -q[j];  // Q an -Q are the same rotation.
+      }
+    }
+    _dest_flags->begin[i] = _flags[i];
+    _dest_values->begin[i] = math::SoaQuaternion::Load(
+      math::simd_float4::Load(q[0].x, q[1].x, q[2].x, q[3].x),
+      math::simd_float4::Load(q[0].y, q[1].y, q[2].y, q[3].y),
+      math::simd_float4::Load(q[0].z, q[1].z, q[2].z, q[3].z),
+      math::simd_float4::Load(q[0].w, q[1].w, q[2].w, q[3].w));
+  }
+}
+
+// Quantizes _value to an unsigned fixed point integer in range [0,_max],
+// normalized in the range of values starting at _min, with a _step between two
+// consecutive integers.
+uint16_t Quantize(float _value, float _min, float _step, float _max) {
+  if (_step <= 0.f) {
+    return 0;
+  }
+  const float value = std::floor((_value - _min) / _step + .5f);
+  return static_cast<uint16_t>(math::Clamp(0.f, value, _max));
 }
 
-ozz::Range<ScaleKey> CopyToAnimation(
-  ozz::Vector<SortingScaleKey>::Std* _src) {
+// Copies translation or scale keys to an Animation. Values are quantized to
+// _bits unsigned fixed point integers, normalized in the range of values of
+// their track, and bit-packed to _values. Ranges are output to _ranges in soa
+// format, with 2 elements per soa track: tracks minimum values, followed by
+// quantization steps.
+template<typename _DestKey, typename _SrcKeys>
+ozz::Range<_DestKey> CopyToAnimation(_SrcKeys* _src,
+                                     int _num_tracks,
+                                     int _bits,
+                                     ozz::Range<math::SoaFloat3>* _ranges,
+                                     ozz::Range<uint8_t>* _values) {
+  typedef typename _SrcKeys::value_type SrcKey;
   const size_t src_count = _src->size();
   if (!src_count) {
-    return ozz::Range<ScaleKey>();
+    return ozz::Range<_DestKey>();
   }
 
-  // Sort animation keys to favor cache coherency.
-  std::sort(&_src->front(), (&_src->back()) + 1, &SortingKeyLess<SortingScaleKey>);
+  // Computes tracks ranges.
+  const float max_value = static_cast<float>((1 << _bits) - 1);
+  ozz::Vector<math::Float3>::Std mins(
+    _num_tracks, math::Float3(std::numeric_limits<float>::max()));
+  ozz::Vector<math::Float3>::Std maxs(
+    _num_tracks, math::Float3(-std::numeric_limits<float>::max()));
+  for (size_t i = 0; i < src_count; ++i) {
+    const SrcKey& key = (*_src)[i];
+    mins[key.track] = Min(mins[key.track], key.key.value);
+    maxs[key.track] = Max(maxs[key.track], key.key.value);
+  }
 
-  // Fills output.
-  ozz::Range<ScaleKey> dest =
-    memory::default_allocator()->AllocateRange<ScaleKey>(src_count);
-  const SortingScaleKey* src = &_src->front();
+  // Computes quantization steps. Tracks without key get an empty range.
+  ozz::Vector<math::Float3>::Std steps(_num_tracks, math::Float3::zero());
+  for (int i = 0; i < _num_tracks; ++i) {
+    if (mins[i].x > maxs[i].x) {
+      mins[i] = math::Float3::zero();
+    } else {
+      steps[i] = (maxs[i] - mins[i]) / max_value;
+    }
+  }
+
+  // Sort animation keys to favor cache coherency.
+  std::sort(array_begin(*_src), array_end(*_src), &SortingKeyLess<SrcKey>);
+
+  // Fills output. Values of key n are packed from bit n * 3 * _bits.
+  memory::Allocator* allocator = memory::default_allocator();
+  ozz::Range<_DestKey> dest = allocator->AllocateRange<_DestKey>(src_count);
+  *_values = allocator->AllocateRange<uint8_t>(
+    animation::internal::PackedSize(src_count * 3, _bits));
+  std::memset(_values->begin, 0, _values->Size());
+  const SrcKey* src = &_src->front();
+  int offset = 0;
   for (size_t i = 0; i < src_count; ++i) {
-    ScaleKey& key = dest.begin[i];
-    key.time = src[i].key.time;
+    _DestKey& key = dest.begin[i];
+    const math::Float3& min = mins[src[i].track];
+    const math::Float3& step = steps[src[i].track];
+    key.time = static_cast<uint16_t>(static_cast<int>(src[i].key.time));
     key.track = src[i].track;
-    key.value[0] = ozz::math::FloatToHalf(src[i].key.value.x);
-    key.value[1] = ozz::math::FloatToHalf(src[i].key.value.y);
-    key.value[2] = ozz::math::FloatToHalf(src[i].key.value.z);
+    const math::Float3& value = src[i].key.value;
+    animation::internal::WriteBits(
+      _values->begin, &offset, Quantize(value.x, min.x, step.x, max_value),
+      _bits);
+    animation::internal::WriteBits(
+      _values->begin, &offset, Quantize(value.y, min.y, step.y, max_value),
+      _bits);
+    animation::internal::WriteBits(
+      _values->begin, &offset, Quantize(value.z, min.z, step.z, max_value),
+      _bits);
+  }
+
+  // Packs ranges to soa format.
+  const int num_soa_tracks = _num_tracks / 4;
+  *_ranges =
+    memory::default_allocator()->AllocateRange<math::SoaFloat3>(
+      num_soa_tracks * 2);
+  for (int i = 0; i < num_soa_tracks; ++i) {
+    const math::Float3* m = &mins[i * 4];
+    _ranges->begin[i * 2 + 0] = math::SoaFloat3::Load(
+      math::simd_float4::Load(m[0].x, m[1].x, m[2].x, m[3].x),
+      math::simd_float4::Load(m[0].y, m[1].y, m[2].y, m[3].y),
+      math::simd_float4::Load(m[0].z, m[1].z, m[2].z, m[3].z));
+    const math::Float3* st = &steps[i * 4];
+    _ranges->begin[i * 2 + 1] = math::SoaFloat3::Load(
+      math::simd_float4::Load(st[0].x, st[1].x, st[2].x, st[3].x),
+      math::simd_float4::Load(st[0].y, st[1].y, st[2].y, st[3].y),
+      math::simd_float4::Load(st[0].z, st[1].z, st[2].z, st[3].z));
   }
   return dest;
 }
 
-// Specialize for rotations in order to normalize quaternions.
-// Consecutive opposite quaternions are also fixed up in order to avoid checking
-// for the smallest path during the NLerp runtime algorithm.
+// Specialize for rotations in order to normalize and compress quaternions.
+// Quaternions are compressed using their smallest three components, the
+// largest one being restored at runtime. The sampling job takes care of
+// interpolating along the shortest path, as Q and -Q represent the same
+// rotation but compression might choose a different sign for consecutive keys.
 ozz::Range<RotationKey> CopyToAnimation(
   ozz::Vector<SortingRotationKey>::Std* _src) {
   const size_t src_count = _src->size();
@@ -191,71 +369,153 @@ ozz::Range<RotationKey> CopyToAnimation(
     return ozz::Range<RotationKey>();
   }
 
-  // Normalize quaternions.
-  // Also fixes-up successive opposite quaternions that would fail to take the
-  // shortest path during the normalized-lerp.
-  // Note that keys are still sorted per-track at that point, which allows this
-  // algorithm to process all consecutive keys.
-  size_t track = std::numeric_limits<size_t>::max();
-  const math::Quaternion identity = math::Quaternion::identity();
-  SortingRotationKey* src = &_src->front();
-  for (size_t i = 0; i < src_count; ++i) {
-    math::Quaternion normalized = NormalizeSafe(src[i].key.value, identity);
-    if (track != src[i].track) {  // First key of the track.
-      if (normalized.w < 0.f) {  // .w eq to a dot with identity quaternion.
-        normalized = -normalized;  // Q an -Q are the same rotation.
-      }
-    } else {  // Still on the same track: so fixes-up quaternion.
-      const math::Float4 prev(src[i - 1].key.value.x, src[i - 1].key.value.y,
-                              src[i - 1].key.value.z, src[i - 1].key.value.w);
-      const math::Float4 curr(normalized.x, normalized.y,
-                              normalized.z, normalized.w);
-      if (Dot(prev, curr) < 0.f) {
-        normalized = -normalized;  // Q an -Q are the same rotation.
-      }
-    }
-    // Stores fixed-up quaternion.
-    src[i].key.value = normalized;
-    track = src[i].track;
-  }
-
   // Sort.
+  SortingRotationKey* src = &_src->front();
   std::sort(array_begin(*_src),
             array_end(*_src),
             &SortingKeyLess<SortingRotationKey>);
 
   // Fills output.
+  const math::Quaternion identity = math::Quaternion::identity();
   ozz::Range<RotationKey> dest =
     memory::default_allocator()->AllocateRange<RotationKey>(src_count);
   for (size_t i = 0; i < src_count; ++i) {
     RotationKey& dkey = dest.begin[i];
-    dkey.time = src[i].key.time;
+    dkey.time = static_cast<uint16_t>(static_cast<int>(src[i].key.time));
     dkey.track = src[i].track;
-    // Stores the sign of the 4th component.
-    const math::Quaternion& squat = src[i].key.value;
-    dkey.wsign = squat.w >= 0.f;
-    // Quantize x, y, z components on 16 bits signed integers.
-    const int x = static_cast<int>(floor(squat.x * 32767.f + .5f));
-    const int y = static_cast<int>(floor(squat.y * 32767.f + .5f));
-    const int z = static_cast<int>(floor(squat.z * 32767.f + .5f));
-    dkey.value[0] = math::Clamp(-32767, x, 32767) & 0xffff;
-    dkey.value[1] = math::Clamp(-32767, y, 32767) & 0xffff;
-    dkey.value[2] = math::Clamp(-32767, z, 32767) & 0xffff;
+
+    // Finds the largest component of the normalized quaternion.
+    const math::Quaternion normalized =
+      NormalizeSafe(src[i].key.value, identity);
+    const float components[4] = {
+      normalized.x, normalized.y, normalized.z, normalized.w};
+    int largest = 0;
+    for (int c = 1; c < 4; ++c) {
+      if (std::abs(components[c]) > std::abs(components[largest])) {
+        largest = c;
+      }
+    }
+    dkey.largest = largest;
+
+    // Q and -Q are the same rotation, so the largest component is made
+    // positive and doesn't need a sign. The 3 other components are in range
+    // [-1/sqrt(2),1/sqrt(2)], they are scaled by sqrt(2) and quantized to 16
+    // bits signed integers.
+    const float scale = components[largest] < 0.f ?
+      -kRotationQuantizationScale : kRotationQuantizationScale;
+    for (int c = 0, v = 0; c < 4; ++c) {
+      if (c == largest) {
+        continue;
+      }
+      const int quantized =
+        static_cast<int>(floor(components[c] * scale + .5f));
+      dkey.value[v++] = math::Clamp(-32767, quantized, 32767) & 0xffff;
+    }
   }
   return dest;
 }
+
+// Copies to an Animation the high bits of sorted _src keys time, with an
+// element per key, if key times are _wide. Low bits are stored in the keys.
+template<typename _SrcKeys>
+ozz::Range<uint8_t> CopyTimeHighsToAnimation(const _SrcKeys& _src,
+                                             bool _wide) {
+  if (!_wide || _src.empty()) {
+    return ozz::Range<uint8_t>();
+  }
+  ozz::Range<uint8_t> dest =
+    memory::default_allocator()->AllocateRange<uint8_t>(_src.size());
+  for (size_t i = 0; i < _src.size(); ++i) {
+    dest.begin[i] =
+      static_cast<uint8_t>(static_cast<int>(_src[i].key.time) >> 16);
+  }
+  return dest;
+}
+
+// Builds a seek index for _keys, made of _num_seeks entries. Each entry is a
+// snapshot of the sampling state at time (entry + 1) * _interval, computed by
+// running the same keys update algorithm as the SamplingJob: the keys cursor,
+// followed by left and right keys indices of every track. _highs are the keys
+// time high bits, empty if key times aren't wide.
+template<typename _Key>
+ozz::Range<int> BuildSeekIndex(ozz::Range<const _Key> _keys,
+                               ozz::Range<const uint8_t> _highs,
+                               int _num_tracks,
+                               int _num_animated,
+                               float _duration,
+                               float _interval,
+                               int _num_seeks) {
+  const int stride = 1 + _num_tracks * 2;
+  ozz::Range<int> seeks =
+    memory::default_allocator()->AllocateRange<int>(stride * _num_seeks);
+  if (!_num_seeks) {
+    return seeks;
+  }
+
+  // Initializes keys with the first 2 sets of key frames, made of a key per
+  // animated track. Constant tracks refer to the first 2 keys, as they're
+  // decompressed along with the other tracks of their soa element.
+  ozz::Vector<int>::Std keys(_num_tracks * 2);
+  for (int i = 0; i < _num_tracks; ++i) {
+    keys[i * 2 + 0] = 0;
+    keys[i * 2 + 1] = _num_animated;
+  }
+  for (int i = 0; i < _num_animated; ++i) {
+    const int base = _keys.begin[i].track * 2;
+    keys[base + 0] = i;
+    keys[base + 1] = i + _num_animated;
+  }
+  const _Key* cursor = _keys.begin + _num_animated * 2;
+
+  for (int i = 0; i < _num_seeks; ++i) {
+    const float time = ToKeyTime(static_cast<float>(i + 1) * _interval,
+                                 _duration, _highs.begin != NULL);
+    while (cursor < _keys.end &&
+           KeyTime(_keys.begin, _highs.begin,
+                   keys[cursor->track * 2 + 1]) <= time) {
+      const int base = cursor->track * 2;
+      keys[base] = keys[base + 1];
+      keys[base + 1] = static_cast<int>(cursor - _keys.begin);
+      ++cursor;
+    }
+
+    int* entry = seeks.begin + i * stride;
+    entry[0] = static_cast<int>(cursor - _keys.begin);
+    std::copy(keys.begin(), keys.end(), entry + 1);
+  }
+  return seeks;
+}
 }  // namespace
 
+AnimationBuilder::AnimationBuilder()
+    : seek_interval(0.f),
+      translation_bits(16),
+      scale_bits(16) {
+}
+
 // Ensures _input's validity and allocates _animation.
-// An animation needs to have at least two key frames per joint, the first at
-// t = 0 and the last at t = duration. If at least one of those keys are not
-// in the RawAnimation then the builder creates it.
+// An animated track needs to have at least two key frames, the first at t = 0
+// and the last at t = duration. If at least one of those keys are not in the
+// RawAnimation then the builder creates it. Constant tracks have no key frame.
 Animation* AnimationBuilder::operator()(const RawAnimation& _input) const {
   // Tests _raw_animation validity.
   if (!_input.Validate()) {
     return NULL;
   }
 
+  // Tests quantization settings.
+  if (translation_bits < 1 || translation_bits > 16 ||
+      scale_bits < 1 || scale_bits > 16) {
+    return NULL;
+  }
+
+  // Tests that key times are still distinct once quantized. Key times are
+  // widened to 24 bits if they aren't on 16 bits.
+  const bool wide = !HasDistinctKeyTimes(_input, false);
+  if (wide && !HasDistinctKeyTimes(_input, true)) {
+    return NULL;
+  }
+
   // Everything is fine, allocates and fills the animation.
   // Nothing can fail now.
   Animation* animation = memory::default_allocator()->New<Animation>();
@@ -263,6 +523,7 @@ Animation* AnimationBuilder::operator()(const RawAnimation& _input) const {
   // Sets duration.
   const float duration = _input.duration;
   animation->duration_ = duration;
+  animation->wide_key_times_ = wide;
   // A _duration == 0 would create some division by 0 during sampling.
   // Also we need at least to keys with different times, which cannot be done
   // if duration is 0.
@@ -289,34 +550,99 @@ Animation* AnimationBuilder::operator()(const RawAnimation& _input) const {
   ozz::Vector<SortingScaleKey>::Std sorting_scales;
   sorting_scales.reserve(scales);
 
+  // Constant tracks flags (a byte per soa track) and values. Soa padding
+  // tracks are constant identity tracks.
+  const size_t num_soa_flags = num_soa_tracks / 4;
+  ozz::Vector<uint8_t>::Std translation_flags(num_soa_flags, 0);
+  ozz::Vector<math::Float3>::Std translation_values(
+    num_soa_tracks, RawAnimation::TranslationKey::identity());
+  ozz::Vector<uint8_t>::Std rotation_flags(num_soa_flags, 0);
+  ozz::Vector<math::Quaternion>::Std rotation_values(
+    num_soa_tracks, RawAnimation::RotationKey::identity());
+  ozz::Vector<uint8_t>::Std scale_flags(num_soa_flags, 0);
+  ozz::Vector<math::Float3>::Std scale_values(
+    num_soa_tracks, RawAnimation::ScaleKey::identity());
+
   // Filters RawAnimation keys and copies them to the output sorting structure.
+  // Constant tracks have no key, their value is copied to constant values.
+  int num_animated_translations = 0;
+  int num_animated_rotations = 0;
+  int num_animated_scales = 0;
   uint16_t i = 0;
   for (; i < num_tracks; ++i) {
     const RawAnimation::JointTrack& raw_track = _input.tracks[i];
-    CopyRaw(raw_track.translations, i, duration, &sorting_translations);
-    CopyRaw(raw_track.rotations, i, duration, &sorting_rotations);
-    CopyRaw(raw_track.scales, i, duration, &sorting_scales);
+    num_animated_translations += CopyTrack(
+      raw_track.translations, i, duration, wide, &sorting_translations,
+      &translation_flags, &translation_values);
+    num_animated_rotations += CopyTrack(
+      raw_track.rotations, i, duration, wide, &sorting_rotations,
+      &rotation_flags, &rotation_values);
+    num_animated_scales += CopyTrack(
+      raw_track.scales, i, duration, wide, &sorting_scales,
+      &scale_flags, &scale_values);
   }
 
-  // Add enough identity keys to match soa requirements.
+  // Flags soa padding tracks as constant.
   for (; i < num_soa_tracks; ++i) {
-    typedef RawAnimation::TranslationKey SrcTKey;
-    PushBackIdentityKey<SrcTKey>(i, 0.f, &sorting_translations);
-    PushBackIdentityKey<SrcTKey>(i, duration, &sorting_translations);
-
-    typedef RawAnimation::RotationKey SrcRKey;
-    PushBackIdentityKey<SrcRKey>(i, 0.f, &sorting_rotations);
-    PushBackIdentityKey<SrcRKey>(i, duration, &sorting_rotations);
-
-    typedef RawAnimation::ScaleKey SrcSKey;
-    PushBackIdentityKey<SrcSKey>(i, 0.f, &sorting_scales);
-    PushBackIdentityKey<SrcSKey>(i, duration, &sorting_scales);
+    const uint8_t flag = static_cast<uint8_t>(1 << (i & 3));
+    translation_flags[i / 4] |= flag;
+    rotation_flags[i / 4] |= flag;
+    scale_flags[i / 4] |= flag;
   }
 
   // Copy sorted keys to final animation.
-  animation->translations_ = CopyToAnimation(&sorting_translations);
+  animation->translations_ = CopyToAnimation<TranslationKey>(
+    &sorting_translations, num_soa_tracks, translation_bits,
+    &animation->translation_ranges_, &animation->translation_values_);
+  animation->translation_bits_ = translation_bits;
   animation->rotations_ = CopyToAnimation(&sorting_rotations);
-  animation->scales_ = CopyToAnimation(&sorting_scales);
+  animation->scales_ = CopyToAnimation<ScaleKey>(
+    &sorting_scales, num_soa_tracks, scale_bits, &animation->scale_ranges_,
+    &animation->scale_values_);
+  animation->scale_bits_ = scale_bits;
+  animation->translation_time_highs_ =
+    CopyTimeHighsToAnimation(sorting_translations, wide);
+  animation->rotation_time_highs_ =
+    CopyTimeHighsToAnimation(sorting_rotations, wide);
+  animation->scale_time_highs_ =
+    CopyTimeHighsToAnimation(sorting_scales, wide);
+  animation->num_animated_translations_ = num_animated_translations;
+  animation->num_animated_rotations_ = num_animated_rotations;
+  animation->num_animated_scales_ = num_animated_scales;
+
+  // Copy constant tracks to final animation.
+  CopyToAnimation(translation_flags, translation_values,
+                  &animation->translation_constant_flags_,
+                  &animation->translation_constants_);
+  CopyToAnimation(rotation_flags, rotation_values,
+                  &animation->rotation_constant_flags_,
+                  &animation->rotation_constants_);
+  CopyToAnimation(scale_flags, scale_values,
+                  &animation->scale_constant_flags_,
+                  &animation->scale_constants_);
+
+  // Builds seek index, with an entry every interval, excluding t = 0 and
+  // t >= duration. The interval is enlarged if seek_interval would require
+  // more than kMaxSeeks entries.
+  int num_seeks = 0;
+  float interval = seek_interval;
+  if (interval > 0.f && num_soa_tracks) {
+    interval = math::Max(interval, duration / (kMaxSeeks + 1));
+    while (num_seeks < kMaxSeeks &&
+           static_cast<float>(num_seeks + 1) * interval < duration) {
+      ++num_seeks;
+    }
+    animation->seek_interval_ = interval;
+  }
+  animation->translation_seeks_ = BuildSeekIndex(
+    animation->translations(), animation->translation_time_highs(),
+    num_soa_tracks, num_animated_translations, duration, interval, num_seeks);
+  animation->rotation_seeks_ = BuildSeekIndex(
+    animation->rotations(), animation->rotation_time_highs(),
+    num_soa_tracks, num_animated_rotations, duration, interval, num_seeks);
+  animation->scale_seeks_ = BuildSeekIndex(
+    animation->scales(), animation->scale_time_highs(),
+    num_soa_tracks, num_animated_scales, duration, interval, num_seeks);
 
   return animation;  // Success.
 }
@@ -0,0 +1,388 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/animation_compressor.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include "ozz/base/containers/vector.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_float.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+
+#include "ozz/animation/runtime/compressed_animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "../offline/raw_animation_sampling.h"
+#include "../runtime/packed_bits.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+namespace {
+
+// Uniformly sampled values of a channel (translations, rotations or scales),
+// and their quantization parameters.
+struct Channel {
+  explicit Channel(int _num_components)
+      : num_components(_num_components) {
+  }
+
+  // Returns the address of the components of _track value at _frame.
+  float* value(int _track, int _frame, int _num_frames) {
+    return &values[(_track * _num_frames + _frame) * num_components];
+  }
+
+  // Number of components of a value.
+  int num_components;
+
+  // Values, stored track after track, frame after frame.
+  ozz::Vector<float>::Std values;
+
+  // Minimum values and quantization steps, stored track after track.
+  ozz::Vector<float>::Std mins;
+  ozz::Vector<float>::Std steps;
+
+  // Bits per component, for every track.
+  ozz::Vector<int>::Std bits;
+};
+
+// Returns the smallest number of bits that allows to quantize a value whose
+// components range is at most _extent, such that the quantization error
+// multiplied by _scale is within _budget. 0 bit means the value is constant
+// (equal to the range minimum).
+int SelectBits(float _extent, float _scale, float _budget) {
+  for (int bits = 0; bits < CompressedAnimation::kMaxBits; ++bits) {
+    const float error =
+      bits == 0 ? _extent : _extent / ((1 << bits) - 1) * .5f;
+    if (error * _scale <= _budget) {
+      return bits;
+    }
+  }
+  return CompressedAnimation::kMaxBits;
+}
+
+// Computes _channel ranges of values and returns, for every track, the
+// largest range of its components.
+ozz::Vector<float>::Std ComputeRanges(int _num_tracks, int _num_frames,
+                                      Channel* _channel) {
+  const int num_components = _channel->num_components;
+  _channel->mins.resize(_num_tracks * num_components);
+  _channel->steps.resize(_num_tracks * num_components, 0.f);
+  ozz::Vector<float>::Std extents(_num_tracks, 0.f);
+  for (int i = 0; i < _num_tracks; ++i) {
+    for (int c = 0; c < num_components; ++c) {
+      float min = _channel->value(i, 0, _num_frames)[c];
+      float max = min;
+      for (int f = 1; f < _num_frames; ++f) {
+        const float value = _channel->value(i, f, _num_frames)[c];
+        min = math::Min(min, value);
+        max = math::Max(max, value);
+      }
+      _channel->mins[i * num_components + c] = min;
+      extents[i] = math::Max(extents[i], max - min);
+    }
+  }
+  return extents;
+}
+
+// Computes _channel quantization steps from its bits.
+void ComputeSteps(int _num_tracks, int _num_frames, Channel* _channel) {
+  const int num_components = _channel->num_components;
+  for (int i = 0; i < _num_tracks; ++i) {
+    const int bits = _channel->bits[i];
+    if (bits == 0) {
+      continue;
+    }
+    for (int c = 0; c < num_components; ++c) {
+      float max = _channel->value(i, 0, _num_frames)[c];
+      for (int f = 1; f < _num_frames; ++f) {
+        max = math::Max(max, _channel->value(i, f, _num_frames)[c]);
+      }
+      const float extent = max - _channel->mins[i * num_components + c];
+      _channel->steps[i * num_components + c] = extent / ((1 << bits) - 1);
+    }
+  }
+}
+
+// Returns the soa value of component _component of the 4 tracks of soa track
+// _soa, from per track _values.
+math::SimdFloat4 LoadSoa(const ozz::Vector<float>::Std& _values,
+                         int _num_components, int _soa, int _component) {
+  const float* values = &_values[_soa * 4 * _num_components + _component];
+  return math::simd_float4::Load(values[0],
+                                 values[_num_components],
+                                 values[_num_components * 2],
+                                 values[_num_components * 3]);
+}
+
+void CopyRanges(const Channel& _channel, int _num_soa_tracks,
+                ozz::Range<math::SoaFloat3>* _ranges) {
+  for (int i = 0; i < _num_soa_tracks; ++i) {
+    const math::SoaFloat3 min = {LoadSoa(_channel.mins, 3, i, 0),
+                                 LoadSoa(_channel.mins, 3, i, 1),
+                                 LoadSoa(_channel.mins, 3, i, 2)};
+    const math::SoaFloat3 step = {LoadSoa(_channel.steps, 3, i, 0),
+                                  LoadSoa(_channel.steps, 3, i, 1),
+                                  LoadSoa(_channel.steps, 3, i, 2)};
+    _ranges->begin[i * 2] = min;
+    _ranges->begin[i * 2 + 1] = step;
+  }
+}
+
+void CopyRanges(const Channel& _channel, int _num_soa_tracks,
+                ozz::Range<math::SoaFloat4>* _ranges) {
+  for (int i = 0; i < _num_soa_tracks; ++i) {
+    const math::SoaFloat4 min = {LoadSoa(_channel.mins, 4, i, 0),
+                                 LoadSoa(_channel.mins, 4, i, 1),
+                                 LoadSoa(_channel.mins, 4, i, 2),
+                                 LoadSoa(_channel.mins, 4, i, 3)};
+    const math::SoaFloat4 step = {LoadSoa(_channel.steps, 4, i, 0),
+                                  LoadSoa(_channel.steps, 4, i, 1),
+                                  LoadSoa(_channel.steps, 4, i, 2),
+                                  LoadSoa(_channel.steps, 4, i, 3)};
+    _ranges->begin[i * 2] = min;
+    _ranges->begin[i * 2 + 1] = step;
+  }
+}
+
+// Quantizes and writes _track value of _channel at _frame.
+void PackValue(Channel* _channel, int _track, int _frame, int _num_frames,
+               uint8_t* _buffer, int* _offset) {
+  const int bits = _channel->bits[_track];
+  if (bits == 0) {
+    return;
+  }
+  const int num_components = _channel->num_components;
+  const int max = (1 << bits) - 1;
+  const float* value = _channel->value(_track, _frame, _num_frames);
+  for (int c = 0; c < num_components; ++c) {
+    const float min = _channel->mins[_track * num_components + c];
+    const float step = _channel->steps[_track * num_components + c];
+    int quantized = 0;
+    if (step > 0.f) {
+      quantized = static_cast<int>(std::floor((value[c] - min) / step + .5f));
+    }
+    animation::internal::WriteBits(_buffer, _offset,
+                                   math::Clamp(0, quantized, max), bits);
+  }
+}
+}  // namespace
+
+AnimationCompressor::AnimationCompressor()
+    : tolerance(1e-3f),  // 1mm.
+      distance(.1f),  // 10cm.
+      sample_rate(30.f) {
+}
+
+CompressedAnimation* AnimationCompressor::operator()(
+  const RawAnimation& _input, const Skeleton& _skeleton) const {
+  // Tests _raw_animation validity.
+  if (!_input.Validate()) {
+    return NULL;
+  }
+
+  // Tests skeleton and compression settings.
+  const int num_tracks = _input.num_tracks();
+  if (num_tracks != _skeleton.num_joints() ||
+      !(tolerance > 0.f) || !(distance > 0.f) || !(sample_rate > 0.f)) {
+    return NULL;
+  }
+
+  // Everything is fine, nothing can fail now.
+  const float duration = _input.duration;
+  const int num_soa_tracks = (num_tracks + 3) / 4;
+  const int num_padded_tracks = num_soa_tracks * 4;
+  const int num_frames = math::Max(
+    static_cast<int>(std::ceil(duration * sample_rate - 1e-3f)) + 1, 2);
+
+  // Uniformly samples all the tracks. Soa padding tracks are identity tracks.
+  Channel translations(3);
+  Channel rotations(4);
+  Channel scales(3);
+  translations.values.resize(num_padded_tracks * num_frames * 3);
+  rotations.values.resize(num_padded_tracks * num_frames * 4);
+  scales.values.resize(num_padded_tracks * num_frames * 3);
+  for (int i = 0; i < num_padded_tracks; ++i) {
+    math::Quaternion previous = RawAnimation::RotationKey::identity();
+    for (int f = 0; f < num_frames; ++f) {
+      const float time = duration * f / (num_frames - 1);
+      math::Float3 translation = RawAnimation::TranslationKey::identity();
+      math::Quaternion rotation = RawAnimation::RotationKey::identity();
+      math::Float3 scale = RawAnimation::ScaleKey::identity();
+      if (i < num_tracks) {
+        const RawAnimation::JointTrack& track = _input.tracks[i];
+        internal::SampleTrack(track.translations, time, &translation);
+        internal::SampleTrack(track.rotations, time, &rotation);
+        internal::SampleTrack(track.scales, time, &scale);
+      }
+
+      // Keeps consecutive rotations in the same hemisphere, so they can be
+      // interpolated directly.
+      const float dot = previous.x * rotation.x + previous.y * rotation.y +
+                        previous.z * rotation.z + previous.w * rotation.w;
+      if (f != 0 && dot < 0.f) {
+        rotation = -rotation;
+      }
+      previous = rotation;
+
+      float* t = translations.value(i, f, num_frames);
+      t[0] = translation.x; t[1] = translation.y; t[2] = translation.z;
+      float* r = rotations.value(i, f, num_frames);
+      r[0] = rotation.x; r[1] = rotation.y; r[2] = rotation.z;
+      r[3] = rotation.w;
+      float* s = scales.value(i, f, num_frames);
+      s[0] = scale.x; s[1] = scale.y; s[2] = scale.z;
+    }
+  }
+
+  const ozz::Vector<float>::Std translation_extents =
+    ComputeRanges(num_padded_tracks, num_frames, &translations);
+  const ozz::Vector<float>::Std rotation_extents =
+    ComputeRanges(num_padded_tracks, num_frames, &rotations);
+  const ozz::Vector<float>::Std scale_extents =
+    ComputeRanges(num_padded_tracks, num_frames, &scales);
+
+  // Computes, from the skeleton hierarchy, the distance from each joint to its
+  // farthest descendant (reach), and the number of joints of the longest chain
+  // each joint belongs to (depth + height). Parents are always stored before
+  // their children.
+  ozz::Range<const Skeleton::JointProperties> properties =
+    _skeleton.joint_properties();
+  ozz::Vector<float>::Std reaches(num_padded_tracks, 0.f);
+  ozz::Vector<int>::Std depths(num_padded_tracks, 1);
+  ozz::Vector<int>::Std heights(num_padded_tracks, 0);
+  for (int i = 0; i < num_tracks; ++i) {
+    const int parent = properties.begin[i].parent;
+    if (parent != Skeleton::kNoParentIndex) {
+      depths[i] = depths[parent] + 1;
+    }
+  }
+  for (int i = num_tracks - 1; i >= 0; --i) {
+    const int parent = properties.begin[i].parent;
+    if (parent == Skeleton::kNoParentIndex) {
+      continue;
+    }
+    float length = 0.f;
+    for (int f = 0; f < num_frames; ++f) {
+      const float* t = translations.value(i, f, num_frames);
+      length = math::Max(
+        length, std::sqrt(t[0] * t[0] + t[1] * t[1] + t[2] * t[2]));
+    }
+    reaches[parent] = math::Max(reaches[parent], reaches[i] + length);
+    heights[parent] = math::Max(heights[parent], heights[i] + 1);
+  }
+
+  // Selects bits of every track, sharing tolerance between the translation,
+  // rotation and scale of all the joints of the chain. A quantization error e
+  // on each component moves a joint by at most sqrt(3).e, and rotates it by at
+  // most 4.e radians.
+  const float kSqrt3 = 1.7320508f;
+  translations.bits.resize(num_padded_tracks);
+  rotations.bits.resize(num_padded_tracks);
+  scales.bits.resize(num_padded_tracks);
+  for (int i = 0; i < num_padded_tracks; ++i) {
+    const float budget = tolerance / (3.f * (depths[i] + heights[i]));
+    const float lever = reaches[i] + distance;
+    translations.bits[i] =
+      SelectBits(translation_extents[i], kSqrt3, budget);
+    rotations.bits[i] =
+      SelectBits(rotation_extents[i], 4.f * lever, budget);
+    scales.bits[i] =
+      SelectBits(scale_extents[i], kSqrt3 * lever, budget);
+  }
+  ComputeSteps(num_padded_tracks, num_frames, &translations);
+  ComputeSteps(num_padded_tracks, num_frames, &rotations);
+  ComputeSteps(num_padded_tracks, num_frames, &scales);
+
+  // Allocates and fills the animation.
+  memory::Allocator* allocator = memory::default_allocator();
+  CompressedAnimation* animation = allocator->New<CompressedAnimation>();
+  animation->duration_ = duration;
+  animation->num_tracks_ = num_tracks;
+  animation->num_frames_ = num_frames;
+
+  animation->translation_bits_ =
+    allocator->AllocateRange<uint8_t>(num_padded_tracks);
+  animation->rotation_bits_ =
+    allocator->AllocateRange<uint8_t>(num_padded_tracks);
+  animation->scale_bits_ = allocator->AllocateRange<uint8_t>(num_padded_tracks);
+  for (int i = 0; i < num_padded_tracks; ++i) {
+    animation->translation_bits_.begin[i] =
+      static_cast<uint8_t>(translations.bits[i]);
+    animation->rotation_bits_.begin[i] =
+      static_cast<uint8_t>(rotations.bits[i]);
+    animation->scale_bits_.begin[i] = static_cast<uint8_t>(scales.bits[i]);
+  }
+
+  animation->translation_ranges_ =
+    allocator->AllocateRange<math::SoaFloat3>(num_soa_tracks * 2);
+  CopyRanges(translations, num_soa_tracks, &animation->translation_ranges_);
+  animation->rotation_ranges_ =
+    allocator->AllocateRange<math::SoaFloat4>(num_soa_tracks * 2);
+  CopyRanges(rotations, num_soa_tracks, &animation->rotation_ranges_);
+  animation->scale_ranges_ =
+    allocator->AllocateRange<math::SoaFloat3>(num_soa_tracks * 2);
+  CopyRanges(scales, num_soa_tracks, &animation->scale_ranges_);
+
+  // Packs frames, track after track.
+  animation->ComputeFrameLayout();
+  const int num_blocks =
+    (num_frames + CompressedAnimation::kBlockFrames - 1) /
+    CompressedAnimation::kBlockFrames;
+  animation->blocks_ = allocator->AllocateRange<uint8_t>(
+    num_blocks * animation->block_size_ + CompressedAnimation::kPaddingBytes);
+  std::memset(animation->blocks_.begin, 0, animation->blocks_.Size());
+  for (int f = 0; f < num_frames; ++f) {
+    const int block = f / CompressedAnimation::kBlockFrames;
+    uint8_t* buffer =
+      animation->blocks_.begin + block * animation->block_size_;
+    int offset =
+      (f - block * CompressedAnimation::kBlockFrames) * animation->frame_bits_;
+    for (int i = 0; i < num_padded_tracks; ++i) {
+      PackValue(&translations, i, f, num_frames, buffer, &offset);
+      PackValue(&rotations, i, f, num_frames, buffer, &offset);
+      PackValue(&scales, i, f, num_frames, buffer, &offset);
+    }
+  }
+
+  return animation;
+}
+}  // offline
+}  // animation
+}  // ozz
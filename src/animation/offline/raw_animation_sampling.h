@@ -0,0 +1,103 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_ANIMATION_OFFLINE_RAW_ANIMATION_SAMPLING_H_
+#define OZZ_ANIMATION_OFFLINE_RAW_ANIMATION_SAMPLING_H_
+
+#ifndef OZZ_INCLUDE_PRIVATE_HEADER
+#error "This header is private, it cannot be included from public headers."
+#endif  // OZZ_INCLUDE_PRIVATE_HEADER
+
+// Declares helpers to sample raw animation tracks at any time, for builders
+// that need to resample raw animations.
+
+#include <cassert>
+#include <cstddef>
+
+#include "ozz/base/maths/vec_float.h"
+#include "ozz/base/maths/quaternion.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+namespace internal {
+
+// Finds the keys surrounding _time in _keys, which must not be empty, and
+// outputs their indices and the interpolation coefficient.
+template<typename _Keys>
+inline void FindKeys(const _Keys& _keys, float _time,
+                     size_t* _left, size_t* _right, float* _alpha) {
+  assert(!_keys.empty());
+  size_t right = 0;
+  while (right < _keys.size() && _keys[right].time <= _time) {
+    ++right;
+  }
+  if (right == 0 || right == _keys.size()) {
+    *_left = *_right = right == 0 ? 0 : right - 1;
+    *_alpha = 0.f;
+    return;
+  }
+  *_left = right - 1;
+  *_right = right;
+  const float left_time = _keys[right - 1].time;
+  *_alpha = (_time - left_time) / (_keys[right].time - left_time);
+}
+
+// Interpolates translation or scale values.
+inline math::Float3 Interpolate(const math::Float3& _a,
+                                const math::Float3& _b,
+                                float _alpha) {
+  return Lerp(_a, _b, _alpha);
+}
+
+// Interpolates rotation values, along the shortest path.
+inline math::Quaternion Interpolate(const math::Quaternion& _a,
+                                    const math::Quaternion& _b,
+                                    float _alpha) {
+  const float dot = _a.x * _b.x + _a.y * _b.y + _a.z * _b.z + _a.w * _b.w;
+  return NLerp(_a, dot < 0.f ? -_b : _b, _alpha);
+}
+
+// Samples _keys at _time. _value is left unchanged if there's no key.
+template<typename _Keys, typename _Value>
+inline void SampleTrack(const _Keys& _keys, float _time, _Value* _value) {
+  if (_keys.empty()) {
+    return;
+  }
+  size_t left, right;
+  float alpha;
+  FindKeys(_keys, _time, &left, &right, &alpha);
+  *_value = Interpolate(_keys[left].value, _keys[right].value, alpha);
+}
+}  // internal
+}  // offline
+}  // animation
+}  // ozz
+#endif  // OZZ_ANIMATION_OFFLINE_RAW_ANIMATION_SAMPLING_H_
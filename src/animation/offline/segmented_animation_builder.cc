@@ -0,0 +1,146 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/segmented_animation_builder.h"
+
+#include <cassert>
+#include <cmath>
+
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/segmented_animation.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "../offline/raw_animation_sampling.h"
+#include "../runtime/animation_keyframe.h"
+
+namespace ozz {
+namespace animation {
+namespace offline {
+namespace {
+
+// Remaining time below which the last segment is merged with the previous
+// one, as a ratio of the segment duration.
+const float kMinLastSegmentRatio = 1e-2f;
+
+// Copies to _segment the keys of _keys within range [_begin,_end], shifted to
+// segment local time, plus keys sampled at the range boundaries. Keys that
+// would share a quantized key time with a boundary key are skipped.
+template<typename _Keys>
+void CopySegment(const _Keys& _keys, float _begin, float _end,
+                 _Keys* _segment) {
+  if (_keys.empty()) {
+    return;
+  }
+  const float duration = _end - _begin;
+  typename _Keys::value_type key = _keys[0];
+  internal::SampleTrack(_keys, _begin, &key.value);
+  key.time = 0.f;
+  _segment->push_back(key);
+  for (size_t i = 0; i < _keys.size(); ++i) {
+    // Time is tested once shifted and converted to wide key time units, so
+    // that neither rounding nor quantization can produce keys colliding with
+    // boundary keys, which would fail building the segment.
+    key = _keys[i];
+    key.time -= _begin;
+    const float key_time = ToKeyTime(key.time, duration, true);
+    if (key_time >= .5f && key_time < kMaxWideKeyTime - .5f) {
+      _segment->push_back(key);
+    }
+  }
+  internal::SampleTrack(_keys, _end, &key.value);
+  key.time = duration;
+  _segment->push_back(key);
+}
+}  // namespace
+
+SegmentedAnimationBuilder::SegmentedAnimationBuilder()
+    : segment_duration(5.f) {
+}
+
+SegmentedAnimation* SegmentedAnimationBuilder::operator()(
+  const RawAnimation& _input) const {
+  // Tests _raw_animation validity.
+  if (!_input.Validate() || !(segment_duration > 0.f)) {
+    return NULL;
+  }
+
+  // Computes the number of segments. The last one covers the remaining time.
+  const float duration = _input.duration;
+  int num_segments =
+    static_cast<int>(std::ceil(duration / segment_duration));
+  if (num_segments > 1 &&
+      duration - (num_segments - 1) * segment_duration <
+        segment_duration * kMinLastSegmentRatio) {
+    --num_segments;
+  }
+  num_segments = num_segments < 1 ? 1 : num_segments;
+
+  memory::Allocator* allocator = memory::default_allocator();
+  SegmentedAnimation* animation = allocator->New<SegmentedAnimation>();
+  animation->duration_ = duration;
+  animation->num_tracks_ = _input.num_tracks();
+  animation->segment_duration_ = segment_duration;
+  animation->Allocate(num_segments);
+
+  const int num_tracks = _input.num_tracks();
+  for (int s = 0; s < num_segments; ++s) {
+    const float begin = s * segment_duration;
+    const float end =
+      s == num_segments - 1 ? duration : (s + 1) * segment_duration;
+
+    RawAnimation raw_segment;
+    raw_segment.duration = end - begin;
+    raw_segment.tracks.resize(num_tracks);
+    for (int i = 0; i < num_tracks; ++i) {
+      const RawAnimation::JointTrack& track = _input.tracks[i];
+      RawAnimation::JointTrack& segment_track = raw_segment.tracks[i];
+      CopySegment(track.translations, begin, end,
+                  &segment_track.translations);
+      CopySegment(track.rotations, begin, end, &segment_track.rotations);
+      CopySegment(track.scales, begin, end, &segment_track.scales);
+    }
+
+    Animation* segment = builder(raw_segment);
+    if (!segment) {
+      allocator->Delete(animation);
+      return NULL;
+    }
+    animation->segments_[s].animation = segment;
+  }
+  return animation;
+}
+}  // offline
+}  // animation
+}  // ozz
@@ -66,6 +66,11 @@ OZZ_OPTIONS_DECLARE_FLOAT(
   scale,
   "Optimizer scale tolerance in percents",
   ozz::animation::offline::AnimationOptimizer().scale_tolerance, false)
+OZZ_OPTIONS_DECLARE_FLOAT(
+  seek_interval,
+  "Time interval between animation seek index entries in seconds, which "\
+  "speeds up backward and random access sampling. 0 disables seek index",
+  ozz::animation::offline::AnimationBuilder().seek_interval, false)
 
 static bool ValidateEndianness(const ozz::options::Option& _option,
                                int /*_argc*/) {
@@ -206,7 +211,8 @@ int AnimationConverter::operator()(int _argc, const char** _argv) {
         OPTIONS_skeleton << std::endl;
       return EXIT_FAILURE;
     }
-    ozz::io::IArchive archive(&file);
+    ozz::io::BufferedStream stream(&file);
+    ozz::io::IArchive archive(&stream);
 
     // File could contain a RawSkeleton or a Skeleton.
     if (archive.TestTag<ozz::animation::offline::RawSkeleton>()) {
@@ -272,6 +278,7 @@ int AnimationConverter::operator()(int _argc, const char** _argv) {
   if (!OPTIONS_raw) {
     ozz::log::Log() << "Builds runtime animation." << std::endl;
     ozz::animation::offline::AnimationBuilder builder;
+    builder.seek_interval = OPTIONS_seek_interval;
     animation = builder(raw_optimized_animation);
     if (!animation) {
       ozz::log::Err() << "Failed to build runtime animation." << std::endl;
@@ -305,7 +312,8 @@ int AnimationConverter::operator()(int _argc, const char** _argv) {
       " Endian output binary format selected." << std::endl;
 
     // Initializes output archive.
-    ozz::io::OArchive archive(&file, endianness);
+    ozz::io::BufferedStream stream(&file);
+    ozz::io::OArchive archive(&stream, endianness);
 
     // Fills output archive with the animation.
     if (OPTIONS_raw) {
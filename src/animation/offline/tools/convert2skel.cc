@@ -172,7 +172,8 @@ int SkeletonConverter::operator()(int _argc, const char** _argv) {
       " Endian output binary format selected." << std::endl;
 
     // Initializes output archive.
-    ozz::io::OArchive archive(&file, endianness);
+    ozz::io::BufferedStream stream(&file);
+    ozz::io::OArchive archive(&stream, endianness);
 
     // Fills output archive with the skeleton.
     if (OPTIONS_raw) {
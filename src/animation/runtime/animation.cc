@@ -30,20 +30,289 @@
 
 #include "ozz/animation/runtime/animation.h"
 
+#include <cassert>
+#include <cstring>
+
+#include "ozz/base/atomic.h"
 #include "ozz/base/io/archive.h"
+#include "ozz/base/io/image.h"
 #include "ozz/base/maths/math_archive.h"
+#include "ozz/base/maths/soa_math_archive.h"
+#include "ozz/base/maths/soa_quaternion.h"
 #include "ozz/base/memory/allocator.h"
 
 // Internal include file
 #define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
 #include "../runtime/animation_keyframe.h"
+#include "../runtime/packed_bits.h"
 
 namespace ozz {
+namespace io {
+// Specializes key frames swapping, as they are made of 16 bits members.
+template <>
+struct PodSwapper<animation::TranslationKey> {
+  static void Swap(animation::TranslationKey* _keys, size_t _count, bool) {
+    EndianSwapper<uint16_t>::Swap(reinterpret_cast<uint16_t*>(_keys),
+                                  _count * sizeof(*_keys) / 2);
+  }
+};
+
+template <>
+struct PodSwapper<animation::ScaleKey> {
+  static void Swap(animation::ScaleKey* _keys, size_t _count, bool) {
+    EndianSwapper<uint16_t>::Swap(reinterpret_cast<uint16_t*>(_keys),
+                                  _count * sizeof(*_keys) / 2);
+  }
+};
+
+// Rotation keys track and largest bit-fields share a 16 bits word, whose
+// layout depends on the endianness: bit-fields are allocated from the least
+// significant bit on little endian platforms, and from the most significant
+// bit on big endian ones.
+template <>
+struct PodSwapper<animation::RotationKey> {
+  static void Swap(animation::RotationKey* _keys, size_t _count,
+                   bool _to_native) {
+    const bool little = GetNativeEndianness() == kLittleEndian;
+    for (size_t i = 0; i < _count; ++i) {
+      animation::RotationKey& key = _keys[i];
+      key.time = EndianSwapper<uint16_t>::Swap(key.time);
+      EndianSwapper<int16_t>::Swap(key.value, 3);
+      char* word = reinterpret_cast<char*>(&key) + sizeof(key.time);
+      uint16_t foreign;
+      if (_to_native) {
+        std::memcpy(&foreign, word, sizeof(foreign));
+        foreign = EndianSwapper<uint16_t>::Swap(foreign);
+        key.track = little ? foreign >> 2 : foreign & 0x3fff;
+        key.largest = little ? foreign & 3 : foreign >> 14;
+      } else {
+        foreign = little ? (key.track << 2 | key.largest) :
+                           (key.track | key.largest << 14);
+        foreign = EndianSwapper<uint16_t>::Swap(foreign);
+        std::memcpy(word, &foreign, sizeof(foreign));
+      }
+    }
+  }
+};
+}  // io
+
 namespace animation {
 
+namespace {
+void SaveSeeks(ozz::io::OArchive& _archive, ozz::Range<const int> _seeks) {
+  const ptrdiff_t count = _seeks.Count();
+  _archive << static_cast<int32_t>(count);
+  if (count) {
+    _archive << ozz::io::MakeArray(_seeks.begin, count);
+  }
+}
+
+ozz::Range<int> LoadSeeks(ozz::io::IArchive& _archive) {
+  int32_t count;
+  _archive >> count;
+  ozz::Range<int> seeks =
+    memory::default_allocator()->AllocateRange<int>(count);
+  if (count) {
+    _archive >> ozz::io::MakeArray(seeks.begin, count);
+  }
+  return seeks;
+}
+
+void SaveBytes(ozz::io::OArchive& _archive, ozz::Range<const uint8_t> _bytes) {
+  const ptrdiff_t count = _bytes.Count();
+  _archive << static_cast<int32_t>(count);
+  if (count) {
+    _archive << ozz::io::MakeArray(_bytes.begin, count);
+  }
+}
+
+ozz::Range<uint8_t> LoadBytes(ozz::io::IArchive& _archive) {
+  int32_t count;
+  _archive >> count;
+  ozz::Range<uint8_t> bytes =
+    memory::default_allocator()->AllocateRange<uint8_t>(count);
+  if (count) {
+    _archive >> ozz::io::MakeArray(bytes.begin, count);
+  }
+  return bytes;
+}
+
+void SaveRanges(ozz::io::OArchive& _archive,
+                ozz::Range<const math::SoaFloat3> _ranges) {
+  const ptrdiff_t count = _ranges.Count();
+  _archive << static_cast<int32_t>(count);
+  if (count) {
+    _archive << ozz::io::MakeArray(_ranges.begin, count);
+  }
+}
+
+ozz::Range<math::SoaFloat3> LoadRanges(ozz::io::IArchive& _archive) {
+  int32_t count;
+  _archive >> count;
+  ozz::Range<math::SoaFloat3> ranges =
+    memory::default_allocator()->AllocateRange<math::SoaFloat3>(count);
+  if (count) {
+    _archive >> ozz::io::MakeArray(ranges.begin, count);
+  }
+  return ranges;
+}
+
+template<typename _Value>
+void SaveConstants(ozz::io::OArchive& _archive,
+                   ozz::Range<const uint8_t> _flags,
+                   ozz::Range<const _Value> _values) {
+  assert(_flags.Count() == _values.Count());
+  const ptrdiff_t count = _flags.Count();
+  _archive << static_cast<int32_t>(count);
+  if (count) {
+    _archive << ozz::io::MakeArray(_flags.begin, count);
+    _archive << ozz::io::MakeArray(_values.begin, count);
+  }
+}
+
+// Loads constant tracks flags and values, and returns the number of animated
+// tracks of the channel.
+template<typename _Value>
+int LoadConstants(ozz::io::IArchive& _archive,
+                  int _num_soa_tracks,
+                  ozz::Range<uint8_t>* _flags,
+                  ozz::Range<_Value>* _values) {
+  int32_t count;
+  _archive >> count;
+  memory::Allocator* allocator = memory::default_allocator();
+  *_flags = allocator->AllocateRange<uint8_t>(count);
+  *_values = allocator->AllocateRange<_Value>(count);
+  int num_animated = _num_soa_tracks * 4;
+  if (count) {
+    _archive >> ozz::io::MakeArray(_flags->begin, count);
+    _archive >> ozz::io::MakeArray(_values->begin, count);
+    for (int i = 0; i < count; ++i) {
+      for (int flags = _flags->begin[i]; flags; flags >>= 1) {
+        num_animated -= flags & 1;
+      }
+    }
+  }
+  return num_animated;
+}
+
+// Tests that _seeks is a valid seek index of _num_seeks entries, for _keys of
+// an animation of _num_soa_tracks. Entries are used as keys indices by the
+// sampling job, so they must all be within keys range.
+template<typename _Key>
+bool ValidateSeeks(ozz::Range<const int> _seeks,
+                   ozz::Range<const _Key> _keys,
+                   int _num_soa_tracks,
+                   int _num_animated,
+                   int _num_seeks) {
+  const int stride = 1 + _num_soa_tracks * 4 * 2;
+  if (_seeks.Count() != static_cast<size_t>(stride * _num_seeks)) {
+    return false;
+  }
+  const int num_keys = static_cast<int>(_keys.Count());
+  for (int i = 0; i < _num_seeks; ++i) {
+    const int* entry = _seeks.begin + i * stride;
+    // Keys cursor is never before the first 2 keys of every animated track.
+    if (entry[0] < _num_animated * 2 || entry[0] > num_keys) {
+      return false;
+    }
+    // Constant tracks of a channel without any key refer to key 0.
+    for (int k = 1; k < stride; ++k) {
+      if (entry[k] < 0 || (entry[k] >= num_keys && entry[k] != 0)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+// Tests that all _animation seek index buffers match its keys and tracks. They
+// must be empty if the animation has no seek index.
+bool ValidateSeekIndex(const Animation& _animation) {
+  const int num_soa_tracks = _animation.num_soa_tracks();
+  int num_seeks = 0;
+  if (_animation.seek_interval() > 0.f) {
+    const int stride = 1 + num_soa_tracks * 4 * 2;
+    num_seeks =
+      static_cast<int>(_animation.translation_seeks().Count()) / stride;
+  }
+  return ValidateSeeks(_animation.translation_seeks(),
+                       _animation.translations(), num_soa_tracks,
+                       _animation.num_animated_translations(), num_seeks) &&
+         ValidateSeeks(_animation.rotation_seeks(),
+                       _animation.rotations(), num_soa_tracks,
+                       _animation.num_animated_rotations(), num_seeks) &&
+         ValidateSeeks(_animation.scale_seeks(),
+                       _animation.scales(), num_soa_tracks,
+                       _animation.num_animated_scales(), num_seeks);
+}
+
+// Tests that _highs buffer has an element per key of _keys if key times are
+// _wide, or is empty otherwise.
+template<typename _Key>
+bool ValidateTimeHighs(ozz::Range<const uint8_t> _highs,
+                       ozz::Range<const _Key> _keys,
+                       bool _wide) {
+  return _highs.Count() == (_wide ? _keys.Count() : 0);
+}
+
+// Tests that _values buffer has room for the 3 components of _bits bits of every
+// key of _keys, plus padding, or is empty if there's no key.
+template<typename _Key>
+bool ValidateValues(ozz::Range<const uint8_t> _values,
+                    ozz::Range<const _Key> _keys,
+                    int _bits) {
+  const size_t num_keys = _keys.Count();
+  if (!num_keys) {
+    return _values.Count() == 0;
+  }
+  return _bits >= 1 && _bits <= 16 &&
+         _values.Count() == internal::PackedSize(num_keys * 3, _bits);
+}
+
+// Tests that all _animation time highs and packed values buffers match its
+// keys, as the sampling job reads them along with keys.
+bool ValidateKeys(const Animation& _animation) {
+  const bool wide = _animation.wide_key_times();
+  return ValidateTimeHighs(_animation.translation_time_highs(),
+                           _animation.translations(), wide) &&
+         ValidateTimeHighs(_animation.rotation_time_highs(),
+                           _animation.rotations(), wide) &&
+         ValidateTimeHighs(_animation.scale_time_highs(),
+                           _animation.scales(), wide) &&
+         ValidateValues(_animation.translation_values(),
+                        _animation.translations(),
+                        _animation.translation_bits()) &&
+         ValidateValues(_animation.scale_values(), _animation.scales(),
+                        _animation.scale_bits());
+}
+}  // namespace
+
+namespace {
+// Returns a new animation generation id. Animations can be loaded from
+// multiple threads, so the counter is incremented atomically. 0 is never
+// returned, so it can stand for no animation.
+uint32_t NextGeneration() {
+  static volatile long counter = 0;
+  uint32_t generation;
+  do {
+    generation = static_cast<uint32_t>(atomic::Increment(&counter));
+  } while (generation == 0);
+  return generation;
+}
+}  // namespace
+
 Animation::Animation()
-    : duration_(0.f),
-      num_tracks_(0) {
+    : generation_(NextGeneration()),
+      num_animated_translations_(0),
+      num_animated_rotations_(0),
+      num_animated_scales_(0),
+      translation_bits_(0),
+      scale_bits_(0),
+      seek_interval_(0.f),
+      duration_(0.f),
+      wide_key_times_(false),
+      num_tracks_(0),
+      image_view_(false) {
 }
 
 Animation::~Animation() {
@@ -51,21 +320,79 @@ Animation::~Animation() {
 }
 
 void Animation::Destroy() {
-  memory::Allocator* allocator = memory::default_allocator();
-  allocator->Deallocate(translations_);
+  // Buffers of an image view belong to the image, so they're only forgotten.
+  if (!image_view_) {
+    memory::Allocator* allocator = memory::default_allocator();
+    allocator->Deallocate(translations_);
+    allocator->Deallocate(rotations_);
+    allocator->Deallocate(scales_);
+    allocator->Deallocate(translation_time_highs_);
+    allocator->Deallocate(rotation_time_highs_);
+    allocator->Deallocate(scale_time_highs_);
+    allocator->Deallocate(translation_ranges_);
+    allocator->Deallocate(scale_ranges_);
+    allocator->Deallocate(translation_values_);
+    allocator->Deallocate(scale_values_);
+    allocator->Deallocate(translation_seeks_);
+    allocator->Deallocate(rotation_seeks_);
+    allocator->Deallocate(scale_seeks_);
+    allocator->Deallocate(translation_constant_flags_);
+    allocator->Deallocate(rotation_constant_flags_);
+    allocator->Deallocate(scale_constant_flags_);
+    allocator->Deallocate(translation_constants_);
+    allocator->Deallocate(rotation_constants_);
+    allocator->Deallocate(scale_constants_);
+  }
+  image_view_ = false;
   translations_.begin = NULL; translations_.end = NULL;
-  allocator->Deallocate(rotations_);
   rotations_.begin = NULL; rotations_.end = NULL;
-  allocator->Deallocate(scales_);
   scales_.begin = NULL; scales_.end = NULL;
+  translation_time_highs_.begin = NULL; translation_time_highs_.end = NULL;
+  rotation_time_highs_.begin = NULL; rotation_time_highs_.end = NULL;
+  scale_time_highs_.begin = NULL; scale_time_highs_.end = NULL;
+  translation_ranges_.begin = NULL; translation_ranges_.end = NULL;
+  scale_ranges_.begin = NULL; scale_ranges_.end = NULL;
+  translation_values_.begin = NULL; translation_values_.end = NULL;
+  scale_values_.begin = NULL; scale_values_.end = NULL;
+  translation_seeks_.begin = NULL; translation_seeks_.end = NULL;
+  rotation_seeks_.begin = NULL; rotation_seeks_.end = NULL;
+  scale_seeks_.begin = NULL; scale_seeks_.end = NULL;
+  translation_constant_flags_.begin = NULL;
+  translation_constant_flags_.end = NULL;
+  rotation_constant_flags_.begin = NULL; rotation_constant_flags_.end = NULL;
+  scale_constant_flags_.begin = NULL; scale_constant_flags_.end = NULL;
+  translation_constants_.begin = NULL; translation_constants_.end = NULL;
+  rotation_constants_.begin = NULL; rotation_constants_.end = NULL;
+  scale_constants_.begin = NULL; scale_constants_.end = NULL;
+
+  num_animated_translations_ = 0;
+  num_animated_rotations_ = 0;
+  num_animated_scales_ = 0;
+
+  translation_bits_ = 0;
+  scale_bits_ = 0;
+
+  seek_interval_ = 0.f;
 
   duration_ = 0.f;
+  wide_key_times_ = false;
   num_tracks_ = 0;
+
+  // Content is about to change, caches must not consider it as the same
+  // animation anymore.
+  generation_ = NextGeneration();
 }
 
 size_t Animation::size() const {
   const size_t size =
-    sizeof(*this) + translations_.Size() + rotations_.Size() + scales_.Size();
+    sizeof(*this) + translations_.Size() + rotations_.Size() + scales_.Size() +
+    translation_time_highs_.Size() + rotation_time_highs_.Size() +
+    scale_time_highs_.Size() + translation_ranges_.Size() +
+    scale_ranges_.Size() + translation_values_.Size() + scale_values_.Size() +
+    translation_seeks_.Size() + rotation_seeks_.Size() + scale_seeks_.Size() +
+    translation_constant_flags_.Size() + rotation_constant_flags_.Size() +
+    scale_constant_flags_.Size() + translation_constants_.Size() +
+    rotation_constants_.Size() + scale_constants_.Size();
   return size;
 }
 
@@ -73,35 +400,39 @@ void Animation::Save(ozz::io::OArchive& _archive) const {
   _archive << duration_;
   _archive << static_cast<int32_t>(num_tracks_);
 
+  // Key frames are POD structures, saved as contiguous blocks of memory.
   const ptrdiff_t translation_count = translations_.Count();
   _archive << static_cast<int32_t>(translation_count);
-  for (ptrdiff_t i = 0; i < translation_count; ++i) {
-    const TranslationKey& key = translations_.begin[i];
-    _archive << key.time;
-    _archive << key.track;
-    _archive << ozz::io::MakeArray(key.value);
-  }
-
+  _archive << ozz::io::MakePodArray(translations_.begin, translation_count);
   const ptrdiff_t rotation_count = rotations_.Count();
   _archive << static_cast<int32_t>(rotation_count);
-  for (ptrdiff_t i = 0; i < rotation_count; ++i) {
-    const RotationKey& key = rotations_.begin[i];
-    _archive << key.time;
-    uint16_t track = key.track;
-    _archive << track;
-    bool wsign = key.wsign;
-    _archive << wsign;
-    _archive << ozz::io::MakeArray(key.value);
-  }
-
+  _archive << ozz::io::MakePodArray(rotations_.begin, rotation_count);
   const ptrdiff_t scale_count = scales_.Count();
   _archive << static_cast<int32_t>(scale_count);
-  for (ptrdiff_t i = 0; i < scale_count; ++i) {
-    const ScaleKey& key = scales_.begin[i];
-    _archive << key.time;
-    _archive << key.track;
-    _archive << ozz::io::MakeArray(key.value);
-  }
+  _archive << ozz::io::MakePodArray(scales_.begin, scale_count);
+
+  _archive << wide_key_times_;
+  SaveBytes(_archive, translation_time_highs());
+  SaveBytes(_archive, rotation_time_highs());
+  SaveBytes(_archive, scale_time_highs());
+
+  _archive << static_cast<int32_t>(translation_bits_);
+  SaveBytes(_archive, translation_values());
+  _archive << static_cast<int32_t>(scale_bits_);
+  SaveBytes(_archive, scale_values());
+
+  SaveRanges(_archive, translation_ranges());
+  SaveRanges(_archive, scale_ranges());
+
+  SaveConstants(_archive, translation_constant_flags(),
+                translation_constants());
+  SaveConstants(_archive, rotation_constant_flags(), rotation_constants());
+  SaveConstants(_archive, scale_constant_flags(), scale_constants());
+
+  _archive << seek_interval_;
+  SaveSeeks(_archive, translation_seeks_);
+  SaveSeeks(_archive, rotation_seeks_);
+  SaveSeeks(_archive, scale_seeks_);
 }
 
 void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
@@ -110,7 +441,7 @@ void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   Destroy();
 
   // No retro-compatibility with anterior versions.
-  if (_version != 2) {
+  if (_version != 10) {
     return;
   }
 
@@ -122,38 +453,159 @@ void Animation::Load(ozz::io::IArchive& _archive, uint32_t _version) {
   _archive >> num_tracks;
   num_tracks_ = num_tracks;
 
+  // Key frames are loaded with a single read per buffer, and swapped in-place
+  // if needed.
   int32_t translation_count;
   _archive >> translation_count;
   translations_ = allocator->AllocateRange<TranslationKey>(translation_count);
-  for (int i = 0; i < translation_count; ++i) {
-    TranslationKey& key = translations_.begin[i];
-    _archive >> key.time;
-    _archive >> key.track;
-    _archive >> ozz::io::MakeArray(key.value);
-  }
+  _archive >> ozz::io::MakePodArray(translations_.begin, translation_count);
   int32_t rotation_count;
   _archive >> rotation_count;
   rotations_ = allocator->AllocateRange<RotationKey>(rotation_count);
-  for (int i = 0; i < rotation_count; ++i) {
-    RotationKey& key = rotations_.begin[i];
-    _archive >> key.time;
-    uint16_t track;
-    _archive >> track;
-    key.track = track;
-    bool wsign;
-    _archive >> wsign;
-    key.wsign = wsign;
-    _archive >> ozz::io::MakeArray(key.value);
-  }
+  _archive >> ozz::io::MakePodArray(rotations_.begin, rotation_count);
   int32_t scale_count;
   _archive >> scale_count;
   scales_ = allocator->AllocateRange<ScaleKey>(scale_count);
-  for (int i = 0; i < scale_count; ++i) {
-    ScaleKey& key = scales_.begin[i];
-    _archive >> key.time;
-    _archive >> key.track;
-    _archive >> ozz::io::MakeArray(key.value);
+  _archive >> ozz::io::MakePodArray(scales_.begin, scale_count);
+
+  _archive >> wide_key_times_;
+  translation_time_highs_ = LoadBytes(_archive);
+  rotation_time_highs_ = LoadBytes(_archive);
+  scale_time_highs_ = LoadBytes(_archive);
+
+  int32_t translation_bits;
+  _archive >> translation_bits;
+  translation_bits_ = translation_bits;
+  translation_values_ = LoadBytes(_archive);
+  int32_t scale_bits;
+  _archive >> scale_bits;
+  scale_bits_ = scale_bits;
+  scale_values_ = LoadBytes(_archive);
+
+  translation_ranges_ = LoadRanges(_archive);
+  scale_ranges_ = LoadRanges(_archive);
+
+  const int num_soa = num_soa_tracks();
+  num_animated_translations_ = LoadConstants(
+    _archive, num_soa, &translation_constant_flags_,
+    &translation_constants_);
+  num_animated_rotations_ = LoadConstants(
+    _archive, num_soa, &rotation_constant_flags_, &rotation_constants_);
+  num_animated_scales_ = LoadConstants(
+    _archive, num_soa, &scale_constant_flags_, &scale_constants_);
+
+  _archive >> seek_interval_;
+  translation_seeks_ = LoadSeeks(_archive);
+  rotation_seeks_ = LoadSeeks(_archive);
+  scale_seeks_ = LoadSeeks(_archive);
+
+  // Seek index entries are used as keys indices by the sampling job, and time
+  // highs and values are read along with keys. The animation is left empty if
+  // they don't match its keys and tracks.
+  if (!ValidateSeekIndex(*this) || !ValidateKeys(*this)) {
+    Destroy();
+  }
+}
+
+size_t Animation::SaveImage(void* _image, size_t _size,
+                            Endianness _endianness) const {
+  io::ImageWriter writer(_image, _size, _endianness);
+  writer.WriteHeader<Animation>();
+  writer.Write(duration_);
+  writer.Write(static_cast<int32_t>(num_tracks_));
+  writer.Write(static_cast<int32_t>(num_animated_translations_));
+  writer.Write(static_cast<int32_t>(num_animated_rotations_));
+  writer.Write(static_cast<int32_t>(num_animated_scales_));
+  writer.Write(seek_interval_);
+  writer.Write(static_cast<int32_t>(wide_key_times_));
+  writer.Write(translations_);
+  writer.Write(rotations_);
+  writer.Write(scales_);
+  writer.Write(translation_time_highs_);
+  writer.Write(rotation_time_highs_);
+  writer.Write(scale_time_highs_);
+  writer.Write(translation_ranges_);
+  writer.Write(scale_ranges_);
+  writer.Write(static_cast<int32_t>(translation_bits_));
+  writer.Write(translation_values_);
+  writer.Write(static_cast<int32_t>(scale_bits_));
+  writer.Write(scale_values_);
+  writer.Write(translation_seeks_);
+  writer.Write(rotation_seeks_);
+  writer.Write(scale_seeks_);
+  writer.Write(translation_constant_flags_);
+  writer.Write(rotation_constant_flags_);
+  writer.Write(scale_constant_flags_);
+  writer.Write(translation_constants_);
+  writer.Write(rotation_constants_);
+  writer.Write(scale_constants_);
+  return _image ? writer.Finish() : writer.size();
+}
+
+bool Animation::LoadImage(void* _image, size_t _size) {
+
+  // Destroy animation in case it was already used before.
+  Destroy();
+
+  io::ImageReader reader(_image, _size);
+  // No retro-compatibility with anterior versions.
+  const uint32_t version = reader.ReadHeader<Animation>();
+  if (version != io::internal::Version<const Animation>::kValue) {
+    return false;
+  }
+
+  // From now on, buffers belong to the image.
+  image_view_ = true;
+
+  int32_t num_tracks = 0;
+  int32_t num_animated_translations = 0;
+  int32_t num_animated_rotations = 0;
+  int32_t num_animated_scales = 0;
+  int32_t wide_key_times = 0;
+  int32_t translation_bits = 0;
+  int32_t scale_bits = 0;
+  reader.Read(&duration_);
+  reader.Read(&num_tracks);
+  reader.Read(&num_animated_translations);
+  reader.Read(&num_animated_rotations);
+  reader.Read(&num_animated_scales);
+  reader.Read(&seek_interval_);
+  reader.Read(&wide_key_times);
+  reader.Read(&translations_);
+  reader.Read(&rotations_);
+  reader.Read(&scales_);
+  reader.Read(&translation_time_highs_);
+  reader.Read(&rotation_time_highs_);
+  reader.Read(&scale_time_highs_);
+  reader.Read(&translation_ranges_);
+  reader.Read(&scale_ranges_);
+  reader.Read(&translation_bits);
+  reader.Read(&translation_values_);
+  reader.Read(&scale_bits);
+  reader.Read(&scale_values_);
+  reader.Read(&translation_seeks_);
+  reader.Read(&rotation_seeks_);
+  reader.Read(&scale_seeks_);
+  reader.Read(&translation_constant_flags_);
+  reader.Read(&rotation_constant_flags_);
+  reader.Read(&scale_constant_flags_);
+  reader.Read(&translation_constants_);
+  reader.Read(&rotation_constants_);
+  reader.Read(&scale_constants_);
+  num_tracks_ = num_tracks;
+  num_animated_translations_ = num_animated_translations;
+  num_animated_rotations_ = num_animated_rotations;
+  num_animated_scales_ = num_animated_scales;
+  wide_key_times_ = wide_key_times != 0;
+  translation_bits_ = translation_bits;
+  scale_bits_ = scale_bits;
+
+  if (!reader.Finish() || !ValidateSeekIndex(*this) ||
+      !ValidateKeys(*this)) {
+    Destroy();
+    return false;
   }
+  return true;
 }
 }  // animation
 }  // ozz
@@ -0,0 +1,95 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include <cassert>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/allocator.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "../runtime/animation_archive.h"
+
+namespace ozz {
+namespace animation {
+namespace internal {
+
+Animation* LoadAnimation(io::Stream* _stream, int _offset, uint32_t _size) {
+  if (!_stream || !_stream->opened() ||
+      _stream->Seek(_offset, io::Stream::kSet) != 0) {
+    return NULL;
+  }
+  io::IArchive archive(_stream);
+  if (!archive.TestTag<Animation>()) {
+    return NULL;
+  }
+  memory::Allocator* allocator = memory::default_allocator();
+  Animation* animation = allocator->New<Animation>();
+  archive >> *animation;
+
+  // Animation content is invalid if it doesn't match the index, for example if
+  // its version isn't supported.
+  if (_stream->Tell() != _offset + static_cast<int>(_size)) {
+    allocator->Delete(animation);
+    return NULL;
+  }
+  return animation;
+}
+
+uint32_t WriteAnimation(const Animation& _animation,
+                        const io::OArchive& _archive,
+                        io::MemoryStream* _stream) {
+  assert(_stream);
+  const Endianness native = GetNativeEndianness();
+  const Endianness endianness = !_archive.endian_swap() ? native :
+    (native == kLittleEndian ? kBigEndian : kLittleEndian);
+  const int begin = _stream->Tell();
+  io::OArchive archive(_stream, endianness);
+  archive << _animation;
+  return static_cast<uint32_t>(_stream->Tell() - begin);
+}
+
+void CopyAnimations(io::MemoryStream* _stream, io::OArchive& _archive) {
+  assert(_stream);
+  const size_t size = static_cast<size_t>(_stream->Tell());
+  _stream->Seek(0, io::Stream::kSet);
+  char buffer[4096];
+  for (size_t copied = 0; copied < size;) {
+    const size_t read = _stream->Read(buffer, sizeof(buffer));
+    OZZ_IF_DEBUG(size_t written =) _archive.SaveBinary(buffer, read);
+    assert(written == read);
+    copied += read;
+  }
+}
+}  // internal
+}  // animation
+}  // ozz
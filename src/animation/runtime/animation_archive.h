@@ -0,0 +1,73 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_ANIMATION_RUNTIME_ANIMATION_ARCHIVE_H_
+#define OZZ_ANIMATION_RUNTIME_ANIMATION_ARCHIVE_H_
+
+#ifndef OZZ_INCLUDE_PRIVATE_HEADER
+#error "This header is private, it cannot be included from public headers."
+#endif  // OZZ_INCLUDE_PRIVATE_HEADER
+
+// Declares helpers to store animations as standalone archives following an
+// index, which are loaded on demand. They are shared by the AnimationBank and
+// the SegmentedAnimation.
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace io {
+class OArchive;
+class Stream;
+class MemoryStream;
+}  // io
+namespace animation {
+
+class Animation;
+
+namespace internal {
+
+// Loads the animation stored as a standalone archive of _size bytes at _offset
+// of _stream. Returns NULL if it cannot be read, or if its content doesn't
+// match _size, for example if its version isn't supported.
+// The returned animation is allocated with the default allocator.
+Animation* LoadAnimation(io::Stream* _stream, int _offset, uint32_t _size);
+
+// Appends _animation as a standalone archive to _stream, using the same
+// endianness as _archive. Returns the number of bytes written.
+uint32_t WriteAnimation(const Animation& _animation,
+                        const io::OArchive& _archive,
+                        io::MemoryStream* _stream);
+
+// Copies the whole content of _stream to _archive, as binary data.
+void CopyAnimations(io::MemoryStream* _stream, io::OArchive& _archive);
+}  // internal
+}  // animation
+}  // ozz
+#endif  // OZZ_ANIMATION_RUNTIME_ANIMATION_ARCHIVE_H_
@@ -0,0 +1,277 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/animation_bank.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/allocator.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "../runtime/animation_archive.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+// Sorts clips by hash, and then by name so the order is deterministic even if
+// hashes collide.
+template<typename _Clip>
+bool ClipLess(const _Clip& _left, const _Clip& _right) {
+  return _left.hash < _right.hash ||
+         (_left.hash == _right.hash &&
+          std::strcmp(_left.name, _right.name) < 0);
+}
+}  // namespace
+
+uint32_t AnimationBank::Hash(const char* _name) {
+  // 32 bits FNV-1a hash.
+  uint32_t hash = 2166136261u;
+  for (const char* c = _name; *c; ++c) {
+    hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619u;
+  }
+  return hash;
+}
+
+AnimationBank::AnimationBank()
+    : clips_(NULL),
+      num_animations_(0),
+      names_(NULL),
+      names_size_(0),
+      stream_(NULL),
+      base_(0) {
+}
+
+AnimationBank::~AnimationBank() {
+  Destroy();
+}
+
+void AnimationBank::Destroy() {
+  UnloadAll();
+  memory::Allocator* allocator = memory::default_allocator();
+  allocator->Deallocate(clips_);
+  clips_ = NULL;
+  num_animations_ = 0;
+  allocator->Deallocate(names_);
+  names_ = NULL;
+  names_size_ = 0;
+  stream_ = NULL;
+  base_ = 0;
+}
+
+int AnimationBank::Find(const char* _name) const {
+  Clip key;
+  key.hash = Hash(_name);
+  key.name = _name;
+  const Clip* begin = clips_;
+  const Clip* end = clips_ + num_animations_;
+  const Clip* clip = std::lower_bound(begin, end, key, &ClipLess<Clip>);
+  if (clip == end || clip->hash != key.hash ||
+      std::strcmp(clip->name, _name) != 0) {
+    return -1;
+  }
+  return static_cast<int>(clip - clips_);
+}
+
+const char* AnimationBank::name(int _id) const {
+  assert(_id >= 0 && _id < num_animations_);
+  return clips_[_id].name;
+}
+
+const Animation* AnimationBank::animation(int _id) const {
+  assert(_id >= 0 && _id < num_animations_);
+  return clips_[_id].animation;
+}
+
+const Animation* AnimationBank::Load(int _id) {
+  assert(_id >= 0 && _id < num_animations_);
+  Clip& clip = clips_[_id];
+  if (clip.animation) {
+    return clip.animation;
+  }
+
+  // Animation is stored as a standalone archive.
+  Animation* animation = internal::LoadAnimation(
+    stream_, base_ + static_cast<int>(clip.offset), clip.size);
+  if (!animation) {
+    return NULL;
+  }
+  clip.animation = animation;
+  return animation;
+}
+
+void AnimationBank::Unload(int _id) {
+  assert(_id >= 0 && _id < num_animations_);
+  memory::default_allocator()->Delete(clips_[_id].animation);
+  clips_[_id].animation = NULL;
+}
+
+void AnimationBank::UnloadAll() {
+  for (int i = 0; i < num_animations_; ++i) {
+    Unload(i);
+  }
+}
+
+bool AnimationBank::Write(io::OArchive& _archive,
+                          Range<const Entry> _entries) {
+  const size_t count = _entries.Count();
+  for (size_t i = 0; i < count; ++i) {
+    if (!_entries.begin[i].name || !_entries.begin[i].animation) {
+      return false;
+    }
+  }
+
+  // Builds a temporary bank, whose clips reference entries names. Clips offset
+  // temporarily stores their entry index, as clips are sorted.
+  memory::Allocator* allocator = memory::default_allocator();
+  AnimationBank bank;
+  bank.clips_ = allocator->Allocate<Clip>(count);
+  bank.num_animations_ = static_cast<int>(count);
+  for (size_t i = 0; i < count; ++i) {
+    Clip& clip = bank.clips_[i];
+    clip.hash = Hash(_entries.begin[i].name);
+    clip.offset = static_cast<uint32_t>(i);
+    clip.size = 0;
+    clip.name = _entries.begin[i].name;
+    clip.animation = NULL;
+  }
+
+  // Sorts clips, and rejects duplicated names.
+  Clip* end = bank.clips_ + count;
+  std::sort(bank.clips_, end, &ClipLess<Clip>);
+  for (size_t i = 1; i < count; ++i) {
+    if (bank.clips_[i].hash == bank.clips_[i - 1].hash &&
+        std::strcmp(bank.clips_[i].name, bank.clips_[i - 1].name) == 0) {
+      return false;
+    }
+  }
+
+  // Animations are serialized first, as their sizes are required by the
+  // index.
+  io::MemoryStream animations;
+  for (size_t i = 0; i < count; ++i) {
+    Clip& clip = bank.clips_[i];
+    const int offset = animations.Tell();
+    clip.size = internal::WriteAnimation(
+      *_entries.begin[clip.offset].animation, _archive, &animations);
+    clip.offset = static_cast<uint32_t>(offset);
+  }
+
+  // Writes the index, with the same tag and version an archive << operator
+  // would write, so it's loaded with the archive >> operator.
+  io::internal::Tagger<const AnimationBank>::Write(_archive);
+  _archive << static_cast<uint32_t>(
+    io::internal::Version<const AnimationBank>::kValue);
+  _archive << static_cast<int32_t>(count);
+  size_t names_size = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const Clip& clip = bank.clips_[i];
+    _archive << clip.hash;
+    _archive << clip.offset;
+    _archive << clip.size;
+    names_size += std::strlen(clip.name) + 1;
+  }
+  _archive << static_cast<int32_t>(names_size);
+  for (size_t i = 0; i < count; ++i) {
+    const char* name = bank.clips_[i].name;
+    _archive << io::MakeArray(name, std::strlen(name) + 1);
+  }
+
+  // Animations follow the index.
+  internal::CopyAnimations(&animations, _archive);
+  return true;
+}
+
+void AnimationBank::Load(io::IArchive& _archive, uint32_t _version) {
+  // Destroy bank in case it was already used before.
+  Destroy();
+
+  // No retro-compatibility with anterior versions.
+  if (_version != 1) {
+    return;
+  }
+
+  int32_t num_animations;
+  _archive >> num_animations;
+  if (num_animations < 0) {
+    return;
+  }
+  num_animations_ = num_animations;
+  memory::Allocator* allocator = memory::default_allocator();
+  clips_ = allocator->Allocate<Clip>(num_animations_);
+  for (int i = 0; i < num_animations_; ++i) {
+    Clip& clip = clips_[i];
+    _archive >> clip.hash;
+    _archive >> clip.offset;
+    _archive >> clip.size;
+    clip.name = NULL;
+    clip.animation = NULL;
+  }
+
+  // Names are all concatenated in the same buffer.
+  int32_t names_size;
+  _archive >> names_size;
+  if (names_size < 0) {
+    Destroy();
+    return;
+  }
+  names_size_ = names_size;
+  names_ = allocator->Allocate<char>(names_size_);
+  _archive >> io::MakeArray(names_, names_size_);
+
+  // The buffer must contain exactly a terminated name per animation, so names
+  // of a corrupted bank can't be read past the end of the buffer.
+  int num_names = 0;
+  for (size_t i = 0; i < names_size_; ++i) {
+    num_names += names_[i] == '\0';
+  }
+  if (num_names != num_animations_ ||
+      (names_size_ != 0 && names_[names_size_ - 1] != '\0')) {
+    Destroy();
+    return;
+  }
+  const char* name = names_;
+  for (int i = 0; i < num_animations_; ++i) {
+    clips_[i].name = name;
+    name += std::strlen(name) + 1;
+  }
+
+  // Animations follow the index.
+  stream_ = _archive.stream();
+  base_ = stream_->Tell();
+}
+}  // animation
+}  // ozz
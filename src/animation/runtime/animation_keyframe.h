@@ -44,45 +44,78 @@ namespace animation {
 // coherency.
 // Key frame values are compressed, according on their type. Decompression is
 // efficient because it's done on SoA data and cached during sampling.
+// Key frame times are quantized to 16 bits unsigned integers, as a fraction of
+// the animation duration: 0 is the beginning of the animation, kMaxKeyTime is
+// its end. Sampling is done in these key time units, so key times never need
+// to be converted back to seconds.
+// Animations whose keys are too close to be distinct on 16 bits use wide key
+// times instead, quantized to 24 bits (kMaxWideKeyTime is the end of the
+// animation). The 8 high bits of a key time are stored in a separate buffer
+// with a byte per key (see Animation::translation_time_highs()), so keys
+// layout is the same in both cases.
+
+// Key time of the last key frame of a track, matching animation duration.
+const int kMaxKeyTime = 0xffff;
+
+// Key time of the last key frame of a track, matching animation duration, when
+// key times are wide.
+const int kMaxWideKeyTime = 0xffffff;
+
+// Converts _time, in seconds, to key time units of an animation of duration
+// _duration, whose key times are _wide or not. The same function is used to
+// build and sample the animation, so both agree on key times comparisons.
+inline float ToKeyTime(float _time, float _duration, bool _wide) {
+  const int max_key_time = _wide ? kMaxWideKeyTime : kMaxKeyTime;
+  return _time * (static_cast<float>(max_key_time) / _duration);
+}
+
+// Returns the time of key _index of _keys, in key time units. _highs is the
+// buffer of key times high bits, or NULL if key times aren't wide.
+template<typename _Key>
+inline int KeyTime(const _Key* _keys, const uint8_t* _highs, int _index) {
+  const int time = _keys[_index].time;
+  return _highs ? time | (_highs[_index] << 16) : time;
+}
 
 // Defines the translation key frame type.
-// Translation values are stored as half precision floats with 16 bits per
-// component.
+// Translation values are stored as unsigned fixed point integers, normalized in
+// the range of values of their track (see Animation::translation_ranges()).
+// They are bit-packed in a separate buffer, with Animation::translation_bits()
+// bits per component: the 3 components of key n start at bit
+// n * 3 * translation_bits() of Animation::translation_values().
 struct TranslationKey {
-  float time;
+  uint16_t time;
   uint16_t track;
-  uint16_t value[3];
 };
 
 // Defines the rotation key frame type.
-// Rotation value is a quaternion. Quaternion are normalized, which means each
-// component is in range [0:1]. This property allows to quantize the first 3
-// components to 3 signed integer 16 bits values. The 4th component is restored
-// at runtime, using the knowledge that |w| = √(1 - (x^2 + y^2 + z^2)). The sign
-// of this 4th component is stored using 1 bit taken from the track member.
-//
-// It's often recommended to store the 3 smallest components (and restore the
-// largest) as they can be pre-multiplied by √2 to gain some precision. As
-// decompression is done in SoA format, restoring a non-fixed component requires
-// too much code to reshuffle the SoaQuaternion. Furthermore 16 bits quantization
-// is already very precise, not worth a 1.4 factor.
-// Quantization could be reduced to 11-11-10 bits as often used for animation
-// key frames, but in this case RotationKey structure would contain 16 bits of
-// padding.
+// Rotation value is a normalized quaternion, compressed using its smallest
+// three components. The largest component is dropped, and restored at runtime
+// using the knowledge that its absolute value is √(1 - (a^2 + b^2 + c^2)). Its
+// index is stored in 2 bits taken from the track member. Q and -Q being the
+// same rotation, the quaternion is negated if needed so the largest component
+// is positive, which saves storing its sign.
+// The 3 remaining components are in range [-1/√2:1/√2]. They are stored in
+// increasing index order, scaled by √2 and quantized to signed 16 bits
+// integers. Compared to storing x, y and z, precision is improved by a factor
+// √2, and restoring the largest component (which is at least 1/2) is well
+// conditioned even when w is close to 0.
 struct RotationKey {
-  float time;
-  uint16_t track:15;
-  bool wsign:1;
+  uint16_t time;
+  uint16_t track:14;
+  uint16_t largest:2;
   int16_t value[3];
 };
 
+// Scale applied to the 3 smallest components of a rotation before being
+// quantized to signed 16 bits integers: √2 * 32767.
+const float kRotationQuantizationScale = 32767.f * 1.41421356f;
+
 // Defines the scale key frame type.
-// Scale values are stored as half precision floats with 16 bits per
-// component.
+// Scale values are stored like translation ones, see TranslationKey.
 struct ScaleKey {
-  float time;
+  uint16_t time;
   uint16_t track;
-  uint16_t value[3];
 };
 }  // animation
 }  // ozz
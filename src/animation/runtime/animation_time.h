@@ -0,0 +1,64 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_ANIMATION_RUNTIME_ANIMATION_TIME_H_
+#define OZZ_ANIMATION_RUNTIME_ANIMATION_TIME_H_
+
+#ifndef OZZ_INCLUDE_PRIVATE_HEADER
+#error "This header is private, it cannot be included from public headers."
+#endif  // OZZ_INCLUDE_PRIVATE_HEADER
+
+// Declares the conversion from a job time to an animation time, shared by all
+// sampling jobs and segmented animations, so they agree on the sampled time.
+
+#include <cmath>
+
+#include "ozz/base/maths/math_ex.h"
+
+namespace ozz {
+namespace animation {
+namespace internal {
+
+// Computes the time used to sample an animation of duration _duration, from
+// the job's _time. _time is wrapped in range [0,_duration] if _loop is true,
+// otherwise it's clamped.
+inline float AnimationTime(float _time, float _duration, bool _loop) {
+  float time = _time;
+  if (_loop) {
+    const float loops = _time / _duration;
+    time = _time - std::floor(loops) * _duration;
+  }
+  // Clamping also resolves approximations issues on range bounds.
+  return math::Clamp(0.f, time, _duration);
+}
+}  // internal
+}  // animation
+}  // ozz
+#endif  // OZZ_ANIMATION_RUNTIME_ANIMATION_TIME_H_
@@ -38,6 +38,11 @@
 #include "ozz/base/maths/math_ex.h"
 #include "ozz/base/maths/soa_transform.h"
 
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "../runtime/job_kernels.h"
+#include "../runtime/blending_stages.h"
+
 namespace ozz {
 namespace animation {
 
@@ -46,8 +51,39 @@ BlendingJob::Layer::Layer()
 }
 
 BlendingJob::BlendingJob()
-    : threshold(.1f) {
+    : threshold(.1f),
+      from(0),
+      to(Skeleton::kMaxSoAJoints),
+      scratch(NULL),
+      scratch_size(0) {
+}
+
+namespace {
+// Validates _layers content, whose transforms and joint weights must be at
+// least _min_range long.
+bool ValidateLayers(Range<const BlendingJob::Layer> _layers,
+                    ptrdiff_t _min_range) {
+  bool valid = true;
+  for (const BlendingJob::Layer* layer = _layers.begin;
+       _layers.begin && layer < _layers.end;  // Handles NULL pointers.
+       ++layer) {
+    // Tests transforms validity.
+    valid &= layer->transform.begin != NULL;
+    valid &= layer->transform.end >= layer->transform.begin;
+    valid &= layer->transform.end - layer->transform.begin >= _min_range;
+
+    // Joint weights are optional.
+    if (layer->joint_weights.begin != NULL) {
+      valid &= layer->joint_weights.end >= layer->joint_weights.begin;
+      valid &=
+        layer->joint_weights.end - layer->joint_weights.begin >= _min_range;
+    } else {
+      valid &= layer->joint_weights.end == NULL;
+    }
+  }
+  return valid;
 }
+}  // namespace
 
 bool BlendingJob::Validate() const {
   // Don't need any early out, as jobs are valid in most of the performance
@@ -73,187 +109,144 @@ bool BlendingJob::Validate() const {
   const ptrdiff_t min_range = bind_pose.end - bind_pose.begin;
   valid &= output.end - output.begin >= min_range;
 
-  // Validates layers.
-  for (const Layer* layer = layers.begin;
-       layers.begin && layer < layers.end;  // Handles NULL pointers.
-       ++layer) {
-    // Tests transforms validity.
-    valid &= layer->transform.begin != NULL;
-    valid &= layer->transform.end >= layer->transform.begin;
-    valid &= layer->transform.end - layer->transform.begin >= min_range;
+  // Blended joints are tracked in a fixed size set.
+  valid &= min_range <= Skeleton::kMaxSoAJoints;
 
-    // Joint weights are optional.
-    if (layer->joint_weights.begin != NULL) {
-      valid &= layer->joint_weights.end >= layer->joint_weights.begin;
-      valid &= layer->joint_weights.end - layer->joint_weights.begin >= min_range;
-    } else {
-      valid &= layer->joint_weights.end == NULL;
-    }
-  }
+  // Test soa joints range.
+  valid &= from >= 0;
+  valid &= to >= from;
 
-  return valid;
-}
+  // Scratch buffer is optional, up to kMaxStackSoAJoints.
+  if (scratch != NULL) {
+    valid &= scratch_size >= min_range;
+  } else {
+    valid &= math::Min<ptrdiff_t>(to, min_range) - from <= kMaxStackSoAJoints;
+  }
 
-namespace {
+  // Validates layers.
+  valid &= ValidateLayers(layers, min_range);
 
-// Macro that defines the process of blending the 1st pass.
-#define OZZ_BLEND_1ST_PASS(_in, _simd_weight, _out) { \
-  _out->translation = _in.translation * _simd_weight; \
-  _out->rotation = _in.rotation * _simd_weight; \
-  _out->scale = _in.scale * _simd_weight; \
-}
+  // Validates additive layers, which are optional.
+  valid &= additive_layers.end >= additive_layers.begin;
+  valid &= additive_layers.begin != NULL || additive_layers.end == NULL;
+  valid &= ValidateLayers(additive_layers, min_range);
 
-// Macro that defines the process of blending any pass but the first.
-#define OZZ_BLEND_N_PASS(_in, _simd_weight, _out) { \
-  /* Blends translation. */ \
-  _out->translation = _out->translation + _in.translation * _simd_weight; \
-  /* Blends rotations, negates opposed quaternions to be sure to choose*/ \
-  /* the shortest path between the two.*/ \
-  const math::SimdFloat4 dot = _out->rotation.x * _in.rotation.x + \
-                               _out->rotation.y * _in.rotation.y + \
-                               _out->rotation.z * _in.rotation.z + \
-                               _out->rotation.w * _in.rotation.w; \
-  const math::SimdInt4 sign = math::Sign(dot); \
-  const math::SoaQuaternion rotation = {math::Xor(_in.rotation.x, sign), \
-                                        math::Xor(_in.rotation.y, sign), \
-                                        math::Xor(_in.rotation.z, sign), \
-                                        math::Xor(_in.rotation.w, sign)}; \
-  _out->rotation = _out->rotation + rotation * _simd_weight; \
-  /* Blends scales.*/ \
-  _out->scale = _out->scale + _in.scale * _simd_weight; \
+  return valid;
 }
 
-// Defines parameters that are exchanged accross blending stages.
-struct ProcessArgs {
-  ProcessArgs(const BlendingJob& _job)
-    : job(_job),
-      num_soa_joints(_job.bind_pose.end - _job.bind_pose.begin),
-      num_passes(0),
-      num_partial_passes(0),
-      accumulated_weight(0.f) {
-    // The range of all buffers has already been validated.
-    assert(job.output.end >= job.output.begin + num_soa_joints);
-    assert(OZZ_ARRAY_SIZE(accumulated_weights) >= num_soa_joints);
+namespace internal {
+
+BlendingArgs::BlendingArgs(float _threshold,
+                           Range<const math::SoaTransform> _bind_pose,
+                           Range<math::SoaTransform> _output,
+                           math::SimdFloat4* _accumulated_weights)
+  : accumulated_weights(_accumulated_weights),
+    threshold(_threshold),
+    bind_pose(_bind_pose.begin),
+    output(_output.begin),
+    num_soa_joints(_bind_pose.end - _bind_pose.begin),
+    num_passes(0),
+    num_partial_passes(0),
+    accumulated_weight(0.f) {
+  // The range of all buffers has already been validated.
+  assert(_output.end >= _output.begin + num_soa_joints);
+  assert(_accumulated_weights);
+  assert(num_soa_joints <= Skeleton::kMaxSoAJoints);
+  for (size_t i = 0; i < (num_soa_joints + 31) / 32; ++i) {
+    blended[i] = 0;
   }
+}
 
-  // Allocates enough space to store a accumulated weights per-joint.
-  // It will be initialized by the first pass processed, if any.
-  // This is quite big for a stack allocation (16 byte * maximum number of
-  // joints). This is one of the reasons why the number of joints is limited
-  // by the API.
-  // Note that this array is used with SoA data.
-  // This is the first argument in order to avoid wasting too much space with
-  // alignment padding.
-  math::SimdFloat4 accumulated_weights[Skeleton::kMaxSoAJoints];
-
-  // The job to process.
-  const BlendingJob& job;
-
-  // The number of transforms to process as defind by the size of the bind pose.
-  size_t num_soa_joints;
-
-  // Number of processed blended passes (excluding passes with a weight <= 0.f),
-  // including partial passes.
-  int num_passes;
-
-  // Number of processed partial blending passes (aka with a weight per-joint).
-  int num_partial_passes;
-
-  // The accumulated weight of all layers.
-  float accumulated_weight;
-
- private:
-   // Disables assignment operators.
-   ProcessArgs(const ProcessArgs&);
-   void operator = (const ProcessArgs&);
-};
-
-// Blends all layers of the job to its output.
-void BlendLayers(ProcessArgs* _args) {
-  assert(_args);
-
-  // Iterates through all layers and blend them to the output.
-  for (const BlendingJob::Layer* layer = _args->job.layers.begin;
-       layer < _args->job.layers.end;
-       ++layer) {
-
-    // Asserts buffer sizes, which must never fail as it has been validated.
-    assert(layer->transform.end >=
-           layer->transform.begin + _args->num_soa_joints);
-    assert(!layer->joint_weights.begin ||
-           (layer->joint_weights.end >=
-            layer->joint_weights.begin + _args->num_soa_joints));
+namespace {
 
-    // Skip irrelevant layers.
-    if (layer->weight <= 0.f) {
-      continue;
+// Returns the index of the first soa joint in range [_from,_end[ whose bit in
+// _set equals _value, or _end if there's none. Words that don't contain any
+// such bit are skipped at once.
+size_t FindJoint(const uint32_t* _set, size_t _from, size_t _end,
+                 bool _value) {
+  const uint32_t flip = _value ? 0u : ~0u;
+  for (size_t i = _from; i < _end;) {
+    const uint32_t word = (_set[i / 32] ^ flip) >> (i & 31);
+    if (word == 0) {
+      i = (i & ~size_t(31)) + 32;  // Skips to next word.
+    } else if (word & 1) {
+      return i;
+    } else {
+      ++i;
     }
+  }
+  return _end;
+}
 
-    // Accumulates global weights.
-    _args->accumulated_weight += layer->weight;
-    const math::SimdFloat4 layer_weight = math::simd_float4::Load1(layer->weight);
+// Returns true if soa joint _i is in _set.
+bool TestJoint(const uint32_t* _set, size_t _i) {
+  return (_set[_i / 32] & (1u << (_i & 31))) != 0;
+}
+}  // namespace
 
-    if (layer->joint_weights.begin) {
-      // This layer has per-joint weights.
-      ++_args->num_partial_passes;
+LayerRanges::LayerRanges(BlendingArgs* _args,
+                         const math::SimdFloat4* _joint_weights)
+  : args_(_args),
+    joint_weights_(_joint_weights),
+    cursor_(0),
+    weights_end_(0) {
+  assert(_args);
+}
 
-      if (_args->num_passes == 0) {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          const math::SimdFloat4 weight =
-            layer_weight * math::Max0(layer->joint_weights.begin[i]);
-          _args->accumulated_weights[i] = weight;
-          OZZ_BLEND_1ST_PASS(src, weight, dest);
-        }
-      } else {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          const math::SimdFloat4 weight =
-            layer_weight * math::Max0(layer->joint_weights.begin[i]);
-          _args->accumulated_weights[i] =
-            _args->accumulated_weights[i] + weight;
-          OZZ_BLEND_N_PASS(src, weight, dest);
-        }
+bool LayerRanges::Next(size_t* _begin, size_t* _end, bool* _first_pass) {
+  assert(_begin && _end && _first_pass);
+  const size_t num_soa_joints = args_->num_soa_joints;
+  size_t begin = cursor_;
+  if (begin >= weights_end_) {
+    // Finds next range of soa joints with a positive weight.
+    if (joint_weights_) {
+      for (; begin < num_soa_joints && !HasWeight(joint_weights_[begin]);
+           ++begin) {
       }
-    } else {
-      // This is a full layer.
-      if (_args->num_passes == 0) {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          _args->accumulated_weights[i] = layer_weight;
-          OZZ_BLEND_1ST_PASS(src, layer_weight, dest);
-        }
-      } else {
-        for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = layer->transform.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
-          _args->accumulated_weights[i] =
-            _args->accumulated_weights[i] + layer_weight;
-          OZZ_BLEND_N_PASS(src, layer_weight, dest);
-        }
+      weights_end_ = begin;
+      for (; weights_end_ < num_soa_joints &&
+             HasWeight(joint_weights_[weights_end_]);
+           ++weights_end_) {
       }
+    } else {
+      weights_end_ = num_soa_joints;
+    }
+    if (begin == num_soa_joints) {
+      cursor_ = num_soa_joints;
+      return false;
     }
-    // One more pass blended.
-    ++_args->num_passes;
   }
+
+  // The range ends with the weights range, or as soon as the blended state of
+  // soa joints changes.
+  uint32_t* set = args_->blended;
+  const bool blended = TestJoint(set, begin);
+  const size_t end = FindJoint(set, begin, weights_end_, !blended);
+
+  // Adds the range to the blended set.
+  for (size_t i = begin; i < end; ++i) {
+    set[i / 32] |= 1u << (i & 31);
+  }
+
+  *_begin = begin;
+  *_end = end;
+  *_first_pass = !blended;
+  cursor_ = end;
+  return true;
 }
 
 // Blends bind pose to the output if accumulated weight is less than the
 // threshold value.
-void BlendBindPose(ProcessArgs* _args) {
+void BlendBindPose(BlendingArgs* _args) {
   assert(_args);
 
-  // Asserts buffer sizes, which must never fail as it has been validated.
-  assert(_args->job.bind_pose.end >=
-         _args->job.bind_pose.begin + _args->num_soa_joints);
+  // Buffer sizes were validated when _args was built.
+  assert(_args->bind_pose && _args->output);
 
   if (_args->num_partial_passes == 0) {
     // No partial blending pass detected, threshold can be tested globaly.
     const float bp_weight =
-      _args->job.threshold - _args->accumulated_weight;
+      _args->threshold - _args->accumulated_weight;
 
     if (bp_weight > 0.f) {  // The bind pose is needed if it has a weight.
       const math::SimdFloat4 simd_bp_weight =
@@ -261,17 +254,17 @@ void BlendBindPose(ProcessArgs* _args) {
 
       // Updates global accumulated weight, but not per-joint weight any more
       // because normalization stage will be global also.
-      _args->accumulated_weight = _args->job.threshold;
+      _args->accumulated_weight = _args->threshold;
       if (_args->num_passes == 0) {
         for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = _args->job.bind_pose.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
+          const math::SoaTransform& src = _args->bind_pose[i];
+          math::SoaTransform* dest = _args->output + i;
           OZZ_BLEND_1ST_PASS(src, simd_bp_weight, dest);
         }
       } else {
         for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-          const math::SoaTransform& src = _args->job.bind_pose.begin[i];
-          math::SoaTransform* dest = _args->job.output.begin + i;
+          const math::SoaTransform& src = _args->bind_pose[i];
+          math::SoaTransform* dest = _args->output + i;
           OZZ_BLEND_N_PASS(src, simd_bp_weight, dest);
         }
       }
@@ -280,19 +273,32 @@ void BlendBindPose(ProcessArgs* _args) {
     // Blending passes contain partial blending, threshold must be tested for
     // each joint.
     const math::SimdFloat4 threshold = 
-      math::simd_float4::Load1(_args->job.threshold);
+      math::simd_float4::Load1(_args->threshold);
 
     // There's been at least 1 pass as num_partial_passes != 0.
     assert(_args->num_passes != 0);
 
-    for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-      const math::SoaTransform& src = _args->job.bind_pose.begin[i];
-      math::SoaTransform* dest = _args->job.output.begin + i;
-      const math::SimdFloat4 bp_weight =
-        math::Max0(threshold - _args->accumulated_weights[i]);
-      _args->accumulated_weights[i] =
-        math::Max(threshold, _args->accumulated_weights[i]);
-      OZZ_BLEND_N_PASS(src, bp_weight, dest);
+    // Iterates ranges of soa joints that were blended, or not.
+    for (size_t begin = 0, end = 0; begin < _args->num_soa_joints;
+         begin = end) {
+      const bool blended = TestJoint(_args->blended, begin);
+      end = FindJoint(_args->blended, begin, _args->num_soa_joints, !blended);
+      if (!blended) {
+        // No layer affects these joints, which are set to the bind pose.
+        for (size_t i = begin; i < end; ++i) {
+          _args->output[i] = _args->bind_pose[i];
+        }
+        continue;
+      }
+      for (size_t i = begin; i < end; ++i) {
+        const math::SoaTransform& src = _args->bind_pose[i];
+        math::SoaTransform* dest = _args->output + i;
+        const math::SimdFloat4 bp_weight =
+          math::Max0(threshold - _args->accumulated_weights[i]);
+        _args->accumulated_weights[i] =
+          math::Max(threshold, _args->accumulated_weights[i]);
+        OZZ_BLEND_N_PASS(src, bp_weight, dest);
+      }
     }
   }
 }
@@ -301,7 +307,7 @@ void BlendBindPose(ProcessArgs* _args) {
 // quaternions have been fixed up during blending passes.
 // Translations and scales are already normalized because weights were
 // pre-multiplied by the normalization ratio.
-void Normalize(ProcessArgs* _args) {
+void Normalize(BlendingArgs* _args) {
   assert(_args);
 
   if (_args->num_partial_passes == 0) {
@@ -310,21 +316,123 @@ void Normalize(ProcessArgs* _args) {
     const math::SimdFloat4 ratio =
       math::simd_float4::Load1(1.f / _args->accumulated_weight);
     for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-      math::SoaTransform& dest = _args->job.output.begin[i];
+      math::SoaTransform& dest = _args->output[i];
       dest.rotation = NormalizeEst(dest.rotation);
       dest.translation = dest.translation * ratio;
       dest.scale = dest.scale * ratio;
     }
   } else {
     // Partial blending normalization requires to compute the divider per-joint.
+    // Joints that weren't blended are already set to the bind pose.
     const math::SimdFloat4 one = math::simd_float4::one();
-    for (size_t i = 0; i < _args->num_soa_joints; ++i) {
-      const math::SimdFloat4 ratio = one / _args->accumulated_weights[i];
-      math::SoaTransform& dest = _args->job.output.begin[i];
-      dest.rotation = NormalizeEst(dest.rotation);
-      dest.translation = dest.translation * ratio;
-      dest.scale = dest.scale * ratio;
+    const size_t num_soa_joints = _args->num_soa_joints;
+    for (size_t begin = FindJoint(_args->blended, 0, num_soa_joints, true);
+         begin < num_soa_joints;) {
+      const size_t end =
+        FindJoint(_args->blended, begin, num_soa_joints, false);
+      for (size_t i = begin; i < end; ++i) {
+        const math::SimdFloat4 ratio = one / _args->accumulated_weights[i];
+        math::SoaTransform& dest = _args->output[i];
+        dest.rotation = NormalizeEst(dest.rotation);
+        dest.translation = dest.translation * ratio;
+        dest.scale = dest.scale * ratio;
+      }
+      begin = FindJoint(_args->blended, end, num_soa_joints, true);
+    }
+  }
+}
+}  // internal
+
+namespace {
+
+// Blends all layers of the job to its output. _args is setup for the range of
+// soa joints starting at _from.
+void BlendLayers(const BlendingJob& _job,
+                 size_t _from,
+                 internal::BlendingArgs* _args) {
+  assert(_args);
+
+  const internal::JobKernels& kernels = internal::GetJobKernels();
+
+  // Iterates through all layers and blend them to the output.
+  for (const BlendingJob::Layer* layer = _job.layers.begin;
+       layer < _job.layers.end;
+       ++layer) {
+
+    // Asserts buffer sizes, which must never fail as it has been validated.
+    assert(layer->transform.end >=
+           layer->transform.begin + _from + _args->num_soa_joints);
+    assert(!layer->joint_weights.begin ||
+           (layer->joint_weights.end >=
+            layer->joint_weights.begin + _from + _args->num_soa_joints));
+
+    // Skip irrelevant layers.
+    if (layer->weight <= 0.f) {
+      continue;
+    }
+
+    // Accumulates global weights.
+    _args->accumulated_weight += layer->weight;
+
+    if (layer->joint_weights.begin) {
+      // This layer has per-joint weights.
+      ++_args->num_partial_passes;
+    }
+
+    // Blends the layer with the kernel of the selected instruction set. Only
+    // the ranges of joints with a positive weight are blended.
+    const math::SoaTransform* transforms = layer->transform.begin + _from;
+    const math::SimdFloat4* joint_weights =
+      layer->joint_weights.begin ? layer->joint_weights.begin + _from : NULL;
+    internal::LayerRanges ranges(_args, joint_weights);
+    size_t begin, end;
+    bool first_pass;
+    while (ranges.Next(&begin, &end, &first_pass)) {
+      kernels.blend_layer(transforms + begin,
+                          joint_weights ? joint_weights + begin : NULL,
+                          layer->weight,
+                          first_pass,
+                          end - begin,
+                          _args->output + begin,
+                          _args->accumulated_weights + begin);
     }
+
+    // One more pass blended.
+    ++_args->num_passes;
+  }
+}
+
+// Applies all additive layers of the job to its output, one pass per layer.
+// _args is setup for the range of soa joints starting at _from.
+void AddLayers(const BlendingJob& _job,
+               size_t _from,
+               internal::BlendingArgs* _args) {
+  assert(_args);
+
+  const internal::JobKernels& kernels = internal::GetJobKernels();
+
+  for (const BlendingJob::Layer* layer = _job.additive_layers.begin;
+       layer < _job.additive_layers.end;
+       ++layer) {
+    // Asserts buffer sizes, which must never fail as it has been validated.
+    assert(layer->transform.end >=
+           layer->transform.begin + _from + _args->num_soa_joints);
+    assert(!layer->joint_weights.begin ||
+           (layer->joint_weights.end >=
+            layer->joint_weights.begin + _from + _args->num_soa_joints));
+
+    // Skip irrelevant layers.
+    if (layer->weight <= 0.f) {
+      continue;
+    }
+
+    // Applies the layer with the kernel of the selected instruction set.
+    kernels.add_layer(layer->transform.begin + _from,
+                      layer->joint_weights.begin ?
+                        layer->joint_weights.begin + _from : NULL,
+                      layer->weight,
+                      _args->num_soa_joints,
+                      _args->output);
   }
 }
 }  // namespace
@@ -334,17 +442,40 @@ bool BlendingJob::Run() const {
     return false;
   }
 
-  // Initializes blended parameters that are exchanged accross blend stages.
-  ProcessArgs process_args(*this);
+  // Early out if there's no soa joint in the range, to is clamped to the bind
+  // pose size.
+  const size_t begin = static_cast<size_t>(from);
+  const size_t end = math::Min(static_cast<size_t>(to), bind_pose.Count());
+  if (begin >= end) {
+    return true;
+  }
+
+  // Per-joint weights are accumulated to the scratch buffer, or to a stack
+  // buffer if there's none.
+  math::SimdFloat4 stack_weights[kMaxStackSoAJoints];
+  math::SimdFloat4* accumulated_weights =
+    scratch ? scratch + begin : stack_weights;
+
+  // Initializes blended parameters that are exchanged accross blend stages,
+  // restricted to the range of soa joints to blend.
+  internal::BlendingArgs process_args(
+    threshold,
+    Range<const math::SoaTransform>(bind_pose.begin + begin,
+                                    bind_pose.begin + end),
+    Range<math::SoaTransform>(output.begin + begin, output.end),
+    accumulated_weights);
 
   // Blends all layers to the job output buffers.
-  BlendLayers(&process_args);
+  BlendLayers(*this, begin, &process_args);
 
   // Applies bind pose.
-  BlendBindPose(&process_args);
+  internal::BlendBindPose(&process_args);
 
   // Normalizes output.
-  Normalize(&process_args);
+  internal::Normalize(&process_args);
+
+  // Applies additive layers to the normalized output.
+  AddLayers(*this, begin, &process_args);
 
   return true;
 }
@@ -0,0 +1,154 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_ANIMATION_RUNTIME_BLENDING_STAGES_H_
+#define OZZ_ANIMATION_RUNTIME_BLENDING_STAGES_H_
+
+#ifndef OZZ_INCLUDE_PRIVATE_HEADER
+#error "This header is private, it cannot be included from public headers."
+#endif  // OZZ_INCLUDE_PRIVATE_HEADER
+
+// Declares the blending stages that follow layers blending, aka bind pose
+// blending and normalization. They are shared by the BlendingJob and the
+// SamplingBlendingJob, which only differ in the way layers are blended.
+
+#include <cstddef>
+
+#include "ozz/base/platform.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+namespace ozz {
+namespace math { struct SoaTransform; }
+namespace animation {
+namespace internal {
+
+// Number of 32 bits words of a set of soa joints, one bit per soa joint.
+enum { kSoaJointSetWords = (Skeleton::kMaxSoAJoints + 31) / 32 };
+
+// Defines parameters that are exchanged accross blending stages.
+struct BlendingArgs {
+  // Initializes arguments for blending the num_soa_joints defined by
+  // _bind_pose range. _output and _accumulated_weights must be at least as big
+  // as _bind_pose.
+  BlendingArgs(float _threshold,
+               Range<const math::SoaTransform> _bind_pose,
+               Range<math::SoaTransform> _output,
+               math::SimdFloat4* _accumulated_weights);
+
+  // Accumulated weights per-joint, provided by the caller. It will be
+  // initialized by the first pass processed, if any.
+  // Note that this array is used with SoA data.
+  math::SimdFloat4* accumulated_weights;
+
+  // The bind pose threshold, see BlendingJob::threshold.
+  float threshold;
+
+  // The bind pose and output buffers, both at least num_soa_joints long.
+  const math::SoaTransform* bind_pose;
+  math::SoaTransform* output;
+
+  // The number of transforms to process as defind by the size of the bind pose.
+  size_t num_soa_joints;
+
+  // Number of processed blended passes (excluding passes with a weight <= 0.f),
+  // including partial passes.
+  int num_passes;
+
+  // Number of processed partial blending passes (aka with a weight per-joint).
+  int num_partial_passes;
+
+  // The accumulated weight of all layers.
+  float accumulated_weight;
+
+  // Set of the soa joints blended by at least one layer. Output and
+  // accumulated weights of the other soa joints aren't initialized.
+  // Only the words required by num_soa_joints are used and initialized.
+  uint32_t blended[kSoaJointSetWords];
+
+ private:
+   // Disables assignment operators.
+   BlendingArgs(const BlendingArgs&);
+   void operator = (const BlendingArgs&);
+};
+
+// Iterates the ranges of soa joints a layer must be blended to, skipping soa
+// joints whose 4 joint weights are all less than or equal to 0. Ranges are
+// split so that each one is either blended for the first time (first pass),
+// or blended on top of previous layers.
+// Soa joints of each range are added to the set of blended joints of _args
+// as the range is iterated.
+class LayerRanges {
+ public:
+  // Prepares iteration of the soa joints with a positive weight in
+  // _joint_weights, or all soa joints if _joint_weights is NULL.
+  LayerRanges(BlendingArgs* _args, const math::SimdFloat4* _joint_weights);
+
+  // Gets next range [_begin,_end[ of soa joints to blend, and whether it's
+  // the first pass for this range. Returns false when all ranges were
+  // iterated.
+  bool Next(size_t* _begin, size_t* _end, bool* _first_pass);
+
+ private:
+  // Disables copy and assignation.
+  LayerRanges(const LayerRanges&);
+  void operator = (const LayerRanges&);
+
+  BlendingArgs* args_;
+
+  // Per-joint weights of the layer, NULL if all joints are blended.
+  const math::SimdFloat4* joint_weights_;
+
+  // Index of the first soa joint not iterated yet.
+  size_t cursor_;
+
+  // End of the current range of soa joints with a positive weight, which
+  // can be iterated in multiple ranges.
+  size_t weights_end_;
+};
+
+// Returns true if any of the 4 joint weights of _weights is positive.
+OZZ_INLINE bool HasWeight(math::_SimdFloat4 _weights) {
+  return !math::AreAllFalse(math::CmpGt(_weights, math::simd_float4::zero()));
+}
+
+// Blends bind pose to the output if accumulated weight is less than the
+// threshold value. Soa joints that weren't blended by any layer of a partial
+// blending are set to the bind pose.
+void BlendBindPose(BlendingArgs* _args);
+
+// Normalizes output rotations, translations and scales by the accumulated
+// weights. Only blended soa joints are normalized.
+void Normalize(BlendingArgs* _args);
+}  // internal
+}  // animation
+}  // ozz
+#endif  // OZZ_ANIMATION_RUNTIME_BLENDING_STAGES_H_
@@ -0,0 +1,170 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/compressed_animation.h"
+
+#include <cassert>
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/maths/soa_math_archive.h"
+#include "ozz/base/maths/soa_float.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+template<typename _Value>
+void SaveBuffer(ozz::io::OArchive& _archive, ozz::Range<const _Value> _buffer) {
+  const ptrdiff_t count = _buffer.Count();
+  _archive << static_cast<int32_t>(count);
+  if (count) {
+    _archive << ozz::io::MakeArray(_buffer.begin, count);
+  }
+}
+
+template<typename _Value>
+ozz::Range<_Value> LoadBuffer(ozz::io::IArchive& _archive) {
+  int32_t count;
+  _archive >> count;
+  ozz::Range<_Value> buffer =
+    memory::default_allocator()->AllocateRange<_Value>(count);
+  if (count) {
+    _archive >> ozz::io::MakeArray(buffer.begin, count);
+  }
+  return buffer;
+}
+}  // namespace
+
+CompressedAnimation::CompressedAnimation()
+    : frame_bits_(0),
+      block_size_(0),
+      num_frames_(0),
+      duration_(0.f),
+      num_tracks_(0) {
+}
+
+CompressedAnimation::~CompressedAnimation() {
+  Destroy();
+}
+
+void CompressedAnimation::Destroy() {
+  memory::Allocator* allocator = memory::default_allocator();
+  allocator->Deallocate(translation_bits_);
+  translation_bits_.begin = NULL; translation_bits_.end = NULL;
+  allocator->Deallocate(rotation_bits_);
+  rotation_bits_.begin = NULL; rotation_bits_.end = NULL;
+  allocator->Deallocate(scale_bits_);
+  scale_bits_.begin = NULL; scale_bits_.end = NULL;
+  allocator->Deallocate(translation_ranges_);
+  translation_ranges_.begin = NULL; translation_ranges_.end = NULL;
+  allocator->Deallocate(rotation_ranges_);
+  rotation_ranges_.begin = NULL; rotation_ranges_.end = NULL;
+  allocator->Deallocate(scale_ranges_);
+  scale_ranges_.begin = NULL; scale_ranges_.end = NULL;
+  allocator->Deallocate(blocks_);
+  blocks_.begin = NULL; blocks_.end = NULL;
+
+  frame_bits_ = 0;
+  block_size_ = 0;
+  num_frames_ = 0;
+  duration_ = 0.f;
+  num_tracks_ = 0;
+}
+
+void CompressedAnimation::ComputeFrameLayout() {
+  frame_bits_ = 0;
+  const size_t count = translation_bits_.Count();
+  assert(rotation_bits_.Count() == count && scale_bits_.Count() == count);
+  for (size_t i = 0; i < count; ++i) {
+    frame_bits_ += translation_bits_.begin[i] * 3 +
+                   rotation_bits_.begin[i] * 4 +
+                   scale_bits_.begin[i] * 3;
+  }
+  block_size_ = (frame_bits_ * kBlockFrames + 7) / 8;
+}
+
+size_t CompressedAnimation::size() const {
+  const size_t size =
+    sizeof(*this) + translation_bits_.Size() + rotation_bits_.Size() +
+    scale_bits_.Size() + translation_ranges_.Size() +
+    rotation_ranges_.Size() + scale_ranges_.Size() + blocks_.Size();
+  return size;
+}
+
+void CompressedAnimation::Save(ozz::io::OArchive& _archive) const {
+  _archive << duration_;
+  _archive << static_cast<int32_t>(num_tracks_);
+  _archive << static_cast<int32_t>(num_frames_);
+
+  SaveBuffer(_archive, translation_bits());
+  SaveBuffer(_archive, rotation_bits());
+  SaveBuffer(_archive, scale_bits());
+
+  SaveBuffer(_archive, translation_ranges());
+  SaveBuffer(_archive, rotation_ranges());
+  SaveBuffer(_archive, scale_ranges());
+
+  SaveBuffer(_archive, blocks());
+}
+
+void CompressedAnimation::Load(ozz::io::IArchive& _archive,
+                               uint32_t _version) {
+  // Destroy animation in case it was already used before.
+  Destroy();
+
+  if (_version != 1) {
+    return;
+  }
+
+  _archive >> duration_;
+
+  int32_t num_tracks;
+  _archive >> num_tracks;
+  num_tracks_ = num_tracks;
+
+  int32_t num_frames;
+  _archive >> num_frames;
+  num_frames_ = num_frames;
+
+  translation_bits_ = LoadBuffer<uint8_t>(_archive);
+  rotation_bits_ = LoadBuffer<uint8_t>(_archive);
+  scale_bits_ = LoadBuffer<uint8_t>(_archive);
+
+  translation_ranges_ = LoadBuffer<math::SoaFloat3>(_archive);
+  rotation_ranges_ = LoadBuffer<math::SoaFloat4>(_archive);
+  scale_ranges_ = LoadBuffer<math::SoaFloat3>(_archive);
+
+  blocks_ = LoadBuffer<uint8_t>(_archive);
+
+  ComputeFrameLayout();
+}
+}  // animation
+}  // ozz
@@ -0,0 +1,213 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/compressed_sampling_job.h"
+
+#include <cassert>
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/animation/runtime/compressed_animation.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "../runtime/animation_time.h"
+#include "../runtime/packed_bits.h"
+
+namespace ozz {
+namespace animation {
+
+namespace {
+
+// Quantized values of the 4 tracks of a soa track, for one frame.
+struct QuantizedSoaTransform {
+  int translation[3][4];
+  int rotation[4][4];
+  int scale[3][4];
+};
+
+// Unpacks _count components of _bits bits, starting at bit *_offset of
+// _frame, to lane _lane of _values. *_offset is moved passed the components.
+// Nothing is read for 0 bits components, as *_offset can then be at the end
+// of the buffer.
+OZZ_INLINE void Unpack(const uint8_t* _frame, int* _offset, int _bits,
+                       int _count, int _lane, int (*_values)[4]) {
+  if (_bits == 0) {
+    for (int c = 0; c < _count; ++c) {
+      _values[c][_lane] = 0;
+    }
+    return;
+  }
+  for (int c = 0; c < _count; ++c) {
+    _values[c][_lane] = internal::ReadBits(_frame, *_offset, _bits);
+    *_offset += _bits;
+  }
+}
+
+// Restores 4 values from their quantized integers _q.
+OZZ_INLINE math::SimdFloat4 Dequantize(const int* _q,
+                                       math::_SimdFloat4 _min,
+                                       math::_SimdFloat4 _step) {
+  return math::MAdd(math::simd_float4::FromInt(math::simd_int4::LoadPtrU(_q)),
+                    _step, _min);
+}
+
+OZZ_INLINE math::SoaFloat3 Dequantize(const int (*_q)[4],
+                                      const math::SoaFloat3& _min,
+                                      const math::SoaFloat3& _step) {
+  const math::SoaFloat3 value = {Dequantize(_q[0], _min.x, _step.x),
+                                 Dequantize(_q[1], _min.y, _step.y),
+                                 Dequantize(_q[2], _min.z, _step.z)};
+  return value;
+}
+
+OZZ_INLINE math::SoaQuaternion Dequantize(const int (*_q)[4],
+                                          const math::SoaFloat4& _min,
+                                          const math::SoaFloat4& _step) {
+  const math::SoaQuaternion value = {Dequantize(_q[0], _min.x, _step.x),
+                                     Dequantize(_q[1], _min.y, _step.y),
+                                     Dequantize(_q[2], _min.z, _step.z),
+                                     Dequantize(_q[3], _min.w, _step.w)};
+  return value;
+}
+
+// Returns the address of the first byte of _frame, and outputs in _offset the
+// bit offset of the frame from this byte.
+const uint8_t* FrameAddress(const CompressedAnimation& _animation, int _frame,
+                            int* _offset) {
+  const int block = _frame / CompressedAnimation::kBlockFrames;
+  const int in_block = _frame - block * CompressedAnimation::kBlockFrames;
+  *_offset = in_block * _animation.frame_bits();
+  return _animation.blocks().begin + block * _animation.block_size();
+}
+
+}  // namespace
+
+CompressedSamplingJob::CompressedSamplingJob()
+    : time(0.f),
+      loop(false),
+      animation(NULL) {
+}
+
+bool CompressedSamplingJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL pointers.
+  if (!animation) {
+    return false;
+  }
+  valid &= output.begin != NULL;
+
+  // Tests output range, implicitly tests output.end != NULL.
+  const ptrdiff_t num_soa_tracks = animation->num_soa_tracks();
+  valid &= output.end - output.begin >= num_soa_tracks;
+
+  return valid;
+}
+
+bool CompressedSamplingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_soa_tracks = animation->num_soa_tracks();
+  if (num_soa_tracks == 0) {  // Early out if animation contains no joint.
+    return true;
+  }
+
+  // Clamps or wraps time in range [0,duration], and finds the frames to
+  // interpolate.
+  const float duration = animation->duration();
+  const float anim_time = internal::AnimationTime(time, duration, loop);
+  const int last_frame = animation->num_frames() - 1;
+  assert(last_frame >= 1);
+  const float position = anim_time * (last_frame / duration);
+  const int frame = math::Min(static_cast<int>(position), last_frame - 1);
+  const math::SimdFloat4 alpha = math::simd_float4::Load1(
+    math::Min(position - frame, 1.f));
+
+  int offsets[2];
+  const uint8_t* frames[2] = {FrameAddress(*animation, frame, &offsets[0]),
+                              FrameAddress(*animation, frame + 1, &offsets[1])};
+
+  const uint8_t* translation_bits = animation->translation_bits().begin;
+  const uint8_t* rotation_bits = animation->rotation_bits().begin;
+  const uint8_t* scale_bits = animation->scale_bits().begin;
+  const math::SoaFloat3* translation_ranges =
+    animation->translation_ranges().begin;
+  const math::SoaFloat4* rotation_ranges = animation->rotation_ranges().begin;
+  const math::SoaFloat3* scale_ranges = animation->scale_ranges().begin;
+
+  for (int i = 0; i < num_soa_tracks; ++i) {
+    // Unpacks both frames values of the 4 tracks, which are stored track after
+    // track in a frame.
+    QuantizedSoaTransform q[2];
+    for (int j = 0; j < 4; ++j) {
+      const int track = i * 4 + j;
+      const int tbits = translation_bits[track];
+      const int rbits = rotation_bits[track];
+      const int sbits = scale_bits[track];
+      for (int f = 0; f < 2; ++f) {
+        Unpack(frames[f], &offsets[f], tbits, 3, j, q[f].translation);
+        Unpack(frames[f], &offsets[f], rbits, 4, j, q[f].rotation);
+        Unpack(frames[f], &offsets[f], sbits, 3, j, q[f].scale);
+      }
+    }
+
+    // Restores and interpolates values using soa math.
+    const math::SoaFloat3& tmin = translation_ranges[i * 2];
+    const math::SoaFloat3& tstep = translation_ranges[i * 2 + 1];
+    output.begin[i].translation =
+      Lerp(Dequantize(q[0].translation, tmin, tstep),
+           Dequantize(q[1].translation, tmin, tstep),
+           alpha);
+
+    const math::SoaFloat4& rmin = rotation_ranges[i * 2];
+    const math::SoaFloat4& rstep = rotation_ranges[i * 2 + 1];
+    output.begin[i].rotation =
+      NLerp(Dequantize(q[0].rotation, rmin, rstep),
+            Dequantize(q[1].rotation, rmin, rstep),
+            alpha);
+
+    const math::SoaFloat3& smin = scale_ranges[i * 2];
+    const math::SoaFloat3& sstep = scale_ranges[i * 2 + 1];
+    output.begin[i].scale =
+      Lerp(Dequantize(q[0].scale, smin, sstep),
+           Dequantize(q[1].scale, smin, sstep),
+           alpha);
+  }
+
+  return true;
+}
+}  // animation
+}  // ozz
@@ -0,0 +1,367 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+// Implements runtime jobs kernels declared in job_kernels.h. This file is
+// included by every job_kernels*.cc file, each one being compiled for a
+// different instruction set. The including file defines
+// OZZ_JOB_KERNELS_GETTER as the name of the function returning its kernels
+// table.
+// Kernels are defined in an unnamed namespace, so instances compiled for
+// different instruction sets never collide. For the same reason, they only
+// rely on force-inlined functions (accessing ranges through begin pointers).
+
+#ifndef OZZ_JOB_KERNELS_GETTER
+#error "OZZ_JOB_KERNELS_GETTER must be defined before including this file."
+#endif  // OZZ_JOB_KERNELS_GETTER
+
+#include <cassert>
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_float4x4.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/soa_transform8.h"
+
+namespace ozz {
+namespace animation {
+namespace internal {
+namespace {
+
+// Interpolates soa hot data, see JobKernels::interpolate.
+void Interpolates(float _anim_time,
+                  int _num_soa_tracks,
+                  const InterpSoaTranslation* _translations,
+                  const InterpSoaRotation* _rotations,
+                  const InterpSoaScale* _scales,
+                  const bool* _mask,
+                  math::SoaTransform* _output) {
+  int i = 0;
+#ifdef OZZ_HAS_AVX2
+  // Interpolates 2 soa tracks at a time using 8-wide simd math.
+  const math::SimdFloat8 anim_time8 = math::simd_float8::Load1(_anim_time);
+  for (; i + 1 < _num_soa_tracks; i += 2) {
+    const bool low = !_mask || _mask[i];
+    const bool high = !_mask || _mask[i + 1];
+    if (!low && !high) {  // Skips masked out tracks.
+      continue;
+    }
+    const InterpSoaTranslation& t0 = _translations[i];
+    const InterpSoaTranslation& t1 = _translations[i + 1];
+    const InterpSoaRotation& r0 = _rotations[i];
+    const InterpSoaRotation& r1 = _rotations[i + 1];
+    const InterpSoaScale& s0 = _scales[i];
+    const InterpSoaScale& s1 = _scales[i + 1];
+
+    // Prepares interpolation coefficients.
+    const math::SimdFloat8 t_time0 =
+      math::simd_float8::Load(t0.time[0], t1.time[0]);
+    const math::SimdFloat8 interp_t_time = (anim_time8 - t_time0) *
+      math::RcpEst(math::simd_float8::Load(t0.time[1], t1.time[1]) - t_time0);
+    const math::SimdFloat8 r_time0 =
+      math::simd_float8::Load(r0.time[0], r1.time[0]);
+    const math::SimdFloat8 interp_r_time = (anim_time8 - r_time0) *
+      math::RcpEst(math::simd_float8::Load(r0.time[1], r1.time[1]) - r_time0);
+    const math::SimdFloat8 s_time0 =
+      math::simd_float8::Load(s0.time[0], s1.time[0]);
+    const math::SimdFloat8 interp_s_time = (anim_time8 - s_time0) *
+      math::RcpEst(math::simd_float8::Load(s0.time[1], s1.time[1]) - s_time0);
+
+    // Processes interpolations, see 4-wide implementation below.
+    const math::SoaFloat3_8 translation = Lerp(
+      math::SoaFloat3_8::Load(t0.value[0], t1.value[0]),
+      math::SoaFloat3_8::Load(t0.value[1], t1.value[1]),
+      interp_t_time);
+    const math::SoaQuaternion8 rotation = NLerpEst(
+      math::SoaQuaternion8::Load(r0.value[0], r1.value[0]),
+      math::SoaQuaternion8::Load(r0.value[1], r1.value[1]),
+      interp_r_time);
+    const math::SoaFloat3_8 scale = Lerp(
+      math::SoaFloat3_8::Load(s0.value[0], s1.value[0]),
+      math::SoaFloat3_8::Load(s0.value[1], s1.value[1]),
+      interp_s_time);
+
+    if (low) {
+      _output[i].translation = GetLow(translation);
+      _output[i].rotation = GetLow(rotation);
+      _output[i].scale = GetLow(scale);
+    }
+    if (high) {
+      _output[i + 1].translation = GetHigh(translation);
+      _output[i + 1].rotation = GetHigh(rotation);
+      _output[i + 1].scale = GetHigh(scale);
+    }
+  }
+#endif  // OZZ_HAS_AVX2
+
+  const math::SimdFloat4 anim_time = math::simd_float4::Load1(_anim_time);
+  for (; i < _num_soa_tracks; ++i) {
+    if (_mask && !_mask[i]) {  // Skips masked out tracks.
+      continue;
+    }
+
+    // Prepares interpolation coefficients.
+    const math::SimdFloat4 interp_t_time =
+      (anim_time - _translations[i].time[0]) *
+      math::RcpEst(_translations[i].time[1] - _translations[i].time[0]);
+    const math::SimdFloat4 interp_r_time =
+      (anim_time - _rotations[i].time[0]) *
+      math::RcpEst(_rotations[i].time[1] - _rotations[i].time[0]);
+    const math::SimdFloat4 interp_s_time =
+      (anim_time - _scales[i].time[0]) *
+      math::RcpEst(_scales[i].time[1] - _scales[i].time[0]);
+
+    // Processes interpolations.
+    // The lerp of the rotation uses the shortest path, because opposed
+    // quaternions were negated during animation build stage (AnimationBuilder).
+    _output[i].translation = Lerp(
+      _translations[i].value[0], _translations[i].value[1], interp_t_time);
+    _output[i].rotation = NLerpEst(
+      _rotations[i].value[0], _rotations[i].value[1], interp_r_time);
+    _output[i].scale = Lerp(
+      _scales[i].value[0], _scales[i].value[1], interp_s_time);
+  }
+}
+
+#ifdef OZZ_HAS_AVX2
+// Blends a layer to the output, 2 soa joints at a time using 8-wide simd
+// math. Returns the number of soa joints processed, remaining ones (if any)
+// must be processed by the 4-wide implementation.
+size_t BlendLayer8(const math::SoaTransform* _transforms,
+                   const math::SimdFloat4* _joint_weights,
+                   math::_SimdFloat4 _layer_weight,
+                   bool _first_pass,
+                   size_t _num_soa_joints,
+                   math::SoaTransform* _output,
+                   math::SimdFloat4* _accumulated_weights) {
+  const math::SimdFloat8 layer_weight =
+    math::simd_float8::Load(_layer_weight, _layer_weight);
+  size_t i = 0;
+  for (; i + 1 < _num_soa_joints; i += 2) {
+    const math::SoaTransform8 src =
+      math::SoaTransform8::Load(_transforms[i], _transforms[i + 1]);
+    math::SoaTransform* out = _output + i;
+    math::SimdFloat4* accumulated_weights = _accumulated_weights + i;
+
+    // Computes per-joint weights.
+    math::SimdFloat8 weight = layer_weight;
+    if (_joint_weights) {
+      weight = layer_weight * math::Max0(
+        math::simd_float8::Load(_joint_weights[i], _joint_weights[i + 1]));
+    }
+
+    math::SoaTransform8 dest;
+    if (_first_pass) {
+      OZZ_BLEND_1ST_PASS(src, weight, (&dest));
+    } else {
+      dest = math::SoaTransform8::Load(out[0], out[1]);
+      OZZ_BLEND_N_PASS(src, weight, (&dest));
+      weight = weight + math::simd_float8::Load(accumulated_weights[0],
+                                                accumulated_weights[1]);
+    }
+    accumulated_weights[0] = math::GetLow(weight);
+    accumulated_weights[1] = math::GetHigh(weight);
+    out[0] = math::GetLow(dest);
+    out[1] = math::GetHigh(dest);
+  }
+  return i;
+}
+#endif  // OZZ_HAS_AVX2
+
+// Blends a layer, see JobKernels::blend_layer.
+void BlendLayer(const math::SoaTransform* _transforms,
+                const math::SimdFloat4* _joint_weights,
+                float _weight,
+                bool _first_pass,
+                size_t _num_soa_joints,
+                math::SoaTransform* _output,
+                math::SimdFloat4* _accumulated_weights) {
+  const math::SimdFloat4 layer_weight = math::simd_float4::Load1(_weight);
+
+  // Soa joints from index "first" are blended by the 4-wide loops below.
+  size_t first = 0;
+#ifdef OZZ_HAS_AVX2
+  first = BlendLayer8(_transforms, _joint_weights, layer_weight, _first_pass,
+                      _num_soa_joints, _output, _accumulated_weights);
+#endif  // OZZ_HAS_AVX2
+
+  if (_joint_weights) {
+    // This layer has per-joint weights.
+    if (_first_pass) {
+      for (size_t i = first; i < _num_soa_joints; ++i) {
+        const math::SoaTransform& src = _transforms[i];
+        math::SoaTransform* dest = _output + i;
+        const math::SimdFloat4 weight =
+          layer_weight * math::Max0(_joint_weights[i]);
+        _accumulated_weights[i] = weight;
+        OZZ_BLEND_1ST_PASS(src, weight, dest);
+      }
+    } else {
+      for (size_t i = first; i < _num_soa_joints; ++i) {
+        const math::SoaTransform& src = _transforms[i];
+        math::SoaTransform* dest = _output + i;
+        const math::SimdFloat4 weight =
+          layer_weight * math::Max0(_joint_weights[i]);
+        _accumulated_weights[i] = _accumulated_weights[i] + weight;
+        OZZ_BLEND_N_PASS(src, weight, dest);
+      }
+    }
+  } else {
+    // This is a full layer.
+    if (_first_pass) {
+      for (size_t i = first; i < _num_soa_joints; ++i) {
+        const math::SoaTransform& src = _transforms[i];
+        math::SoaTransform* dest = _output + i;
+        _accumulated_weights[i] = layer_weight;
+        OZZ_BLEND_1ST_PASS(src, layer_weight, dest);
+      }
+    } else {
+      for (size_t i = first; i < _num_soa_joints; ++i) {
+        const math::SoaTransform& src = _transforms[i];
+        math::SoaTransform* dest = _output + i;
+        _accumulated_weights[i] = _accumulated_weights[i] + layer_weight;
+        OZZ_BLEND_N_PASS(src, layer_weight, dest);
+      }
+    }
+  }
+}
+
+// Applies an additive layer, see JobKernels::add_layer.
+void AddLayer(const math::SoaTransform* _transforms,
+              const math::SimdFloat4* _joint_weights,
+              float _weight,
+              size_t _num_soa_joints,
+              math::SoaTransform* _output) {
+  const math::SimdFloat4 layer_weight = math::simd_float4::Load1(_weight);
+  const math::SimdFloat4 one = math::simd_float4::one();
+
+  if (_joint_weights) {
+    // This layer has per-joint weights. Soa joints whose weights are all
+    // null are left unchanged.
+    const math::SimdFloat4 zero = math::simd_float4::zero();
+    for (size_t i = 0; i < _num_soa_joints; ++i) {
+      const math::SimdFloat4 weight =
+        layer_weight * math::Max0(_joint_weights[i]);
+      if (math::AreAllFalse(math::CmpGt(weight, zero))) {
+        continue;
+      }
+      const math::SoaTransform& src = _transforms[i];
+      math::SoaTransform* dest = _output + i;
+      OZZ_ADD_PASS(src, weight, one, dest);
+    }
+  } else {
+    // This is a full layer.
+    for (size_t i = 0; i < _num_soa_joints; ++i) {
+      const math::SoaTransform& src = _transforms[i];
+      math::SoaTransform* dest = _output + i;
+      OZZ_ADD_PASS(src, layer_weight, one, dest);
+    }
+  }
+}
+
+// Converts to model-space matrices, see JobKernels::local_to_model.
+void LocalToModel(int _from,
+                  int _to,
+                  const Skeleton::JointProperties* _properties,
+                  const math::SoaTransform* _input,
+                  math::Float4x4* _output) {
+  using math::SoaTransform;
+  using math::SoaFloat4x4;
+  using math::Float4x4;
+
+  // Initializes an identity matrix that will be used to compute roots model
+  // matrices without requiring a branch.
+  const Float4x4 identity = Float4x4::identity();
+
+  // Converts to matrices and applies hierarchical transformation.
+  for (int joint = _from; joint < _to;) {
+    // The range might not start on a soa joint boundary.
+    const int soa_joint = joint / 4;
+
+    // Aos matrices of the joints processed by this iteration, up to 8 with
+    // the 8-wide path.
+    math::SimdFloat4 local_aos_matrices[32];
+    int batch_size = 4;
+#ifdef OZZ_HAS_AVX2
+    if (_to - soa_joint * 4 > 4) {
+      // Builds 2 soa matrices at once from 2 soa transforms, using 8-wide
+      // simd math.
+      const math::SoaTransform8 transform = math::SoaTransform8::Load(
+        _input[soa_joint], _input[soa_joint + 1]);
+      SoaFloat4x4 local_soa_matrices[2];
+      math::ToAffine(transform, &local_soa_matrices[0], &local_soa_matrices[1]);
+      // Converts to aos matrices.
+      math::Transpose16x16(&local_soa_matrices[0].cols[0].x,
+                           local_aos_matrices);
+      math::Transpose16x16(&local_soa_matrices[1].cols[0].x,
+                           local_aos_matrices + 16);
+      batch_size = 8;
+    } else
+#endif  // OZZ_HAS_AVX2
+    {
+      // Builds soa matrices from soa transforms.
+      const SoaTransform& transform = _input[soa_joint];
+      const SoaFloat4x4 local_soa_matrices =
+        SoaFloat4x4::FromAffine(transform.translation,
+                                transform.rotation,
+                                transform.scale);
+      // Converts to aos matrices.
+      math::Transpose16x16(&local_soa_matrices.cols[0].x, local_aos_matrices);
+    }
+
+    // Applies hierarchical transformation.
+    const int proceed_up_to = math::Min(soa_joint * 4 + batch_size, _to);
+    const math::SimdFloat4* local_aos_matrix =
+      local_aos_matrices + (joint - soa_joint * 4) * 4;
+    for (; joint < proceed_up_to; ++joint, local_aos_matrix += 4) {
+      const int parent = _properties[joint].parent;
+      const Float4x4* parent_matrix =
+        math::Select(parent == Skeleton::kNoParentIndex,
+                     &identity,
+                     &_output[parent]);
+      const Float4x4 local_matrix = {{local_aos_matrix[0],
+                                      local_aos_matrix[1],
+                                      local_aos_matrix[2],
+                                      local_aos_matrix[3]}};
+      _output[joint] = (*parent_matrix) * local_matrix;
+    }
+  }
+}
+
+// Declares kernels table.
+const JobKernels kJobKernels = {&Interpolates, &BlendLayer, &AddLayer,
+                                 &LocalToModel};
+}  // namespace
+
+const JobKernels* OZZ_JOB_KERNELS_GETTER() {
+  return &kJobKernels;
+}
+}  // internal
+}  // animation
+}  // ozz
@@ -0,0 +1,70 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "../runtime/job_kernels.h"
+
+#include "ozz/base/cpu.h"
+
+// Instantiates kernels for the instruction set the library is built with.
+#define OZZ_JOB_KERNELS_GETTER GetBaselineJobKernels
+#include "../runtime/job_kernels-inl.h"
+
+namespace ozz {
+namespace animation {
+namespace internal {
+
+namespace {
+// Kernels of the highest instruction set built, up to each instruction set.
+// They are resolved once during static initialization, so selecting kernels
+// is a single lookup.
+struct KernelsTable {
+  KernelsTable() {
+    const JobKernels* built[cpu::kInstructionSetCount] = {
+      GetBaselineJobKernels(), GetSSE4_1JobKernels(), GetAVX2JobKernels()};
+    kernels[cpu::kBaseline] = built[cpu::kBaseline];
+    for (int set = cpu::kBaseline + 1; set < cpu::kInstructionSetCount; ++set) {
+      kernels[set] = built[set] ? built[set] : kernels[set - 1];
+    }
+  }
+  const JobKernels* kernels[cpu::kInstructionSetCount];
+};
+const KernelsTable kKernelsTable;
+}  // namespace
+
+const JobKernels& GetJobKernels() {
+  const JobKernels* kernels = kKernelsTable.kernels[cpu::GetInstructionSet()];
+  // Entries are NULL if a job is run before static initialization is done.
+  return kernels ? *kernels : *GetBaselineJobKernels();
+}
+}  // internal
+}  // animation
+}  // ozz
@@ -0,0 +1,199 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_ANIMATION_RUNTIME_JOB_KERNELS_H_
+#define OZZ_ANIMATION_RUNTIME_JOB_KERNELS_H_
+
+#ifndef OZZ_INCLUDE_PRIVATE_HEADER
+#error "This header is private, it cannot be included from public headers."
+#endif  // OZZ_INCLUDE_PRIVATE_HEADER
+
+// Declares runtime jobs kernels, aka the hot loops of sampling, blending and
+// local-to-model jobs. Kernels are compiled once per instruction set
+// (job_kernels*.cc files), jobs are dispatched at runtime to the kernels of
+// the instruction set selected by ozz::cpu::GetInstructionSet().
+
+#include <cstddef>
+
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/soa_transform8.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+namespace ozz {
+namespace animation {
+namespace internal {
+
+// Soa hot data to interpolate, as stored in the SamplingCache. Times are in
+// animation key time units.
+struct InterpSoaTranslation {
+  math::SimdFloat4 time[2];
+  math::SoaFloat3 value[2];
+};
+struct InterpSoaRotation {
+  math::SimdFloat4 time[2];
+  math::SoaQuaternion value[2];
+};
+struct InterpSoaScale {
+  math::SimdFloat4 time[2];
+  math::SoaFloat3 value[2];
+};
+
+// Defines the table of kernels compiled for an instruction set.
+struct JobKernels {
+  // Interpolates soa hot data at _anim_time (in key time units) to _output.
+  // Masked out tracks (_mask[i] false) are skipped, _mask can be NULL.
+  void (*interpolate)(float _anim_time,
+                      int _num_soa_tracks,
+                      const InterpSoaTranslation* _translations,
+                      const InterpSoaRotation* _rotations,
+                      const InterpSoaScale* _scales,
+                      const bool* _mask,
+                      math::SoaTransform* _output);
+
+  // Blends a layer (_transforms with a global _weight and optional
+  // per-joint _joint_weights) to _output, and accumulates per-joint weights
+  // to _accumulated_weights. Outputs are initialized if _first_pass is true.
+  void (*blend_layer)(const math::SoaTransform* _transforms,
+                      const math::SimdFloat4* _joint_weights,
+                      float _weight,
+                      bool _first_pass,
+                      size_t _num_soa_joints,
+                      math::SoaTransform* _output,
+                      math::SimdFloat4* _accumulated_weights);
+
+  // Applies an additive layer (_transforms deltas with a global _weight and
+  // optional per-joint _joint_weights) to _output.
+  void (*add_layer)(const math::SoaTransform* _transforms,
+                    const math::SimdFloat4* _joint_weights,
+                    float _weight,
+                    size_t _num_soa_joints,
+                    math::SoaTransform* _output);
+
+  // Converts _input local-space soa transforms of joints [_from,_to[ to
+  // model-space matrices, according to joints hierarchy described by
+  // _properties. Model-space matrices of parents that are outside of the range
+  // are read from _output.
+  void (*local_to_model)(int _from,
+                         int _to,
+                         const Skeleton::JointProperties* _properties,
+                         const math::SoaTransform* _input,
+                         math::Float4x4* _output);
+};
+
+// Returns kernels compiled for the baseline instruction set.
+const JobKernels* GetBaselineJobKernels();
+
+// Returns kernels compiled for SSE4.1 instruction set, or NULL if the library
+// isn't built with SSE4.1 kernels.
+const JobKernels* GetSSE4_1JobKernels();
+
+// Returns kernels compiled for AVX2 instruction set, or NULL if the library
+// isn't built with AVX2 kernels.
+const JobKernels* GetAVX2JobKernels();
+
+// Returns kernels of the highest instruction set built, up to the one selected
+// by ozz::cpu::GetInstructionSet().
+const JobKernels& GetJobKernels();
+
+// Returns _q, negated if it is opposed to _ref (negative dot product).
+OZZ_INLINE math::SoaQuaternion ShortestPath(const math::SoaQuaternion& _ref,
+                                            const math::SoaQuaternion& _q) {
+  const math::SimdFloat4 dot =
+    _ref.x * _q.x + _ref.y * _q.y + _ref.z * _q.z + _ref.w * _q.w;
+  const math::SimdInt4 sign = math::Sign(dot);
+  const math::SoaQuaternion rotation = {math::Xor(_q.x, sign),
+                                        math::Xor(_q.y, sign),
+                                        math::Xor(_q.z, sign),
+                                        math::Xor(_q.w, sign)};
+  return rotation;
+}
+
+#ifdef OZZ_HAS_AVX2
+// 8-wide version of ShortestPath.
+OZZ_INLINE math::SoaQuaternion8 ShortestPath(const math::SoaQuaternion8& _ref,
+                                             const math::SoaQuaternion8& _q) {
+  const math::SimdFloat8 dot =
+    _ref.x * _q.x + _ref.y * _q.y + _ref.z * _q.z + _ref.w * _q.w;
+  const math::SimdInt8 sign = math::Sign(dot);
+  const math::SoaQuaternion8 rotation = {math::Xor(_q.x, sign),
+                                         math::Xor(_q.y, sign),
+                                         math::Xor(_q.z, sign),
+                                         math::Xor(_q.w, sign)};
+  return rotation;
+}
+#endif  // OZZ_HAS_AVX2
+
+// Macro that defines the process of blending the 1st pass.
+#define OZZ_BLEND_1ST_PASS(_in, _simd_weight, _out) { \
+  _out->translation = _in.translation * _simd_weight; \
+  _out->rotation = _in.rotation * _simd_weight; \
+  _out->scale = _in.scale * _simd_weight; \
+}
+
+// Macro that defines the process of blending any pass but the first.
+#define OZZ_BLEND_N_PASS(_in, _simd_weight, _out) { \
+  /* Blends translation. */ \
+  _out->translation = _out->translation + _in.translation * _simd_weight; \
+  /* Blends rotations, negates opposed quaternions to be sure to choose*/ \
+  /* the shortest path between the two.*/ \
+  _out->rotation = _out->rotation + \
+    internal::ShortestPath(_out->rotation, _in.rotation) * _simd_weight; \
+  /* Blends scales.*/ \
+  _out->scale = _out->scale + _in.scale * _simd_weight; \
+}
+
+// Macro that defines the process of applying an additive pass. Deltas are
+// weighted toward identity: translation is added, rotation is pre-multiplied
+// and scale is multiplied. _one must be a SimdFloat4 of 1.f.
+#define OZZ_ADD_PASS(_in, _simd_weight, _one, _out) { \
+  /* Adds translation. */ \
+  _out->translation = _out->translation + _in.translation * _simd_weight; \
+  /* Rotates by the delta rotation, nlerped from identity. The delta is*/ \
+  /* negated if needed to take the shortest path from identity.*/ \
+  const math::SimdInt4 sign = math::Sign(_in.rotation.w); \
+  const math::SoaQuaternion rotation = { \
+    math::Xor(_in.rotation.x, sign) * _simd_weight, \
+    math::Xor(_in.rotation.y, sign) * _simd_weight, \
+    math::Xor(_in.rotation.z, sign) * _simd_weight, \
+    (math::Xor(_in.rotation.w, sign) - _one) * _simd_weight + _one}; \
+  _out->rotation = NormalizeEst(rotation) * _out->rotation; \
+  /* Scales by the delta scale, lerped from one.*/ \
+  const math::SoaFloat3 scale = { \
+    (_in.scale.x - _one) * _simd_weight + _one, \
+    (_in.scale.y - _one) * _simd_weight + _one, \
+    (_in.scale.z - _one) * _simd_weight + _one}; \
+  _out->scale = _out->scale * scale; \
+}
+
+}  // internal
+}  // animation
+}  // ozz
+#endif  // OZZ_ANIMATION_RUNTIME_JOB_KERNELS_H_
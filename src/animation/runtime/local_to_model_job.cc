@@ -39,9 +39,20 @@
 
 #include "ozz/animation/runtime/skeleton.h"
 
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "../runtime/job_kernels.h"
+
 namespace ozz {
 namespace animation {
 
+LocalToModelJob::LocalToModelJob()
+    : skeleton(NULL),
+      from(0),
+      to(Skeleton::kMaxJoints),
+      root(Skeleton::kNoParentIndex) {
+}
+
 bool LocalToModelJob::Validate() const {
   // Don't need any early out, as jobs are valid in most of the performance
   // critical cases.
@@ -62,21 +73,25 @@ bool LocalToModelJob::Validate() const {
   valid &= input.end - input.begin >= num_soa_joints;
   valid &= output.end - output.begin >= num_joints;
 
+  // Test joints range.
+  valid &= from >= 0;
+  valid &= to >= from;
+
+  // Test subtree root joint.
+  valid &= root == Skeleton::kNoParentIndex ||
+           (root >= 0 && root < num_joints);
+
   return valid;
 }
 
 bool LocalToModelJob::Run() const {
-  using math::SoaTransform;
-  using math::SoaFloat4x4;
-  using math::Float4x4;
-
   if (!Validate()) {
     return false;
   }
 
-  // Early out if no joint.
-  const int num_joints = skeleton->num_joints();
-  if (num_joints == 0) {
+  // Early out if no joint to process.
+  const int end = math::Min(to, skeleton->num_joints());
+  if (from >= end) {
     return true;
   }
 
@@ -84,40 +99,45 @@ bool LocalToModelJob::Run() const {
   Range<const Skeleton::JointProperties> properties =
     skeleton->joint_properties();
 
-  // Output.
-  Float4x4* const model_matrices = output.begin;
-
-  // Initializes an identity matrix that will be used to compute roots model
-  // matrices without requiring a branch.
-  const Float4x4 identity = Float4x4::identity();
-
-  // Converts to matrices and applies hierarchical transformation.
-  for (int joint = 0; joint < num_joints;) {
-    // Builds soa matrices from soa transforms.
-    const SoaTransform& transform = input.begin[joint / 4];
-    const SoaFloat4x4 local_soa_matrices =
-      SoaFloat4x4::FromAffine(transform.translation,
-                              transform.rotation,
-                              transform.scale);
-    // Converts to aos matrices.
-    math::SimdFloat4 local_aos_matrices[16];
-    math::Transpose16x16(&local_soa_matrices.cols[0].x, local_aos_matrices);
-
-    // Applies hierarchical transformation.
-    const int proceed_up_to = joint + math::Min(4, num_joints - joint);
-    const math::SimdFloat4* local_aos_matrix = local_aos_matrices;
-    for (; joint < proceed_up_to; ++joint, local_aos_matrix += 4) {
-      const int parent = properties.begin[joint].parent;
-      const Float4x4* parent_matrix =
-        math::Select(parent == Skeleton::kNoParentIndex,
-                     &identity,
-                     &model_matrices[parent]);
-      const Float4x4 local_matrix = {{local_aos_matrix[0],
-                                      local_aos_matrix[1],
-                                      local_aos_matrix[2],
-                                      local_aos_matrix[3]}};
-      model_matrices[joint] = (*parent_matrix) * local_matrix;
-    }
+  const internal::JobKernels& kernels = internal::GetJobKernels();
+
+  // Converts to matrices and applies hierarchical transformation, with the
+  // kernel of the selected instruction set.
+  if (root == Skeleton::kNoParentIndex) {
+    kernels.local_to_model(from, end, properties.begin, input.begin,
+                           output.begin);
+    return true;
+  }
+
+  // Processes root joint first, whose parent matrix is read from the output.
+  if (root >= from && root < end) {
+    kernels.local_to_model(root, root + 1, properties.begin, input.begin,
+                           output.begin);
+  }
+  if (properties[root].is_leaf) {
+    return true;
+  }
+
+  // Siblings are stored contiguously, followed by their descendants sorted by
+  // sibling. So all root descendants are stored contiguously from its first
+  // child, and a joint belongs to them if its parent is root or a previous
+  // descendant. The first child follows the subtrees of root's previous
+  // siblings, which are scanned over.
+  int first_child = root + 1;
+  for (; first_child < end && properties[first_child].parent != root;
+       ++first_child) {
+  }
+  int last_descendant = first_child;
+  for (; last_descendant < end &&
+         (properties[last_descendant].parent == root ||
+          properties[last_descendant].parent >= first_child);
+       ++last_descendant) {
+  }
+
+  const int first = math::Max(first_child, from);
+  if (first < last_descendant) {
+    kernels.local_to_model(first, last_descendant, properties.begin,
+                           input.begin, output.begin);
   }
   return true;
 }
@@ -0,0 +1,82 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_ANIMATION_RUNTIME_PACKED_BITS_H_
+#define OZZ_ANIMATION_RUNTIME_PACKED_BITS_H_
+
+#ifndef OZZ_INCLUDE_PRIVATE_HEADER
+#error "This header is private, it cannot be included from public headers."
+#endif  // OZZ_INCLUDE_PRIVATE_HEADER
+
+// Declares bit-packing functions, shared by animations that store quantized
+// values with an arbitrary number of bits. Bits are packed from the least
+// significant bit of the first byte, so packed buffers don't depend on the
+// platform endianness.
+
+#include <cstddef>
+
+#include "ozz/base/platform.h"
+
+namespace ozz {
+namespace animation {
+namespace internal {
+
+// Number of padding bytes required at the end of a packed buffer, so that
+// ReadBits can read its last value.
+const int kPackedPaddingBytes = 2;
+
+// Returns the size in bytes of a buffer that packs _count values of _bits bits,
+// including padding.
+inline size_t PackedSize(size_t _count, int _bits) {
+  return (_count * _bits + 7) / 8 + kPackedPaddingBytes;
+}
+
+// Reads the _bits bits unsigned integer at bit _offset of _buffer. _bits must
+// be in range ]0,16], and _buffer must be readable up to 2 bytes after the
+// byte containing _offset bit.
+OZZ_INLINE int ReadBits(const uint8_t* _buffer, int _offset, int _bits) {
+  const uint8_t* bytes = _buffer + (_offset >> 3);
+  const uint32_t word = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16);
+  return static_cast<int>((word >> (_offset & 7)) & ((1u << _bits) - 1));
+}
+
+// Writes the _bits low bits of _value at bit *_offset of _buffer, and moves
+// *_offset passed them. _buffer is expected to be zeroed.
+inline void WriteBits(uint8_t* _buffer, int* _offset, int _value, int _bits) {
+  for (int b = 0; b < _bits; ++b, ++*_offset) {
+    if (_value & (1 << b)) {
+      _buffer[*_offset >> 3] |= static_cast<uint8_t>(1 << (*_offset & 7));
+    }
+  }
+}
+}  // internal
+}  // animation
+}  // ozz
+#endif  // OZZ_ANIMATION_RUNTIME_PACKED_BITS_H_
@@ -0,0 +1,239 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/sampling_blending_job.h"
+
+#include <cstddef>
+#include <cassert>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/maths/soa_transform.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "../runtime/animation_keyframe.h"
+#include "../runtime/animation_time.h"
+#include "../runtime/blending_stages.h"
+#include "../runtime/job_kernels.h"
+
+namespace ozz {
+namespace animation {
+
+SamplingBlendingJob::Layer::Layer()
+    : animation(NULL),
+      cache(NULL),
+      time(0.f),
+      loop(false),
+      weight(0.f),
+      joint_weights(NULL),
+      joint_weights_size(0) {
+}
+
+SamplingBlendingJob::SamplingBlendingJob()
+    : threshold(.1f),
+      scratch(NULL),
+      scratch_size(0) {
+}
+
+bool SamplingBlendingJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for valid threshold).
+  valid &= threshold > 0.f;
+
+  // Test for NULL begin pointers.
+  valid &= layers.begin != NULL;
+  valid &= bind_pose.begin != NULL;
+  valid &= output.begin != NULL;
+
+  // Test ranges are valid (implicitly test for NULL end pointers).
+  valid &= layers.end >= layers.begin;
+  valid &= bind_pose.end >= bind_pose.begin;
+  valid &= output.end >= output.begin;
+
+  // The bind pose size defines the ranges of transforms to blend, so all
+  // other buffers should be bigger.
+  const ptrdiff_t min_range = bind_pose.end - bind_pose.begin;
+  valid &= output.end - output.begin >= min_range;
+
+  // Blended joints are tracked in a fixed size set.
+  valid &= min_range <= Skeleton::kMaxSoAJoints;
+
+  // Scratch buffer is optional, up to BlendingJob::kMaxStackSoAJoints.
+  if (scratch != NULL) {
+    valid &= scratch_size >= min_range;
+  } else {
+    valid &= min_range <= BlendingJob::kMaxStackSoAJoints;
+  }
+
+  // Validates layers.
+  for (const Layer* layer = layers.begin;
+       layers.begin && layer < layers.end;  // Handles NULL pointers.
+       ++layer) {
+    // Tests animation and cache validity.
+    if (!layer->animation || !layer->cache) {
+      valid = false;
+      continue;
+    }
+    const int num_soa_tracks = layer->animation->num_soa_tracks();
+    valid &= num_soa_tracks >= min_range;
+    valid &= layer->cache->max_soa_tracks() >= num_soa_tracks;
+
+    // Joint weights are optional.
+    if (layer->joint_weights != NULL) {
+      valid &= layer->joint_weights_size >= min_range;
+    }
+  }
+
+  return valid;
+}
+
+namespace {
+// Number of soa joints interpolated at once, before being blended to the
+// output. This is small enough for the interpolated transforms to remain in
+// the L1 cache until they are blended (16 * 160 bytes).
+const size_t kBatchSize = 16;
+}  // namespace
+
+bool SamplingBlendingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const internal::JobKernels& kernels = internal::GetJobKernels();
+
+  // Per-joint weights are accumulated to the scratch buffer, or to a stack
+  // buffer if there's none.
+  math::SimdFloat4 stack_weights[BlendingJob::kMaxStackSoAJoints];
+  math::SimdFloat4* accumulated_weights =
+    scratch ? scratch : stack_weights;
+
+  // Initializes blended parameters that are exchanged accross blend stages.
+  internal::BlendingArgs process_args(
+    threshold, bind_pose, output, accumulated_weights);
+  const size_t num_soa_joints = process_args.num_soa_joints;
+  if (num_soa_joints == 0) {  // Early out if there's no joint to blend.
+    return true;
+  }
+
+  // Interpolated transforms of a batch of joints, blended straight away.
+  math::SoaTransform batch[kBatchSize];
+
+  // Sampling mask of the soa tracks that are blended. Animations with more
+  // tracks are entirely decompressed.
+  bool track_mask[BlendingJob::kMaxStackSoAJoints];
+
+  // Iterates through all layers, sample and blend them to the output.
+  for (const Layer* layer = layers.begin; layer < layers.end; ++layer) {
+    // Skip irrelevant layers, they don't even need to be sampled.
+    if (layer->weight <= 0.f) {
+      continue;
+    }
+
+    // Accumulates global weights.
+    process_args.accumulated_weight += layer->weight;
+
+    if (layer->joint_weights) {
+      // This layer has per-joint weights.
+      ++process_args.num_partial_passes;
+    }
+
+    // Builds the ranges of soa joints to blend, skipping the ones whose
+    // joint weights are all zero.
+    internal::LayerRanges ranges(&process_args, layer->joint_weights);
+
+    // Fetches and decompresses key frames required to sample at t = anim_time.
+    // Only the soa tracks that are blended are decompressed, using the
+    // sampling mask.
+    const Animation& animation = *layer->animation;
+    const int num_soa_tracks = animation.num_soa_tracks();
+    const bool* mask = NULL;
+    if (num_soa_tracks <= BlendingJob::kMaxStackSoAJoints &&
+        (layer->joint_weights ||
+         num_soa_tracks > static_cast<int>(num_soa_joints))) {
+      for (int i = 0; i < num_soa_tracks; ++i) {
+        track_mask[i] = static_cast<size_t>(i) < num_soa_joints &&
+                        (!layer->joint_weights ||
+                         internal::HasWeight(layer->joint_weights[i]));
+      }
+      mask = track_mask;
+    }
+    const float anim_time =
+      internal::AnimationTime(layer->time, animation.duration(), layer->loop);
+    SamplingCache* cache = layer->cache;
+    cache->Update(animation, anim_time, mask);
+    const float key_time = ToKeyTime(anim_time, animation.duration(),
+                                     animation.wide_key_times());
+
+    // Interpolates and blends the layer ranges by batches of joints.
+    size_t begin, end;
+    bool first_pass;
+    while (ranges.Next(&begin, &end, &first_pass)) {
+      for (size_t i = begin; i < end; i += kBatchSize) {
+        const size_t count = math::Min(kBatchSize, end - i);
+        kernels.interpolate(key_time,
+                            static_cast<int>(count),
+                            cache->soa_translations_ + i,
+                            cache->soa_rotations_ + i,
+                            cache->soa_scales_ + i,
+                            NULL,
+                            batch);
+        kernels.blend_layer(batch,
+                            layer->joint_weights ?
+                              layer->joint_weights + i : NULL,
+                            layer->weight,
+                            first_pass,
+                            count,
+                            process_args.output + i,
+                            process_args.accumulated_weights + i);
+      }
+    }
+
+    // One more pass blended.
+    ++process_args.num_passes;
+  }
+
+  // Applies bind pose.
+  internal::BlendBindPose(&process_args);
+
+  // Normalizes output.
+  internal::Normalize(&process_args);
+
+  return true;
+}
+}  // animation
+}  // ozz
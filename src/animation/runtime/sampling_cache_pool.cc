@@ -0,0 +1,150 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/sampling_cache_pool.h"
+
+#include <cassert>
+
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace animation {
+
+SamplingCachePool::SamplingCachePool(int _num_caches, int _max_tracks)
+    : entries_(NULL),
+      num_caches_(_num_caches),
+      front_(-1),
+      back_(-1) {
+  assert(_num_caches > 0);
+  memory::Allocator* allocator = memory::default_allocator();
+  entries_ = allocator->Allocate<Entry>(num_caches_);
+  for (int i = 0; i < num_caches_; ++i) {
+    Entry& entry = entries_[i];
+    entry.cache = allocator->New<SamplingCache>(_max_tracks);
+    entry.assignment = 0;
+    entry.previous = i - 1;
+    entry.next = i + 1 < num_caches_ ? i + 1 : -1;
+  }
+  front_ = num_caches_ > 0 ? 0 : -1;
+  back_ = num_caches_ - 1;
+}
+
+SamplingCachePool::~SamplingCachePool() {
+  memory::Allocator* allocator = memory::default_allocator();
+  for (int i = 0; i < num_caches_; ++i) {
+    allocator->Delete(entries_[i].cache);
+  }
+  allocator->Deallocate(entries_);
+}
+
+int SamplingCachePool::max_tracks() const {
+  return entries_[0].cache->max_tracks();
+}
+
+bool SamplingCachePool::assigned(const Handle& _handle) const {
+  return _handle.cache >= 0 && _handle.cache < num_caches_ &&
+         entries_[_handle.cache].assignment == _handle.assignment;
+}
+
+SamplingCache* SamplingCachePool::Acquire(Handle* _handle) {
+  assert(_handle);
+  if (assigned(*_handle)) {
+    MoveToFront(_handle->cache);
+    return entries_[_handle->cache].cache;
+  }
+
+  // Evicts the least recently used cache. Its assignment number changes, so
+  // the handle it was assigned to doesn't match anymore.
+  const int index = back_;
+  Entry& entry = entries_[index];
+  if (++entry.assignment == 0) {  // 0 is never used, as Handle defaults to it.
+    ++entry.assignment;
+  }
+  entry.cache->Invalidate();
+  MoveToFront(index);
+
+  _handle->cache = index;
+  _handle->assignment = entry.assignment;
+  return entry.cache;
+}
+
+void SamplingCachePool::Release(Handle* _handle) {
+  assert(_handle);
+  if (assigned(*_handle)) {
+    Entry& entry = entries_[_handle->cache];
+    if (++entry.assignment == 0) {
+      ++entry.assignment;
+    }
+    entry.cache->Invalidate();
+    MoveToBack(_handle->cache);
+  }
+  *_handle = Handle();
+}
+
+void SamplingCachePool::Unlink(int _index) {
+  Entry& entry = entries_[_index];
+  if (entry.previous >= 0) {
+    entries_[entry.previous].next = entry.next;
+  } else {
+    front_ = entry.next;
+  }
+  if (entry.next >= 0) {
+    entries_[entry.next].previous = entry.previous;
+  } else {
+    back_ = entry.previous;
+  }
+}
+
+void SamplingCachePool::MoveToFront(int _index) {
+  if (front_ == _index) {
+    return;
+  }
+  Unlink(_index);
+  Entry& entry = entries_[_index];
+  entry.previous = -1;
+  entry.next = front_;
+  entries_[front_].previous = _index;
+  front_ = _index;
+}
+
+void SamplingCachePool::MoveToBack(int _index) {
+  if (back_ == _index) {
+    return;
+  }
+  Unlink(_index);
+  Entry& entry = entries_[_index];
+  entry.previous = back_;
+  entry.next = -1;
+  entries_[back_].next = _index;
+  back_ = _index;
+}
+}  // animation
+}  // ozz
@@ -31,6 +31,7 @@
 #include "ozz/animation/runtime/sampling_job.h"
 
 #include <cassert>
+#include <limits>
 
 #include "ozz/base/maths/math_ex.h"
 #include "ozz/base/maths/soa_transform.h"
@@ -40,25 +41,13 @@
 // Internal include file
 #define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
 #include "../runtime/animation_keyframe.h"
+#include "../runtime/animation_time.h"
+#include "../runtime/job_kernels.h"
+#include "../runtime/packed_bits.h"
 
 namespace ozz {
 namespace animation {
 
-namespace internal {
-struct InterpSoaTranslation {
-  math::SimdFloat4 time[2];
-  math::SoaFloat3 value[2];
-};
-struct InterpSoaRotation {
-  math::SimdFloat4 time[2];
-  math::SoaQuaternion value[2];
-};
-struct InterpSoaScale {
-  math::SimdFloat4 time[2];
-  math::SoaFloat3 value[2];
-};
-}  // internal
-
 bool SamplingJob::Validate() const {
   // Don't need any early out, as jobs are valid in most of the performance
   // critical cases.
@@ -78,51 +67,238 @@ bool SamplingJob::Validate() const {
   // Tests cache size.
   valid &= cache->max_soa_tracks() >= num_soa_tracks;
 
+  // Tests mask range, which is optional.
+  valid &= !mask.begin || mask.end - mask.begin >= num_soa_tracks;
+
   return valid;
 }
 
 namespace {
-// Loops through the sorted key frames and update cache structure.
+// Flags all soa entries as outdated. It cares to only flag valid soa entries as
+// this is the exit condition of other algorithms.
+void OutdateAll(int _num_soa_tracks, unsigned char* _outdated) {
+  const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
+  for (int i = 0; i < num_outdated_flags - 1; ++i) {
+    _outdated[i] = 0xff;
+  }
+  _outdated[num_outdated_flags - 1] =
+    0xff >> (num_outdated_flags * 8 - _num_soa_tracks);
+}
+
+// Sets _track cache keys to _left and _right, and flags its soa entry as
+// outdated if they changed.
+void SetKeys(int _track, int _left, int _right,
+             int* _cache, unsigned char* _outdated) {
+  const int base = _track * 2;
+  if (_cache[base] != _left || _cache[base + 1] != _right) {
+    _cache[base] = _left;
+    _cache[base + 1] = _right;
+    _outdated[_track / 32] |= (1 << ((_track & 0x1f) / 4));
+  }
+}
+
+// Restores cache keys from the seek index entry _seek, or initializes them with
+// the first 2 sets of key frames if _seek is NULL. Returns the new cursor.
+// _num_animated is the number of animated (non-constant) tracks.
+// Only the soa entries whose keys changed are outdated, so rewinding a looping
+// animation doesn't decompress again the tracks that have the same keys. Soa
+// entries of an invalid cache are already all outdated, see
+// SamplingCache::Step.
+template<typename _Key>
+const _Key* RestoreKeys(int _num_soa_tracks, int _num_animated,
+                        ozz::Range<const _Key> _keys,
+                        const int* _seek,
+                        int* _cache, unsigned char* _outdated) {
+  const int num_tracks = _num_soa_tracks * 4;
+  if (_seek) {
+    for (int i = 0; i < num_tracks; ++i) {
+      SetKeys(i, _seek[i * 2 + 1], _seek[i * 2 + 2], _cache, _outdated);
+    }
+    return _keys.begin + _seek[0];
+  }
+
+  // Initializes interpolated entries with the first 2 sets of key frames,
+  // made of a key per animated track, sorted by track. The sorting algorithm
+  // ensures that the first 2 key frames of a track are consecutive. Constant
+  // tracks refer to the first 2 keys, as they're decompressed along with the
+  // other tracks of their soa element.
+  for (int i = 0, key = 0; i < num_tracks; ++i) {
+    if (key < _num_animated && _keys.begin[key].track == i) {
+      SetKeys(i, key, key + _num_animated, _cache, _outdated);  // 2nd row.
+      ++key;
+    } else {
+      SetKeys(i, 0, _num_animated, _cache, _outdated);
+    }
+  }
+  return _keys.begin + _num_animated * 2;
+}
+
+// Returns the index of the first key of _track, which must be animated. First
+// set of key frames is made of _num_animated keys sorted by track.
+template<typename _Key>
+int FirstKey(ozz::Range<const _Key> _keys, int _num_animated, int _track) {
+  int first = 0;
+  for (int count = _num_animated; count > 0;) {
+    const int step = count / 2;
+    if (_keys.begin[first + step].track < _track) {
+      first += step + 1;
+      count -= step + 1;
+    } else {
+      count = step;
+    }
+  }
+  assert(first < _num_animated && _keys.begin[first].track == _track);
+  return first;
+}
+
+// Finds the left key of the _pending tracks whose left key was reset to -1 by
+// a backward step. Iterates keys backward from _cursor, down to _seek entry
+// cursor (or to the first 2 sets of key frames if _seek is NULL). A track that
+// has no key in this range gets its left key from _seek entry.
+// Iterates at most *_budget keys, which is decremented accordingly. Returns
+// false if the budget is exhausted before all keys are found, leaving _cache
+// in an invalid state.
+template<typename _Key>
+bool ResolvePendingKeys(int _num_tracks, int _num_animated,
+                        ozz::Range<const _Key> _keys,
+                        const int* _seek,
+                        const _Key* _cursor,
+                        int _pending,
+                        int* _cache,
+                        int* _budget) {
+  const int seek_cursor = _seek ? _seek[0] : _num_animated * 2;
+  for (const _Key* key = _cursor - 1;
+       _pending && key >= _keys.begin + seek_cursor;
+       --key) {
+    if (--*_budget < 0) {
+      return false;
+    }
+    const int base = key->track * 2;
+    const int index = static_cast<int>(key - _keys.begin);
+    if (_cache[base] < 0 && index < _cache[base + 1]) {
+      _cache[base] = index;
+      --_pending;
+    }
+  }
+
+  // Remaining tracks have no key in range [seek cursor, right key[. Their left
+  // key is seek entry's right key if their right key is after seek cursor, or
+  // seek entry's left key otherwise (right keys are then the same).
+  for (int i = 0; _pending && i < _num_tracks; ++i) {
+    const int base = i * 2;
+    if (_cache[base] >= 0) {
+      continue;
+    }
+    if (_cache[base + 1] >= seek_cursor) {
+      _cache[base] = _seek ?
+        _seek[base + 2] : _num_animated + FirstKey(_keys, _num_animated, i);
+    } else {
+      _cache[base] =
+        _seek ? _seek[base + 1] : FirstKey(_keys, _num_animated, i);
+    }
+    --_pending;
+  }
+  assert(!_pending);
+  return true;
+}
+
+// Steps cache keys backward to _time (in key time units), by removing from the
+// cache the keys that are after _time, from *_cursor down to _seek entry
+// cursor. _highs is the buffer of keys time high bits, or NULL if key times
+// aren't wide.
+// Returns false if too many keys need to be removed or iterated to find the
+// new left keys, in which case it's more efficient to restore the cache from
+// the seek index. The cost of a backward step is thus bounded by the number of
+// animated tracks, whether the animation has a seek index or not. The cache is
+// left in an invalid state in this case, but soa entries whose keys were
+// changed are flagged outdated.
+template<typename _Key>
+bool StepKeysBackward(float _time, int _num_soa_tracks, int _num_animated,
+                      ozz::Range<const _Key> _keys,
+                      const uint8_t* _highs,
+                      const int* _seek,
+                      const _Key** _cursor,
+                      int* _cache, unsigned char* _outdated) {
+  const int num_tracks = _num_soa_tracks * 4;
+  const _Key* seek_cursor =
+    _keys.begin + (_seek ? _seek[0] : _num_animated * 2);
+
+  // Iterates while the key before the cursor was pushed to the cache after
+  // _time, aka while the left key of its track is after _time. The key before
+  // the cursor is always the right key of its track. Left key of the track
+  // becomes the right one, while the new left key is flagged pending (-1) as
+  // it's not known yet.
+  const _Key* cursor = *_cursor;
+  int pending = 0;
+  int removed = 0;
+  int budget = _num_animated * 2;
+  while (cursor > seek_cursor) {
+    const _Key* key = cursor - 1;
+    const int base = key->track * 2;
+    assert(_cache[base + 1] == static_cast<int>(key - _keys.begin));
+    if (_cache[base] < 0) {
+      // This track was already stepped back, its left key must be known.
+      if (!ResolvePendingKeys(num_tracks, _num_animated, _keys, _seek, cursor,
+                              pending, _cache, &budget)) {
+        return false;
+      }
+      pending = 0;
+    }
+    if (KeyTime(_keys.begin, _highs, _cache[base]) <= _time) {
+      break;
+    }
+    if (++removed > _num_animated * 2) {
+      return false;
+    }
+    // Flag this soa entry as outdated.
+    _outdated[key->track / 32] |= (1 << ((key->track & 0x1f) / 4));
+    // Updates cache.
+    _cache[base + 1] = _cache[base];
+    _cache[base] = -1;
+    ++pending;
+    // Process previous key.
+    --cursor;
+  }
+  if (!ResolvePendingKeys(num_tracks, _num_animated, _keys, _seek, cursor,
+                          pending, _cache, &budget)) {
+    return false;
+  }
+
+  *_cursor = cursor;
+  return true;
+}
+
+// Loops through the sorted key frames and update cache structure. _time is in
+// key time units, _highs the buffer of keys time high bits (or NULL).
+// _seek is the seek index entry the closest to _time (but not after), or NULL
+// if there's none. The cache is restored from _seek entry if it's invalid or
+// too far from _time, otherwise it's stepped backward or forward to _time.
 template<typename _Key>
-void UpdateKeys(float _time, int _num_soa_tracks,
+void UpdateKeys(float _time, int _num_soa_tracks, int _num_animated,
                 ozz::Range<const _Key> _keys,
+                const uint8_t* _highs,
+                const int* _seek,
                 int* _cursor,
                 int* _cache, unsigned char* _outdated) {
     assert(_num_soa_tracks >= 1);
-    const int num_tracks = _num_soa_tracks * 4;
-    assert(_keys.begin + num_tracks * 2 <= _keys.end);
+    assert(_keys.begin + _num_animated * 2 <= _keys.end);
 
-    const _Key* cursor = &_keys.begin[*_cursor];
-    if (!*_cursor) {
-      // Initializes interpolated entries with the first 2 sets of key frames.
-      // The sorting algorithm ensures that the first 2 key frames of a track
-      // are consecutive.
-      for (int i = 0; i < _num_soa_tracks; ++i) {
-        const int in_index0 = i * 4;  // * soa size
-        const int in_index1 = in_index0 + num_tracks;  // 2nd row.
-        const int out_index = i * 4 * 2;   
-        _cache[out_index + 0] = in_index0 + 0;
-        _cache[out_index + 1] = in_index1 + 0;
-        _cache[out_index + 2] = in_index0 + 1;
-        _cache[out_index + 3] = in_index1 + 1;
-        _cache[out_index + 4] = in_index0 + 2;
-        _cache[out_index + 5] = in_index1 + 2;
-        _cache[out_index + 6] = in_index0 + 3;
-        _cache[out_index + 7] = in_index1 + 3;
-      }
-      cursor = _keys.begin + num_tracks * 2;  // New cursor position.
+    // Early out if all tracks are constant, as there's no key to update.
+    if (!_num_animated) {
+      return;
+    }
 
-      // All entries are outdated. It cares to only flag valid soa entries as
-      // this is the exit condition of other algorithms.
-      const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
-      for (int i = 0; i < num_outdated_flags - 1; ++i) {
-        _outdated[i] = 0xff;
-      }
-      _outdated[num_outdated_flags - 1] =
-        0xff >> (num_outdated_flags * 8 - _num_soa_tracks);
-    } else {
-      assert(cursor >= _keys.begin + num_tracks * 2 && cursor <= _keys.end);
+    const _Key* cursor = &_keys.begin[*_cursor];
+    const int seek_cursor = _seek ? _seek[0] : _num_animated * 2;
+    if (!*_cursor ||  // The cache is invalid.
+        // Seek entry is ahead of the cache by more than 2 sets of key frames.
+        seek_cursor - *_cursor > _num_animated * 2 ||
+        !StepKeysBackward(_time, _num_soa_tracks, _num_animated, _keys,
+                          _highs, _seek, &cursor, _cache, _outdated)) {
+      cursor = RestoreKeys(_num_soa_tracks, _num_animated, _keys, _seek,
+                           _cache, _outdated);
     }
+    assert(cursor >= _keys.begin + _num_animated * 2 && cursor <= _keys.end);
 
     // Search for the keys that matches _time.
     // Iterates while the cache is not updated with left and right keys required
@@ -131,7 +307,8 @@ void UpdateKeys(float _time, int _num_soa_tracks,
     // It will mean that all the keys lower than _time have been processed,
     // meaning all cache entries are updated. 
     while (cursor < _keys.end &&
-           _keys.begin[_cache[cursor->track * 2 + 1]].time <= _time) {
+           KeyTime(_keys.begin, _highs,
+                   _cache[cursor->track * 2 + 1]) <= _time) {
       // Flag this soa entry as outdated.
       _outdated[cursor->track / 32] |= (1 << ((cursor->track & 0x1f) / 4));
       // Updates cache.
@@ -147,70 +324,242 @@ void UpdateKeys(float _time, int _num_soa_tracks,
     *_cursor = static_cast<int>(cursor - _keys.begin);
 }
 
+// Packs _mask entries of soa tracks [_flags * 8, _flags * 8 + 8[ in a byte,
+// using the same format as outdated flags. All tracks are enabled if _mask is
+// NULL.
+unsigned char MaskFlags(const bool* _mask, int _num_soa_tracks, int _flags) {
+  if (!_mask) {
+    return 0xff;
+  }
+  unsigned char flags = 0;
+  const int end = math::Min(_flags * 8 + 8, _num_soa_tracks);
+  for (int i = _flags * 8, bit = 1; i < end; ++i, bit <<= 1) {
+    flags |= _mask[i] ? bit : 0;
+  }
+  return flags;
+}
+
+// Overwrites _value lanes selected by _mask with _constant ones.
+void SelectConstant(math::_SimdInt4 _mask,
+                    const math::SoaFloat3& _constant,
+                    math::SoaFloat3* _value) {
+  _value->x = math::Select(_mask, _constant.x, _value->x);
+  _value->y = math::Select(_mask, _constant.y, _value->y);
+  _value->z = math::Select(_mask, _constant.z, _value->z);
+}
+
+void SelectConstant(math::_SimdInt4 _mask,
+                    const math::SoaQuaternion& _constant,
+                    math::SoaQuaternion* _value) {
+  _value->x = math::Select(_mask, _constant.x, _value->x);
+  _value->y = math::Select(_mask, _constant.y, _value->y);
+  _value->z = math::Select(_mask, _constant.z, _value->z);
+  _value->w = math::Select(_mask, _constant.w, _value->w);
+}
+
+// Writes _constant value to the lanes of _interp soa entry that are flagged
+// constant in _flags. If all lanes are constant, keys weren't decompressed so
+// times are also set, such that interpolation outputs _constant.
+template<typename _Interp, typename _Value>
+void UpdateSoaConstants(int _flags, const _Value& _constant,
+                        _Interp* _interp) {
+  if (_flags == 0xf) {
+    _interp->time[0] = math::simd_float4::zero();
+    _interp->time[1] = math::simd_float4::one();
+    _interp->value[0] = _constant;
+    _interp->value[1] = _constant;
+  } else {
+    const math::SimdInt4 mask = math::simd_int4::Load(
+      (_flags & 1) != 0, (_flags & 2) != 0, (_flags & 4) != 0,
+      (_flags & 8) != 0);
+    SelectConstant(mask, _constant, &_interp->value[0]);
+    SelectConstant(mask, _constant, &_interp->value[1]);
+  }
+}
+
+// Decompresses the times of the 4 keys of _keys referenced by _interp (with a
+// stride of 2) to key time units. _highs is the buffer of keys time high bits,
+// or NULL if key times aren't wide.
+template<typename _Key>
+OZZ_INLINE math::SimdFloat4 DecompressKeyTimes(ozz::Range<const _Key> _keys,
+                                               const uint8_t* _highs,
+                                               const int* _interp) {
+  const math::SimdInt4 time =
+    math::simd_int4::Load(_keys.begin[_interp[0]].time,
+                          _keys.begin[_interp[2]].time,
+                          _keys.begin[_interp[4]].time,
+                          _keys.begin[_interp[6]].time);
+  if (!_highs) {
+    return math::simd_float4::FromInt(time);
+  }
+  const math::SimdInt4 high =
+    math::simd_int4::Load(_highs[_interp[0]], _highs[_interp[2]],
+                          _highs[_interp[4]], _highs[_interp[6]]);
+  return math::simd_float4::FromInt(math::Or(time, math::ShiftL(high, 16)));
+}
+
+// Decompresses the values of the 4 keys referenced by _interp (with a stride of
+// 2) to soa _value. Values are read from _values buffer, packed with _bits bits
+// per component, and restored with a single multiply-add using quantization
+// range _min and _step.
+OZZ_INLINE void DecompressValues(const uint8_t* _values, int _bits,
+                                 const int* _interp,
+                                 const math::SoaFloat3& _min,
+                                 const math::SoaFloat3& _step,
+                                 math::SoaFloat3* _value) {
+  int quantized[3][4];
+  for (int l = 0; l < 4; ++l) {
+    const int offset = _interp[l * 2] * 3 * _bits;
+    for (int c = 0; c < 3; ++c) {
+      quantized[c][l] =
+        internal::ReadBits(_values, offset + c * _bits, _bits);
+    }
+  }
+  _value->x = math::MAdd(
+    math::simd_float4::FromInt(math::simd_int4::LoadPtrU(quantized[0])),
+    _step.x, _min.x);
+  _value->y = math::MAdd(
+    math::simd_float4::FromInt(math::simd_int4::LoadPtrU(quantized[1])),
+    _step.y, _min.y);
+  _value->z = math::MAdd(
+    math::simd_float4::FromInt(math::simd_int4::LoadPtrU(quantized[2])),
+    _step.z, _min.z);
+}
+
 void UpdateSoaTranslations(int _num_soa_tracks,
                            ozz::Range<const TranslationKey> _keys,
+                           const uint8_t* _highs,
+                           ozz::Range<const math::SoaFloat3> _ranges,
+                           const uint8_t* _values,
+                           int _bits,
+                           ozz::Range<const uint8_t> _constant_flags,
+                           ozz::Range<const math::SoaFloat3> _constants,
                            const int* _interp,
+                           const bool* _mask,
                            unsigned char* _outdated,
                            internal::InterpSoaTranslation* soa_translations_) {
   const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
   for (int j = 0; j < num_outdated_flags; ++j) {
-    unsigned char outdated = _outdated[j];
-    _outdated[j] = 0;  // Reset outdated entries as all will be processed.
+    // Masked out entries are not processed, so they remain outdated.
+    unsigned char outdated =
+      _outdated[j] & MaskFlags(_mask, _num_soa_tracks, j);
+    _outdated[j] &= ~outdated;  // Reset outdated entries that are processed.
     for (int i = j * 8; outdated; ++i, outdated >>= 1) {
       if (!(outdated & 1)) {
         continue;
       }
+
+      // Soa entries whose tracks are all constant have no key.
+      const int constant_flags =
+        _constant_flags.begin ? _constant_flags.begin[i] : 0;
+      if (constant_flags == 0xf) {
+        UpdateSoaConstants(constant_flags, _constants.begin[i],
+                           &soa_translations_[i]);
+        continue;
+      }
       const int base = i * 4 * 2;  // * soa size * 2 keys
 
+      // Quantization range of the soa entry.
+      const math::SoaFloat3& min = _ranges.begin[i * 2 + 0];
+      const math::SoaFloat3& step = _ranges.begin[i * 2 + 1];
+
       // Decompress left side keyframes and store them in soa structures.
-      const TranslationKey& k00 = _keys.begin[_interp[base + 0]];
-      const TranslationKey& k10 = _keys.begin[_interp[base + 2]];
-      const TranslationKey& k20 = _keys.begin[_interp[base + 4]];
-      const TranslationKey& k30 = _keys.begin[_interp[base + 6]];
-      soa_translations_[i].time[0] = math::simd_float4::Load(
-        k00.time, k10.time, k20.time, k30.time);
-      soa_translations_[i].value[0].x = math::HalfToFloat(math::simd_int4::Load(
-        k00.value[0], k10.value[0], k20.value[0], k30.value[0]));
-      soa_translations_[i].value[0].y = math::HalfToFloat(math::simd_int4::Load(
-        k00.value[1], k10.value[1], k20.value[1], k30.value[1]));
-      soa_translations_[i].value[0].z = math::HalfToFloat(math::simd_int4::Load(
-        k00.value[2], k10.value[2], k20.value[2], k30.value[2]));
+      soa_translations_[i].time[0] =
+        DecompressKeyTimes(_keys, _highs, _interp + base);
+      DecompressValues(_values, _bits, _interp + base, min, step,
+                       &soa_translations_[i].value[0]);
 
       // Decompress right side keyframes and store them in soa structures.
-      const TranslationKey& k01 = _keys.begin[_interp[base + 1]];
-      const TranslationKey& k11 = _keys.begin[_interp[base + 3]];
-      const TranslationKey& k21 = _keys.begin[_interp[base + 5]];
-      const TranslationKey& k31 = _keys.begin[_interp[base + 7]];
-      soa_translations_[i].time[1] = math::simd_float4::Load(
-        k01.time, k11.time, k21.time, k31.time);
-      soa_translations_[i].value[1].x = math::HalfToFloat(math::simd_int4::Load(
-        k01.value[0], k11.value[0], k21.value[0], k31.value[0]));
-      soa_translations_[i].value[1].y = math::HalfToFloat(math::simd_int4::Load(
-        k01.value[1], k11.value[1], k21.value[1], k31.value[1]));
-      soa_translations_[i].value[1].z = math::HalfToFloat(math::simd_int4::Load(
-        k01.value[2], k11.value[2], k21.value[2], k31.value[2]));
+      soa_translations_[i].time[1] =
+        DecompressKeyTimes(_keys, _highs, _interp + base + 1);
+      DecompressValues(_values, _bits, _interp + base + 1, min, step,
+                       &soa_translations_[i].value[1]);
+
+      // Overwrites constant tracks values.
+      if (constant_flags) {
+        UpdateSoaConstants(constant_flags, _constants.begin[i],
+                           &soa_translations_[i]);
+      }
     }
   }
 }
 
+// Decompresses the rotations of keys _k0 to _k3 to soa quaternion _quat. The
+// 3 smallest components are restored first, then the largest one, before all
+// of them are moved to their component according to the key largest index.
+OZZ_INLINE void DecompressRotations(const RotationKey& _k0,
+                                    const RotationKey& _k1,
+                                    const RotationKey& _k2,
+                                    const RotationKey& _k3,
+                                    math::SoaQuaternion* _quat) {
+  const math::SimdFloat4 int_to_float =
+    math::simd_float4::Load1(1.f / kRotationQuantizationScale);
+  const math::SimdFloat4 a = int_to_float * math::simd_float4::FromInt(
+    math::simd_int4::Load(_k0.value[0], _k1.value[0],
+                          _k2.value[0], _k3.value[0]));
+  const math::SimdFloat4 b = int_to_float * math::simd_float4::FromInt(
+    math::simd_int4::Load(_k0.value[1], _k1.value[1],
+                          _k2.value[1], _k3.value[1]));
+  const math::SimdFloat4 c = int_to_float * math::simd_float4::FromInt(
+    math::simd_int4::Load(_k0.value[2], _k1.value[2],
+                          _k2.value[2], _k3.value[2]));
+
+  // Restores the largest component, which is positive and at least 1/2, so
+  // the estimated reciprocal square root refined with a Newton-Raphson step
+  // is accurate.
+  const math::SimdFloat4 ll = math::Max(
+    math::simd_float4::Load1(.25f),
+    math::simd_float4::one() - (a * a + b * b + c * c));
+  const math::SimdFloat4 l = ll * math::RSqrtEstNR(ll);
+
+  // Moves components in place: components before the largest one are stored
+  // at their own index, the ones after it are shifted by one.
+  const math::SimdInt4 largest =
+    math::simd_int4::Load(_k0.largest, _k1.largest,
+                          _k2.largest, _k3.largest);
+  const math::SimdInt4 largest_x =
+    math::CmpEq(largest, math::simd_int4::zero());
+  const math::SimdInt4 largest_y =
+    math::CmpEq(largest, math::simd_int4::one());
+  const math::SimdInt4 largest_z =
+    math::CmpEq(largest, math::simd_int4::Load(2, 2, 2, 2));
+  const math::SimdInt4 largest_w =
+    math::CmpEq(largest, math::simd_int4::Load(3, 3, 3, 3));
+  _quat->x = math::Select(largest_x, l, a);
+  _quat->y = math::Select(largest_y, l, math::Select(largest_x, a, b));
+  _quat->z = math::Select(largest_z, l, math::Select(largest_w, c, b));
+  _quat->w = math::Select(largest_w, l, c);
+}
+
 void UpdateSoaRotations(int _num_soa_tracks,
                         ozz::Range<const RotationKey> _keys,
+                        const uint8_t* _highs,
+                        ozz::Range<const uint8_t> _constant_flags,
+                        ozz::Range<const math::SoaQuaternion> _constants,
                         const int* _interp,
+                        const bool* _mask,
                         unsigned char* _outdated,
                         internal::InterpSoaRotation* soa_rotations_) {
-  const math::SimdFloat4 one = math::simd_float4::one();
-  const math::SimdFloat4 eps = math::simd_float4::Load1(1e-16f);
-  const math::SimdFloat4 int_to_float = math::simd_float4::Load1(1.f / 32767.f);
-
   const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
   for (int j = 0; j < num_outdated_flags; ++j) {
-    unsigned char outdated = _outdated[j];
-    _outdated[j] = 0;  // Reset outdated entries as all will be processed.
+    // Masked out entries are not processed, so they remain outdated.
+    unsigned char outdated =
+      _outdated[j] & MaskFlags(_mask, _num_soa_tracks, j);
+    _outdated[j] &= ~outdated;  // Reset outdated entries that are processed.
     for (int i = j * 8; outdated; ++i, outdated >>= 1) {
       if (!(outdated & 1)) {
         continue;
       }
 
+      // Soa entries whose tracks are all constant have no key.
+      const int constant_flags =
+        _constant_flags.begin ? _constant_flags.begin[i] : 0;
+      if (constant_flags == 0xf) {
+        UpdateSoaConstants(constant_flags, _constants.begin[i],
+                           &soa_rotations_[i]);
+        continue;
+      }
+
       const int base = i * 4 * 2;  // * soa size * 2 keys per track
 
       // Decompress left side keyframes and store them in soa structures.
@@ -218,135 +567,141 @@ void UpdateSoaRotations(int _num_soa_tracks,
       const RotationKey& k10 = _keys.begin[_interp[base + 2]];
       const RotationKey& k20 = _keys.begin[_interp[base + 4]];
       const RotationKey& k30 = _keys.begin[_interp[base + 6]];
-      soa_rotations_[i].time[0] = math::simd_float4::Load(
-        k00.time, k10.time, k20.time, k30.time);
+      soa_rotations_[i].time[0] =
+        DecompressKeyTimes(_keys, _highs, _interp + base);
       math::SoaQuaternion& quat0 = soa_rotations_[i].value[0];
-      quat0.x = int_to_float * math::simd_float4::FromInt(math::simd_int4::Load(
-        k00.value[0], k10.value[0], k20.value[0], k30.value[0]));
-      quat0.y = int_to_float * math::simd_float4::FromInt(math::simd_int4::Load(
-        k00.value[1], k10.value[1], k20.value[1], k30.value[1]));
-      quat0.z = int_to_float * math::simd_float4::FromInt(math::simd_int4::Load(
-        k00.value[2], k10.value[2], k20.value[2], k30.value[2]));
-
-      // Get back sign of w component.
-      const math::SimdInt4 wsign0 = math::simd_int4::Load(
-        k00.wsign, k10.wsign, k20.wsign, k30.wsign);
-      // Get back length of w component. Favors performance over accuracy by
-      // using x * RSqrtEst(x) instead of Sqrt(x).
-      const math::SimdFloat4 ww0 = math::Max(eps,
-        one - (quat0.x * quat0.x + quat0.y * quat0.y + quat0.z * quat0.z));
-      const math::SimdFloat4 w0 = ww0 * math::RSqrtEst(ww0);
-      // Reapply w's sign.
-      quat0.w = math::Select(wsign0, w0, -w0);
+      DecompressRotations(k00, k10, k20, k30, &quat0);
 
       // Decompress right side keyframes and store them in soa structures.
       const RotationKey& k01 = _keys.begin[_interp[base + 1]];
       const RotationKey& k11 = _keys.begin[_interp[base + 3]];
       const RotationKey& k21 = _keys.begin[_interp[base + 5]];
       const RotationKey& k31 = _keys.begin[_interp[base + 7]];
-      soa_rotations_[i].time[1] = math::simd_float4::Load(
-        k01.time, k11.time, k21.time, k31.time);
+      soa_rotations_[i].time[1] =
+        DecompressKeyTimes(_keys, _highs, _interp + base + 1);
       math::SoaQuaternion& quat1 = soa_rotations_[i].value[1];
-      quat1.x = int_to_float * math::simd_float4::FromInt(math::simd_int4::Load(
-        k01.value[0], k11.value[0], k21.value[0], k31.value[0]));
-      quat1.y = int_to_float * math::simd_float4::FromInt(math::simd_int4::Load(
-        k01.value[1], k11.value[1], k21.value[1], k31.value[1]));
-      quat1.z = int_to_float * math::simd_float4::FromInt(math::simd_int4::Load(
-        k01.value[2], k11.value[2], k21.value[2], k31.value[2]));
-      // Get back sign of w component.
-      const math::SimdInt4 wsign1 = math::simd_int4::Load(
-        k01.wsign, k11.wsign, k21.wsign, k31.wsign);
-      // Get back length of w component. Favors performance over accuracy by
-      // using x * RSqrtEst(x) instead of Sqrt(x).
-      const math::SimdFloat4 ww1 = math::Max(eps,
-        one - (quat1.x * quat1.x + quat1.y * quat1.y + quat1.z * quat1.z));
-      const math::SimdFloat4 w1 = ww1 * math::RSqrtEst(ww1);
-      // Reapply w's sign.
-      quat1.w = math::Select(wsign1, w1, -w1);
+      DecompressRotations(k01, k11, k21, k31, &quat1);
+
+      // Negates right side quaternions that aren't in the same hemisphere as
+      // the left side ones, so the interpolation takes the shortest path.
+      const math::SimdFloat4 dot = quat0.x * quat1.x + quat0.y * quat1.y +
+                                   quat0.z * quat1.z + quat0.w * quat1.w;
+      const math::SimdInt4 flip = math::And(
+        math::CmpLt(dot, math::simd_float4::zero()),
+        math::simd_int4::mask_sign());
+      quat1.x = math::Xor(quat1.x, flip);
+      quat1.y = math::Xor(quat1.y, flip);
+      quat1.z = math::Xor(quat1.z, flip);
+      quat1.w = math::Xor(quat1.w, flip);
+
+      // Overwrites constant tracks values.
+      if (constant_flags) {
+        UpdateSoaConstants(constant_flags, _constants.begin[i],
+                           &soa_rotations_[i]);
+      }
     }
   }
 }
 
 void UpdateSoaScales(int _num_soa_tracks,
                      ozz::Range<const ScaleKey> _keys,
+                     const uint8_t* _highs,
+                     ozz::Range<const math::SoaFloat3> _ranges,
+                     const uint8_t* _values,
+                     int _bits,
+                     ozz::Range<const uint8_t> _constant_flags,
+                     ozz::Range<const math::SoaFloat3> _constants,
                      const int* _interp,
+                     const bool* _mask,
                      unsigned char* _outdated,
                      internal::InterpSoaScale* soa_scales_) {
   const int num_outdated_flags = (_num_soa_tracks + 7) / 8;
   for (int j = 0; j < num_outdated_flags; ++j) {
-    unsigned char outdated = _outdated[j];
-    _outdated[j] = 0;  // Reset outdated entries as all will be processed.
+    // Masked out entries are not processed, so they remain outdated.
+    unsigned char outdated =
+      _outdated[j] & MaskFlags(_mask, _num_soa_tracks, j);
+    _outdated[j] &= ~outdated;  // Reset outdated entries that are processed.
     for (int i = j * 8; outdated; ++i, outdated >>= 1) {
       if (!(outdated & 1)) {
         continue;
       }
+
+      // Soa entries whose tracks are all constant have no key.
+      const int constant_flags =
+        _constant_flags.begin ? _constant_flags.begin[i] : 0;
+      if (constant_flags == 0xf) {
+        UpdateSoaConstants(constant_flags, _constants.begin[i],
+                           &soa_scales_[i]);
+        continue;
+      }
       const int base = i * 4 * 2;  // * soa size * 2 keys
 
+      // Quantization range of the soa entry.
+      const math::SoaFloat3& min = _ranges.begin[i * 2 + 0];
+      const math::SoaFloat3& step = _ranges.begin[i * 2 + 1];
+
       // Decompress left side keyframes and store them in soa structures.
-      const ScaleKey& k00 = _keys.begin[_interp[base + 0]];
-      const ScaleKey& k10 = _keys.begin[_interp[base + 2]];
-      const ScaleKey& k20 = _keys.begin[_interp[base + 4]];
-      const ScaleKey& k30 = _keys.begin[_interp[base + 6]];
-      soa_scales_[i].time[0] = math::simd_float4::Load(
-        k00.time, k10.time, k20.time, k30.time);
-      soa_scales_[i].value[0].x = math::HalfToFloat(math::simd_int4::Load(
-        k00.value[0],k10.value[0], k20.value[0], k30.value[0]));
-      soa_scales_[i].value[0].y = math::HalfToFloat(math::simd_int4::Load(
-        k00.value[1], k10.value[1], k20.value[1], k30.value[1]));
-      soa_scales_[i].value[0].z = math::HalfToFloat(math::simd_int4::Load(
-        k00.value[2], k10.value[2], k20.value[2], k30.value[2]));
+      soa_scales_[i].time[0] =
+        DecompressKeyTimes(_keys, _highs, _interp + base);
+      DecompressValues(_values, _bits, _interp + base, min, step,
+                       &soa_scales_[i].value[0]);
 
       // Decompress right side keyframes and store them in soa structures.
-      const ScaleKey& k01 = _keys.begin[_interp[base + 1]];
-      const ScaleKey& k11 = _keys.begin[_interp[base + 3]];
-      const ScaleKey& k21 = _keys.begin[_interp[base + 5]];
-      const ScaleKey& k31 = _keys.begin[_interp[base + 7]];
-      soa_scales_[i].time[1] = math::simd_float4::Load(
-        k01.time, k11.time, k21.time, k31.time);
-      soa_scales_[i].value[1].x = math::HalfToFloat(math::simd_int4::Load(
-        k01.value[0], k11.value[0], k21.value[0], k31.value[0]));
-      soa_scales_[i].value[1].y = math::HalfToFloat(math::simd_int4::Load(
-        k01.value[1], k11.value[1], k21.value[1], k31.value[1]));
-      soa_scales_[i].value[1].z = math::HalfToFloat(math::simd_int4::Load(
-        k01.value[2], k11.value[2], k21.value[2], k31.value[2]));
+      soa_scales_[i].time[1] =
+        DecompressKeyTimes(_keys, _highs, _interp + base + 1);
+      DecompressValues(_values, _bits, _interp + base + 1, min, step,
+                       &soa_scales_[i].value[1]);
+
+      // Overwrites constant tracks values.
+      if (constant_flags) {
+        UpdateSoaConstants(constant_flags, _constants.begin[i],
+                           &soa_scales_[i]);
+      }
     }
   }
 }
 
-void Interpolates(float _anim_time,
-                  int _num_soa_tracks,
-                  const internal::InterpSoaTranslation* _translations,
-                  const internal::InterpSoaRotation* _rotations,
-                  const internal::InterpSoaScale* _scales,
-                  math::SoaTransform* _output) {
-    const math::SimdFloat4 anim_time = math::simd_float4::Load1(_anim_time);
-    for (int i = 0; i < _num_soa_tracks; ++i) {
-      // Prepares interpolation coefficients.
-      const math::SimdFloat4 interp_t_time =
-        (anim_time - _translations[i].time[0]) *
-        math::RcpEst(_translations[i].time[1] - _translations[i].time[0]);
-      const math::SimdFloat4 interp_r_time =
-        (anim_time - _rotations[i].time[0]) *
-        math::RcpEst(_rotations[i].time[1] - _rotations[i].time[0]);
-      const math::SimdFloat4 interp_s_time =
-        (anim_time - _scales[i].time[0]) *
-        math::RcpEst(_scales[i].time[1] - _scales[i].time[0]);
-
-      // Processes interpolations.
-      // The lerp of the rotation uses the shortest path, because opposed
-      // quaternions were negated during animation build stage (AnimationBuilder).
-      _output[i].translation = Lerp(
-        _translations[i].value[0], _translations[i].value[1], interp_t_time);
-      _output[i].rotation = NLerpEst(
-        _rotations[i].value[0], _rotations[i].value[1], interp_r_time);
-      _output[i].scale = Lerp(
-        _scales[i].value[0], _scales[i].value[1], interp_s_time);
-    }
+// Returns _highs buffer of _animation keys time high bits, or NULL if its key
+// times aren't wide. An empty buffer can have a non-NULL begin once loaded.
+const uint8_t* TimeHighs(const Animation& _animation,
+                         ozz::Range<const uint8_t> _highs) {
+  return _animation.wide_key_times() ? _highs.begin : NULL;
+}
+
+// Returns the entry of _seeks that matches _seek index, or NULL if _seek is
+// negative.
+const int* SeekEntry(ozz::Range<const int> _seeks, int _num_soa_tracks,
+                     int _seek) {
+  if (_seek < 0) {
+    return NULL;
+  }
+  const int stride = 1 + _num_soa_tracks * 4 * 2;
+  assert(_seeks.begin + (_seek + 1) * stride <= _seeks.end);
+  return _seeks.begin + _seek * stride;
+}
+
+// Returns the time, in key time units, up to which (excluded) keys referenced
+// by _cache remain valid. This is the time of the key that would allow next
+// key (at _cursor) to be pushed to the cache, see UpdateKeys loop condition.
+template<typename _Key>
+float KeysValidUntil(ozz::Range<const _Key> _keys,
+                     const uint8_t* _highs,
+                     int _cursor,
+                     const int* _cache) {
+  const _Key* cursor = &_keys.begin[_cursor];
+  if (cursor >= _keys.end) {
+    // All keys were already pushed to the cache.
+    return std::numeric_limits<float>::max();
+  }
+  return static_cast<float>(
+    KeyTime(_keys.begin, _highs, _cache[cursor->track * 2 + 1]));
 }
+
 }  // namespace
 
 SamplingJob::SamplingJob()
     : time(0.f),
+      loop(false),
       animation(NULL),
       cache(NULL) {
 }
@@ -361,62 +716,120 @@ bool SamplingJob::Run() const {
     return true;
   }
 
-  // Clamps time in range [0,duration].
-  const float anim_time = math::Clamp(0.f, time, animation->duration());
+  // Clamps or wraps time in range [0,duration].
+  const float anim_time =
+    internal::AnimationTime(time, animation->duration(), loop);
 
-  // Step the cache to this potentially new animation and time.
+  // Fetches and decompresses key frames required to sample at t = anim_time.
   assert(cache->max_soa_tracks() >= num_soa_tracks);
-  cache->Step(*animation, anim_time);
+  cache->Update(*animation, anim_time, mask.begin);
 
-  // Fetch key frames from the animation to the cache a t = anim_time.
-  // Then updates outdated soa hot values.
-  UpdateKeys(anim_time, num_soa_tracks,
-             animation->translations(),
-             &cache->translation_cursor_,
-             cache->translation_keys_,
-             cache->outdated_translations_);
-  UpdateSoaTranslations(num_soa_tracks,
-                        animation->translations(),
-                        cache->translation_keys_,
-                        cache->outdated_translations_,
-                        cache->soa_translations_);
-
-  UpdateKeys(anim_time, num_soa_tracks,
-             animation->rotations(),
-             &cache->rotation_cursor_,
-             cache->rotation_keys_,
-             cache->outdated_rotations_);
-  UpdateSoaRotations(num_soa_tracks,
-                     animation->rotations(),
-                     cache->rotation_keys_,
-                     cache->outdated_rotations_,
-                     cache->soa_rotations_);
-
-  UpdateKeys(anim_time, num_soa_tracks,
-             animation->scales(),
-             &cache->scale_cursor_,
-             cache->scale_keys_,
-             cache->outdated_scales_);
-  UpdateSoaScales(num_soa_tracks,
-                  animation->scales(),
-                  cache->scale_keys_,
-                  cache->outdated_scales_,
-                  cache->soa_scales_);
-
-  // Interpolates soa hot data.
-  Interpolates(anim_time,
-               num_soa_tracks,
-               cache->soa_translations_,
-               cache->soa_rotations_,
-               cache->soa_scales_,
-               output.begin);
+  // Interpolates soa hot data, in key time units.
+  internal::GetJobKernels().interpolate(ToKeyTime(anim_time,
+                                                  animation->duration(),
+                                                  animation->wide_key_times()),
+                                        num_soa_tracks,
+                                        cache->soa_translations_,
+                                        cache->soa_rotations_,
+                                        cache->soa_scales_,
+                                        mask.begin,
+                                        output.begin);
+
+  return true;
+}
+
+BatchSamplingJob::Instance::Instance()
+    : time(0.f),
+      cache(NULL) {
+}
+
+BatchSamplingJob::BatchSamplingJob()
+    : animation(NULL),
+      loop(false) {
+}
+
+bool BatchSamplingJob::Validate() const {
+  // Don't need any early out, as jobs are valid in most of the performance
+  // critical cases.
+  // Tests are written in multiple lines in order to avoid branches.
+  bool valid = true;
+
+  // Test for NULL pointers.
+  if (!animation || !instances.begin) {
+    return false;
+  }
+  valid &= instances.end >= instances.begin;
+
+  // Validates instances, using the same rules as SamplingJob.
+  for (const Instance* instance = instances.begin;
+       instance < instances.end;
+       ++instance) {
+    SamplingJob job;
+    job.time = instance->time;
+    job.animation = animation;
+    job.cache = instance->cache;
+    job.output = instance->output;
+    valid &= job.Validate();
+  }
+
+  return valid;
+}
+
+bool BatchSamplingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  const int num_soa_tracks = animation->num_soa_tracks();
+  if (num_soa_tracks == 0) {  // Early out if animation contains no joint.
+    return true;
+  }
+
+  const internal::JobKernels& kernels = internal::GetJobKernels();
+
+  // The instance whose cache was last updated, and the time range [begin,end[
+  // (in key time units) for which this cache can be used without any key
+  // update.
+  const SamplingCache* leader = NULL;
+  float leader_begin = 0.f;
+  float leader_end = 0.f;
+
+  for (const Instance* instance = instances.begin;
+       instance < instances.end;
+       ++instance) {
+    // Clamps or wraps time in range [0,duration].
+    const float anim_time =
+      internal::AnimationTime(instance->time, animation->duration(), loop);
+    const float key_time = ToKeyTime(anim_time, animation->duration(),
+                                     animation->wide_key_times());
+
+    // Updates this instance's cache if leader's one cannot be used at
+    // anim_time.
+    if (!leader || key_time < leader_begin || key_time >= leader_end) {
+      SamplingCache* cache = instance->cache;
+      assert(cache->max_soa_tracks() >= num_soa_tracks);
+      cache->Update(*animation, anim_time, NULL);
+
+      leader = cache;
+      leader_begin = key_time;
+      leader_end = cache->valid_until(*animation);
+    }
+
+    // Interpolates soa hot data from leader's cache.
+    kernels.interpolate(key_time,
+                        num_soa_tracks,
+                        leader->soa_translations_,
+                        leader->soa_rotations_,
+                        leader->soa_scales_,
+                        NULL,
+                        instance->output.begin);
+  }
 
   return true;
 }
 
 SamplingCache::SamplingCache(int _max_tracks)
-    : animation_(NULL),
-    time_(0.f),
+    : animation_(0),
     max_soa_tracks_((_max_tracks + 3) / 4),
     soa_translations_(NULL),
     soa_rotations_(NULL),
@@ -486,20 +899,144 @@ SamplingCache::~SamplingCache() {
   memory::default_allocator()->Deallocate(soa_translations_);
 }
 
-void SamplingCache::Step(const Animation& _animation, float _time) {
-  // The cache is invalidated if animation has changed or if it is being rewind.
-  if (animation_ != &_animation || _time < time_) {
-    animation_ = &_animation;
+void SamplingCache::Step(const Animation& _animation) {
+  // The cache is invalidated if animation has changed, which is detected with
+  // its generation id rather than its address, as an address can be reused by
+  // another animation. Keys will then be restored from the seek index if any.
+  // Rewinding the animation is handled while updating keys.
+  if (animation_ != _animation.generation()) {
+    animation_ = _animation.generation();
     translation_cursor_ = 0;
     rotation_cursor_ = 0;
     scale_cursor_ = 0;
+
+    // Constant tracks of the new animation also need to be updated, even if
+    // they have no key.
+    const int num_soa_tracks = _animation.num_soa_tracks();
+    if (num_soa_tracks) {
+      assert(max_soa_tracks_ >= num_soa_tracks);
+      OutdateAll(num_soa_tracks, outdated_translations_);
+      OutdateAll(num_soa_tracks, outdated_rotations_);
+      OutdateAll(num_soa_tracks, outdated_scales_);
+    }
+  }
+}
+
+void SamplingCache::Update(const Animation& _animation, float _time,
+                           const bool* _mask) {
+  const int num_soa_tracks = _animation.num_soa_tracks();
+  assert(max_soa_tracks_ >= num_soa_tracks);
+
+  // Step the cache to this potentially new animation.
+  Step(_animation);
+
+  // Finds the seek index entry the closest to _time, but not after it. Entry n
+  // is at time (n + 1) * interval.
+  int seek = -1;
+  const float interval = _animation.seek_interval();
+  if (interval > 0.f) {
+    const int stride = 1 + num_soa_tracks * 4 * 2;
+    const int num_seeks =
+      static_cast<int>(_animation.translation_seeks().Count()) / stride;
+    seek = math::Min(static_cast<int>(_time / interval), num_seeks) - 1;
+    // Fixes up float division approximations, as entry's time must not be
+    // greater than _time.
+    while (seek >= 0 && static_cast<float>(seek + 1) * interval > _time) {
+      --seek;
+    }
   }
-  time_ = _time;
+
+  // Fetch key frames from the animation to the cache a t = _time.
+  // Then updates outdated soa hot values.
+  const float key_time = ToKeyTime(_time, _animation.duration(),
+                                   _animation.wide_key_times());
+  // Keys time high bits, NULL if key times aren't wide.
+  const uint8_t* translation_highs =
+    TimeHighs(_animation, _animation.translation_time_highs());
+  const uint8_t* rotation_highs =
+    TimeHighs(_animation, _animation.rotation_time_highs());
+  const uint8_t* scale_highs =
+    TimeHighs(_animation, _animation.scale_time_highs());
+  UpdateKeys(key_time, num_soa_tracks, _animation.num_animated_translations(),
+             _animation.translations(),
+             translation_highs,
+             SeekEntry(_animation.translation_seeks(), num_soa_tracks, seek),
+             &translation_cursor_,
+             translation_keys_,
+             outdated_translations_);
+  UpdateSoaTranslations(num_soa_tracks,
+                        _animation.translations(),
+                        translation_highs,
+                        _animation.translation_ranges(),
+                        _animation.translation_values().begin,
+                        _animation.translation_bits(),
+                        _animation.translation_constant_flags(),
+                        _animation.translation_constants(),
+                        translation_keys_,
+                        _mask,
+                        outdated_translations_,
+                        soa_translations_);
+
+  UpdateKeys(key_time, num_soa_tracks, _animation.num_animated_rotations(),
+             _animation.rotations(),
+             rotation_highs,
+             SeekEntry(_animation.rotation_seeks(), num_soa_tracks, seek),
+             &rotation_cursor_,
+             rotation_keys_,
+             outdated_rotations_);
+  UpdateSoaRotations(num_soa_tracks,
+                     _animation.rotations(),
+                     rotation_highs,
+                     _animation.rotation_constant_flags(),
+                     _animation.rotation_constants(),
+                     rotation_keys_,
+                     _mask,
+                     outdated_rotations_,
+                     soa_rotations_);
+
+  UpdateKeys(key_time, num_soa_tracks, _animation.num_animated_scales(),
+             _animation.scales(),
+             scale_highs,
+             SeekEntry(_animation.scale_seeks(), num_soa_tracks, seek),
+             &scale_cursor_,
+             scale_keys_,
+             outdated_scales_);
+  UpdateSoaScales(num_soa_tracks,
+                  _animation.scales(),
+                  scale_highs,
+                  _animation.scale_ranges(),
+                  _animation.scale_values().begin,
+                  _animation.scale_bits(),
+                  _animation.scale_constant_flags(),
+                  _animation.scale_constants(),
+                  scale_keys_,
+                  _mask,
+                  outdated_scales_,
+                  soa_scales_);
+}
+
+float SamplingCache::valid_until(const Animation& _animation) const {
+  assert(animation_ == _animation.generation());
+  const uint8_t* translation_highs =
+    TimeHighs(_animation, _animation.translation_time_highs());
+  const uint8_t* rotation_highs =
+    TimeHighs(_animation, _animation.rotation_time_highs());
+  const uint8_t* scale_highs =
+    TimeHighs(_animation, _animation.scale_time_highs());
+  const float translation =
+    KeysValidUntil(_animation.translations(), translation_highs,
+                   translation_cursor_, translation_keys_);
+  const float rotation =
+    KeysValidUntil(_animation.rotations(), rotation_highs,
+                   rotation_cursor_, rotation_keys_);
+  const float scale =
+    KeysValidUntil(_animation.scales(), scale_highs,
+                   scale_cursor_, scale_keys_);
+  return math::Min(translation, math::Min(rotation, scale));
 }
 
 void SamplingCache::Invalidate() {
-  animation_ = NULL;
-  time_ = 0.f;
+  animation_ = 0;
   translation_cursor_ = 0;
   rotation_cursor_ = 0;
   scale_cursor_ = 0;
@@ -0,0 +1,216 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/segmented_animation.h"
+
+#include <cassert>
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/math_ex.h"
+#include "ozz/base/memory/allocator.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "../runtime/animation_archive.h"
+#include "../runtime/animation_time.h"
+
+namespace ozz {
+namespace animation {
+
+SegmentedAnimation::SegmentedAnimation()
+    : duration_(0.f),
+      num_tracks_(0),
+      segment_duration_(0.f),
+      segments_(NULL),
+      num_segments_(0),
+      stream_(NULL),
+      base_(0) {
+}
+
+SegmentedAnimation::~SegmentedAnimation() {
+  Destroy();
+}
+
+void SegmentedAnimation::Destroy() {
+  UnloadAll();
+  memory::default_allocator()->Deallocate(segments_);
+  segments_ = NULL;
+  num_segments_ = 0;
+  duration_ = 0.f;
+  num_tracks_ = 0;
+  segment_duration_ = 0.f;
+  stream_ = NULL;
+  base_ = 0;
+}
+
+void SegmentedAnimation::Allocate(int _num_segments) {
+  assert(!segments_ && num_segments_ == 0);
+  segments_ =
+    memory::default_allocator()->Allocate<Segment>(_num_segments);
+  num_segments_ = _num_segments;
+  for (int i = 0; i < num_segments_; ++i) {
+    Segment& segment = segments_[i];
+    segment.offset = 0;
+    segment.size = 0;
+    segment.animation = NULL;
+  }
+}
+
+int SegmentedAnimation::FindSegment(float _time, bool _loop) const {
+  if (num_segments_ == 0) {
+    return -1;
+  }
+  // Clamps or wraps time in range [0,duration], the same way the SamplingJob
+  // does.
+  const float time = internal::AnimationTime(_time, duration_, _loop);
+
+  // Last segment can be longer than segment_duration_.
+  const int id = static_cast<int>(time / segment_duration_);
+  return math::Min(id, num_segments_ - 1);
+}
+
+float SegmentedAnimation::segment_start(int _id) const {
+  assert(_id >= 0 && _id < num_segments_);
+  return _id * segment_duration_;
+}
+
+const Animation* SegmentedAnimation::segment(int _id) const {
+  assert(_id >= 0 && _id < num_segments_);
+  return segments_[_id].animation;
+}
+
+bool SegmentedAnimation::LoadSegment(int _id) {
+  assert(_id >= 0 && _id < num_segments_);
+  Segment& segment = segments_[_id];
+  if (segment.animation) {
+    return true;
+  }
+
+  // Segment is stored as a standalone archive, whose tracks must match the
+  // index.
+  Animation* animation = internal::LoadAnimation(
+    stream_, base_ + static_cast<int>(segment.offset), segment.size);
+  if (!animation) {
+    return false;
+  }
+  if (animation->num_tracks() != num_tracks_) {
+    memory::default_allocator()->Delete(animation);
+    return false;
+  }
+  segment.animation = animation;
+  return true;
+}
+
+void SegmentedAnimation::UnloadSegment(int _id) {
+  assert(_id >= 0 && _id < num_segments_);
+  memory::default_allocator()->Delete(segments_[_id].animation);
+  segments_[_id].animation = NULL;
+}
+
+void SegmentedAnimation::UnloadAll() {
+  for (int i = 0; i < num_segments_; ++i) {
+    UnloadSegment(i);
+  }
+}
+
+size_t SegmentedAnimation::size() const {
+  size_t size = sizeof(*this) + sizeof(Segment) * num_segments_;
+  for (int i = 0; i < num_segments_; ++i) {
+    if (segments_[i].animation) {
+      size += segments_[i].animation->size();
+    }
+  }
+  return size;
+}
+
+void SegmentedAnimation::Save(io::OArchive& _archive) const {
+  // Segments are serialized first, as their sizes are required by the index.
+  io::MemoryStream segments;
+  memory::Allocator* allocator = memory::default_allocator();
+  uint32_t* sizes = allocator->Allocate<uint32_t>(num_segments_);
+  for (int i = 0; i < num_segments_; ++i) {
+    assert(segments_[i].animation && "All segments must be loaded.");
+    sizes[i] =
+      internal::WriteAnimation(*segments_[i].animation, _archive, &segments);
+  }
+
+  // Writes the index, followed by the segments.
+  _archive << duration_;
+  _archive << static_cast<int32_t>(num_tracks_);
+  _archive << segment_duration_;
+  _archive << static_cast<int32_t>(num_segments_);
+  uint32_t offset = 0;
+  for (int i = 0; i < num_segments_; ++i) {
+    _archive << offset;
+    _archive << sizes[i];
+    offset += sizes[i];
+  }
+  allocator->Deallocate(sizes);
+  internal::CopyAnimations(&segments, _archive);
+}
+
+void SegmentedAnimation::Load(io::IArchive& _archive, uint32_t _version) {
+  // Destroy animation in case it was already used before.
+  Destroy();
+
+  // No retro-compatibility with anterior versions.
+  if (_version != 1) {
+    return;
+  }
+
+  float duration;
+  _archive >> duration;
+  int32_t num_tracks;
+  _archive >> num_tracks;
+  float segment_duration;
+  _archive >> segment_duration;
+  int32_t num_segments;
+  _archive >> num_segments;
+  if (num_tracks < 0 || num_segments < 0) {
+    return;
+  }
+  duration_ = duration;
+  num_tracks_ = num_tracks;
+  segment_duration_ = segment_duration;
+  Allocate(num_segments);
+  for (int i = 0; i < num_segments_; ++i) {
+    Segment& segment = segments_[i];
+    _archive >> segment.offset;
+    _archive >> segment.size;
+  }
+
+  // Segments follow the index.
+  stream_ = _archive.stream();
+  base_ = stream_->Tell();
+}
+}  // animation
+}  // ozz
@@ -0,0 +1,113 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/segmented_sampling_job.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/segmented_animation.h"
+#include "ozz/base/maths/soa_transform.h"
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "../runtime/animation_time.h"
+
+namespace ozz {
+namespace animation {
+
+SegmentedSamplingJob::SegmentedSamplingJob()
+    : time(0.f),
+      loop(false),
+      animation(NULL),
+      cache(NULL),
+      segment(NULL),
+      next_segment(NULL) {
+}
+
+bool SegmentedSamplingJob::Validate() const {
+  // Test for NULL pointers.
+  if (!animation || !cache) {
+    return false;
+  }
+  bool valid = output.begin != NULL;
+
+  // Tests output range, implicitly tests output.end != NULL.
+  const ptrdiff_t num_soa_tracks = animation->num_soa_tracks();
+  valid &= output.end - output.begin >= num_soa_tracks;
+
+  // Tests cache size.
+  valid &= cache->max_soa_tracks() >= num_soa_tracks;
+
+  return valid;
+}
+
+bool SegmentedSamplingJob::Run() const {
+  if (!Validate()) {
+    return false;
+  }
+
+  // Finds required and following segments.
+  const int id = animation->FindSegment(time, loop);
+  const int num_segments = animation->num_segments();
+  if (segment) {
+    *segment = id;
+  }
+  if (next_segment) {
+    if (id < 0) {
+      *next_segment = -1;
+    } else if (id + 1 < num_segments) {
+      *next_segment = id + 1;
+    } else {
+      *next_segment = loop && num_segments > 1 ? 0 : -1;
+    }
+  }
+  if (id < 0) {  // Early out if animation contains no segment.
+    return true;
+  }
+
+  const Animation* current = animation->segment(id);
+  if (!current) {
+    return false;
+  }
+
+  // Samples the segment at its local time. Time is computed from the clamped
+  // or wrapped time, the same way the segment was found, as segments never
+  // loop.
+  const float anim_time =
+    internal::AnimationTime(time, animation->duration(), loop);
+  SamplingJob job;
+  job.time = anim_time - animation->segment_start(id);
+  job.animation = current;
+  job.cache = cache;
+  job.output = output;
+  return job.Run();
+}
+}  // animation
+}  // ozz
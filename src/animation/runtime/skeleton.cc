@@ -33,6 +33,7 @@
 #include <cstring>
 
 #include "ozz/base/io/archive.h"
+#include "ozz/base/io/image.h"
 #include "ozz/base/maths/soa_math_archive.h"
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/memory/allocator.h"
@@ -41,7 +42,9 @@ namespace ozz {
 namespace io {
 // JointProperties' version can be declared locally as it will be saved from this
 // cpp file only.
-OZZ_IO_TYPE_VERSION(1, animation::Skeleton::JointProperties)
+// Version 1 was limited to 10 bits parent indices, which implies a different
+// root parent index.
+OZZ_IO_TYPE_VERSION(2, animation::Skeleton::JointProperties)
 
 // Specializes Skeleton::JointProperties. This structure's bitset isn't written
 // as-is because of endianness issues.
@@ -62,16 +65,53 @@ void Load(IArchive& _archive,
           animation::Skeleton::JointProperties* _properties,
           size_t _count,
           uint32_t _version) {
-  (void)_version;
+  const uint16_t kNoParentIndexV1 = (1 << 10) - 1;
   for (size_t i = 0; i < _count; ++i) {
     uint16_t parent;
     _archive >> parent;
+    if (_version < 2 && parent == kNoParentIndexV1) {
+      parent = animation::Skeleton::kNoParentIndex;
+    }
     _properties[i].parent = parent;
     bool is_leaf;
     _archive >> is_leaf;
     _properties[i].is_leaf = is_leaf;
   }
 }
+
+// Specializes Skeleton::JointProperties swapping. Bit-fields layout
+// depends on the endianness: they are allocated from the least significant bit
+// on little endian platforms, and from the most significant bit on big endian
+// ones.
+template <>
+struct PodSwapper<animation::Skeleton::JointProperties> {
+  static void Swap(animation::Skeleton::JointProperties* _properties,
+                   size_t _count,
+                   bool _to_native) {
+    const bool little = GetNativeEndianness() == kLittleEndian;
+    const int bits = animation::Skeleton::kMaxJointsNumBits;
+    const uint16_t mask = (1 << bits) - 1;
+    for (size_t i = 0; i < _count; ++i) {
+      animation::Skeleton::JointProperties& properties = _properties[i];
+      uint16_t foreign;
+      if (_to_native) {
+        std::memcpy(&foreign, &properties, sizeof(foreign));
+        foreign = EndianSwapper<uint16_t>::Swap(foreign);
+        properties.parent = little ? foreign >> (16 - bits) : foreign & mask;
+        properties.is_leaf =
+          (little ? foreign >> (15 - bits) : foreign >> bits) & 1;
+      } else {
+        const uint16_t parent = properties.parent;
+        const uint16_t is_leaf = properties.is_leaf;
+        foreign = little ? static_cast<uint16_t>(parent << (16 - bits) |
+                                                 is_leaf << (15 - bits)) :
+                           static_cast<uint16_t>(parent | is_leaf << bits);
+        foreign = EndianSwapper<uint16_t>::Swap(foreign);
+        std::memcpy(&properties, &foreign, sizeof(foreign));
+      }
+    }
+  }
+};
 }  // io
 
 namespace animation {
@@ -80,7 +120,8 @@ Skeleton::Skeleton()
     : joint_properties_(NULL),
       bind_pose_(NULL),
       joint_names_(NULL),
-      num_joints_(0) {
+      num_joints_(0),
+      image_view_(false) {
 }
 
 Skeleton::~Skeleton() {
@@ -89,14 +130,18 @@ Skeleton::~Skeleton() {
 
 void Skeleton::Destroy() {
   memory::Allocator* allocator = memory::default_allocator();
-  allocator->Deallocate(joint_properties_);
+  // Joint properties and bind pose of an image view belong to the image.
+  if (!image_view_) {
+    allocator->Deallocate(joint_properties_);
+    allocator->Deallocate(bind_pose_);
+  }
   joint_properties_ = NULL;
-  allocator->Deallocate(bind_pose_);
   bind_pose_ = NULL;
   allocator->Deallocate(joint_names_);
   joint_names_ = NULL;
 
   num_joints_ = 0;
+  image_view_ = false;
 }
 
 // This function is not inlined in order to avoid the inclusion of SoaTransform.
@@ -171,5 +216,74 @@ void Skeleton::Load(ozz::io::IArchive& _archive, uint32_t _version) {
     memory::default_allocator()->Allocate<math::SoaTransform>(num_soa_joints());
   _archive >> ozz::io::MakeArray(bind_pose_, num_soa_joints());
 }
+
+size_t Skeleton::SaveImage(void* _image, size_t _size,
+                           Endianness _endianness) const {
+  io::ImageWriter writer(_image, _size, _endianness);
+  writer.WriteHeader<Skeleton>();
+  writer.Write(static_cast<int32_t>(num_joints_));
+
+  // Names are all concatenated in the same buffer, starting at
+  // joint_names_[0].
+  size_t chars_count = 0;
+  for (int i = 0; i < num_joints_; ++i) {
+    chars_count += (std::strlen(joint_names_[i]) + 1) * sizeof(char);
+  }
+  const char* names = num_joints_ ? joint_names_[0] : NULL;
+  writer.Write(Range<const char>(names, chars_count));
+  writer.Write(joint_properties());
+  writer.Write(bind_pose());
+  return _image ? writer.Finish() : writer.size();
+}
+
+bool Skeleton::LoadImage(void* _image, size_t _size) {
+
+  // Destroy skeleton in case it was already used before.
+  Destroy();
+
+  io::ImageReader reader(_image, _size);
+  const uint32_t version = reader.ReadHeader<Skeleton>();
+  if (version != io::internal::Version<const Skeleton>::kValue) {
+    return false;
+  }
+
+  // From now on, joint properties and bind pose belong to the image.
+  image_view_ = true;
+
+  int32_t num_joints = 0;
+  Range<char> names;
+  Range<JointProperties> properties;
+  Range<math::SoaTransform> bind_pose;
+  reader.Read(&num_joints);
+  reader.Read(&names);
+  reader.Read(&properties);
+  reader.Read(&bind_pose);
+  if (!reader.Finish() ||
+      num_joints < 0 || num_joints > kMaxJoints ||
+      properties.Count() != static_cast<size_t>(num_joints) ||
+      bind_pose.Count() != static_cast<size_t>(num_joints + 3) / 4 ||
+      (num_joints && (!names.Count() || names.end[-1] != 0))) {
+    Destroy();
+    return false;
+  }
+  num_joints_ = num_joints;
+  joint_properties_ = properties.begin;
+  bind_pose_ = bind_pose.begin;
+
+  // Only the array of pointers is allocated, names are read from the image.
+  if (num_joints_) {
+    joint_names_ = memory::default_allocator()->Allocate<char*>(num_joints_);
+    char* cursor = names.begin;
+    for (int i = 0; i < num_joints_; ++i) {
+      if (cursor >= names.end) {  // Not enough names.
+        Destroy();
+        return false;
+      }
+      joint_names_[i] = cursor;
+      cursor += std::strlen(cursor) + 1;
+    }
+  }
+  return true;
+}
 }  // animation
 }  // ozz
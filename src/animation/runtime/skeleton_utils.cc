@@ -30,6 +30,7 @@
 
 #include "ozz/animation/runtime/skeleton_utils.h"
 
+#include "ozz/base/maths/math_ex.h"
 #include "ozz/base/maths/soa_transform.h"
 
 #include <assert.h>
@@ -63,92 +64,68 @@ ozz::math::Transform GetJointBindPose(const Skeleton& _skeleton, int _joint) {
   return bind_pose;
 }
 
-// Helper macro used to detect if a joint has a brother.
-#define _HAS_SIBLING(_i, _num_joints, _properties) \
-  ((_i + 1 < _num_joints) &&\
-   (_properties[_i].parent == _properties[_i + 1].parent))
-
-// Implement joint hierarchy depth-first traversal.
-// Uses a non-recursive implementation to control stack usage (ie: making
-// algorithm behavior (stack consumption) independent off the data being
-// processed).
-void IterateJointsDF(const Skeleton& _skeleton,
-                     int _from,
-                     JointsIterator* _iterator) {
-  assert(_iterator);
+int SplitJoints(const Skeleton& _skeleton,
+                int _max_joints,
+                Range<JointsChunk> _chunks) {
   const int num_joints = _skeleton.num_joints();
-  Range<const Skeleton::JointProperties> properties =
-    _skeleton.joint_properties();
-
-  // Initialize iterator.
-  _iterator->num_joints = 0;
-
-  // Validates input range first.
-  if (num_joints == 0) {
-    return;
-  }
-  if ((_from < 0 || _from >= num_joints) &&
-      _from != Skeleton::kNoParentIndex) {
-    return;
+  const Skeleton::JointProperties* properties =
+    _skeleton.joint_properties().begin;
+
+  // Chunks are aligned on soa joints.
+  const int chunk_size = (math::Max(_max_joints, 1) + 3) & ~3;
+  const int num_chunks = (num_joints + chunk_size - 1) / chunk_size;
+  if (_chunks.end - _chunks.begin < num_chunks) {
+    return 0;
   }
 
-  // Simulate a stack to unroll usual recursive implementation.
-  struct Context {
-    uint16_t joint:15;
-    uint16_t has_brother:1;
-  };
-  Context stack[Skeleton::kMaxJoints];
-  int stack_size = 0;
-
-  // Initializes iteration start.
-  Context start;
-  if (_from != Skeleton::kNoParentIndex) {
-    start.joint = _from;
-    start.has_brother = false;  // Disallow brother processing.
-  } else {  // num_joints > 0, which was tested as pre-conditions.
-    start.joint = 0;
-    start.has_brother = _HAS_SIBLING(0, num_joints, properties.begin);
-  }
-  stack[stack_size++] = start;
-
-  for (; stack_size != 0;) {
-    // Process next joint on the stack.
-    const Context& top = stack[stack_size - 1];
-
-    // Push that joint to the list and then process its child.
-    _iterator->joints[_iterator->num_joints++] = top.joint;
-
-    // Skip all the joints until the first child is found.
-    if (!properties.begin[top.joint].is_leaf) {  // A leaf has no child anyway.
-      uint16_t next_joint = top.joint + 1;
-      for (;
-           next_joint < num_joints &&
-           top.joint != properties.begin[next_joint].parent;
-           ++next_joint) {
-      }
-      if (next_joint < num_joints) {
-        const Context next = {
-          next_joint,
-          _HAS_SIBLING(next_joint, num_joints, properties.begin)};
-        stack[stack_size++] = next;  // Push child and process it.
-        continue;
+  for (int i = 0; i < num_chunks; ++i) {
+    JointsChunk& chunk = _chunks.begin[i];
+    chunk.begin = i * chunk_size;
+    chunk.end = math::Min(chunk.begin + chunk_size, num_joints);
+
+    // The chunk comes after all the chunks it depends on, as parents are
+    // always stored before their children.
+    int stage = 0;
+    for (int joint = chunk.begin; joint < chunk.end; ++joint) {
+      const int parent = properties[joint].parent;
+      if (parent != Skeleton::kNoParentIndex && parent < chunk.begin) {
+        stage = math::Max(stage, _chunks.begin[parent / chunk_size].stage + 1);
       }
     }
+    chunk.stage = stage;
+  }
+  return num_chunks;
+}
 
-    // Rewind the stack while there's no brother to process.
-    for (;stack_size != 0 && !stack[stack_size - 1].has_brother; --stack_size) {
+namespace {
+// Functor that outputs traversed joints to a JointsIterator.
+class JointsWriter {
+ public:
+  explicit JointsWriter(JointsIterator* _iterator)
+    : iterator_(_iterator) {
+  }
+  void operator()(int _joint, int) {
+    // Joints that don't fit in the buffer are skipped.
+    const ptrdiff_t size = iterator_->joints.end - iterator_->joints.begin;
+    if (iterator_->num_joints < size) {
+      iterator_->joints.begin[iterator_->num_joints++] =
+        static_cast<uint16_t>(_joint);
     }
+  }
+ private:
+  JointsIterator* iterator_;
+};
+}  // namespace
+
+void IterateJointsDF(const Skeleton& _skeleton,
+                     int _from,
+                     JointsIterator* _iterator) {
+  assert(_iterator);
 
-    // Replace top joint by its brother.
-    if (stack_size != 0) {
-      Context& next = stack[stack_size - 1];
-      assert(next.has_brother && next.joint + 1 < num_joints);
+  // Initialize iterator.
+  _iterator->num_joints = 0;
 
-      ++next.joint;  // The brother is the next joint in breadth-first order.
-      next.has_brother = _HAS_SIBLING(next.joint, num_joints, properties.begin);
-    }
-  }
+  IterateJointsDF(_skeleton, _from, JointsWriter(_iterator));
 }
-#undef _HAS_SIBLING
 }  // animation
 }  // ozz
@@ -0,0 +1,58 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/atomic.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif  // _MSC_VER
+
+namespace ozz {
+namespace atomic {
+
+#if defined(_MSC_VER)
+long Increment(volatile long* _value) {
+  return _InterlockedIncrement(_value);
+}
+
+long Decrement(volatile long* _value) {
+  return _InterlockedDecrement(_value);
+}
+#else  // _MSC_VER
+long Increment(volatile long* _value) {
+  return __sync_add_and_fetch(_value, 1);
+}
+
+long Decrement(volatile long* _value) {
+  return __sync_sub_and_fetch(_value, 1);
+}
+#endif  // _MSC_VER
+}  // atomic
+}  // ozz
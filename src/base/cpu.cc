@@ -0,0 +1,147 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/cpu.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || \
+    defined(__i386__) || defined(__x86_64__)
+#define OZZ_CPU_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__GNUC__)
+#include <cpuid.h>
+#endif  // _MSC_VER
+#endif  // x86
+
+namespace ozz {
+namespace cpu {
+
+namespace {
+
+#if defined(OZZ_CPU_X86) && (defined(_MSC_VER) || defined(__GNUC__))
+// Executes CPUID instruction for _leaf and _sub_leaf, and outputs eax, ebx,
+// ecx, edx registers to _regs.
+void CpuId(unsigned int _leaf, unsigned int _sub_leaf, unsigned int _regs[4]) {
+#if defined(_MSC_VER)
+  int regs[4];
+  __cpuidex(regs, static_cast<int>(_leaf), static_cast<int>(_sub_leaf));
+  for (int i = 0; i < 4; ++i) {
+    _regs[i] = static_cast<unsigned int>(regs[i]);
+  }
+#else  // __GNUC__
+  __cpuid_count(_leaf, _sub_leaf, _regs[0], _regs[1], _regs[2], _regs[3]);
+#endif  // _MSC_VER
+}
+
+// Reads extended control register 0, which tells which registers states are
+// saved by the os.
+unsigned int XGetBv0() {
+#if defined(_MSC_VER)
+  return static_cast<unsigned int>(_xgetbv(0));
+#else  // __GNUC__
+  unsigned int eax, edx;
+  __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return eax;
+#endif  // _MSC_VER
+}
+
+bool DetectSupport(InstructionSet _set) {
+  unsigned int regs[4];
+  CpuId(0, 0, regs);
+  const unsigned int max_leaf = regs[0];
+  if (max_leaf < 1) {
+    return false;
+  }
+  CpuId(1, 0, regs);
+  const unsigned int features = regs[2];  // ecx
+  switch (_set) {
+    case kSSE4_1: {
+      return (features & (1 << 19)) != 0;
+    }
+    case kAVX2: {
+      // AVX requires os support of ymm registers (OSXSAVE and xcr0 bits 1-2).
+      const unsigned int kOsXSave = 1 << 27;
+      const unsigned int kAvx = 1 << 28;
+      if ((features & (kOsXSave | kAvx)) != (kOsXSave | kAvx) ||
+          (XGetBv0() & 6) != 6 ||
+          max_leaf < 7) {
+        return false;
+      }
+      CpuId(7, 0, regs);
+      return (regs[1] & (1 << 5)) != 0;  // ebx
+    }
+    default: {
+      return _set == kBaseline;
+    }
+  }
+}
+#else  // OZZ_CPU_X86
+bool DetectSupport(InstructionSet _set) {
+  return _set == kBaseline;
+}
+#endif  // OZZ_CPU_X86
+}  // namespace
+
+bool IsSupported(InstructionSet _set) {
+  if (_set < kBaseline || _set >= kInstructionSetCount) {
+    return false;
+  }
+  return _set == kBaseline || DetectSupport(_set);
+}
+
+InstructionSet Detect() {
+  for (int set = kInstructionSetCount - 1; set > kBaseline; --set) {
+    if (IsSupported(static_cast<InstructionSet>(set))) {
+      return static_cast<InstructionSet>(set);
+    }
+  }
+  return kBaseline;
+}
+
+namespace {
+// Instruction set selected for job kernels. It's detected during static
+// initialization, so jobs run concurrently only ever read it. It's kBaseline
+// (zero initialized) if read by another static initializer before detection.
+InstructionSet selected_set = Detect();
+}  // namespace
+
+InstructionSet GetInstructionSet() {
+  return selected_set;
+}
+
+bool SetInstructionSet(InstructionSet _set) {
+  if (!IsSupported(_set)) {
+    return false;
+  }
+  selected_set = _set;
+  return true;
+}
+}  // cpu
+}  // ozz
@@ -0,0 +1,341 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/io/async_loader.h"
+
+#include <cassert>
+#include <cstring>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else  // _WIN32
+#include <pthread.h>
+#endif  // _WIN32
+
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace io {
+
+namespace {
+// Wraps platform specific threading primitives.
+#if defined(_WIN32)
+typedef CRITICAL_SECTION Mutex;
+typedef CONDITION_VARIABLE Condition;
+typedef HANDLE Thread;
+
+void InitMutex(Mutex* _mutex) { InitializeCriticalSection(_mutex); }
+void DestroyMutex(Mutex* _mutex) { DeleteCriticalSection(_mutex); }
+void Lock(Mutex* _mutex) { EnterCriticalSection(_mutex); }
+void Unlock(Mutex* _mutex) { LeaveCriticalSection(_mutex); }
+void InitCondition(Condition* _cond) { InitializeConditionVariable(_cond); }
+void DestroyCondition(Condition* _cond) { (void)_cond; }
+void WaitCondition(Condition* _cond, Mutex* _mutex) {
+  SleepConditionVariableCS(_cond, _mutex, INFINITE);
+}
+void Broadcast(Condition* _cond) { WakeAllConditionVariable(_cond); }
+#else  // _WIN32
+typedef pthread_mutex_t Mutex;
+typedef pthread_cond_t Condition;
+typedef pthread_t Thread;
+
+void InitMutex(Mutex* _mutex) { pthread_mutex_init(_mutex, NULL); }
+void DestroyMutex(Mutex* _mutex) { pthread_mutex_destroy(_mutex); }
+void Lock(Mutex* _mutex) { pthread_mutex_lock(_mutex); }
+void Unlock(Mutex* _mutex) { pthread_mutex_unlock(_mutex); }
+void InitCondition(Condition* _cond) { pthread_cond_init(_cond, NULL); }
+void DestroyCondition(Condition* _cond) { pthread_cond_destroy(_cond); }
+void WaitCondition(Condition* _cond, Mutex* _mutex) {
+  pthread_cond_wait(_cond, _mutex);
+}
+void Broadcast(Condition* _cond) { pthread_cond_broadcast(_cond); }
+#endif  // _WIN32
+
+// Interface of the object run by worker threads.
+class Worker {
+ public:
+  virtual void Work() = 0;
+
+ protected:
+  ~Worker() {}
+};
+
+// Runs _worker, from a worker thread.
+#if defined(_WIN32)
+DWORD WINAPI ThreadEntry(LPVOID _worker) {
+  static_cast<Worker*>(_worker)->Work();
+  return 0;
+}
+
+bool StartThread(Thread* _thread, Worker* _worker) {
+  *_thread = ::CreateThread(NULL, 0, &ThreadEntry, _worker, 0, NULL);
+  return *_thread != NULL;
+}
+
+void JoinThread(Thread* _thread) {
+  WaitForSingleObject(*_thread, INFINITE);
+  CloseHandle(*_thread);
+}
+#else  // _WIN32
+void* ThreadEntry(void* _worker) {
+  static_cast<Worker*>(_worker)->Work();
+  return NULL;
+}
+
+bool StartThread(Thread* _thread, Worker* _worker) {
+  return pthread_create(_thread, NULL, &ThreadEntry, _worker) == 0;
+}
+
+void JoinThread(Thread* _thread) {
+  pthread_join(*_thread, NULL);
+}
+#endif  // _WIN32
+}  // namespace
+
+struct AsyncLoader::Request {
+  // Function that loads object from an archive.
+  LoadFunction load;
+
+  // Object to load.
+  void* object;
+
+  // Copy of the file name.
+  char* filename;
+
+  // Request status, protected by loader mutex.
+  Status status;
+
+  // Is request in the queue, waiting to be processed.
+  bool queued;
+
+  // Next request in the queue.
+  Request* next;
+
+  // Loads object from its file. Doesn't access any shared data, so it can be
+  // called without the loader lock.
+  bool Process() const {
+    File file(filename, "rb");
+    if (!file.opened()) {
+      return false;
+    }
+    BufferedStream stream(&file);
+    IArchive archive(&stream);
+    return load(archive, object);
+  }
+};
+
+struct AsyncLoader::Impl : public Worker {
+  // Processes queued requests until the loader exits.
+  virtual void Work() {
+    Lock(&mutex);
+    for (;;) {
+      while (!head && !exit) {
+        WaitCondition(&queued, &mutex);
+      }
+      if (exit) {
+        break;
+      }
+
+      // Pops the first request. It remains pending while it's processed.
+      Request* request = head;
+      head = request->next;
+      if (!head) {
+        tail = NULL;
+      }
+      request->next = NULL;
+      request->queued = false;
+
+      Unlock(&mutex);
+      const bool succeeded = request->Process();
+      Lock(&mutex);
+
+      request->status = succeeded ? kSucceeded : kFailed;
+      Broadcast(&completed);
+    }
+    Unlock(&mutex);
+  }
+
+  // Protects all the members below, and requests status.
+  Mutex mutex;
+
+  // Signaled when a request is queued, or when threads must exit.
+  Condition queued;
+
+  // Signaled when a request is completed.
+  Condition completed;
+
+  // Queue of requests waiting to be processed.
+  Request* head;
+  Request* tail;
+
+  // Number of requests that weren't released.
+  int num_requests;
+
+  // Tells threads to exit.
+  bool exit;
+
+  // Worker threads.
+  Thread* threads;
+  int num_threads;
+};
+
+AsyncLoader::AsyncLoader(int _num_threads)
+    : impl_(NULL) {
+  memory::Allocator* allocator = memory::default_allocator();
+  impl_ = allocator->New<Impl>();
+  InitMutex(&impl_->mutex);
+  InitCondition(&impl_->queued);
+  InitCondition(&impl_->completed);
+  impl_->head = NULL;
+  impl_->tail = NULL;
+  impl_->num_requests = 0;
+  impl_->exit = false;
+  impl_->threads = NULL;
+  impl_->num_threads = 0;
+  if (_num_threads > 0) {
+    impl_->threads = allocator->Allocate<Thread>(_num_threads);
+    while (impl_->num_threads < _num_threads &&
+           StartThread(&impl_->threads[impl_->num_threads], impl_)) {
+      ++impl_->num_threads;
+    }
+  }
+}
+
+AsyncLoader::~AsyncLoader() {
+  assert(impl_->num_requests == 0 && "All handles must be released.");
+
+  // Threads exit once requests being processed are completed.
+  Lock(&impl_->mutex);
+  impl_->exit = true;
+  Broadcast(&impl_->queued);
+  Unlock(&impl_->mutex);
+  for (int i = 0; i < impl_->num_threads; ++i) {
+    JoinThread(&impl_->threads[i]);
+  }
+
+  memory::Allocator* allocator = memory::default_allocator();
+  allocator->Deallocate(impl_->threads);
+  DestroyCondition(&impl_->completed);
+  DestroyCondition(&impl_->queued);
+  DestroyMutex(&impl_->mutex);
+  allocator->Delete(impl_);
+}
+
+int AsyncLoader::num_threads() const {
+  return impl_->num_threads;
+}
+
+AsyncLoader::Handle AsyncLoader::Push(const char* _filename, void* _object,
+                                      LoadFunction _load) {
+  memory::Allocator* allocator = memory::default_allocator();
+  Request* request = allocator->New<Request>();
+  const size_t length = std::strlen(_filename) + 1;
+  request->filename = allocator->Allocate<char>(length);
+  std::memcpy(request->filename, _filename, length);
+  request->load = _load;
+  request->object = _object;
+  request->status = kPending;
+  request->queued = false;
+  request->next = NULL;
+
+  // Without any thread, request is processed immediately.
+  if (impl_->num_threads == 0) {
+    request->status = request->Process() ? kSucceeded : kFailed;
+    Lock(&impl_->mutex);
+    ++impl_->num_requests;
+    Unlock(&impl_->mutex);
+    return request;
+  }
+
+  Lock(&impl_->mutex);
+  ++impl_->num_requests;
+  request->queued = true;
+  if (impl_->tail) {
+    impl_->tail->next = request;
+  } else {
+    impl_->head = request;
+  }
+  impl_->tail = request;
+  Broadcast(&impl_->queued);
+  Unlock(&impl_->mutex);
+  return request;
+}
+
+AsyncLoader::Status AsyncLoader::status(Handle _handle) const {
+  Lock(&impl_->mutex);
+  const Status status = _handle->status;
+  Unlock(&impl_->mutex);
+  return status;
+}
+
+AsyncLoader::Status AsyncLoader::Wait(Handle _handle) {
+  Lock(&impl_->mutex);
+  while (_handle->status == kPending) {
+    WaitCondition(&impl_->completed, &impl_->mutex);
+  }
+  const Status status = _handle->status;
+  Unlock(&impl_->mutex);
+  return status;
+}
+
+void AsyncLoader::Release(Handle _handle) {
+  Lock(&impl_->mutex);
+  if (_handle->queued) {
+    // Removes the request from the queue, so it's never processed.
+    Request* previous = NULL;
+    for (Request* request = impl_->head; request != _handle;
+         request = request->next) {
+      previous = request;
+    }
+    if (previous) {
+      previous->next = _handle->next;
+    } else {
+      impl_->head = _handle->next;
+    }
+    if (impl_->tail == _handle) {
+      impl_->tail = previous;
+    }
+  } else {
+    // Waits for the request to be completed, as a thread is processing it.
+    while (_handle->status == kPending) {
+      WaitCondition(&impl_->completed, &impl_->mutex);
+    }
+  }
+  --impl_->num_requests;
+  Unlock(&impl_->mutex);
+
+  memory::Allocator* allocator = memory::default_allocator();
+  allocator->Deallocate(_handle->filename);
+  allocator->Delete(_handle);
+}
+}  // io
+}  // ozz
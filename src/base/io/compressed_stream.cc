@@ -0,0 +1,490 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/io/compressed_stream.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "ozz/base/memory/allocator.h"
+
+namespace ozz {
+namespace io {
+
+namespace {
+// Compressed stream header magic.
+const char kMagic[4] = {'o', 'z', 'l', 'z'};
+
+// Size of the stream and block headers.
+const size_t kHeaderSize = 8;
+
+// Maximum block size accepted when reading a header, which protects from
+// allocating an unreasonable amount of memory for a corrupted stream.
+const size_t kMaxBlockSize = 16 << 20;
+
+// Minimum length of a back-reference.
+const size_t kMinMatch = 4;
+
+// Maximum offset of a back-reference.
+const size_t kMaxOffset = 0xffff;
+
+// Number of bits of the hash table used to find back-references.
+const int kHashBits = 12;
+
+// Headers are stored little endian, whatever the native endianness.
+void StoreLE32(uint32_t _value, char* _dest) {
+  for (int i = 0; i < 4; ++i) {
+    _dest[i] = static_cast<char>(_value >> (i * 8));
+  }
+}
+
+uint32_t LoadLE32(const char* _src) {
+  uint32_t value = 0;
+  for (int i = 0; i < 4; ++i) {
+    value |= static_cast<uint32_t>(static_cast<uint8_t>(_src[i])) << (i * 8);
+  }
+  return value;
+}
+
+uint32_t Load32(const uint8_t* _src) {
+  uint32_t value;
+  std::memcpy(&value, _src, sizeof(value));
+  return value;
+}
+
+uint32_t Hash(uint32_t _value) {
+  return (_value * 2654435761u) >> (32 - kHashBits);
+}
+
+// Writes a length extension, made of 255 bytes followed by the remainder.
+uint8_t* WriteLength(uint8_t* _dest, size_t _length) {
+  for (; _length >= 255; _length -= 255) {
+    *_dest++ = 255;
+  }
+  *_dest++ = static_cast<uint8_t>(_length);
+  return _dest;
+}
+
+// Writes a sequence of _num_literals literals, followed by a back-reference,
+// unless _match_length is 0.
+uint8_t* WriteSequence(uint8_t* _dest, const uint8_t* _literals,
+                       size_t _num_literals, size_t _offset,
+                       size_t _match_length) {
+  // Token stores literals and match lengths on 4 bits each. 15 means that the
+  // length is extended with following bytes.
+  const size_t match = _match_length ? _match_length - kMinMatch : 0;
+  const uint8_t token = static_cast<uint8_t>(
+    ((_num_literals < 15 ? _num_literals : 15) << 4) |
+    (match < 15 ? match : 15));
+  *_dest++ = token;
+  if (_num_literals >= 15) {
+    _dest = WriteLength(_dest, _num_literals - 15);
+  }
+  std::memcpy(_dest, _literals, _num_literals);
+  _dest += _num_literals;
+  if (_match_length) {
+    *_dest++ = static_cast<uint8_t>(_offset);
+    *_dest++ = static_cast<uint8_t>(_offset >> 8);
+    if (match >= 15) {
+      _dest = WriteLength(_dest, match - 15);
+    }
+  }
+  return _dest;
+}
+
+// Reads a length extension. Returns false if _src is overrun.
+bool ReadLength(const uint8_t** _src, const uint8_t* _src_end,
+                size_t* _length) {
+  uint8_t byte;
+  do {
+    if (*_src == _src_end) {
+      return false;
+    }
+    byte = *(*_src)++;
+    *_length += byte;
+  } while (byte == 255);
+  return true;
+}
+}  // namespace
+
+size_t CompressedStream::Compress(const void* _src, size_t _src_size,
+                                  void* _dest, size_t _dest_size) {
+  if (_dest_size < CompressBound(_src_size)) {
+    return 0;
+  }
+  const uint8_t* src = static_cast<const uint8_t*>(_src);
+  uint8_t* dest = static_cast<uint8_t*>(_dest);
+
+  // Hash table of the last position of every 4 bytes sequence hash, offset by
+  // one so that 0 means no position.
+  size_t table[1 << kHashBits];
+  std::memset(table, 0, sizeof(table));
+
+  size_t anchor = 0;  // Start of pending literals.
+  size_t i = 0;
+  while (i + kMinMatch <= _src_size) {
+    const uint32_t sequence = Load32(src + i);
+    size_t& entry = table[Hash(sequence)];
+    const size_t candidate = entry;
+    entry = i + 1;
+    if (candidate == 0 || i - (candidate - 1) > kMaxOffset ||
+        Load32(src + candidate - 1) != sequence) {
+      ++i;
+      continue;
+    }
+
+    // Extends the match as far as possible.
+    const size_t ref = candidate - 1;
+    size_t length = kMinMatch;
+    while (i + length < _src_size && src[ref + length] == src[i + length]) {
+      ++length;
+    }
+    dest = WriteSequence(dest, src + anchor, i - anchor, i - ref, length);
+    i += length;
+    anchor = i;
+  }
+
+  // Remaining bytes are literals.
+  dest = WriteSequence(dest, src + anchor, _src_size - anchor, 0, 0);
+
+  const size_t size = dest - static_cast<uint8_t*>(_dest);
+  assert(size <= CompressBound(_src_size));
+  return size;
+}
+
+size_t CompressedStream::Decompress(const void* _src, size_t _src_size,
+                                    void* _dest, size_t _dest_size) {
+  const uint8_t* src = static_cast<const uint8_t*>(_src);
+  const uint8_t* src_end = src + _src_size;
+  uint8_t* dest = static_cast<uint8_t*>(_dest);
+  uint8_t* dest_end = dest + _dest_size;
+  uint8_t* const dest_begin = dest;
+
+  while (src < src_end) {
+    const uint8_t token = *src++;
+
+    // Copies literals.
+    size_t num_literals = token >> 4;
+    if (num_literals == 15 && !ReadLength(&src, src_end, &num_literals)) {
+      return 0;
+    }
+    if (num_literals > static_cast<size_t>(src_end - src) ||
+        num_literals > static_cast<size_t>(dest_end - dest)) {
+      return 0;
+    }
+    std::memcpy(dest, src, num_literals);
+    src += num_literals;
+    dest += num_literals;
+
+    // Last sequence has no back-reference.
+    if (src == src_end) {
+      break;
+    }
+
+    // Copies back-reference.
+    if (src_end - src < 2) {
+      return 0;
+    }
+    const size_t offset = src[0] | (src[1] << 8);
+    src += 2;
+    size_t length = token & 0xf;
+    if (length == 15 && !ReadLength(&src, src_end, &length)) {
+      return 0;
+    }
+    length += kMinMatch;
+    if (offset == 0 || offset > static_cast<size_t>(dest - dest_begin) ||
+        length > static_cast<size_t>(dest_end - dest)) {
+      return 0;
+    }
+    const uint8_t* ref = dest - offset;
+    if (offset >= length) {
+      std::memcpy(dest, ref, length);
+      dest += length;
+    } else {
+      // Overlapping copy repeats the last offset bytes.
+      for (const uint8_t* end = dest + length; dest < end;) {
+        *dest++ = *ref++;
+      }
+    }
+  }
+  return dest - dest_begin;
+}
+
+const size_t CompressedStream::kDefaultBlockSize = 64 << 10;
+
+CompressedStream::CompressedStream(Stream* _stream, Mode _mode,
+                                   size_t _block_size)
+    : stream_(_stream),
+      mode_(_mode),
+      block_(NULL),
+      block_size_(_block_size),
+      packed_(NULL),
+      packed_size_(0),
+      base_(0),
+      block_position_(0),
+      block_begin_(0),
+      end_(0),
+      cursor_(0),
+      next_block_position_(0),
+      valid_(false) {
+  assert(_stream);
+  if (!stream_->opened()) {
+    return;
+  }
+
+  // Writes or reads the header.
+  char header[kHeaderSize];
+  if (mode_ == kCompress) {
+    assert(_block_size > 0 && _block_size <= kMaxBlockSize);
+    std::memcpy(header, kMagic, sizeof(kMagic));
+    StoreLE32(static_cast<uint32_t>(block_size_), header + 4);
+    if (stream_->Write(header, kHeaderSize) != kHeaderSize) {
+      return;
+    }
+  } else {
+    if (stream_->Read(header, kHeaderSize) != kHeaderSize ||
+        std::memcmp(header, kMagic, sizeof(kMagic)) != 0) {
+      return;
+    }
+    block_size_ = LoadLE32(header + 4);
+    if (block_size_ == 0 || block_size_ > kMaxBlockSize) {
+      return;
+    }
+  }
+  base_ = stream_->Tell();
+  block_position_ = base_;
+  next_block_position_ = base_;
+
+  memory::Allocator* allocator = memory::default_allocator();
+  block_ = allocator->Allocate<char>(block_size_);
+  packed_size_ = CompressBound(block_size_);
+  packed_ = allocator->Allocate<char>(packed_size_);
+  valid_ = true;
+}
+
+CompressedStream::~CompressedStream() {
+  if (mode_ == kCompress) {
+    Flush();
+  }
+  memory::Allocator* allocator = memory::default_allocator();
+  allocator->Deallocate(block_);
+  allocator->Deallocate(packed_);
+}
+
+bool CompressedStream::opened() const {
+  return valid_ && stream_->opened();
+}
+
+bool CompressedStream::Flush() {
+  if (mode_ != kCompress || !valid_) {
+    return false;
+  }
+  if (end_ == 0) {
+    return true;
+  }
+
+  // Block is stored raw if compression doesn't reduce its size.
+  size_t packed_size = Compress(block_, end_, packed_, packed_size_);
+  const char* data = packed_;
+  if (packed_size == 0 || packed_size >= end_) {
+    packed_size = end_;
+    data = block_;
+  }
+  char header[kHeaderSize];
+  StoreLE32(static_cast<uint32_t>(end_), header);
+  StoreLE32(static_cast<uint32_t>(packed_size), header + 4);
+  const bool success =
+    stream_->Write(header, kHeaderSize) == kHeaderSize &&
+    stream_->Write(data, packed_size) == packed_size;
+
+  block_begin_ += static_cast<int>(end_);
+  block_position_ += static_cast<int>(kHeaderSize + packed_size);
+  end_ = 0;
+  cursor_ = 0;
+  return success;
+}
+
+size_t CompressedStream::Write(const void* _buffer, size_t _size) {
+  if (mode_ != kCompress || !valid_) {
+    return 0;
+  }
+  const char* buffer = static_cast<const char*>(_buffer);
+  size_t written = 0;
+  while (written < _size) {
+    const size_t remaining = block_size_ - end_;
+    const size_t size = remaining < _size - written ?
+                        remaining : _size - written;
+    std::memcpy(block_ + end_, buffer + written, size);
+    end_ += size;
+    cursor_ = end_;
+    written += size;
+    if (end_ == block_size_ && !Flush()) {
+      break;
+    }
+  }
+  return written;
+}
+
+bool CompressedStream::ReadBlockHeader(int _block, size_t* _size,
+                                       size_t* _packed_size) {
+  char header[kHeaderSize];
+  if (stream_->Seek(_block, kSet) != 0 ||
+      stream_->Read(header, kHeaderSize) != kHeaderSize) {
+    return false;
+  }
+  *_size = LoadLE32(header);
+  *_packed_size = LoadLE32(header + 4);
+  return *_size > 0 && *_size <= block_size_ &&
+         *_packed_size > 0 && *_packed_size <= packed_size_;
+}
+
+bool CompressedStream::LoadBlock(int _position) {
+  if (_position < 0) {
+    return false;
+  }
+
+  // Blocks are searched forward from the current block, or from the first
+  // one.
+  int block = base_;
+  int begin = 0;
+  if (_position >= block_begin_ + static_cast<int>(end_) && end_ != 0) {
+    block = next_block_position_;
+    begin = block_begin_ + static_cast<int>(end_);
+  } else if (_position >= block_begin_) {
+    block = block_position_;
+    begin = block_begin_;
+  }
+  size_t size;
+  size_t packed_size;
+  for (;;) {
+    if (!ReadBlockHeader(block, &size, &packed_size)) {
+      // Position can be the end of the uncompressed data.
+      if (_position != begin) {
+        return false;
+      }
+      size = 0;
+      packed_size = 0;
+      break;
+    }
+    if (_position < begin + static_cast<int>(size)) {
+      break;
+    }
+    block += static_cast<int>(kHeaderSize + packed_size);
+    begin += static_cast<int>(size);
+  }
+
+  // Decompresses the block, or reads it directly if it is stored raw.
+  if (size != 0) {
+    char* data = packed_size == size ? block_ : packed_;
+    if (stream_->Read(data, packed_size) != packed_size ||
+        (data == packed_ &&
+         Decompress(packed_, packed_size, block_, size) != size)) {
+      end_ = 0;
+      cursor_ = 0;
+      return false;
+    }
+  }
+  block_position_ = block;
+  block_begin_ = begin;
+  next_block_position_ = size != 0 ?
+    block + static_cast<int>(kHeaderSize + packed_size) : block;
+  end_ = size;
+  cursor_ = _position - begin;
+  return true;
+}
+
+size_t CompressedStream::Read(void* _buffer, size_t _size) {
+  if (mode_ != kDecompress || !valid_) {
+    return 0;
+  }
+  char* buffer = static_cast<char*>(_buffer);
+  size_t read = 0;
+  while (read < _size) {
+    if (cursor_ == end_) {
+      if (!LoadBlock(Tell()) || end_ == 0) {
+        break;
+      }
+    }
+    const size_t remaining = end_ - cursor_;
+    const size_t size = remaining < _size - read ? remaining : _size - read;
+    std::memcpy(buffer + read, block_ + cursor_, size);
+    cursor_ += size;
+    read += size;
+  }
+  return read;
+}
+
+int CompressedStream::Seek(int _offset, Origin _origin) {
+  if (!valid_) {
+    return -1;
+  }
+  int origin;
+  switch (_origin) {
+    case kCurrent: origin = Tell(); break;
+    case kEnd: {
+      if (mode_ == kCompress) {
+        origin = Tell();
+        break;
+      }
+      // Finds uncompressed data size by walking block headers from the
+      // current block.
+      int block = block_position_;
+      origin = block_begin_;
+      size_t size;
+      size_t packed_size;
+      while (ReadBlockHeader(block, &size, &packed_size)) {
+        block += static_cast<int>(kHeaderSize + packed_size);
+        origin += static_cast<int>(size);
+      }
+      break;
+    }
+    case kSet: origin = 0; break;
+    default: return -1;
+  }
+  const int position = origin + _offset;
+
+  if (mode_ == kCompress) {
+    return position == Tell() ? 0 : -1;
+  }
+
+  // Position is in the current block.
+  if (position >= block_begin_ &&
+      position <= block_begin_ + static_cast<int>(end_)) {
+    cursor_ = position - block_begin_;
+    return 0;
+  }
+  return LoadBlock(position) ? 0 : -1;
+}
+
+int CompressedStream::Tell() const {
+  return block_begin_ + static_cast<int>(cursor_);
+}
+}  // io
+}  // ozz
@@ -0,0 +1,201 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/io/image.h"
+
+#include <cassert>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else  // _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+namespace ozz {
+namespace io {
+
+namespace {
+// Offset of the image size in the header: endianness byte and padding, then
+// version.
+const size_t kImageSizeOffset = 8;
+}  // namespace
+
+ImageWriter::ImageWriter(void* _buffer, size_t _size, Endianness _endianness)
+    : buffer_(static_cast<char*>(_buffer)),
+      size_(_size),
+      cursor_(0),
+      endianness_(_endianness),
+      swap_(_endianness != GetNativeEndianness()) {
+  assert(!_buffer ||
+         (reinterpret_cast<uintptr_t>(_buffer) & (kImageAlignment - 1)) == 0);
+}
+
+void ImageWriter::WriteHeader(const char* _tag, uint32_t _version) {
+  const uint8_t header[4] = {static_cast<uint8_t>(endianness_), 0, 0, 0};
+  WriteArray(header, 4);
+  Write(_version);
+  Write(static_cast<uint32_t>(0));  // Image size, written by Finish().
+  WriteArray(_tag, std::strlen(_tag) + 1);
+  Align(4);
+}
+
+void ImageWriter::Align(size_t _alignment) {
+  const size_t aligned = (cursor_ + _alignment - 1) & ~(_alignment - 1);
+  if (buffer_ && aligned <= size_) {
+    std::memset(buffer_ + cursor_, 0, aligned - cursor_);
+  }
+  cursor_ = aligned;
+}
+
+size_t ImageWriter::Finish() {
+  if (!buffer_ || cursor_ > size_) {
+    return 0;
+  }
+  uint32_t size = static_cast<uint32_t>(cursor_);
+  if (swap_) {
+    size = EndianSwapper<uint32_t>::Swap(size);
+  }
+  std::memcpy(buffer_ + kImageSizeOffset, &size, sizeof(size));
+  return cursor_;
+}
+
+ImageReader::ImageReader(void* _image, size_t _size)
+    : image_(static_cast<char*>(_image)),
+      size_(_size),
+      cursor_(0),
+      swap_(false),
+      valid_(_image != NULL &&
+             (reinterpret_cast<uintptr_t>(_image) &
+              (kImageAlignment - 1)) == 0) {
+}
+
+uint32_t ImageReader::ReadHeader(const char* _tag) {
+  const uint8_t* endianness = ReadArray<uint8_t>(4);
+  if (!endianness || endianness[0] > kLittleEndian) {
+    valid_ = false;
+    return 0;
+  }
+  swap_ = static_cast<Endianness>(endianness[0]) != GetNativeEndianness();
+
+  uint32_t version = 0, size = 0;
+  Read(&version);
+  Read(&size);
+  if (!valid_ || size > size_) {
+    valid_ = false;
+    return 0;
+  }
+  size_ = size;  // Restricts reads to the image itself.
+
+  // Compares tags, including null terminating character.
+  const size_t tag_length = std::strlen(_tag) + 1;
+  const char* tag = ReadArray<char>(tag_length);
+  if (!tag || std::memcmp(tag, _tag, tag_length) != 0) {
+    valid_ = false;
+    return 0;
+  }
+  Align(4);
+  return version;
+}
+
+void ImageReader::Align(size_t _alignment) {
+  cursor_ = (cursor_ + _alignment - 1) & ~(_alignment - 1);
+}
+
+bool ImageReader::Finish() {
+  if (valid_ && swap_) {
+    // Image was swapped in-place, so it's now native.
+    image_[0] = static_cast<char>(GetNativeEndianness());
+    swap_ = false;
+  }
+  return valid_;
+}
+
+#if defined(_WIN32)
+MappedFile::MappedFile(const char* _filename)
+    : data_(NULL),
+      size_(0),
+      handle_(NULL) {
+  HANDLE file = CreateFileA(_filename, GENERIC_READ, FILE_SHARE_READ, NULL,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE) {
+    return;
+  }
+  LARGE_INTEGER size;
+  if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+    handle_ = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if (handle_) {
+      data_ = MapViewOfFile(handle_, FILE_MAP_COPY, 0, 0, 0);
+      size_ = data_ ? static_cast<size_t>(size.QuadPart) : 0;
+    }
+  }
+  CloseHandle(file);
+}
+
+MappedFile::~MappedFile() {
+  if (data_) {
+    UnmapViewOfFile(data_);
+  }
+  if (handle_) {
+    CloseHandle(handle_);
+  }
+}
+#else  // _WIN32
+MappedFile::MappedFile(const char* _filename)
+    : data_(NULL),
+      size_(0),
+      handle_(NULL) {
+  const int file = open(_filename, O_RDONLY);
+  if (file < 0) {
+    return;
+  }
+  struct stat status;
+  if (fstat(file, &status) == 0 && status.st_size > 0) {
+    void* data = mmap(NULL, status.st_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE, file, 0);
+    if (data != MAP_FAILED) {
+      data_ = data;
+      size_ = static_cast<size_t>(status.st_size);
+    }
+  }
+  close(file);  // The mapping remains valid once the file is closed.
+}
+
+MappedFile::~MappedFile() {
+  if (data_) {
+    munmap(data_, size_);
+  }
+}
+#endif  // _WIN32
+}  // io
+}  // ozz
@@ -192,5 +192,127 @@ bool MemoryStream::Resize(size_t _size) {
   }
   return _size == 0 || buffer_ != NULL;
 }
+
+// Starts BufferedStream implementation.
+const size_t BufferedStream::kDefaultBufferSize = 16<<10;
+
+BufferedStream::BufferedStream(Stream* _stream, size_t _buffer_size)
+    : stream_(_stream),
+      buffer_(NULL),
+      buffer_size_(_buffer_size),
+      end_(0),
+      cursor_(0),
+      writing_(false) {
+  assert(_stream && _buffer_size > 0);
+  buffer_ = ozz::memory::default_allocator()->Allocate<char>(_buffer_size);
+}
+
+BufferedStream::~BufferedStream() {
+  Flush();
+  ozz::memory::default_allocator()->Deallocate(buffer_);
+  buffer_ = NULL;
+}
+
+bool BufferedStream::Flush() {
+  bool success = true;
+  if (writing_) {
+    success = stream_->Write(buffer_, end_) == end_;
+    writing_ = false;
+  } else if (cursor_ != end_) {
+    // Moves decorated stream back to the position of the next byte to read.
+    success = stream_->Seek(-static_cast<int>(end_ - cursor_),
+                            Stream::kCurrent) == 0;
+  }
+  end_ = 0;
+  cursor_ = 0;
+  return success;
+}
+
+bool BufferedStream::opened() const {
+  return buffer_ != NULL && stream_->opened();
+}
+
+size_t BufferedStream::Read(void* _buffer, size_t _size) {
+  if (writing_) {
+    Flush();
+  }
+  char* buffer = static_cast<char*>(_buffer);
+  size_t read = 0;
+  while (read < _size) {
+    if (cursor_ == end_) {
+      const size_t remaining = _size - read;
+      if (remaining >= buffer_size_) {
+        // Bypasses the buffer for big reads.
+        end_ = 0;
+        cursor_ = 0;
+        return read + stream_->Read(buffer + read, remaining);
+      }
+      // Reads ahead.
+      end_ = stream_->Read(buffer_, buffer_size_);
+      cursor_ = 0;
+      if (end_ == 0) {
+        break;
+      }
+    }
+    const size_t size = math::Min(end_ - cursor_, _size - read);
+    std::memcpy(buffer + read, buffer_ + cursor_, size);
+    cursor_ += size;
+    read += size;
+  }
+  return read;
+}
+
+size_t BufferedStream::Write(const void* _buffer, size_t _size) {
+  if (!writing_) {
+    // Drops read ahead data, moving decorated stream to the write position.
+    if (!Flush()) {
+      return 0;
+    }
+    writing_ = true;
+  }
+  if (end_ + _size > buffer_size_) {
+    if (!Flush()) {
+      return 0;
+    }
+    writing_ = true;
+    if (_size >= buffer_size_) {
+      // Bypasses the buffer for big writes.
+      return stream_->Write(_buffer, _size);
+    }
+  }
+  std::memcpy(buffer_ + end_, _buffer, _size);
+  end_ += _size;
+  return _size;
+}
+
+int BufferedStream::Seek(int _offset, Origin _origin) {
+  if (_origin != kCurrent && _origin != kEnd && _origin != kSet) {
+    return -1;
+  }
+  // Seeking within read ahead data only moves the cursor.
+  if (!writing_ && end_ != 0 && _origin != kEnd) {
+    const int tell = Tell();
+    const int start = tell - static_cast<int>(cursor_);
+    const int target = _origin == kCurrent ? tell + _offset : _offset;
+    if (tell >= 0 && target >= start &&
+        target <= start + static_cast<int>(end_)) {
+      cursor_ = static_cast<size_t>(target - start);
+      return 0;
+    }
+  }
+  if (!Flush()) {
+    return -1;
+  }
+  return stream_->Seek(_offset, _origin);
+}
+
+int BufferedStream::Tell() const {
+  const int tell = stream_->Tell();
+  if (tell < 0) {
+    return tell;
+  }
+  return writing_ ? tell + static_cast<int>(end_) :
+                    tell - static_cast<int>(end_ - cursor_);
+}
 }  // io
 }  // ozz
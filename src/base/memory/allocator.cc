@@ -34,6 +34,7 @@
 #include <cassert>
 #include <memory.h>
 
+#include "ozz/base/atomic.h"
 #include "ozz/base/maths/math_ex.h"
 
 namespace ozz {
@@ -73,7 +74,7 @@ class HeapAllocator : public Allocator {
     header->unaligned = unaligned;
     header->size = _size;
     // Allocation's succeeded.
-    ++allocation_count_;
+    atomic::Increment(&allocation_count_);
     return aligned;
   }
 
@@ -87,7 +88,7 @@ class HeapAllocator : public Allocator {
       free(old_header->unaligned);
 
       // Deallocation completed.
-      --allocation_count_;
+      atomic::Decrement(&allocation_count_);
     }
     return new_block;
   }
@@ -98,14 +99,14 @@ class HeapAllocator : public Allocator {
         reinterpret_cast<char*>(_block) - sizeof(Header));
       free(header->unaligned);
       // Deallocation completed.
-      --allocation_count_;
+      atomic::Decrement(&allocation_count_);
     }
   }
 
  private:
   // Internal allocation count used to track memory leaks.
   // Should equals 0 at destruction time.
-  int allocation_count_;
+  volatile long allocation_count_;
 };
 
 namespace {
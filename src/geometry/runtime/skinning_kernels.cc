@@ -0,0 +1,75 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "../runtime/skinning_kernels.h"
+
+#include <cstddef>
+
+#include "ozz/base/cpu.h"
+
+// Instantiates kernels for the instruction set the library is built with.
+#define OZZ_SKINNING_KERNELS_GETTER GetBaselineSkinningKernels
+#include "../runtime/skinning_kernels-inl.h"
+
+namespace ozz {
+namespace geometry {
+namespace internal {
+
+namespace {
+// Kernels of the highest instruction set built, up to each instruction set.
+// They are resolved once during static initialization, so selecting kernels
+// is a single lookup.
+struct KernelsTable {
+  KernelsTable() {
+    const SkinningKernels* built[cpu::kInstructionSetCount] = {
+      GetBaselineSkinningKernels(),
+      GetSSE4_1SkinningKernels(),
+      GetAVX2SkinningKernels()};
+    kernels[cpu::kBaseline] = built[cpu::kBaseline];
+    for (int set = cpu::kBaseline + 1; set < cpu::kInstructionSetCount; ++set) {
+      kernels[set] = built[set] ? built[set] : kernels[set - 1];
+    }
+  }
+  const SkinningKernels* kernels[cpu::kInstructionSetCount];
+};
+const KernelsTable kKernelsTable;
+}  // namespace
+
+const SkinningKernels& GetSkinningKernels() {
+  const SkinningKernels* kernels =
+    kKernelsTable.kernels[cpu::GetInstructionSet()];
+  // Entries are NULL if a job is run before static initialization is done.
+  return kernels ? *kernels : *GetBaselineSkinningKernels();
+}
+}  // internal
+}  // geometry
+}  // ozz
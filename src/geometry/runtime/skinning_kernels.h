@@ -0,0 +1,76 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#ifndef OZZ_GEOMETRY_RUNTIME_SKINNING_KERNELS_H_
+#define OZZ_GEOMETRY_RUNTIME_SKINNING_KERNELS_H_
+
+#ifndef OZZ_INCLUDE_PRIVATE_HEADER
+#error "This header is private, it cannot be included from public headers."
+#endif  // OZZ_INCLUDE_PRIVATE_HEADER
+
+// Declares skinning job kernels. Kernels are compiled once per instruction
+// set (skinning_kernels*.cc files), the job is dispatched at runtime to the
+// kernels of the instruction set selected by ozz::cpu::GetInstructionSet().
+
+namespace ozz {
+namespace geometry {
+struct SkinningJob;
+
+namespace internal {
+
+// Defines a skinning function, specialized for a skinning variant.
+typedef void (*SkinningFct)(const SkinningJob&);
+
+// Defines the table of kernels compiled for an instruction set.
+struct SkinningKernels {
+  // Skinning functions, indexed by inverse transpose matrices usage (0 or 1),
+  // number of influences (1 to 4, then n), and normals/tangents presence
+  // (positions, + normals, + tangents).
+  SkinningFct fct[2][5][3];
+};
+
+// Returns kernels compiled for the baseline instruction set.
+const SkinningKernels* GetBaselineSkinningKernels();
+
+// Returns kernels compiled for SSE4.1 instruction set, or NULL if the library
+// isn't built with SSE4.1 kernels.
+const SkinningKernels* GetSSE4_1SkinningKernels();
+
+// Returns kernels compiled for AVX2 instruction set, or NULL if the library
+// isn't built with AVX2 kernels.
+const SkinningKernels* GetAVX2SkinningKernels();
+
+// Returns kernels of the highest instruction set built, up to the one selected
+// by ozz::cpu::GetInstructionSet().
+const SkinningKernels& GetSkinningKernels();
+}  // internal
+}  // geometry
+}  // ozz
+#endif  // OZZ_GEOMETRY_RUNTIME_SKINNING_KERNELS_H_
@@ -0,0 +1,52 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+// Internal include file
+#define OZZ_INCLUDE_PRIVATE_HEADER  // Allows to include private headers.
+#include "../runtime/skinning_kernels.h"
+
+#include <cstddef>
+
+// This file is compiled with AVX2 instruction set enabled, when supported
+// by the compiler and the target architecture (see CMakeLists.txt).
+#ifdef OZZ_HAS_AVX2
+#define OZZ_SKINNING_KERNELS_GETTER GetAVX2SkinningKernels
+#include "../runtime/skinning_kernels-inl.h"
+#else  // OZZ_HAS_AVX2
+namespace ozz {
+namespace geometry {
+namespace internal {
+const SkinningKernels* GetAVX2SkinningKernels() {
+  return NULL;
+}
+}  // internal
+}  // geometry
+}  // ozz
+#endif  // OZZ_HAS_AVX2
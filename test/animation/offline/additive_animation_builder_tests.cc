@@ -0,0 +1,281 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/additive_animation_builder.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/math_constant.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/maths/transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::AdditiveAnimationBuilder;
+using ozz::animation::offline::AnimationBuilder;
+
+typedef ozz::Range<const ozz::math::Transform> ReferencePose;
+
+namespace {
+
+// Builds a 2 tracks animation, the second one has no key.
+void BuildInput(RawAnimation* _input) {
+  _input->duration = 1.f;
+  _input->tracks.resize(2);
+  RawAnimation::JointTrack& track = _input->tracks[0];
+  const RawAnimation::TranslationKey t0 = {
+    0.f, ozz::math::Float3(1.f, 2.f, 3.f)};
+  const RawAnimation::TranslationKey t1 = {
+    1.f, ozz::math::Float3(2.f, 4.f, 6.f)};
+  track.translations.push_back(t0);
+  track.translations.push_back(t1);
+  const RawAnimation::RotationKey r0 = {
+    0.f, ozz::math::Quaternion::FromAxisAngle(
+      ozz::math::Float4(0.f, 1.f, 0.f, ozz::math::kPi_2 * .5f))};
+  const RawAnimation::RotationKey r1 = {
+    .5f, ozz::math::Quaternion::FromAxisAngle(
+      ozz::math::Float4(0.f, 1.f, 0.f, ozz::math::kPi_2))};
+  track.rotations.push_back(r0);
+  track.rotations.push_back(r1);
+  const RawAnimation::ScaleKey s0 = {
+    0.f, ozz::math::Float3(2.f, 2.f, 2.f)};
+  const RawAnimation::ScaleKey s1 = {
+    1.f, ozz::math::Float3(4.f, 1.f, 2.f)};
+  track.scales.push_back(s0);
+  track.scales.push_back(s1);
+}
+}  // namespace
+
+TEST(Error, AdditiveAnimationBuilder) {
+  AdditiveAnimationBuilder builder;
+
+  { // NULL output.
+    RawAnimation input;
+    EXPECT_TRUE(input.Validate());
+    EXPECT_FALSE(builder(input, NULL));
+  }
+
+  { // Invalid input animation.
+    RawAnimation input;
+    input.duration = -1.f;
+    EXPECT_FALSE(input.Validate());
+
+    RawAnimation output;
+    output.duration = -1.f;
+    output.tracks.resize(1);
+    EXPECT_FALSE(builder(input, &output));
+    EXPECT_FLOAT_EQ(output.duration, RawAnimation().duration);
+    EXPECT_EQ(output.num_tracks(), 0);
+  }
+
+  { // Reference pose too small.
+    RawAnimation input;
+    BuildInput(&input);
+    const ozz::math::Transform reference[1] = {
+      ozz::math::Transform::identity()};
+
+    RawAnimation output;
+    output.tracks.resize(1);
+    EXPECT_FALSE(builder(input, ReferencePose(reference), &output));
+    EXPECT_EQ(output.num_tracks(), 0);
+  }
+}
+
+TEST(BuildFirstKey, AdditiveAnimationBuilder) {
+  AdditiveAnimationBuilder builder;
+  RawAnimation input;
+  BuildInput(&input);
+
+  RawAnimation output;
+  ASSERT_TRUE(builder(input, &output));
+  EXPECT_FLOAT_EQ(output.duration, input.duration);
+  ASSERT_EQ(output.num_tracks(), 2);
+
+  const RawAnimation::JointTrack& track = output.tracks[0];
+  ASSERT_EQ(track.translations.size(), 2u);
+  EXPECT_FLOAT_EQ(track.translations[1].time, 1.f);
+  EXPECT_FLOAT3_EQ(track.translations[0].value, 0.f, 0.f, 0.f);
+  EXPECT_FLOAT3_EQ(track.translations[1].value, 1.f, 2.f, 3.f);
+
+  ASSERT_EQ(track.rotations.size(), 2u);
+  EXPECT_FLOAT_EQ(track.rotations[1].time, .5f);
+  EXPECT_QUATERNION_EQ(track.rotations[0].value, 0.f, 0.f, 0.f, 1.f);
+  EXPECT_QUATERNION_EQ(track.rotations[1].value,
+                       0.f, .3826834f, 0.f, .9238795f);
+
+  ASSERT_EQ(track.scales.size(), 2u);
+  EXPECT_FLOAT3_EQ(track.scales[0].value, 1.f, 1.f, 1.f);
+  EXPECT_FLOAT3_EQ(track.scales[1].value, 2.f, .5f, 1.f);
+
+  // Track without key remains without key.
+  EXPECT_EQ(output.tracks[1].translations.size(), 0u);
+  EXPECT_EQ(output.tracks[1].rotations.size(), 0u);
+  EXPECT_EQ(output.tracks[1].scales.size(), 0u);
+}
+
+TEST(BuildReference, AdditiveAnimationBuilder) {
+  AdditiveAnimationBuilder builder;
+  RawAnimation input;
+  BuildInput(&input);
+
+  const ozz::math::Transform reference[2] = {
+    {ozz::math::Float3(1.f, 1.f, 1.f),
+     ozz::math::Quaternion::FromAxisAngle(
+       ozz::math::Float4(0.f, 1.f, 0.f, ozz::math::kPi_2)),
+     ozz::math::Float3(2.f, 2.f, 2.f)},
+    {ozz::math::Float3(0.f, 0.f, 5.f),
+     ozz::math::Quaternion::identity(),
+     ozz::math::Float3(1.f, 1.f, .5f)}};
+
+  RawAnimation output;
+  ASSERT_TRUE(builder(input, ReferencePose(reference), &output));
+  ASSERT_EQ(output.num_tracks(), 2);
+
+  const RawAnimation::JointTrack& track = output.tracks[0];
+  ASSERT_EQ(track.translations.size(), 2u);
+  EXPECT_FLOAT3_EQ(track.translations[0].value, 0.f, 1.f, 2.f);
+  EXPECT_FLOAT3_EQ(track.translations[1].value, 1.f, 3.f, 5.f);
+
+  // Delta w is kept positive.
+  ASSERT_EQ(track.rotations.size(), 2u);
+  EXPECT_QUATERNION_EQ(track.rotations[0].value,
+                       0.f, -.3826834f, 0.f, .9238795f);
+  EXPECT_QUATERNION_EQ(track.rotations[1].value, 0.f, 0.f, 0.f, 1.f);
+
+  ASSERT_EQ(track.scales.size(), 2u);
+  EXPECT_FLOAT3_EQ(track.scales[0].value, 1.f, 1.f, 1.f);
+  EXPECT_FLOAT3_EQ(track.scales[1].value, 2.f, .5f, 1.f);
+
+  // Track without key is compared to identity.
+  const RawAnimation::JointTrack& empty = output.tracks[1];
+  ASSERT_EQ(empty.translations.size(), 1u);
+  EXPECT_FLOAT3_EQ(empty.translations[0].value, 0.f, 0.f, -5.f);
+  ASSERT_EQ(empty.rotations.size(), 1u);
+  EXPECT_QUATERNION_EQ(empty.rotations[0].value, 0.f, 0.f, 0.f, 1.f);
+  ASSERT_EQ(empty.scales.size(), 1u);
+  EXPECT_FLOAT3_EQ(empty.scales[0].value, 1.f, 1.f, 2.f);
+}
+
+TEST(Apply, AdditiveAnimationBuilder) {
+  // Applying the additive animation to its reference pose with a BlendingJob
+  // gives the input animation back.
+  RawAnimation input;
+  BuildInput(&input);
+  const ozz::math::Transform reference[2] = {
+    {ozz::math::Float3(1.f, -1.f, 0.f),
+     ozz::math::Quaternion::FromAxisAngle(
+       ozz::math::Float4(1.f, 0.f, 0.f, ozz::math::kPi_2 * .5f)),
+     ozz::math::Float3(1.f, 2.f, 1.f)},
+    ozz::math::Transform::identity()};
+
+  AdditiveAnimationBuilder additive_builder;
+  RawAnimation raw_additive;
+  ASSERT_TRUE(
+    additive_builder(input, ReferencePose(reference), &raw_additive));
+
+  AnimationBuilder builder;
+  ozz::animation::Animation* animation = builder(input);
+  ASSERT_TRUE(animation != NULL);
+  ozz::animation::Animation* additive = builder(raw_additive);
+  ASSERT_TRUE(additive != NULL);
+
+  // Reference pose, in soa format.
+  ozz::math::SoaTransform bind_pose[1] = {
+    ozz::math::SoaTransform::identity()};
+  bind_pose[0].translation = ozz::math::SoaFloat3::Load(
+    ozz::math::simd_float4::Load(1.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(-1.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::zero());
+  bind_pose[0].rotation = ozz::math::SoaQuaternion::Load(
+    ozz::math::simd_float4::Load(reference[0].rotation.x, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::zero(),
+    ozz::math::simd_float4::zero(),
+    ozz::math::simd_float4::Load(reference[0].rotation.w, 1.f, 1.f, 1.f));
+  bind_pose[0].scale = ozz::math::SoaFloat3::Load(
+    ozz::math::simd_float4::one(),
+    ozz::math::simd_float4::Load(2.f, 1.f, 1.f, 1.f),
+    ozz::math::simd_float4::one());
+
+  ozz::animation::SamplingCache cache(2);
+  for (float t = 0.f; t <= 1.f; t += .1f) {
+    ozz::math::SoaTransform x[1];
+    ozz::animation::SamplingJob sampling;
+    sampling.animation = animation;
+    sampling.cache = &cache;
+    sampling.time = t;
+    sampling.output = x;
+    ASSERT_TRUE(sampling.Run());
+
+    ozz::math::SoaTransform delta[1];
+    sampling.animation = additive;
+    sampling.output = delta;
+    ASSERT_TRUE(sampling.Run());
+
+    // Base layer has no weight, so the output is the bind pose on which the
+    // additive layer is applied.
+    ozz::animation::BlendingJob::Layer additive_layer[1];
+    additive_layer[0].weight = 1.f;
+    additive_layer[0].transform = delta;
+    ozz::math::SoaTransform output[1];
+    ozz::animation::BlendingJob blending;
+    blending.layers.begin = blending.layers.end = additive_layer;
+    blending.additive_layers = additive_layer;
+    blending.bind_pose = bind_pose;
+    blending.output = output;
+    ASSERT_TRUE(blending.Run());
+
+    // Only the first 2 joints are compared.
+    float a[4], b[4];
+    const ozz::math::SimdFloat4* values[2][10] = {
+      {&x[0].translation.x, &x[0].translation.y, &x[0].translation.z,
+       &x[0].rotation.x, &x[0].rotation.y, &x[0].rotation.z, &x[0].rotation.w,
+       &x[0].scale.x, &x[0].scale.y, &x[0].scale.z},
+      {&output[0].translation.x, &output[0].translation.y,
+       &output[0].translation.z, &output[0].rotation.x, &output[0].rotation.y,
+       &output[0].rotation.z, &output[0].rotation.w, &output[0].scale.x,
+       &output[0].scale.y, &output[0].scale.z}};
+    for (int v = 0; v < 10; ++v) {
+      ozz::math::StorePtrU(*values[0][v], a);
+      ozz::math::StorePtrU(*values[1][v], b);
+      EXPECT_NEAR(a[0], b[0], 2e-3f);
+      EXPECT_NEAR(a[1], b[1], 2e-3f);
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(additive);
+}
@@ -310,3 +310,329 @@ TEST(Sort, AnimationBuilder) {
     ozz::memory::default_allocator()->Delete(animation);
   }
 }
+
+TEST(Constant, AnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);
+
+  // Track 0 translation has keys with the same value, track 1 is animated,
+  // track 2 has no key and track 3 has a single key. Track 4 is animated.
+  for (int i = 0; i < 3; ++i) {
+    const float time = i * .4f;
+    const RawAnimation::TranslationKey t0 = {
+      time, ozz::math::Float3(1.f, 2.f, 3.f)};
+    raw_animation.tracks[0].translations.push_back(t0);
+    const RawAnimation::TranslationKey t1 = {
+      time, ozz::math::Float3(time, 0.f, 0.f)};
+    raw_animation.tracks[1].translations.push_back(t1);
+    const RawAnimation::TranslationKey t4 = {
+      time, ozz::math::Float3(0.f, 0.f, time)};
+    raw_animation.tracks[4].translations.push_back(t4);
+  }
+  const RawAnimation::TranslationKey t3 = {
+    .5f, ozz::math::Float3(4.f, 5.f, 6.f)};
+  raw_animation.tracks[3].translations.push_back(t3);
+
+  // All rotations are constant, only scale of track 4 is animated.
+  const RawAnimation::RotationKey r2 = {
+    .2f, ozz::math::Quaternion(0.f, 0.f, -.70710677f, -.70710677f)};
+  raw_animation.tracks[2].rotations.push_back(r2);
+  const RawAnimation::ScaleKey s40 = {.2f, ozz::math::Float3(1.f, 1.f, 1.f)};
+  raw_animation.tracks[4].scales.push_back(s40);
+  const RawAnimation::ScaleKey s41 = {.6f, ozz::math::Float3(2.f, 2.f, 2.f)};
+  raw_animation.tracks[4].scales.push_back(s41);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  // Constant tracks have no key.
+  EXPECT_EQ(animation->num_animated_translations(), 2);
+  EXPECT_EQ(animation->num_animated_rotations(), 0);
+  EXPECT_TRUE(animation->rotations().begin == animation->rotations().end);
+  EXPECT_EQ(animation->num_animated_scales(), 1);
+
+  // Constant tracks are flagged, including soa padding tracks.
+  ASSERT_EQ(animation->translation_constant_flags().Count(), 2u);
+  EXPECT_EQ(animation->translation_constant_flags().begin[0], 0xd);
+  EXPECT_EQ(animation->translation_constant_flags().begin[1], 0xe);
+  ASSERT_EQ(animation->translation_constants().Count(), 2u);
+  ASSERT_EQ(animation->rotation_constant_flags().Count(), 2u);
+  EXPECT_EQ(animation->rotation_constant_flags().begin[0], 0xf);
+  EXPECT_EQ(animation->rotation_constant_flags().begin[1], 0xf);
+  ASSERT_EQ(animation->rotation_constants().Count(), 2u);
+  ASSERT_EQ(animation->scale_constant_flags().Count(), 2u);
+  EXPECT_EQ(animation->scale_constant_flags().begin[0], 0xf);
+  EXPECT_EQ(animation->scale_constant_flags().begin[1], 0xe);
+  ASSERT_EQ(animation->scale_constants().Count(), 2u);
+
+  // Constant values are normalized (rotations) but not quantized.
+  EXPECT_SOAFLOAT3_EQ(animation->translation_constants().begin[0],
+                      1.f, 0.f, 0.f, 4.f,
+                      2.f, 0.f, 0.f, 5.f,
+                      3.f, 0.f, 0.f, 6.f);
+  EXPECT_SOAQUATERNION_EQ_EST(animation->rotation_constants().begin[0],
+                              0.f, 0.f, 0.f, 0.f,
+                              0.f, 0.f, 0.f, 0.f,
+                              0.f, 0.f, .70710677f, 0.f,
+                              1.f, 1.f, .70710677f, 1.f);
+
+  // Samples constant and animated tracks.
+  ozz::animation::SamplingJob job;
+  ozz::animation::SamplingCache cache(5);
+  ozz::math::SoaTransform output[2];
+  job.animation = animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 2;
+
+  job.time = .6f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1.f, .6f, 0.f, 4.f,
+                                                 2.f, 0.f, 0.f, 5.f,
+                                                 3.f, 0.f, 0.f, 6.f);
+  EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation, 0.f, 0.f, 0.f, 0.f,
+                                                  0.f, 0.f, 0.f, 0.f,
+                                                  0.f, 0.f, .70710677f, 0.f,
+                                                  1.f, 1.f, .70710677f, 1.f);
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].scale, 1.f, 1.f, 1.f, 1.f,
+                                           1.f, 1.f, 1.f, 1.f,
+                                           1.f, 1.f, 1.f, 1.f);
+  EXPECT_SOAFLOAT3_EQ_EST(output[1].translation, 0.f, 0.f, 0.f, 0.f,
+                                                 0.f, 0.f, 0.f, 0.f,
+                                                 .6f, 0.f, 0.f, 0.f);
+  EXPECT_SOAFLOAT3_EQ_EST(output[1].scale, 2.f, 1.f, 1.f, 1.f,
+                                           2.f, 1.f, 1.f, 1.f,
+                                           2.f, 1.f, 1.f, 1.f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(KeyTimeQuantization, AnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1000.f;
+  raw_animation.tracks.resize(1);
+
+  const RawAnimation::TranslationKey key0 = {
+    0.f, ozz::math::Float3(1.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(key0);
+  const RawAnimation::TranslationKey key1 = {
+    1000.f / 65535.f, ozz::math::Float3(2.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(key1);
+  const RawAnimation::TranslationKey key2 = {
+    500.f, ozz::math::Float3(4.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(key2);
+  const RawAnimation::TranslationKey key3 = {
+    999.999f, ozz::math::Float3(8.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(key3);
+
+  // Key 1 is 1/65535th of the duration after key 0, so it has its own
+  // quantized time on 16 bits.
+  AnimationBuilder builder;
+  {
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_FALSE(animation->wide_key_times());
+    EXPECT_EQ(animation->translation_time_highs().Count(), 0u);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  // Constant tracks keys are dropped, so they can be closer.
+  const RawAnimation::RotationKey rkey0 = {
+    0.f, ozz::math::Quaternion::identity()};
+  raw_animation.tracks[0].rotations.push_back(rkey0);
+  const RawAnimation::RotationKey rkey1 = {
+    .001f, ozz::math::Quaternion::identity()};
+  raw_animation.tracks[0].rotations.push_back(rkey1);
+  {
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_FALSE(animation->wide_key_times());
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+  raw_animation.tracks[0].rotations.clear();
+
+  // Key 1 now shares key 0 quantized time on 16 bits, but not on 24 bits. Key
+  // times are widened rather than merging them.
+  raw_animation.tracks[0].translations[1].time = .001f;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_TRUE(animation->wide_key_times());
+  // A time high bits element per key: the 4 raw keys, plus the key added at
+  // t = duration.
+  EXPECT_EQ(animation->translation_time_highs().Count(), 5u);
+  EXPECT_EQ(animation->rotation_time_highs().Count(), 0u);
+
+  ozz::animation::SamplingJob job;
+  ozz::animation::SamplingCache cache(1);
+  ozz::math::SoaTransform output[1];
+  job.animation = animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 1;
+
+  job.time = 0.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1.f, 0.f, 0.f, 0.f,
+                                                 0.f, 0.f, 0.f, 0.f,
+                                                 0.f, 0.f, 0.f, 0.f);
+  job.time = .002f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 2.f, 0.f, 0.f, 0.f,
+                                                 0.f, 0.f, 0.f, 0.f,
+                                                 0.f, 0.f, 0.f, 0.f);
+  job.time = 250.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 3.f, 0.f, 0.f, 0.f,
+                                                 0.f, 0.f, 0.f, 0.f,
+                                                 0.f, 0.f, 0.f, 0.f);
+  job.time = 1000.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 8.f, 0.f, 0.f, 0.f,
+                                                 0.f, 0.f, 0.f, 0.f,
+                                                 0.f, 0.f, 0.f, 0.f);
+  ozz::memory::default_allocator()->Delete(animation);
+
+  // Keys that share the same quantized time even on 24 bits fail building.
+  raw_animation.tracks[0].translations[1].time = .00001f;
+  EXPECT_TRUE(!builder(raw_animation));
+
+  // The same applies to rotations and scales.
+  raw_animation.tracks[0].translations.erase(
+    raw_animation.tracks[0].translations.begin() + 1);
+  raw_animation.tracks[0].rotations.push_back(rkey0);
+  const RawAnimation::RotationKey rkey1_animated = {
+    .00001f, ozz::math::Quaternion(0.f, .70710677f, 0.f, .70710677f)};
+  raw_animation.tracks[0].rotations.push_back(rkey1_animated);
+  ASSERT_TRUE(raw_animation.Validate());
+  EXPECT_TRUE(!builder(raw_animation));
+}
+
+TEST(LongKeyTimeQuantization, AnimationBuilder) {
+  // A 60 fps clip of 20 minutes, whose keys are less than 1/65535th of the
+  // duration apart.
+  const int num_keys = 60 * 60 * 20 + 1;
+  RawAnimation raw_animation;
+  raw_animation.duration = 60.f * 20.f;
+  raw_animation.tracks.resize(1);
+  for (int i = 0; i < num_keys; ++i) {
+    const RawAnimation::TranslationKey key = {
+      i / 60.f, ozz::math::Float3(static_cast<float>(i & 1), 0.f, 0.f)};
+    raw_animation.tracks[0].translations.push_back(key);
+  }
+  ASSERT_TRUE(raw_animation.Validate());
+
+  AnimationBuilder builder;
+  builder.seek_interval = 60.f;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_TRUE(animation->wide_key_times());
+  EXPECT_EQ(animation->translation_time_highs().Count(),
+            static_cast<size_t>(num_keys));
+
+  ozz::animation::SamplingJob job;
+  ozz::animation::SamplingCache cache(1);
+  ozz::math::SoaTransform output[1];
+  job.animation = animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 1;
+
+  // Samples forward, then backward through the seek index.
+  const float times[] = {0.f, 1.f / 60.f, 600.f + 1.f / 120.f, 1100.f,
+                         301.f / 60.f, 1200.f};
+  const float values[] = {0.f, 1.f, .5f, 0.f, 1.f, 0.f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    job.time = times[i];
+    ASSERT_TRUE(job.Run());
+    EXPECT_NEAR(ozz::math::GetX(output[0].translation.x), values[i], 1e-2f);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Quantization, AnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+
+  // Track 0 is a large root motion, track 1 a small local offset.
+  for (int i = 0; i <= 10; ++i) {
+    const float time = i * .1f;
+    const RawAnimation::TranslationKey t0 = {
+      time, ozz::math::Float3(2000.f * time, -1000.f * time, 1.f)};
+    raw_animation.tracks[0].translations.push_back(t0);
+    const RawAnimation::TranslationKey t1 = {
+      time, ozz::math::Float3(.001f * time, 0.f, -.001f * time)};
+    raw_animation.tracks[1].translations.push_back(t1);
+    const RawAnimation::ScaleKey s1 = {
+      time, ozz::math::Float3(1.f, 1.f + time, 1.f)};
+    raw_animation.tracks[1].scales.push_back(s1);
+  }
+
+  AnimationBuilder builder;
+
+  // Invalid bit widths.
+  builder.translation_bits = 0;
+  EXPECT_TRUE(!builder(raw_animation));
+  builder.translation_bits = 17;
+  EXPECT_TRUE(!builder(raw_animation));
+  builder.translation_bits = 16;
+  builder.scale_bits = 0;
+  EXPECT_TRUE(!builder(raw_animation));
+  builder.scale_bits = 17;
+  EXPECT_TRUE(!builder(raw_animation));
+
+  // Values are bit-packed, so fewer bits make smaller animations.
+  const int bits[] = {16, 11, 8};
+  size_t previous_size = 0;
+  for (size_t b = 0; b < OZZ_ARRAY_SIZE(bits); ++b) {
+    builder.translation_bits = bits[b];
+    builder.scale_bits = bits[b];
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    ASSERT_EQ(animation->translation_ranges().Count(), 2u);
+    ASSERT_EQ(animation->scale_ranges().Count(), 2u);
+    EXPECT_EQ(animation->translation_bits(), bits[b]);
+    EXPECT_EQ(animation->scale_bits(), bits[b]);
+    if (b) {
+      EXPECT_LT(animation->size(), previous_size);
+    }
+    previous_size = animation->size();
+
+    ozz::animation::SamplingJob job;
+    ozz::animation::SamplingCache cache(2);
+    ozz::math::SoaTransform output[1];
+    job.animation = animation;
+    job.cache = &cache;
+    job.output.begin = output;
+    job.output.end = output + 1;
+
+    // Keys are restored within half a quantization step of their track range.
+    // Key times are quantized too, to half a key time unit (1/65535th of the
+    // duration), which adds the track slope times this time error.
+    for (int i = 0; i <= 10; ++i) {
+      const float time = i * .1f;
+      job.time = time;
+      ASSERT_TRUE(job.Run());
+      const float range = static_cast<float>((1 << bits[b]) - 1);
+      const float half_step = .5f / range;
+      const float time_error = .5f / 65535.f;
+      ozz::math::SimdFloat4 expected_x = ozz::math::simd_float4::Load(
+        2000.f * time, .001f * time, 0.f, 0.f);
+      ozz::math::SimdFloat4 tolerance_x = ozz::math::simd_float4::Load(
+        1e-5f + 2000.f * (half_step + time_error),
+        1e-9f + .001f * (half_step + time_error), 0.f, 0.f);
+      const ozz::math::SimdInt4 in_range = ozz::math::CmpLe(
+        ozz::math::Abs(output[0].translation.x - expected_x), tolerance_x);
+      EXPECT_EQ(ozz::math::MoveMask(in_range), 0xf);
+      if (bits[b] == 16) {
+        EXPECT_SOAFLOAT3_EQ_EST(output[0].scale, 1.f, 1.f, 1.f, 1.f,
+                                                 1.f, 1.f + time, 1.f, 1.f,
+                                                 1.f, 1.f, 1.f, 1.f);
+      }
+    }
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+}
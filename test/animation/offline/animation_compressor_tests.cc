@@ -0,0 +1,338 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/animation_compressor.h"
+
+#include <cmath>
+
+#include "gtest/gtest.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/simd_math.h"
+#include "ozz/base/maths/soa_transform.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+
+#include "ozz/animation/runtime/compressed_animation.h"
+#include "ozz/animation/runtime/compressed_sampling_job.h"
+#include "ozz/animation/runtime/local_to_model_job.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+using ozz::animation::CompressedAnimation;
+using ozz::animation::CompressedSamplingJob;
+using ozz::animation::LocalToModelJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::AnimationCompressor;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a skeleton made of a chain of 4 joints.
+Skeleton* BuildChainSkeleton() {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint* joint = &raw_skeleton.roots[0];
+  for (int i = 0; i < 4; ++i) {
+    joint->name = "joint";
+    joint->name += static_cast<char>('0' + i);
+    if (i != 3) {
+      joint->children.resize(1);
+      joint = &joint->children[0];
+    }
+  }
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+
+// Returns the local-space transform of _joint at _frame of the animation built
+// by BuildChainAnimation.
+void ChainTransform(int _joint, int _frame,
+                    ozz::math::Float3* _translation,
+                    ozz::math::Quaternion* _rotation) {
+  *_translation = _joint == 0 ?
+    ozz::math::Float3(std::sin(_frame * .3f), 0.f, 0.f) :
+    ozz::math::Float3(0.f, .3f + _joint * .1f, 0.f);
+  *_rotation = ozz::math::Quaternion::FromAxisAngle(
+    ozz::math::Float4(0.f, 0.f, 1.f,
+                      std::sin(_frame * .2f + _joint) * (_joint + 1) * .3f));
+}
+
+// Builds an animation of the chain skeleton, with keys at 30 frames per
+// second, for 1 second.
+void BuildChainAnimation(RawAnimation* _animation) {
+  _animation->duration = 1.f;
+  _animation->tracks.resize(4);
+  for (int i = 0; i < 4; ++i) {
+    for (int f = 0; f <= 30; ++f) {
+      RawAnimation::TranslationKey t_key;
+      RawAnimation::RotationKey r_key;
+      t_key.time = r_key.time = f / 30.f;
+      ChainTransform(i, f, &t_key.value, &r_key.value);
+      _animation->tracks[i].translations.push_back(t_key);
+      _animation->tracks[i].rotations.push_back(r_key);
+    }
+  }
+}
+
+// Computes model-space position of _skeleton joints from _locals.
+void ModelSpacePositions(const Skeleton& _skeleton,
+                         const ozz::math::SoaTransform& _locals,
+                         ozz::math::Float3* _positions) {
+  ozz::math::Float4x4 models[4];
+  LocalToModelJob job;
+  job.skeleton = &_skeleton;
+  job.input.begin = &_locals;
+  job.input.end = &_locals + 1;
+  job.output.begin = models;
+  job.output.end = models + 4;
+  ASSERT_TRUE(job.Run());
+  for (int i = 0; i < 4; ++i) {
+    float values[4];
+    ozz::math::StorePtrU(models[i].cols[3], values);
+    _positions[i] = ozz::math::Float3(values[0], values[1], values[2]);
+  }
+}
+}  // namespace
+
+TEST(Error, AnimationCompressor) {
+  Skeleton* skeleton = BuildChainSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  AnimationCompressor compressor;
+
+  {  // Invalid raw animation.
+    RawAnimation raw_animation;
+    raw_animation.duration = -1.f;
+    raw_animation.tracks.resize(4);
+    EXPECT_TRUE(!compressor(raw_animation, *skeleton));
+  }
+
+  {  // Number of tracks doesn't match skeleton.
+    RawAnimation raw_animation;
+    raw_animation.duration = 1.f;
+    raw_animation.tracks.resize(3);
+    EXPECT_TRUE(!compressor(raw_animation, *skeleton));
+  }
+
+  {  // Invalid compression settings.
+    RawAnimation raw_animation;
+    raw_animation.duration = 1.f;
+    raw_animation.tracks.resize(4);
+
+    AnimationCompressor invalid_tolerance;
+    invalid_tolerance.tolerance = 0.f;
+    EXPECT_TRUE(!invalid_tolerance(raw_animation, *skeleton));
+
+    AnimationCompressor invalid_distance;
+    invalid_distance.distance = 0.f;
+    EXPECT_TRUE(!invalid_distance(raw_animation, *skeleton));
+
+    AnimationCompressor invalid_rate;
+    invalid_rate.sample_rate = 0.f;
+    EXPECT_TRUE(!invalid_rate(raw_animation, *skeleton));
+  }
+
+  {  // Valid animation.
+    RawAnimation raw_animation;
+    raw_animation.duration = 1.f;
+    raw_animation.tracks.resize(4);
+    CompressedAnimation* animation = compressor(raw_animation, *skeleton);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_EQ(animation->num_tracks(), 4);
+    EXPECT_EQ(animation->num_frames(), 31);
+
+    // Constant tracks use no bit at all.
+    EXPECT_EQ(animation->frame_bits(), 0);
+    EXPECT_EQ(animation->block_size(), 0);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Constant, AnimationCompressor) {
+  Skeleton* skeleton = BuildChainSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  // All tracks are constant, so frames use no bit at all and the blocks buffer
+  // is only made of padding bytes.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(4);
+  for (int i = 0; i < 4; ++i) {
+    const RawAnimation::TranslationKey key = {
+      .5f, ozz::math::Float3(static_cast<float>(i), -1.f, 2.f)};
+    raw_animation.tracks[i].translations.push_back(key);
+  }
+
+  AnimationCompressor compressor;
+  CompressedAnimation* animation = compressor(raw_animation, *skeleton);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_EQ(animation->frame_bits(), 0);
+  EXPECT_EQ(animation->blocks().Count(),
+            static_cast<size_t>(CompressedAnimation::kPaddingBytes));
+
+  const float times[] = {0.f, .3f, 1.f, 2.7f};
+  for (size_t t = 0; t < OZZ_ARRAY_SIZE(times); ++t) {
+    ozz::math::SoaTransform output;
+    CompressedSamplingJob job;
+    job.animation = animation;
+    job.time = times[t];
+    job.loop = true;
+    job.output.begin = &output;
+    job.output.end = &output + 1;
+    ASSERT_TRUE(job.Run());
+
+    EXPECT_SOAFLOAT3_EQ_EST(output.translation, 0.f, 1.f, 2.f, 3.f,
+                                                -1.f, -1.f, -1.f, -1.f,
+                                                2.f, 2.f, 2.f, 2.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output.rotation, 0.f, 0.f, 0.f, 0.f,
+                                                 0.f, 0.f, 0.f, 0.f,
+                                                 0.f, 0.f, 0.f, 0.f,
+                                                 1.f, 1.f, 1.f, 1.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output.scale, 1.f, 1.f, 1.f, 1.f,
+                                          1.f, 1.f, 1.f, 1.f,
+                                          1.f, 1.f, 1.f, 1.f);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Frames, AnimationCompressor) {
+  Skeleton* skeleton = BuildChainSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(4);
+  const RawAnimation::TranslationKey t_key0 = {
+    0.f, ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[1].translations.push_back(t_key0);
+  const RawAnimation::TranslationKey t_key1 = {
+    2.f, ozz::math::Float3(1.f, 0.f, 0.f)};
+  raw_animation.tracks[1].translations.push_back(t_key1);
+
+  AnimationCompressor compressor;
+  compressor.sample_rate = 10.f;
+  CompressedAnimation* animation = compressor(raw_animation, *skeleton);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_EQ(animation->num_frames(), 21);
+
+  // Only track 1 translation is animated.
+  const int bits = animation->translation_bits().begin[1];
+  EXPECT_GT(bits, 0);
+  EXPECT_EQ(animation->frame_bits(), bits * 3);
+  EXPECT_EQ(animation->block_size(),
+            (bits * 3 * CompressedAnimation::kBlockFrames + 7) / 8);
+  EXPECT_EQ(animation->blocks().Count(),
+            animation->block_size() * 2u + CompressedAnimation::kPaddingBytes);
+
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Tolerance, AnimationCompressor) {
+  Skeleton* skeleton = BuildChainSkeleton();
+  ASSERT_TRUE(skeleton != NULL);
+
+  RawAnimation raw_animation;
+  BuildChainAnimation(&raw_animation);
+
+  int previous_frame_bits = 0;
+  const float tolerances[] = {1e-2f, 1e-3f, 1e-4f};
+  for (size_t t = 0; t < OZZ_ARRAY_SIZE(tolerances); ++t) {
+    AnimationCompressor compressor;
+    compressor.tolerance = tolerances[t];
+    CompressedAnimation* animation = compressor(raw_animation, *skeleton);
+    ASSERT_TRUE(animation != NULL);
+
+    // Lower tolerances require more bits.
+    EXPECT_GT(animation->frame_bits(), previous_frame_bits);
+    previous_frame_bits = animation->frame_bits();
+
+    // Root joint carries the longest chain, so it needs more rotation bits
+    // than the leaf.
+    EXPECT_GE(animation->rotation_bits().begin[0],
+              animation->rotation_bits().begin[3]);
+
+    // Compares model-space joint positions to the raw animation ones, for
+    // every frame.
+    for (int f = 0; f <= 30; ++f) {
+      ozz::math::SoaTransform output;
+      CompressedSamplingJob job;
+      job.animation = animation;
+      job.time = f / 30.f;
+      job.output.begin = &output;
+      job.output.end = &output + 1;
+      ASSERT_TRUE(job.Run());
+
+      ozz::math::Float3 translations[4];
+      ozz::math::Quaternion rotations[4];
+      for (int i = 0; i < 4; ++i) {
+        ChainTransform(i, f, &translations[i], &rotations[i]);
+      }
+      const ozz::math::SoaTransform expected = {
+        {ozz::math::simd_float4::Load(translations[0].x, translations[1].x,
+                                      translations[2].x, translations[3].x),
+         ozz::math::simd_float4::Load(translations[0].y, translations[1].y,
+                                      translations[2].y, translations[3].y),
+         ozz::math::simd_float4::Load(translations[0].z, translations[1].z,
+                                      translations[2].z, translations[3].z)},
+        {ozz::math::simd_float4::Load(rotations[0].x, rotations[1].x,
+                                      rotations[2].x, rotations[3].x),
+         ozz::math::simd_float4::Load(rotations[0].y, rotations[1].y,
+                                      rotations[2].y, rotations[3].y),
+         ozz::math::simd_float4::Load(rotations[0].z, rotations[1].z,
+                                      rotations[2].z, rotations[3].z),
+         ozz::math::simd_float4::Load(rotations[0].w, rotations[1].w,
+                                      rotations[2].w, rotations[3].w)},
+        {ozz::math::simd_float4::one(),
+         ozz::math::simd_float4::one(),
+         ozz::math::simd_float4::one()}};
+
+      ozz::math::Float3 expected_positions[4];
+      ModelSpacePositions(*skeleton, expected, expected_positions);
+      ozz::math::Float3 positions[4];
+      ModelSpacePositions(*skeleton, output, positions);
+      for (int i = 0; i < 4; ++i) {
+        EXPECT_LE(Length(positions[i] - expected_positions[i]),
+                  tolerances[t]);
+      }
+    }
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
@@ -0,0 +1,147 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/offline/segmented_animation_builder.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/segmented_animation.h"
+
+using ozz::animation::Animation;
+using ozz::animation::SegmentedAnimation;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::SegmentedAnimationBuilder;
+
+TEST(Error, SegmentedAnimationBuilder) {
+  SegmentedAnimationBuilder builder;
+
+  {  // Invalid duration.
+    RawAnimation raw_animation;
+    raw_animation.duration = 0.f;
+    EXPECT_TRUE(!builder(raw_animation));
+  }
+
+  {  // Invalid segment duration.
+    RawAnimation raw_animation;
+    raw_animation.duration = 1.f;
+    SegmentedAnimationBuilder invalid_builder;
+    invalid_builder.segment_duration = 0.f;
+    EXPECT_TRUE(!invalid_builder(raw_animation));
+  }
+
+  {  // Unsorted keys.
+    RawAnimation raw_animation;
+    raw_animation.duration = 1.f;
+    raw_animation.tracks.resize(1);
+    const RawAnimation::TranslationKey first = {
+      .8f, ozz::math::Float3::zero()};
+    raw_animation.tracks[0].translations.push_back(first);
+    const RawAnimation::TranslationKey second = {
+      .2f, ozz::math::Float3::zero()};
+    raw_animation.tracks[0].translations.push_back(second);
+    EXPECT_TRUE(!builder(raw_animation));
+  }
+}
+
+TEST(Segments, SegmentedAnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.tracks.resize(5);
+  SegmentedAnimationBuilder builder;
+  builder.segment_duration = 2.f;
+
+  {  // Shorter than a segment.
+    raw_animation.duration = 1.f;
+    SegmentedAnimation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    EXPECT_FLOAT_EQ(animation->duration(), 1.f);
+    EXPECT_FLOAT_EQ(animation->segment_duration(), 2.f);
+    EXPECT_EQ(animation->num_tracks(), 5);
+    EXPECT_EQ(animation->num_soa_tracks(), 2);
+    ASSERT_EQ(animation->num_segments(), 1);
+    ASSERT_TRUE(animation->segment(0) != NULL);
+    EXPECT_FLOAT_EQ(animation->segment(0)->duration(), 1.f);
+    EXPECT_EQ(animation->segment(0)->num_tracks(), 5);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  {  // Last segment is shorter.
+    raw_animation.duration = 5.f;
+    SegmentedAnimation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    ASSERT_EQ(animation->num_segments(), 3);
+    EXPECT_FLOAT_EQ(animation->segment(0)->duration(), 2.f);
+    EXPECT_FLOAT_EQ(animation->segment(1)->duration(), 2.f);
+    EXPECT_FLOAT_EQ(animation->segment(2)->duration(), 1.f);
+    EXPECT_FLOAT_EQ(animation->segment_start(2), 4.f);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+
+  {  // Too short last segment is merged with the previous one.
+    raw_animation.duration = 4.001f;
+    SegmentedAnimation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+    ASSERT_EQ(animation->num_segments(), 2);
+    EXPECT_FLOAT_EQ(animation->segment(0)->duration(), 2.f);
+    EXPECT_NEAR(animation->segment(1)->duration(), 2.001f, 1e-5f);
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+}
+
+TEST(FindSegment, SegmentedAnimationBuilder) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 5.f;
+  SegmentedAnimationBuilder builder;
+  builder.segment_duration = 2.f;
+  SegmentedAnimation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  EXPECT_EQ(animation->FindSegment(-1.f, false), 0);
+  EXPECT_EQ(animation->FindSegment(0.f, false), 0);
+  EXPECT_EQ(animation->FindSegment(1.99f, false), 0);
+  EXPECT_EQ(animation->FindSegment(2.f, false), 1);
+  EXPECT_EQ(animation->FindSegment(4.5f, false), 2);
+  EXPECT_EQ(animation->FindSegment(5.f, false), 2);
+  EXPECT_EQ(animation->FindSegment(6.f, false), 2);
+  EXPECT_EQ(animation->FindSegment(6.f, true), 0);
+  EXPECT_EQ(animation->FindSegment(-.5f, true), 2);
+  EXPECT_EQ(animation->FindSegment(12.5f, true), 1);
+
+  ozz::memory::default_allocator()->Delete(animation);
+
+  // Empty animation has no segment.
+  SegmentedAnimation empty;
+  EXPECT_EQ(empty.num_segments(), 0);
+  EXPECT_EQ(empty.FindSegment(0.f, false), -1);
+}
@@ -34,6 +34,7 @@
 #include "ozz/base/maths/gtest_math_helper.h"
 
 #include "ozz/base/io/archive.h"
+#include "ozz/base/io/image.h"
 #include "ozz/base/io/stream.h"
 #include "ozz/base/memory/allocator.h"
 
@@ -94,6 +95,7 @@ TEST(Filled, AnimationSerialize) {
     raw_animation.tracks[0].scales.push_back(s_key);
 
     AnimationBuilder builder;
+    builder.seek_interval = .4f;
     o_animation = builder(raw_animation);
     ASSERT_TRUE(o_animation != NULL);
   }
@@ -117,6 +119,65 @@ TEST(Filled, AnimationSerialize) {
     ASSERT_EQ(o_animation->num_tracks(), i_animation.num_tracks());
     EXPECT_EQ(o_animation->size(), i_animation.size());
 
+    // Compares seek indexes.
+    ASSERT_FLOAT_EQ(o_animation->seek_interval(), i_animation.seek_interval());
+    ASSERT_EQ(o_animation->translation_seeks().Count(), 2u * (1 + 4 * 2));
+    ASSERT_EQ(o_animation->translation_seeks().Count(),
+              i_animation.translation_seeks().Count());
+    EXPECT_EQ(memcmp(o_animation->translation_seeks().begin,
+                     i_animation.translation_seeks().begin,
+                     o_animation->translation_seeks().Size()), 0);
+    ASSERT_EQ(o_animation->rotation_seeks().Count(),
+              i_animation.rotation_seeks().Count());
+    EXPECT_EQ(memcmp(o_animation->rotation_seeks().begin,
+                     i_animation.rotation_seeks().begin,
+                     o_animation->rotation_seeks().Size()), 0);
+    ASSERT_EQ(o_animation->scale_seeks().Count(),
+              i_animation.scale_seeks().Count());
+    EXPECT_EQ(memcmp(o_animation->scale_seeks().begin,
+                     i_animation.scale_seeks().begin,
+                     o_animation->scale_seeks().Size()), 0);
+
+    // Compares quantization ranges.
+    ASSERT_EQ(o_animation->translation_ranges().Count(), 2u);
+    ASSERT_EQ(o_animation->translation_ranges().Count(),
+              i_animation.translation_ranges().Count());
+    EXPECT_EQ(memcmp(o_animation->translation_ranges().begin,
+                     i_animation.translation_ranges().begin,
+                     o_animation->translation_ranges().Size()), 0);
+    ASSERT_EQ(o_animation->scale_ranges().Count(),
+              i_animation.scale_ranges().Count());
+
+    // Compares constant tracks.
+    EXPECT_EQ(o_animation->num_animated_translations(),
+              i_animation.num_animated_translations());
+    EXPECT_EQ(o_animation->num_animated_rotations(),
+              i_animation.num_animated_rotations());
+    EXPECT_EQ(o_animation->num_animated_scales(),
+              i_animation.num_animated_scales());
+    ASSERT_EQ(o_animation->translation_constant_flags().Count(), 1u);
+    ASSERT_EQ(i_animation.translation_constant_flags().Count(), 1u);
+    EXPECT_EQ(o_animation->translation_constant_flags().begin[0],
+              i_animation.translation_constant_flags().begin[0]);
+    ASSERT_EQ(i_animation.translation_constants().Count(), 1u);
+    EXPECT_EQ(memcmp(o_animation->translation_constants().begin,
+                     i_animation.translation_constants().begin,
+                     o_animation->translation_constants().Size()), 0);
+    ASSERT_EQ(i_animation.rotation_constant_flags().Count(), 1u);
+    EXPECT_EQ(o_animation->rotation_constant_flags().begin[0],
+              i_animation.rotation_constant_flags().begin[0]);
+    ASSERT_EQ(i_animation.rotation_constants().Count(), 1u);
+    EXPECT_EQ(memcmp(o_animation->rotation_constants().begin,
+                     i_animation.rotation_constants().begin,
+                     o_animation->rotation_constants().Size()), 0);
+    ASSERT_EQ(i_animation.scale_constant_flags().Count(), 1u);
+    EXPECT_EQ(o_animation->scale_constant_flags().begin[0],
+              i_animation.scale_constant_flags().begin[0]);
+    ASSERT_EQ(i_animation.scale_constants().Count(), 1u);
+    EXPECT_EQ(memcmp(o_animation->scale_constants().begin,
+                     i_animation.scale_constants().begin,
+                     o_animation->scale_constants().Size()), 0);
+
     // Needs to sample to test the animation.
     ozz::animation::SamplingJob job;
     ozz::animation::SamplingCache cache(1);
@@ -201,3 +262,328 @@ TEST(AlreadyInitialized, AnimationSerialize) {
     ASSERT_EQ(i_animation.num_tracks(), 2);
   }
 }
+
+TEST(CorruptedSeeks, AnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+  for (int i = 0; i <= 4; ++i) {
+    const RawAnimation::TranslationKey key = {
+      i * .25f, ozz::math::Float3(i * 1.f, 0.f, 0.f)};
+    raw_animation.tracks[0].translations.push_back(key);
+  }
+
+  AnimationBuilder builder;
+  builder.seek_interval = .3f;
+  Animation* o_animation = builder(raw_animation);
+  ASSERT_TRUE(o_animation != NULL);
+
+  // Seek index is serialized last: interval, followed by translation, rotation
+  // and scale buffers, each of them being a count followed by the entries.
+  const int stride = 1 + 4 * 2;
+  const int num_seeks = 3;
+  ASSERT_EQ(o_animation->translation_seeks().Count(),
+            static_cast<size_t>(stride * num_seeks));
+  const int buffer_size =
+    static_cast<int>(sizeof(int32_t)) * (1 + stride * num_seeks);
+  const int32_t invalid_key = 9999;
+  const int32_t invalid_count = stride * num_seeks - 1;
+  const float invalid_interval = 0.f;
+  struct Corruption {
+    int offset;  // From the end of the archive.
+    const void* value;
+    size_t size;
+  } corruptions[] = {
+    // Last entry of the scale seek index is out of keys range.
+    {-static_cast<int>(sizeof(int32_t)), &invalid_key, sizeof(invalid_key)},
+    // Scale seek count doesn't match the number of tracks.
+    {-buffer_size, &invalid_count, sizeof(invalid_count)},
+    // Seek index isn't empty while the animation has no seek interval.
+    {-buffer_size * 3 - static_cast<int>(sizeof(float)),
+     &invalid_interval, sizeof(invalid_interval)}};
+
+  for (size_t c = 0; c < OZZ_ARRAY_SIZE(corruptions); ++c) {
+    ozz::io::MemoryStream stream;
+    ozz::io::OArchive o(&stream);
+    o << *o_animation;
+    const int size = stream.Tell();
+
+    // Overwrites the corrupted value.
+    stream.Seek(size + corruptions[c].offset, ozz::io::Stream::kSet);
+    stream.Write(corruptions[c].value, corruptions[c].size);
+
+    // Loading fails, the animation is left empty.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+    Animation i_animation;
+    i >> i_animation;
+    EXPECT_EQ(i_animation.num_tracks(), 0);
+    EXPECT_EQ(i_animation.translation_seeks().Count(), 0u);
+  }
+
+  // The uncorrupted animation loads.
+  {
+    ozz::io::MemoryStream stream;
+    ozz::io::OArchive o(&stream);
+    o << *o_animation;
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+    Animation i_animation;
+    i >> i_animation;
+    EXPECT_EQ(i_animation.num_tracks(), 1);
+    EXPECT_EQ(i_animation.translation_seeks().Count(),
+              static_cast<size_t>(stride * num_seeks));
+  }
+
+  ozz::memory::default_allocator()->Delete(o_animation);
+}
+
+namespace {
+// Compares buffers of two animations. Keys are compared binary, as an image
+// loaded with any endianness must match the native animation.
+void ExpectAnimationsEq(const Animation& _a, const Animation& _b) {
+  ASSERT_FLOAT_EQ(_a.duration(), _b.duration());
+  ASSERT_EQ(_a.num_tracks(), _b.num_tracks());
+  ASSERT_FLOAT_EQ(_a.seek_interval(), _b.seek_interval());
+  EXPECT_EQ(_a.num_animated_translations(), _b.num_animated_translations());
+  EXPECT_EQ(_a.num_animated_rotations(), _b.num_animated_rotations());
+  EXPECT_EQ(_a.num_animated_scales(), _b.num_animated_scales());
+  EXPECT_EQ(_a.wide_key_times(), _b.wide_key_times());
+  EXPECT_EQ(_a.translation_bits(), _b.translation_bits());
+  EXPECT_EQ(_a.scale_bits(), _b.scale_bits());
+
+#define EXPECT_RANGE_EQ(_range)\
+  ASSERT_EQ(_a._range().Size(), _b._range().Size());\
+  EXPECT_EQ(memcmp(_a._range().begin, _b._range().begin, _a._range().Size()),\
+            0);
+  EXPECT_RANGE_EQ(translations);
+  EXPECT_RANGE_EQ(rotations);
+  EXPECT_RANGE_EQ(scales);
+  EXPECT_RANGE_EQ(translation_time_highs);
+  EXPECT_RANGE_EQ(rotation_time_highs);
+  EXPECT_RANGE_EQ(scale_time_highs);
+  EXPECT_RANGE_EQ(translation_ranges);
+  EXPECT_RANGE_EQ(scale_ranges);
+  EXPECT_RANGE_EQ(translation_values);
+  EXPECT_RANGE_EQ(scale_values);
+  EXPECT_RANGE_EQ(translation_seeks);
+  EXPECT_RANGE_EQ(rotation_seeks);
+  EXPECT_RANGE_EQ(scale_seeks);
+  EXPECT_RANGE_EQ(translation_constant_flags);
+  EXPECT_RANGE_EQ(rotation_constant_flags);
+  EXPECT_RANGE_EQ(scale_constant_flags);
+  EXPECT_RANGE_EQ(translation_constants);
+  EXPECT_RANGE_EQ(rotation_constants);
+  EXPECT_RANGE_EQ(scale_constants);
+#undef EXPECT_RANGE_EQ
+}
+}  // namespace
+
+TEST(Image, AnimationSerialize) {
+  // Builds a valid animation, with animated and constant tracks.
+  Animation* o_animation = NULL;
+  {
+    RawAnimation raw_animation;
+    raw_animation.duration = 1.f;
+    raw_animation.tracks.resize(3);
+
+    RawAnimation::TranslationKey t_key0 = {
+      0.f, ozz::math::Float3(93.f, 58.f, 46.f)};
+    raw_animation.tracks[0].translations.push_back(t_key0);
+    RawAnimation::TranslationKey t_key1 = {
+      .9f, ozz::math::Float3(46.f, 58.f, 93.f)};
+    raw_animation.tracks[0].translations.push_back(t_key1);
+
+    RawAnimation::RotationKey r_key0 = {
+      0.f, ozz::math::Quaternion(0.f, 1.f, 0.f, 0.f)};
+    raw_animation.tracks[2].rotations.push_back(r_key0);
+    RawAnimation::RotationKey r_key1 = {
+      .5f, ozz::math::Quaternion(0.f, 0.f, .70710677f, .70710677f)};
+    raw_animation.tracks[2].rotations.push_back(r_key1);
+
+    RawAnimation::ScaleKey s_key0 = {
+      0.1f, ozz::math::Float3(99.f, 26.f, 14.f)};
+    raw_animation.tracks[1].scales.push_back(s_key0);
+    RawAnimation::ScaleKey s_key1 = {
+      0.2f, ozz::math::Float3(14.f, 26.f, 99.f)};
+    raw_animation.tracks[1].scales.push_back(s_key1);
+
+    AnimationBuilder builder;
+    builder.seek_interval = .4f;
+    o_animation = builder(raw_animation);
+    ASSERT_TRUE(o_animation != NULL);
+  }
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  const size_t size =
+    o_animation->SaveImage(NULL, 0, ozz::GetNativeEndianness());
+  ASSERT_NE(size, 0u);
+  void* image = allocator->Allocate(size, ozz::io::kImageAlignment);
+
+  // Too small buffer.
+  EXPECT_EQ(o_animation->SaveImage(image, size - 1, ozz::kLittleEndian), 0u);
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ASSERT_EQ(o_animation->SaveImage(image, size, endianess), size);
+
+    // Image is swapped the first time only.
+    for (int l = 0; l < 2; ++l) {
+      Animation i_animation;
+      ASSERT_TRUE(i_animation.LoadImage(image, size));
+      ExpectAnimationsEq(*o_animation, i_animation);
+    }
+
+    // Image can't be loaded as a smaller buffer.
+    Animation i_animation;
+    EXPECT_FALSE(i_animation.LoadImage(image, size - 1));
+    EXPECT_EQ(i_animation.num_tracks(), 0);
+  }
+
+  {  // Samples the image.
+    Animation i_animation;
+    ASSERT_TRUE(i_animation.LoadImage(image, size));
+
+    ozz::animation::SamplingJob job;
+    ozz::animation::SamplingCache cache(3);
+    ozz::math::SoaTransform output[1];
+    job.animation = &i_animation;
+    job.cache = &cache;
+    job.output.begin = output;
+    job.output.end = output + 1;
+    job.time = .5f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].scale, 1.f, 14.f, 1.f, 1.f,
+                                             1.f, 26.f, 1.f, 1.f,
+                                             1.f, 99.f, 1.f, 1.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation,
+                                0.f, 0.f, 0.f, 0.f,
+                                0.f, 0.f, 0.f, 0.f,
+                                0.f, 0.f, .70710677f, 0.f,
+                                1.f, 1.f, .70710677f, 1.f);
+  }
+
+  // Image with an unexpected tag.
+  static_cast<char*>(image)[16] = 'X';
+  Animation i_animation;
+  EXPECT_FALSE(i_animation.LoadImage(image, size));
+
+  allocator->Deallocate(image);
+  allocator->Delete(o_animation);
+}
+
+TEST(ImageReuse, AnimationSerialize) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+
+  AnimationBuilder builder;
+  Animation* o_animation = builder(raw_animation);
+  ASSERT_TRUE(o_animation != NULL);
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  const size_t size =
+    o_animation->SaveImage(NULL, 0, ozz::GetNativeEndianness());
+  void* image = allocator->Allocate(size, ozz::io::kImageAlignment);
+  ASSERT_EQ(o_animation->SaveImage(image, size, ozz::kBigEndian), size);
+
+  // Loads an archive over an image view, and the opposite.
+  ozz::io::MemoryStream stream;
+  {
+    ozz::io::OArchive o(&stream);
+    o << *o_animation;
+  }
+  Animation i_animation;
+  ASSERT_TRUE(i_animation.LoadImage(image, size));
+  stream.Seek(0, ozz::io::Stream::kSet);
+  {
+    ozz::io::IArchive i(&stream);
+    i >> i_animation;
+  }
+  ExpectAnimationsEq(*o_animation, i_animation);
+  ASSERT_TRUE(i_animation.LoadImage(image, size));
+  ExpectAnimationsEq(*o_animation, i_animation);
+
+  allocator->Deallocate(image);
+  allocator->Delete(o_animation);
+}
+
+TEST(WideKeyTimes, AnimationSerialize) {
+  // Builds an animation whose first 2 rotation keys are too close to be
+  // distinct on 16 bits, so key times are wide.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(2);
+  RawAnimation::RotationKey r_key0 = {
+    0.f, ozz::math::Quaternion(0.f, 1.f, 0.f, 0.f)};
+  raw_animation.tracks[1].rotations.push_back(r_key0);
+  RawAnimation::RotationKey r_key1 = {
+    5e-6f, ozz::math::Quaternion(0.f, 0.f, .70710677f, .70710677f)};
+  raw_animation.tracks[1].rotations.push_back(r_key1);
+  RawAnimation::ScaleKey s_key0 = {
+    0.f, ozz::math::Float3(99.f, 26.f, 14.f)};
+  raw_animation.tracks[0].scales.push_back(s_key0);
+  RawAnimation::ScaleKey s_key1 = {
+    .7f, ozz::math::Float3(14.f, 26.f, 99.f)};
+  raw_animation.tracks[0].scales.push_back(s_key1);
+
+  AnimationBuilder builder;
+  builder.seek_interval = .4f;
+  Animation* o_animation = builder(raw_animation);
+  ASSERT_TRUE(o_animation != NULL);
+  ASSERT_TRUE(o_animation->wide_key_times());
+  EXPECT_EQ(o_animation->rotation_time_highs().Count(), 3u);
+  EXPECT_EQ(o_animation->scale_time_highs().Count(), 3u);
+  EXPECT_EQ(o_animation->translation_time_highs().Count(), 0u);
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  const size_t size =
+    o_animation->SaveImage(NULL, 0, ozz::GetNativeEndianness());
+  void* image = allocator->Allocate(size, ozz::io::kImageAlignment);
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+
+    // Archive.
+    ozz::io::MemoryStream stream;
+    {
+      ozz::io::OArchive o(&stream, endianess);
+      o << *o_animation;
+    }
+    stream.Seek(0, ozz::io::Stream::kSet);
+    {
+      ozz::io::IArchive i(&stream);
+      Animation i_animation;
+      i >> i_animation;
+      ExpectAnimationsEq(*o_animation, i_animation);
+    }
+
+    // Image.
+    ASSERT_EQ(o_animation->SaveImage(image, size, endianess), size);
+    Animation i_animation;
+    ASSERT_TRUE(i_animation.LoadImage(image, size));
+    ExpectAnimationsEq(*o_animation, i_animation);
+
+    // Samples the loaded animation after its second rotation key.
+    ozz::animation::SamplingJob job;
+    ozz::animation::SamplingCache cache(1);
+    ozz::math::SoaTransform output[1];
+    job.animation = &i_animation;
+    job.cache = &cache;
+    job.output.begin = output;
+    job.output.end = output + 1;
+    job.time = .7f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].scale, 14.f, 1.f, 1.f, 1.f,
+                                             26.f, 1.f, 1.f, 1.f,
+                                             99.f, 1.f, 1.f, 1.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation,
+                                0.f, 0.f, 0.f, 0.f,
+                                0.f, 0.f, 0.f, 0.f,
+                                0.f, .70710677f, 0.f, 0.f,
+                                1.f, .70710677f, 1.f, 1.f);
+  }
+
+  allocator->Deallocate(image);
+  allocator->Delete(o_animation);
+}
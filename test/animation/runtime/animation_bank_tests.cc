@@ -0,0 +1,262 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/animation_bank.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/animation_builder.h"
+
+using ozz::animation::Animation;
+using ozz::animation::AnimationBank;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::AnimationBuilder;
+
+namespace {
+// Builds an animation of _num_tracks tracks, whose duration is _duration.
+Animation* BuildAnimation(int _num_tracks, float _duration) {
+  RawAnimation raw_animation;
+  raw_animation.duration = _duration;
+  raw_animation.tracks.resize(_num_tracks);
+  const RawAnimation::TranslationKey key = {
+    0.f, ozz::math::Float3(_duration, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(key);
+  AnimationBuilder builder;
+  return builder(raw_animation);
+}
+
+// Writes a bank index whose content is provided by the caller, and loads it.
+// Returns the number of animations of the loaded bank.
+int LoadIndex(uint32_t _version, int32_t _num_animations,
+              int32_t _names_size, const char* _names) {
+  ozz::io::MemoryStream stream;
+  {
+    ozz::io::OArchive o(&stream);
+    ozz::io::internal::Tagger<const AnimationBank>::Write(o);
+    o << _version;
+    o << _num_animations;
+    for (int i = 0; i < _num_animations; ++i) {
+      o << static_cast<uint32_t>(i);  // Hash.
+      o << static_cast<uint32_t>(0);  // Offset.
+      o << static_cast<uint32_t>(0);  // Size.
+    }
+    o << _names_size;
+    if (_names_size > 0) {
+      o << ozz::io::MakeArray(_names, _names_size);
+    }
+  }
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  AnimationBank bank;
+  i >> bank;
+  return bank.num_animations();
+}
+}  // namespace
+
+TEST(Empty, AnimationBank) {
+  ozz::io::MemoryStream stream;
+  {
+    ozz::io::OArchive o(&stream);
+    const ozz::Range<const AnimationBank::Entry> entries;
+    EXPECT_TRUE(AnimationBank::Write(o, entries));
+  }
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  ASSERT_TRUE(i.TestTag<AnimationBank>());
+  AnimationBank bank;
+  i >> bank;
+  EXPECT_EQ(bank.num_animations(), 0);
+  EXPECT_EQ(bank.Find("walk"), -1);
+}
+
+TEST(Invalid, AnimationBank) {
+  Animation* animation = BuildAnimation(1, 1.f);
+  ASSERT_TRUE(animation != NULL);
+
+  ozz::io::MemoryStream stream;
+  ozz::io::OArchive o(&stream);
+  const int tell = stream.Tell();
+
+  {  // Duplicated names.
+    const AnimationBank::Entry entries[] = {
+      {"walk", animation}, {"run", animation}, {"walk", animation}};
+    EXPECT_FALSE(AnimationBank::Write(o, ozz::Range<const AnimationBank::Entry>(
+      entries, OZZ_ARRAY_SIZE(entries))));
+  }
+  {  // NULL name.
+    const AnimationBank::Entry entries[] = {{NULL, animation}};
+    EXPECT_FALSE(AnimationBank::Write(o, ozz::Range<const AnimationBank::Entry>(
+      entries, OZZ_ARRAY_SIZE(entries))));
+  }
+  {  // NULL animation.
+    const AnimationBank::Entry entries[] = {{"walk", NULL}};
+    EXPECT_FALSE(AnimationBank::Write(o, ozz::Range<const AnimationBank::Entry>(
+      entries, OZZ_ARRAY_SIZE(entries))));
+  }
+
+  // Nothing was written.
+  EXPECT_EQ(stream.Tell(), tell);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(LoadUnload, AnimationBank) {
+  const char* names[] = {"walk", "run", "jump", "idle", "crouch"};
+  Animation* animations[OZZ_ARRAY_SIZE(names)];
+  AnimationBank::Entry entries[OZZ_ARRAY_SIZE(names)];
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(names); ++i) {
+    animations[i] = BuildAnimation(static_cast<int>(i + 1), i + 1.f);
+    ASSERT_TRUE(animations[i] != NULL);
+    const AnimationBank::Entry entry = {names[i], animations[i]};
+    entries[i] = entry;
+  }
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+
+    // Bank doesn't need to be at the beginning of the stream.
+    const int32_t prefix = 46;
+    stream.Write(&prefix, sizeof(prefix));
+    {
+      ozz::io::OArchive o(&stream, endianess);
+      ASSERT_TRUE(AnimationBank::Write(
+        o, ozz::Range<const AnimationBank::Entry>(entries,
+                                                  OZZ_ARRAY_SIZE(entries))));
+    }
+
+    ASSERT_EQ(stream.Seek(sizeof(prefix), ozz::io::Stream::kSet), 0);
+    ozz::io::BufferedStream buffered(&stream, 64);
+    ozz::io::IArchive i(&buffered);
+    ASSERT_TRUE(i.TestTag<AnimationBank>());
+    AnimationBank bank;
+    i >> bank;
+    ASSERT_EQ(bank.num_animations(), static_cast<int>(OZZ_ARRAY_SIZE(names)));
+
+    // Only the index is loaded.
+    for (int j = 0; j < bank.num_animations(); ++j) {
+      EXPECT_TRUE(bank.animation(j) == NULL);
+    }
+    EXPECT_EQ(bank.Find("swim"), -1);
+    EXPECT_EQ(bank.Find(""), -1);
+
+    // Loads animations in a different order than the index.
+    for (int j = static_cast<int>(OZZ_ARRAY_SIZE(names)) - 1; j >= 0; --j) {
+      const int id = bank.Find(names[j]);
+      ASSERT_NE(id, -1);
+      EXPECT_STREQ(bank.name(id), names[j]);
+      const Animation* animation = bank.Load(id);
+      ASSERT_TRUE(animation != NULL);
+      EXPECT_EQ(animation, bank.animation(id));
+      EXPECT_EQ(animation, bank.Load(id));
+      EXPECT_FLOAT_EQ(animation->duration(), animations[j]->duration());
+      EXPECT_EQ(animation->num_tracks(), animations[j]->num_tracks());
+      EXPECT_EQ(animation->size(), animations[j]->size());
+    }
+
+    // Unloads and reloads an animation.
+    const int id = bank.Find("jump");
+    bank.Unload(id);
+    EXPECT_TRUE(bank.animation(id) == NULL);
+    ASSERT_TRUE(bank.Load(id) != NULL);
+    EXPECT_FLOAT_EQ(bank.animation(id)->duration(), 3.f);
+
+    bank.UnloadAll();
+    for (int j = 0; j < bank.num_animations(); ++j) {
+      EXPECT_TRUE(bank.animation(j) == NULL);
+    }
+  }
+
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(names); ++i) {
+    ozz::memory::default_allocator()->Delete(animations[i]);
+  }
+}
+
+TEST(Corrupted, AnimationBank) {
+  Animation* animation = BuildAnimation(1, 1.f);
+  ASSERT_TRUE(animation != NULL);
+
+  ozz::io::MemoryStream stream;
+  {
+    ozz::io::OArchive o(&stream);
+    const AnimationBank::Entry entries[] = {{"walk", animation}};
+    ASSERT_TRUE(AnimationBank::Write(o, ozz::Range<const AnimationBank::Entry>(
+      entries, OZZ_ARRAY_SIZE(entries))));
+  }
+
+  // Animation is stored at the end of the stream, as a standalone archive.
+  ozz::io::MemoryStream alone;
+  {
+    ozz::io::OArchive o(&alone);
+    o << *animation;
+  }
+
+  // Overwrites the animation tag, which follows archive endianness byte.
+  const char bad[] = "ozz-unknown";
+  ASSERT_EQ(stream.Seek(1 - alone.Tell(), ozz::io::Stream::kEnd), 0);
+  stream.Write(bad, sizeof(bad));
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  AnimationBank bank;
+  i >> bank;
+  ASSERT_EQ(bank.num_animations(), 1);
+  EXPECT_TRUE(bank.Load(0) == NULL);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(CorruptedIndex, AnimationBank) {
+  // Valid index.
+  EXPECT_EQ(LoadIndex(1, 2, 9, "walk\0run\0"), 2);
+  EXPECT_EQ(LoadIndex(1, 0, 0, ""), 0);
+
+  // Unsupported version.
+  EXPECT_EQ(LoadIndex(2, 2, 9, "walk\0run\0"), 0);
+
+  // Negative sizes.
+  EXPECT_EQ(LoadIndex(1, -1, 9, "walk\0run\0"), 0);
+  EXPECT_EQ(LoadIndex(1, 2, -9, "walk\0run\0"), 0);
+
+  // Unterminated name.
+  EXPECT_EQ(LoadIndex(1, 2, 8, "walk\0run\0"), 0);
+
+  // Less or more names than animations.
+  EXPECT_EQ(LoadIndex(1, 3, 9, "walk\0run\0"), 0);
+  EXPECT_EQ(LoadIndex(1, 1, 9, "walk\0run\0"), 0);
+  EXPECT_EQ(LoadIndex(1, 2, 10, "walk\0run\0\0"), 0);
+}
@@ -30,10 +30,14 @@
 
 #include "ozz/animation/runtime/blending_job.h"
 
+#include <cstring>
+
 #include "gtest/gtest.h"
 #include "ozz/base/maths/gtest_math_helper.h"
 
+#include "ozz/base/cpu.h"
 #include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
 
 using ozz::animation::BlendingJob;
 
@@ -754,3 +758,494 @@ TEST(Threshold, BlendingJob) {
                         8.f, 9.f, 10.f, 11.f);
   }
 }
+
+TEST(InstructionSets, BlendingJob) {
+  // Initializes 3 layers of 3 soa transforms, so kernels remainders are
+  // exercised. Rotations of the last layer are opposed.
+  ozz::math::SoaTransform input_transforms[3][3];
+  ozz::math::SimdFloat4 joint_weights[3];
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      const float f = static_cast<float>(i * 3 + j);
+      const float sign = i == 2 ? -1.f : 1.f;
+      const ozz::math::SoaTransform transform = {
+        {ozz::math::simd_float4::Load(f, 1.f, -2.f, 3.f),
+         ozz::math::simd_float4::Load(4.f, -f, 6.f, .5f),
+         ozz::math::simd_float4::Load(-1.f, 2.f, f, 1.f)},
+        {ozz::math::simd_float4::Load(0.f, .70710677f, 0.f, 0.f),
+         ozz::math::simd_float4::Load(0.f, 0.f, .70710677f, 0.f),
+         ozz::math::simd_float4::Load(.70710677f, 0.f, 0.f, 0.f),
+         ozz::math::simd_float4::Load(.70710677f, .70710677f,
+                                      .70710677f, sign)},
+        {ozz::math::simd_float4::Load(1.f, 2.f, 1.f, .5f),
+         ozz::math::simd_float4::Load(1.f, f, 3.f, 1.f),
+         ozz::math::simd_float4::Load(2.f, 1.f, 1.f, 1.f)}};
+      input_transforms[i][j] = transform;
+    }
+    joint_weights[i] =
+      ozz::math::simd_float4::Load(0.f, .5f, static_cast<float>(i), .1f);
+  }
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  const ozz::math::SoaTransform bind_poses[3] = {identity, identity, identity};
+
+  BlendingJob::Layer layers[3];
+  for (int i = 0; i < 3; ++i) {
+    layers[i].weight = .2f * (i + 1);
+    layers[i].transform.begin = input_transforms[i];
+    layers[i].transform.end = input_transforms[i] + 3;
+  }
+  layers[1].joint_weights.begin = joint_weights;
+  layers[1].joint_weights.end = joint_weights + 3;
+
+  // First layer is also used as a partial additive layer.
+  BlendingJob::Layer additive_layers[1];
+  additive_layers[0].weight = .7f;
+  additive_layers[0].transform = layers[0].transform;
+  additive_layers[0].joint_weights = layers[1].joint_weights;
+
+  BlendingJob job;
+  job.threshold = .5f;
+  job.layers.begin = layers;
+  job.layers.end = layers + 3;
+  job.additive_layers = additive_layers;
+  job.bind_pose.begin = bind_poses;
+  job.bind_pose.end = bind_poses + 3;
+
+  // Computes expected output with baseline kernels.
+  ozz::math::SoaTransform expected[3];
+  ozz::math::SoaTransform output[3];
+  job.output.begin = expected;
+  job.output.end = expected + 3;
+  const ozz::cpu::InstructionSet detected = ozz::cpu::Detect();
+  ASSERT_TRUE(ozz::cpu::SetInstructionSet(ozz::cpu::kBaseline));
+  EXPECT_TRUE(job.Run());
+
+  // Every supported instruction set must output the same result.
+  job.output.begin = output;
+  job.output.end = output + 3;
+  for (int set = 0; set < ozz::cpu::kInstructionSetCount; ++set) {
+    if (!ozz::cpu::SetInstructionSet(
+          static_cast<ozz::cpu::InstructionSet>(set))) {
+      continue;
+    }
+    memset(output, 0, sizeof(output));
+    EXPECT_TRUE(job.Run());
+    EXPECT_EQ(memcmp(output, expected, sizeof(output)), 0);
+  }
+  EXPECT_TRUE(ozz::cpu::SetInstructionSet(detected));
+}
+
+TEST(SparseJointWeights, BlendingJob) {
+  // Uses more soa joints than a word of the internal set of blended joints.
+  const int kNumSoaJoints = 40;
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  const ozz::math::SimdFloat4 one = ozz::math::simd_float4::one();
+  const ozz::math::SimdFloat4 zero = ozz::math::simd_float4::zero();
+
+  // Layer 0 translations are 1, layer 1 translations are 3 and bind pose
+  // translations are 10.
+  ozz::math::SoaTransform input_transforms[2][kNumSoaJoints];
+  ozz::math::SoaTransform bind_poses[kNumSoaJoints];
+  ozz::math::SimdFloat4 joint_weights[2][kNumSoaJoints];
+  for (int i = 0; i < kNumSoaJoints; ++i) {
+    input_transforms[0][i] = identity;
+    input_transforms[0][i].translation =
+      ozz::math::SoaFloat3::Load(one, one, one);
+    input_transforms[1][i] = identity;
+    input_transforms[1][i].translation =
+      input_transforms[0][i].translation * ozz::math::simd_float4::Load1(3.f);
+    bind_poses[i] = identity;
+    bind_poses[i].translation =
+      input_transforms[0][i].translation * ozz::math::simd_float4::Load1(10.f);
+
+    // Layer 0 affects soa joints [2,10[ and [33,36[, layer 1 affects soa
+    // joints [5,20[. Only some of the joints of soa joint 33 are affected.
+    joint_weights[0][i] = (i >= 2 && i < 10) || (i > 33 && i < 36) ?
+      one : zero;
+    joint_weights[1][i] = i >= 5 && i < 20 ? one : zero;
+  }
+  joint_weights[0][33] = ozz::math::simd_float4::Load(0.f, 1.f, 0.f, 0.f);
+
+  BlendingJob::Layer layers[2];
+  for (int i = 0; i < 2; ++i) {
+    layers[i].transform = input_transforms[i];
+    layers[i].joint_weights = joint_weights[i];
+  }
+
+  BlendingJob job;
+  job.layers = layers;
+  job.bind_pose = bind_poses;
+  ozz::math::SoaTransform output[kNumSoaJoints];
+  job.output = output;
+
+  {  // Both layers.
+    layers[0].weight = 1.f;
+    layers[1].weight = 1.f;
+    memset(output, 0, sizeof(output));
+    ASSERT_TRUE(job.Run());
+
+    for (int i = 0; i < kNumSoaJoints; ++i) {
+      const bool l0 = (i >= 2 && i < 10) || (i > 33 && i < 36);
+      const bool l1 = i >= 5 && i < 20;
+      const float x = l0 ? (l1 ? 2.f : 1.f) : (l1 ? 3.f : 10.f);
+      if (i == 33) {
+        EXPECT_SOAFLOAT3_EQ_EST(output[i].translation,
+                                10.f, 1.f, 10.f, 10.f,
+                                10.f, 1.f, 10.f, 10.f,
+                                10.f, 1.f, 10.f, 10.f);
+      } else {
+        EXPECT_SOAFLOAT3_EQ_EST(output[i].translation,
+                                x, x, x, x, x, x, x, x, x, x, x, x);
+      }
+      EXPECT_SOAQUATERNION_EQ_EST(output[i].rotation,
+                                  0.f, 0.f, 0.f, 0.f,
+                                  0.f, 0.f, 0.f, 0.f,
+                                  0.f, 0.f, 0.f, 0.f,
+                                  1.f, 1.f, 1.f, 1.f);
+      EXPECT_SOAFLOAT3_EQ_EST(output[i].scale,
+                              1.f, 1.f, 1.f, 1.f,
+                              1.f, 1.f, 1.f, 1.f,
+                              1.f, 1.f, 1.f, 1.f);
+    }
+  }
+
+  {  // Layer 0 weight is below threshold, layer 1 is disabled.
+    layers[0].weight = .05f;
+    layers[1].weight = 0.f;
+    memset(output, 0, sizeof(output));
+    ASSERT_TRUE(job.Run());
+
+    for (int i = 0; i < kNumSoaJoints; ++i) {
+      const bool l0 = (i >= 2 && i < 10) || (i > 33 && i < 36);
+      const float x = l0 ? 5.5f : 10.f;
+      if (i == 33) {
+        EXPECT_SOAFLOAT3_EQ_EST(output[i].translation,
+                                10.f, 5.5f, 10.f, 10.f,
+                                10.f, 5.5f, 10.f, 10.f,
+                                10.f, 5.5f, 10.f, 10.f);
+      } else {
+        EXPECT_SOAFLOAT3_EQ_EST(output[i].translation,
+                                x, x, x, x, x, x, x, x, x, x, x, x);
+      }
+    }
+  }
+}
+
+TEST(Additive, BlendingJob) {
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+
+  // Base layer translations are 1, 2, 3 and scales are 2.
+  ozz::math::SoaTransform input_transforms[2] = {identity, identity};
+  input_transforms[0].translation = ozz::math::SoaFloat3::Load(
+    ozz::math::simd_float4::Load1(1.f),
+    ozz::math::simd_float4::Load1(2.f),
+    ozz::math::simd_float4::Load1(3.f));
+  input_transforms[0].scale = ozz::math::SoaFloat3::Load(
+    ozz::math::simd_float4::Load1(2.f),
+    ozz::math::simd_float4::Load1(2.f),
+    ozz::math::simd_float4::Load1(2.f));
+  input_transforms[1] = input_transforms[0];
+
+  // Additive layer translates by 4, rotates by 90 degrees around y (the delta
+  // of lane 3 is negated, which is the same rotation) and scales by 3.
+  ozz::math::SoaTransform delta_transforms[2] = {identity, identity};
+  delta_transforms[0].translation = ozz::math::SoaFloat3::Load(
+    ozz::math::simd_float4::Load1(4.f),
+    ozz::math::simd_float4::zero(),
+    ozz::math::simd_float4::zero());
+  delta_transforms[0].rotation = ozz::math::SoaQuaternion::Load(
+    ozz::math::simd_float4::zero(),
+    ozz::math::simd_float4::Load(.70710677f, .70710677f, .70710677f,
+                                 -.70710677f),
+    ozz::math::simd_float4::zero(),
+    ozz::math::simd_float4::Load(.70710677f, .70710677f, .70710677f,
+                                 -.70710677f));
+  delta_transforms[0].scale = ozz::math::SoaFloat3::Load(
+    ozz::math::simd_float4::Load1(3.f),
+    ozz::math::simd_float4::one(),
+    ozz::math::simd_float4::one());
+  delta_transforms[1] = delta_transforms[0];
+  ozz::math::SimdFloat4 joint_weights[2] = {
+    ozz::math::simd_float4::Load(1.f, .5f, 0.f, 1.f),
+    ozz::math::simd_float4::zero()};
+
+  const ozz::math::SoaTransform bind_poses[2] = {identity, identity};
+
+  BlendingJob::Layer layers[1];
+  layers[0].weight = 1.f;
+  layers[0].transform = input_transforms;
+  BlendingJob::Layer additive_layers[1];
+  additive_layers[0].transform = delta_transforms;
+
+  BlendingJob job;
+  job.layers = layers;
+  job.additive_layers = additive_layers;
+  job.bind_pose = bind_poses;
+  ozz::math::SoaTransform output[2];
+  job.output = output;
+
+  {  // Validity.
+    EXPECT_TRUE(job.Validate());
+    additive_layers[0].transform.end = delta_transforms + 1;
+    EXPECT_FALSE(job.Validate());
+    additive_layers[0].transform.end = delta_transforms + 2;
+    job.additive_layers.begin = NULL;
+    EXPECT_FALSE(job.Validate());
+    job.additive_layers.end = NULL;
+    EXPECT_TRUE(job.Validate());
+    job.additive_layers = additive_layers;
+  }
+
+  {  // Null weight, output is the base layer.
+    additive_layers[0].weight = 0.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation,
+                            1.f, 1.f, 1.f, 1.f,
+                            2.f, 2.f, 2.f, 2.f,
+                            3.f, 3.f, 3.f, 3.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation,
+                                0.f, 0.f, 0.f, 0.f,
+                                0.f, 0.f, 0.f, 0.f,
+                                0.f, 0.f, 0.f, 0.f,
+                                1.f, 1.f, 1.f, 1.f);
+  }
+
+  {  // Full weight.
+    additive_layers[0].weight = 1.f;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[1].translation,
+                            5.f, 5.f, 5.f, 5.f,
+                            2.f, 2.f, 2.f, 2.f,
+                            3.f, 3.f, 3.f, 3.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output[1].rotation,
+                                0.f, 0.f, 0.f, 0.f,
+                                .70710677f, .70710677f, .70710677f, .70710677f,
+                                0.f, 0.f, 0.f, 0.f,
+                                .70710677f, .70710677f, .70710677f, .70710677f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[1].scale,
+                            6.f, 6.f, 6.f, 6.f,
+                            2.f, 2.f, 2.f, 2.f,
+                            2.f, 2.f, 2.f, 2.f);
+  }
+
+  {  // Half weight, and per-joint weights.
+    additive_layers[0].weight = .5f;
+    additive_layers[0].joint_weights = joint_weights;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation,
+                            3.f, 2.f, 1.f, 3.f,
+                            2.f, 2.f, 2.f, 2.f,
+                            3.f, 3.f, 3.f, 3.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation,
+                                0.f, 0.f, 0.f, 0.f,
+                                .3826834f, .18736553f, 0.f, .3826834f,
+                                0.f, 0.f, 0.f, 0.f,
+                                .9238795f, .98229015f, 1.f, .9238795f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].scale,
+                            4.f, 3.f, 2.f, 4.f,
+                            2.f, 2.f, 2.f, 2.f,
+                            2.f, 2.f, 2.f, 2.f);
+
+    // Second soa joint has null joint weights, so it's unchanged.
+    EXPECT_SOAFLOAT3_EQ_EST(output[1].translation,
+                            1.f, 1.f, 1.f, 1.f,
+                            2.f, 2.f, 2.f, 2.f,
+                            3.f, 3.f, 3.f, 3.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[1].scale,
+                            2.f, 2.f, 2.f, 2.f,
+                            2.f, 2.f, 2.f, 2.f,
+                            2.f, 2.f, 2.f, 2.f);
+  }
+}
+
+TEST(Scratch, BlendingJob) {
+  // Uses more soa joints than the job can blend without a scratch buffer.
+  const size_t kNumSoaJoints = BlendingJob::kMaxStackSoAJoints + 10;
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  const ozz::math::SimdFloat4 one = ozz::math::simd_float4::one();
+  const ozz::math::SimdFloat4 zero = ozz::math::simd_float4::zero();
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+
+  // Layer 0 translations are 1, layer 1 translations are 3 and bind pose
+  // translations are 10.
+  ozz::Range<ozz::math::SoaTransform> input_transforms[2];
+  ozz::math::SimdFloat4* joint_weights[2];
+  for (int i = 0; i < 2; ++i) {
+    input_transforms[i] =
+      allocator->AllocateRange<ozz::math::SoaTransform>(kNumSoaJoints);
+    joint_weights[i] =
+      allocator->Allocate<ozz::math::SimdFloat4>(kNumSoaJoints);
+  }
+  ozz::Range<ozz::math::SoaTransform> bind_poses =
+    allocator->AllocateRange<ozz::math::SoaTransform>(kNumSoaJoints);
+  ozz::Range<ozz::math::SoaTransform> output =
+    allocator->AllocateRange<ozz::math::SoaTransform>(kNumSoaJoints);
+  ozz::math::SimdFloat4* scratch =
+    allocator->Allocate<ozz::math::SimdFloat4>(kNumSoaJoints);
+
+  for (size_t i = 0; i < kNumSoaJoints; ++i) {
+    input_transforms[0][i] = identity;
+    input_transforms[0][i].translation =
+      ozz::math::SoaFloat3::Load(one, one, one);
+    input_transforms[1][i] = identity;
+    input_transforms[1][i].translation =
+      input_transforms[0][i].translation * ozz::math::simd_float4::Load1(3.f);
+    bind_poses[i] = identity;
+    bind_poses[i].translation =
+      input_transforms[0][i].translation * ozz::math::simd_float4::Load1(10.f);
+
+    // Layer 0 affects all joints, layer 1 affects the ones beyond the stack
+    // buffer limit.
+    joint_weights[0][i] = one;
+    joint_weights[1][i] = i >= BlendingJob::kMaxStackSoAJoints ? one : zero;
+  }
+
+  BlendingJob::Layer layers[2];
+  for (int i = 0; i < 2; ++i) {
+    layers[i].weight = 1.f;
+    layers[i].transform = input_transforms[i];
+    layers[i].joint_weights.begin = joint_weights[i];
+    layers[i].joint_weights.end = joint_weights[i] + kNumSoaJoints;
+  }
+
+  BlendingJob job;
+  job.layers = layers;
+  job.bind_pose = bind_poses;
+  job.output = output;
+
+  // Bind pose exceeds stack buffer capacity.
+  EXPECT_FALSE(job.Validate());
+  EXPECT_FALSE(job.Run());
+
+  {  // Scratch buffer is too small.
+    BlendingJob job_small(job);
+    job_small.scratch = scratch;
+    job_small.scratch_size = kNumSoaJoints - 1;
+    EXPECT_FALSE(job_small.Validate());
+  }
+
+  {  // Smaller bind pose fits in the stack buffer.
+    BlendingJob job_stack(job);
+    job_stack.bind_pose.end =
+      job.bind_pose.begin + BlendingJob::kMaxStackSoAJoints;
+    EXPECT_TRUE(job_stack.Validate());
+  }
+
+  job.scratch = scratch;
+  job.scratch_size = kNumSoaJoints;
+  ASSERT_TRUE(job.Validate());
+  ASSERT_TRUE(job.Run());
+
+  for (size_t i = 0; i < kNumSoaJoints; ++i) {
+    const float x = i >= BlendingJob::kMaxStackSoAJoints ? 2.f : 1.f;
+    EXPECT_SOAFLOAT3_EQ_EST(output[i].translation,
+                            x, x, x, x, x, x, x, x, x, x, x, x);
+  }
+
+  for (int i = 0; i < 2; ++i) {
+    allocator->Deallocate(input_transforms[i]);
+    allocator->Deallocate(joint_weights[i]);
+  }
+  allocator->Deallocate(bind_poses);
+  allocator->Deallocate(output);
+  allocator->Deallocate(scratch);
+}
+
+TEST(Range, BlendingJob) {
+  // Uses more soa joints than the job can blend at once without a scratch
+  // buffer.
+  const size_t kNumSoaJoints = BlendingJob::kMaxStackSoAJoints + 10;
+  const ozz::math::SoaTransform identity = ozz::math::SoaTransform::identity();
+  const ozz::math::SimdFloat4 one = ozz::math::simd_float4::one();
+  const ozz::math::SimdFloat4 zero = ozz::math::simd_float4::zero();
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+
+  // Layer 0 translations are 1, layer 1 translations are 3, additive layer
+  // translations are 1 and bind pose translations are 10.
+  ozz::Range<ozz::math::SoaTransform> input_transforms[3];
+  for (int i = 0; i < 3; ++i) {
+    input_transforms[i] =
+      allocator->AllocateRange<ozz::math::SoaTransform>(kNumSoaJoints);
+  }
+  ozz::math::SimdFloat4* joint_weights =
+    allocator->Allocate<ozz::math::SimdFloat4>(kNumSoaJoints);
+  ozz::Range<ozz::math::SoaTransform> bind_poses =
+    allocator->AllocateRange<ozz::math::SoaTransform>(kNumSoaJoints);
+  ozz::Range<ozz::math::SoaTransform> output =
+    allocator->AllocateRange<ozz::math::SoaTransform>(kNumSoaJoints);
+
+  for (size_t i = 0; i < kNumSoaJoints; ++i) {
+    input_transforms[0][i] = identity;
+    input_transforms[0][i].translation =
+      ozz::math::SoaFloat3::Load(one, one, one);
+    input_transforms[1][i] = identity;
+    input_transforms[1][i].translation =
+      input_transforms[0][i].translation * ozz::math::simd_float4::Load1(3.f);
+    input_transforms[2][i] = input_transforms[0][i];
+    bind_poses[i] = identity;
+    bind_poses[i].translation =
+      input_transforms[0][i].translation * ozz::math::simd_float4::Load1(10.f);
+
+    // Layer 1 affects one soa joint out of 3.
+    joint_weights[i] = i % 3 == 0 ? one : zero;
+  }
+
+  BlendingJob::Layer layers[2];
+  layers[0].weight = .04f;
+  layers[0].transform = input_transforms[0];
+  layers[1].weight = 1.f;
+  layers[1].transform = input_transforms[1];
+  layers[1].joint_weights.begin = joint_weights;
+  layers[1].joint_weights.end = joint_weights + kNumSoaJoints;
+
+  BlendingJob::Layer additive_layers[1];
+  additive_layers[0].weight = 1.f;
+  additive_layers[0].transform = input_transforms[2];
+
+  BlendingJob job;
+  job.layers = layers;
+  job.additive_layers = additive_layers;
+  job.bind_pose = bind_poses;
+  job.output = output;
+
+  // Invalid ranges.
+  job.from = -1;
+  EXPECT_FALSE(job.Validate());
+  job.from = 5;
+  job.to = 4;
+  EXPECT_FALSE(job.Validate());
+
+  // The whole range doesn't fit in the stack buffer.
+  job.from = 0;
+  job.to = static_cast<int>(kNumSoaJoints);
+  EXPECT_FALSE(job.Validate());
+
+  // Nothing to blend.
+  job.from = 1000;
+  job.to = 2000;
+  EXPECT_TRUE(job.Run());
+
+  // Blends by ranges that fit in the stack buffer, starting from the end.
+  memset(output.begin, 0, output.Count() * sizeof(ozz::math::SoaTransform));
+  const int bounds[] = {0, 1, 7, BlendingJob::kMaxStackSoAJoints,
+                        static_cast<int>(kNumSoaJoints) + 50};
+  for (int i = 3; i >= 0; --i) {
+    job.from = bounds[i];
+    job.to = bounds[i + 1];
+    ASSERT_TRUE(job.Run());
+  }
+
+  for (size_t i = 0; i < kNumSoaJoints; ++i) {
+    // Layer 0 is below threshold, bind pose is blended to reach it.
+    const float x = (i % 3 == 0 ? (3.f + .04f) / 1.04f : 6.4f) + 1.f;
+    EXPECT_SOAFLOAT3_EQ_EST(output[i].translation,
+                            x, x, x, x, x, x, x, x, x, x, x, x);
+  }
+
+  for (int i = 0; i < 3; ++i) {
+    allocator->Deallocate(input_transforms[i]);
+  }
+  allocator->Deallocate(joint_weights);
+  allocator->Deallocate(bind_poses);
+  allocator->Deallocate(output);
+}
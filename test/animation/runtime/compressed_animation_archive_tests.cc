@@ -0,0 +1,176 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/compressed_animation.h"
+
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/base/maths/soa_float.h"
+
+#include "ozz/animation/runtime/skeleton.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/animation_compressor.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+
+using ozz::animation::CompressedAnimation;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::AnimationCompressor;
+using ozz::animation::offline::SkeletonBuilder;
+
+TEST(Empty, CompressedAnimationSerialize) {
+  ozz::io::MemoryStream stream;
+
+  // Streams out.
+  ozz::io::OArchive o(&stream, ozz::GetNativeEndianness());
+
+  CompressedAnimation o_animation;
+  o << o_animation;
+
+  // Streams in.
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+
+  CompressedAnimation i_animation;
+  i >> i_animation;
+
+  EXPECT_EQ(o_animation.duration(), i_animation.duration());
+  EXPECT_EQ(o_animation.num_tracks(), i_animation.num_tracks());
+  EXPECT_EQ(o_animation.num_frames(), i_animation.num_frames());
+  EXPECT_EQ(o_animation.frame_bits(), i_animation.frame_bits());
+  EXPECT_EQ(o_animation.size(), i_animation.size());
+}
+
+TEST(Filled, CompressedAnimationSerialize) {
+  // Builds a valid animation.
+  CompressedAnimation* o_animation = NULL;
+  {
+    RawAnimation raw_animation;
+    raw_animation.duration = 2.f;
+    raw_animation.tracks.resize(2);
+
+    RawAnimation::TranslationKey t_key0 = {
+      0.f, ozz::math::Float3(93.f, 58.f, 46.f)};
+    raw_animation.tracks[0].translations.push_back(t_key0);
+    RawAnimation::TranslationKey t_key1 = {
+      .9f, ozz::math::Float3(46.f, 58.f, 93.f)};
+    raw_animation.tracks[0].translations.push_back(t_key1);
+
+    RawAnimation::RotationKey r_key0 = {
+      0.7f, ozz::math::Quaternion(0.f, 1.f, 0.f, 0.f)};
+    raw_animation.tracks[1].rotations.push_back(r_key0);
+    RawAnimation::RotationKey r_key1 = {
+      1.7f, ozz::math::Quaternion(0.f, 0.f, 1.f, 0.f)};
+    raw_animation.tracks[1].rotations.push_back(r_key1);
+
+    RawAnimation::ScaleKey s_key = {
+      0.1f, ozz::math::Float3(99.f, 26.f, 14.f)};
+    raw_animation.tracks[1].scales.push_back(s_key);
+
+    RawSkeleton raw_skeleton;
+    raw_skeleton.roots.resize(1);
+    raw_skeleton.roots[0].name = "root";
+    raw_skeleton.roots[0].children.resize(1);
+    raw_skeleton.roots[0].children[0].name = "child";
+    SkeletonBuilder skeleton_builder;
+    Skeleton* skeleton = skeleton_builder(raw_skeleton);
+    ASSERT_TRUE(skeleton != NULL);
+
+    AnimationCompressor compressor;
+    o_animation = compressor(raw_animation, *skeleton);
+    ozz::memory::default_allocator()->Delete(skeleton);
+    ASSERT_TRUE(o_animation != NULL);
+  }
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+
+    // Streams out.
+    ozz::io::OArchive o(&stream, endianess);
+    o << *o_animation;
+
+    // Streams in.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+
+    CompressedAnimation i_animation;
+    i >> i_animation;
+
+    ASSERT_FLOAT_EQ(o_animation->duration(), i_animation.duration());
+    ASSERT_EQ(o_animation->num_tracks(), i_animation.num_tracks());
+    ASSERT_EQ(o_animation->num_frames(), i_animation.num_frames());
+    EXPECT_EQ(o_animation->frame_bits(), i_animation.frame_bits());
+    EXPECT_EQ(o_animation->block_size(), i_animation.block_size());
+    EXPECT_EQ(o_animation->size(), i_animation.size());
+
+    // Compares bit depths.
+    ASSERT_EQ(o_animation->translation_bits().Count(), 4u);
+    EXPECT_EQ(memcmp(o_animation->translation_bits().begin,
+                     i_animation.translation_bits().begin,
+                     o_animation->translation_bits().Size()), 0);
+    EXPECT_EQ(memcmp(o_animation->rotation_bits().begin,
+                     i_animation.rotation_bits().begin,
+                     o_animation->rotation_bits().Size()), 0);
+    EXPECT_EQ(memcmp(o_animation->scale_bits().begin,
+                     i_animation.scale_bits().begin,
+                     o_animation->scale_bits().Size()), 0);
+
+    // Compares ranges.
+    ASSERT_EQ(o_animation->translation_ranges().Count(), 2u);
+    EXPECT_EQ(memcmp(o_animation->translation_ranges().begin,
+                     i_animation.translation_ranges().begin,
+                     o_animation->translation_ranges().Size()), 0);
+    ASSERT_EQ(o_animation->rotation_ranges().Count(), 2u);
+    EXPECT_EQ(memcmp(o_animation->rotation_ranges().begin,
+                     i_animation.rotation_ranges().begin,
+                     o_animation->rotation_ranges().Size()), 0);
+    ASSERT_EQ(o_animation->scale_ranges().Count(), 2u);
+    EXPECT_EQ(memcmp(o_animation->scale_ranges().begin,
+                     i_animation.scale_ranges().begin,
+                     o_animation->scale_ranges().Size()), 0);
+
+    // Compares blocks.
+    ASSERT_EQ(o_animation->blocks().Count(), i_animation.blocks().Count());
+    EXPECT_EQ(memcmp(o_animation->blocks().begin,
+                     i_animation.blocks().begin,
+                     o_animation->blocks().Size()), 0);
+  }
+  ozz::memory::default_allocator()->Delete(o_animation);
+}
@@ -0,0 +1,301 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/compressed_sampling_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/memory/allocator.h"
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+
+#include "ozz/animation/runtime/compressed_animation.h"
+#include "ozz/animation/runtime/skeleton.h"
+
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/raw_skeleton.h"
+#include "ozz/animation/offline/animation_compressor.h"
+#include "ozz/animation/offline/skeleton_builder.h"
+
+using ozz::animation::CompressedAnimation;
+using ozz::animation::CompressedSamplingJob;
+using ozz::animation::Skeleton;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::RawSkeleton;
+using ozz::animation::offline::AnimationCompressor;
+using ozz::animation::offline::SkeletonBuilder;
+
+namespace {
+// Builds a skeleton made of _num_joints root joints.
+Skeleton* BuildFlatSkeleton(int _num_joints) {
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(_num_joints);
+  for (int i = 0; i < _num_joints; ++i) {
+    raw_skeleton.roots[i].name = "joint";
+    raw_skeleton.roots[i].name += static_cast<char>('0' + i);
+  }
+  SkeletonBuilder builder;
+  return builder(raw_skeleton);
+}
+}  // namespace
+
+TEST(JobValidity, CompressedSamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+
+  Skeleton* skeleton = BuildFlatSkeleton(1);
+  ASSERT_TRUE(skeleton != NULL);
+
+  AnimationCompressor compressor;
+  CompressedAnimation* animation = compressor(raw_animation, *skeleton);
+  ASSERT_TRUE(animation != NULL);
+
+  { // Empty/default job
+    CompressedSamplingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid output
+    CompressedSamplingJob job;
+    job.animation = animation;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid animation.
+    ozz::math::SoaTransform output[1];
+
+    CompressedSamplingJob job;
+    job.output.begin = output;
+    job.output.end = output + 1;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid output range: end < begin.
+    ozz::math::SoaTransform output[1];
+
+    CompressedSamplingJob job;
+    job.animation = animation;
+    job.output.begin = output + 1;
+    job.output.end = output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid job.
+    ozz::math::SoaTransform output[1];
+
+    CompressedSamplingJob job;
+    job.animation = animation;
+    job.output.begin = output;
+    job.output.end = output + 1;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Valid job with bigger output.
+    ozz::math::SoaTransform output[2];
+
+    CompressedSamplingJob job;
+    job.animation = animation;
+    job.output.begin = output;
+    job.output.end = output + 2;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Sampling, CompressedSamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(5);
+
+  // Track 0 translation is linear, so uniform sampling is exact.
+  const RawAnimation::TranslationKey t_key0 = {
+    0.f, ozz::math::Float3(0.f, 1.f, -2.f)};
+  raw_animation.tracks[0].translations.push_back(t_key0);
+  const RawAnimation::TranslationKey t_key1 = {
+    1.f, ozz::math::Float3(4.f, 1.f, 2.f)};
+  raw_animation.tracks[0].translations.push_back(t_key1);
+
+  // Track 1 rotation is constant.
+  const RawAnimation::RotationKey r_key = {
+    .5f, ozz::math::Quaternion(0.f, .70710677f, 0.f, .70710677f)};
+  raw_animation.tracks[1].rotations.push_back(r_key);
+
+  // Track 2 scale is linear from 0 to .5, then constant.
+  const RawAnimation::ScaleKey s_key0 = {
+    0.f, ozz::math::Float3(1.f, 1.f, 1.f)};
+  raw_animation.tracks[2].scales.push_back(s_key0);
+  const RawAnimation::ScaleKey s_key1 = {
+    .5f, ozz::math::Float3(2.f, 3.f, 1.f)};
+  raw_animation.tracks[2].scales.push_back(s_key1);
+
+  // Track 3 translation is constant, track 4 is empty.
+  const RawAnimation::TranslationKey t_key2 = {
+    .3f, ozz::math::Float3(-1.f, 8.f, 3.f)};
+  raw_animation.tracks[3].translations.push_back(t_key2);
+
+  Skeleton* skeleton = BuildFlatSkeleton(5);
+  ASSERT_TRUE(skeleton != NULL);
+
+  AnimationCompressor compressor;
+  compressor.tolerance = 1e-4f;
+  CompressedAnimation* animation = compressor(raw_animation, *skeleton);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_EQ(animation->num_frames(), 31);
+
+  // Constant and empty tracks use no bit.
+  EXPECT_GT(animation->translation_bits().begin[0], 0);
+  EXPECT_EQ(animation->rotation_bits().begin[1], 0);
+  EXPECT_GT(animation->scale_bits().begin[2], 0);
+  EXPECT_EQ(animation->translation_bits().begin[3], 0);
+  for (int i = 4; i < 8; ++i) {
+    EXPECT_EQ(animation->translation_bits().begin[i], 0);
+    EXPECT_EQ(animation->rotation_bits().begin[i], 0);
+    EXPECT_EQ(animation->scale_bits().begin[i], 0);
+  }
+
+  ozz::math::SoaTransform output[3];
+  output[2] = ozz::math::SoaTransform::identity();
+  output[2].translation.x = ozz::math::simd_float4::Load1(46.f);
+
+  CompressedSamplingJob job;
+  job.animation = animation;
+  job.output.begin = output;
+  job.output.end = output + 3;
+
+  const struct {
+    float time;
+    float tx, tz;
+    float sx, sy;
+  } expectations[] = {
+    {-.2f, 0.f, -2.f, 1.f, 1.f},
+    {0.f, 0.f, -2.f, 1.f, 1.f},
+    {.25f, 1.f, -1.f, 1.5f, 2.f},
+    {.51f, 2.04f, .04f, 2.f, 3.f},
+    {1.f, 4.f, 2.f, 2.f, 3.f},
+    {1.5f, 4.f, 2.f, 2.f, 3.f}};
+
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(expectations); ++i) {
+    job.time = expectations[i].time;
+    ASSERT_TRUE(job.Run());
+
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation,
+                            expectations[i].tx, 0.f, 0.f, -1.f,
+                            1.f, 0.f, 0.f, 8.f,
+                            expectations[i].tz, 0.f, 0.f, 3.f);
+    EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation,
+                                0.f, 0.f, 0.f, 0.f,
+                                0.f, .70710677f, 0.f, 0.f,
+                                0.f, 0.f, 0.f, 0.f,
+                                1.f, .70710677f, 1.f, 1.f);
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].scale,
+                            1.f, 1.f, expectations[i].sx, 1.f,
+                            1.f, 1.f, expectations[i].sy, 1.f,
+                            1.f, 1.f, 1.f, 1.f);
+
+    // Empty track and soa padding tracks are identity.
+    EXPECT_SOAFLOAT3_EQ(output[1].translation,
+                        0.f, 0.f, 0.f, 0.f,
+                        0.f, 0.f, 0.f, 0.f,
+                        0.f, 0.f, 0.f, 0.f);
+    EXPECT_SOAQUATERNION_EQ(output[1].rotation,
+                            0.f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f,
+                            1.f, 1.f, 1.f, 1.f);
+    EXPECT_SOAFLOAT3_EQ(output[1].scale,
+                        1.f, 1.f, 1.f, 1.f,
+                        1.f, 1.f, 1.f, 1.f,
+                        1.f, 1.f, 1.f, 1.f);
+
+    // Output passed animation tracks is left unchanged.
+    EXPECT_SOAFLOAT3_EQ(output[2].translation,
+                        46.f, 46.f, 46.f, 46.f,
+                        0.f, 0.f, 0.f, 0.f,
+                        0.f, 0.f, 0.f, 0.f);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Loop, CompressedSamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(1);
+
+  const RawAnimation::TranslationKey t_key0 = {
+    0.f, ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(t_key0);
+  const RawAnimation::TranslationKey t_key1 = {
+    2.f, ozz::math::Float3(8.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(t_key1);
+
+  Skeleton* skeleton = BuildFlatSkeleton(1);
+  ASSERT_TRUE(skeleton != NULL);
+
+  AnimationCompressor compressor;
+  CompressedAnimation* animation = compressor(raw_animation, *skeleton);
+  ASSERT_TRUE(animation != NULL);
+
+  ozz::math::SoaTransform output[1];
+
+  CompressedSamplingJob job;
+  job.animation = animation;
+  job.loop = true;
+  job.output.begin = output;
+  job.output.end = output + 1;
+
+  const struct {
+    float time;
+    float tx;
+  } expectations[] = {
+    {.5f, 2.f}, {2.5f, 2.f}, {-1.5f, 2.f}, {5.f, 4.f}, {-.25f, 7.f}};
+
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(expectations); ++i) {
+    job.time = expectations[i].time;
+    ASSERT_TRUE(job.Run());
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation,
+                            expectations[i].tx, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f,
+                            0.f, 0.f, 0.f, 0.f);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
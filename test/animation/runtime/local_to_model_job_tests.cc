@@ -30,8 +30,11 @@
 
 #include "ozz/animation/runtime/local_to_model_job.h"
 
+#include <cstring>
+
 #include "gtest/gtest.h"
 
+#include "ozz/base/cpu.h"
 #include "ozz/base/memory/allocator.h"
 #include "ozz/base/maths/gtest_math_helper.h"
 #include "ozz/base/maths/soa_transform.h"
@@ -39,6 +42,7 @@
 #include "ozz/animation/offline/raw_skeleton.h"
 #include "ozz/animation/offline/skeleton_builder.h"
 #include "ozz/animation/runtime/skeleton.h"
+#include "ozz/animation/runtime/skeleton_utils.h"
 
 using ozz::animation::Skeleton;
 using ozz::animation::LocalToModelJob;
@@ -276,3 +280,310 @@ TEST(Transformation, LocalToModel) {
                                 0.f, 0.f, 0.f, 1.f);
   ozz::memory::default_allocator()->Delete(skeleton);
 }
+
+TEST(InstructionSets, LocalToModel) {
+  // Builds a hierarchy of 11 joints, so 3 soa transforms are needed, which
+  // exercises kernels remainders.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint* joint = &raw_skeleton.roots[0];
+  for (int i = 0; i < 10; ++i) {
+    joint->name = "joint";
+    joint->children.resize(1);
+    joint = &joint->children[0];
+  }
+  joint->name = "leaf";
+  ASSERT_EQ(raw_skeleton.num_joints(), 11);
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+
+  // Initializes input transformations.
+  ozz::math::SoaTransform input[3];
+  for (int i = 0; i < 3; ++i) {
+    const float f = static_cast<float>(i);
+    const ozz::math::SoaTransform transform = {
+      {ozz::math::simd_float4::Load(f, 1.f, -2.f, 3.f),
+       ozz::math::simd_float4::Load(4.f, -f, 6.f, .5f),
+       ozz::math::simd_float4::Load(-1.f, 2.f, f, 1.f)},
+      {ozz::math::simd_float4::Load(0.f, .70710677f, 0.f, 0.f),
+       ozz::math::simd_float4::Load(0.f, 0.f, .70710677f, 0.f),
+       ozz::math::simd_float4::Load(.70710677f, 0.f, 0.f, 0.f),
+       ozz::math::simd_float4::Load(.70710677f, .70710677f, .70710677f, 1.f)},
+      {ozz::math::simd_float4::Load(1.f, 2.f, 1.f, .5f),
+       ozz::math::simd_float4::Load(1.f, 1.f, 3.f, 1.f),
+       ozz::math::simd_float4::Load(2.f, 1.f, 1.f, 1.f)}};
+    input[i] = transform;
+  }
+
+  // Computes expected output with baseline kernels.
+  ozz::math::Float4x4 expected[11];
+  ozz::math::Float4x4 output[11];
+  LocalToModelJob job;
+  job.skeleton = skeleton;
+  job.input.begin = input;
+  job.input.end = input + 3;
+  job.output.begin = expected;
+  job.output.end = expected + 11;
+  const ozz::cpu::InstructionSet detected = ozz::cpu::Detect();
+  ASSERT_TRUE(ozz::cpu::SetInstructionSet(ozz::cpu::kBaseline));
+  EXPECT_TRUE(job.Run());
+
+  // Every supported instruction set must output the same result.
+  job.output.begin = output;
+  job.output.end = output + 11;
+  for (int set = 0; set < ozz::cpu::kInstructionSetCount; ++set) {
+    if (!ozz::cpu::SetInstructionSet(
+          static_cast<ozz::cpu::InstructionSet>(set))) {
+      continue;
+    }
+    memset(output, 0, sizeof(output));
+    EXPECT_TRUE(job.Run());
+    EXPECT_EQ(memcmp(output, expected, sizeof(output)), 0);
+  }
+  EXPECT_TRUE(ozz::cpu::SetInstructionSet(detected));
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Range, LocalToModel) {
+  // Builds a hierarchy of 3 chains of 6 joints below a root, 19 joints.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(3);
+  for (int i = 0; i < 3; ++i) {
+    RawSkeleton::Joint* joint = &root.children[i];
+    for (int j = 0; j < 5; ++j) {
+      joint->name = "joint";
+      joint->children.resize(1);
+      joint = &joint->children[0];
+    }
+    joint->name = "leaf";
+  }
+  ASSERT_EQ(raw_skeleton.num_joints(), 19);
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+
+  // Initializes input transformations.
+  ozz::math::SoaTransform input[5];
+  for (int i = 0; i < 5; ++i) {
+    const float f = static_cast<float>(i);
+    const ozz::math::SoaTransform transform = {
+      {ozz::math::simd_float4::Load(f, 1.f, -2.f, 3.f),
+       ozz::math::simd_float4::Load(4.f, -f, 6.f, .5f),
+       ozz::math::simd_float4::Load(-1.f, 2.f, f, 1.f)},
+      {ozz::math::simd_float4::Load(0.f, .70710677f, 0.f, 0.f),
+       ozz::math::simd_float4::Load(0.f, 0.f, .70710677f, 0.f),
+       ozz::math::simd_float4::Load(.70710677f, 0.f, 0.f, 0.f),
+       ozz::math::simd_float4::Load(.70710677f, .70710677f, .70710677f, 1.f)},
+      {ozz::math::simd_float4::Load(1.f, 2.f, 1.f, .5f),
+       ozz::math::simd_float4::Load(1.f, 1.f, 3.f, 1.f),
+       ozz::math::simd_float4::Load(2.f, 1.f, 1.f, 1.f)}};
+    input[i] = transform;
+  }
+
+  // Computes reference output with a single job.
+  ozz::math::Float4x4 reference[19];
+  LocalToModelJob job;
+  job.skeleton = skeleton;
+  job.input.begin = input;
+  job.input.end = input + 5;
+  job.output.begin = reference;
+  job.output.end = reference + 19;
+  ASSERT_TRUE(job.Run());
+
+  ozz::math::Float4x4 output[19];
+  job.output.begin = output;
+  job.output.end = output + 19;
+
+  {  // Invalid ranges.
+    LocalToModelJob job_invalid(job);
+    job_invalid.from = -1;
+    EXPECT_FALSE(job_invalid.Validate());
+    job_invalid.from = 5;
+    job_invalid.to = 4;
+    EXPECT_FALSE(job_invalid.Validate());
+    job_invalid.from = 5;
+    job_invalid.to = 5;
+    EXPECT_TRUE(job_invalid.Validate());
+    job_invalid.from = 40;
+    job_invalid.to = 50;
+    EXPECT_TRUE(job_invalid.Run());
+  }
+
+  {  // Unaligned ranges, processed in order.
+    memset(output, 0, sizeof(output));
+    const int bounds[] = {0, 3, 9, 10, 17, 19};
+    for (int i = 0; i < 5; ++i) {
+      job.from = bounds[i];
+      job.to = bounds[i + 1];
+      ASSERT_TRUE(job.Run());
+    }
+    for (int i = 0; i < 19; ++i) {
+      for (int c = 0; c < 4; ++c) {
+        EXPECT_SIMDFLOAT_EQ(output[i].cols[c],
+                            ozz::math::GetX(reference[i].cols[c]),
+                            ozz::math::GetY(reference[i].cols[c]),
+                            ozz::math::GetZ(reference[i].cols[c]),
+                            ozz::math::GetW(reference[i].cols[c]));
+      }
+    }
+  }
+
+  {  // Chunks, processed by stage.
+    ozz::animation::JointsChunk chunks[5];
+    EXPECT_EQ(ozz::animation::SplitJoints(
+      *skeleton, 4, ozz::Range<ozz::animation::JointsChunk>(chunks, 4)), 0);
+    const int num_chunks = ozz::animation::SplitJoints(
+      *skeleton, 4, ozz::Range<ozz::animation::JointsChunk>(chunks));
+    ASSERT_EQ(num_chunks, 5);
+
+    memset(output, 0, sizeof(output));
+    for (int stage = 0, processed = 0; processed < num_chunks; ++stage) {
+      for (int i = 0; i < num_chunks; ++i) {
+        if (chunks[i].stage != stage) {
+          continue;
+        }
+        job.from = chunks[i].begin;
+        job.to = chunks[i].end;
+        ASSERT_TRUE(job.Run());
+        ++processed;
+      }
+    }
+    for (int i = 0; i < 19; ++i) {
+      for (int c = 0; c < 4; ++c) {
+        EXPECT_SIMDFLOAT_EQ(output[i].cols[c],
+                            ozz::math::GetX(reference[i].cols[c]),
+                            ozz::math::GetY(reference[i].cols[c]),
+                            ozz::math::GetZ(reference[i].cols[c]),
+                            ozz::math::GetW(reference[i].cols[c]));
+      }
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(Subtree, LocalToModel) {
+  // Builds a hierarchy of 3 chains of 4 joints below a root, plus a leaf child
+  // of the root, 14 joints. The 4 children of the root are stored first, then
+  // chains descendants.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  RawSkeleton::Joint& root = raw_skeleton.roots[0];
+  root.name = "root";
+  root.children.resize(4);
+  for (int i = 0; i < 3; ++i) {
+    RawSkeleton::Joint* joint = &root.children[i];
+    for (int j = 0; j < 3; ++j) {
+      joint->name = "joint";
+      joint->children.resize(1);
+      joint = &joint->children[0];
+    }
+    joint->name = "leaf";
+  }
+  root.children[3].name = "leaf";
+  ASSERT_EQ(raw_skeleton.num_joints(), 14);
+
+  SkeletonBuilder builder;
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+
+  // Initializes input transformations.
+  ozz::math::SoaTransform input[4];
+  for (int i = 0; i < 4; ++i) {
+    const float f = static_cast<float>(i);
+    const ozz::math::SoaTransform transform = {
+      {ozz::math::simd_float4::Load(f, 1.f, -2.f, 3.f),
+       ozz::math::simd_float4::Load(4.f, -f, 6.f, .5f),
+       ozz::math::simd_float4::Load(-1.f, 2.f, f, 1.f)},
+      {ozz::math::simd_float4::Load(0.f, .70710677f, 0.f, 0.f),
+       ozz::math::simd_float4::Load(0.f, 0.f, .70710677f, 0.f),
+       ozz::math::simd_float4::Load(.70710677f, 0.f, 0.f, 0.f),
+       ozz::math::simd_float4::Load(.70710677f, .70710677f, .70710677f, 1.f)},
+      {ozz::math::simd_float4::Load(1.f, 2.f, 1.f, .5f),
+       ozz::math::simd_float4::Load(1.f, 1.f, 3.f, 1.f),
+       ozz::math::simd_float4::Load(2.f, 1.f, 1.f, 1.f)}};
+    input[i] = transform;
+  }
+
+  // Computes the initial output.
+  ozz::math::Float4x4 output[14];
+  LocalToModelJob job;
+  job.skeleton = skeleton;
+  job.input.begin = input;
+  job.input.end = input + 4;
+  job.output.begin = output;
+  job.output.end = output + 14;
+  ASSERT_TRUE(job.Run());
+
+  {  // Invalid roots.
+    LocalToModelJob job_invalid(job);
+    job_invalid.root = -1;
+    EXPECT_FALSE(job_invalid.Validate());
+    job_invalid.root = 14;
+    EXPECT_FALSE(job_invalid.Validate());
+    job_invalid.root = 13;
+    EXPECT_TRUE(job_invalid.Validate());
+  }
+
+  // Joints of the 2nd chain are 2, 8, 9 and 10. Changes their local
+  // transforms only.
+  const int chain[] = {2, 8, 9, 10};
+  for (int i = 0; i < 4; ++i) {
+    ozz::math::SimdFloat4& x = input[chain[i] / 4].translation.x;
+    x = ozz::math::SetI(x, chain[i] % 4, 46.f);
+  }
+
+  // Computes the reference output, with the new local transforms.
+  ozz::math::Float4x4 reference[14];
+  LocalToModelJob job_reference(job);
+  job_reference.output.begin = reference;
+  job_reference.output.end = reference + 14;
+  ASSERT_TRUE(job_reference.Run());
+
+  ozz::math::Float4x4 initial[14];
+  memcpy(initial, output, sizeof(output));
+
+  // Only the 2 last joints of the chain are updated if range begins at 9.
+  job.root = 2;
+  job.from = 9;
+  ASSERT_TRUE(job.Run());
+  for (int i = 0; i < 14; ++i) {
+    const bool updated = i == 9 || i == 10;
+    EXPECT_EQ(memcmp(&output[i], &initial[i], sizeof(output[i])) != 0,
+              updated);
+  }
+
+  // Processes the whole chain, which must then match the reference. Other
+  // joints are left untouched.
+  job.from = 0;
+  ASSERT_TRUE(job.Run());
+  for (int i = 0; i < 14; ++i) {
+    const bool in_chain = i == 2 || (i >= 8 && i <= 10);
+    if (!in_chain) {
+      EXPECT_EQ(memcmp(&output[i], &initial[i], sizeof(output[i])), 0);
+      continue;
+    }
+    for (int c = 0; c < 4; ++c) {
+      EXPECT_SIMDFLOAT_EQ(output[i].cols[c],
+                          ozz::math::GetX(reference[i].cols[c]),
+                          ozz::math::GetY(reference[i].cols[c]),
+                          ozz::math::GetZ(reference[i].cols[c]),
+                          ozz::math::GetW(reference[i].cols[c]));
+    }
+  }
+
+  // A leaf subtree is the leaf itself.
+  memcpy(output, initial, sizeof(output));
+  job.root = 13;
+  ASSERT_TRUE(job.Run());
+  EXPECT_EQ(memcmp(output, initial, sizeof(output)), 0);
+
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
@@ -0,0 +1,328 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/sampling_blending_job.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/blending_job.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/animation_builder.h"
+
+using ozz::animation::Animation;
+using ozz::animation::BlendingJob;
+using ozz::animation::SamplingBlendingJob;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingJob;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::AnimationBuilder;
+
+namespace {
+
+// Builds an animation of _num_tracks tracks whose keys are all different, the
+// seed _s allows to build different animations.
+Animation* BuildAnimation(int _num_tracks, float _s) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(_num_tracks);
+  for (int i = 0; i < _num_tracks; ++i) {
+    RawAnimation::JointTrack& track = raw_animation.tracks[i];
+    for (int k = 0; k <= 4; ++k) {
+      const float t = k * .5f;
+      const float v = _s + i * .1f + k * .7f;
+      const RawAnimation::TranslationKey tkey = {
+        t, ozz::math::Float3(v, -v, v * .5f)};
+      track.translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey = {
+        t, ozz::math::Quaternion::FromAxisAngle(
+          ozz::math::Float4(0.f, 1.f, 0.f, v))};
+      track.rotations.push_back(rkey);
+      const RawAnimation::ScaleKey skey = {
+        t, ozz::math::Float3(1.f + v * .1f, 1.f, 1.f - v * .05f)};
+      track.scales.push_back(skey);
+    }
+  }
+  AnimationBuilder builder;
+  return builder(raw_animation);
+}
+
+// Compares two soa float4 values.
+void ExpectNear(ozz::math::SimdFloat4 _a, ozz::math::SimdFloat4 _b) {
+  float a[4], b[4];
+  ozz::math::StorePtrU(_a, a);
+  ozz::math::StorePtrU(_b, b);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_NEAR(a[i], b[i], 1e-5f);
+  }
+}
+
+// Compares two ranges of soa transforms.
+void ExpectNear(const ozz::math::SoaTransform* _a,
+                const ozz::math::SoaTransform* _b,
+                int _count) {
+  for (int i = 0; i < _count; ++i) {
+    ExpectNear(_a[i].translation.x, _b[i].translation.x);
+    ExpectNear(_a[i].translation.y, _b[i].translation.y);
+    ExpectNear(_a[i].translation.z, _b[i].translation.z);
+    ExpectNear(_a[i].rotation.x, _b[i].rotation.x);
+    ExpectNear(_a[i].rotation.y, _b[i].rotation.y);
+    ExpectNear(_a[i].rotation.z, _b[i].rotation.z);
+    ExpectNear(_a[i].rotation.w, _b[i].rotation.w);
+    ExpectNear(_a[i].scale.x, _b[i].scale.x);
+    ExpectNear(_a[i].scale.y, _b[i].scale.y);
+    ExpectNear(_a[i].scale.z, _b[i].scale.z);
+  }
+}
+}  // namespace
+
+TEST(JobValidity, SamplingBlendingJob) {
+  Animation* animation = BuildAnimation(8, 0.f);
+  ASSERT_TRUE(animation != NULL);
+  SamplingCache cache(8);
+  SamplingCache small_cache(4);
+  ozz::math::SoaTransform bind_pose[3];
+  ozz::math::SoaTransform output[3];
+  ozz::math::SimdFloat4 joint_weights[3];
+
+  {  // Empty/default job.
+    SamplingBlendingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid job with no layer.
+    SamplingBlendingJob job;
+    job.bind_pose.begin = bind_pose;
+    job.bind_pose.end = bind_pose + 2;
+    job.output.begin = output;
+    job.output.end = output + 2;
+    job.layers.begin = job.layers.end = NULL;
+    EXPECT_FALSE(job.Validate());  // NULL layers range.
+  }
+
+  SamplingBlendingJob::Layer layers[2];
+  layers[0].animation = animation;
+  layers[0].cache = &cache;
+  layers[0].weight = 1.f;
+  layers[1] = layers[0];
+
+  {  // Valid job.
+    SamplingBlendingJob job;
+    job.layers = layers;
+    job.bind_pose.begin = bind_pose;
+    job.bind_pose.end = bind_pose + 2;
+    job.output.begin = output;
+    job.output.end = output + 2;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+
+    // Invalid threshold.
+    job.threshold = 0.f;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Output too small.
+    SamplingBlendingJob job;
+    job.layers = layers;
+    job.bind_pose.begin = bind_pose;
+    job.bind_pose.end = bind_pose + 2;
+    job.output.begin = output;
+    job.output.end = output + 1;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Animation with less soa tracks than the bind pose.
+    SamplingBlendingJob job;
+    job.layers = layers;
+    job.bind_pose = bind_pose;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+  }
+
+  {  // Missing animation, missing cache, cache too small.
+    SamplingBlendingJob job;
+    job.layers = layers;
+    job.bind_pose.begin = bind_pose;
+    job.bind_pose.end = bind_pose + 2;
+    job.output = output;
+    layers[1].animation = NULL;
+    EXPECT_FALSE(job.Validate());
+    layers[1].animation = animation;
+    layers[1].cache = NULL;
+    EXPECT_FALSE(job.Validate());
+    layers[1].cache = &small_cache;
+    EXPECT_FALSE(job.Validate());
+    layers[1].cache = &cache;
+    EXPECT_TRUE(job.Validate());
+  }
+
+  {  // Joint weights.
+    SamplingBlendingJob job;
+    job.layers = layers;
+    job.bind_pose.begin = bind_pose;
+    job.bind_pose.end = bind_pose + 2;
+    job.output = output;
+    layers[0].joint_weights = joint_weights;
+    layers[0].joint_weights_size = 1;
+    EXPECT_FALSE(job.Validate());
+    layers[0].joint_weights_size = 2;
+    EXPECT_TRUE(job.Validate());
+    layers[0].joint_weights = NULL;
+    EXPECT_TRUE(job.Validate());
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Blending, SamplingBlendingJob) {
+  // Uses more joints than the job batch size, and a number of joints that
+  // isn't a multiple of the soa size.
+  const int kNumJoints = 70;
+  const int kNumSoaJoints = (kNumJoints + 3) / 4;
+  const int kNumLayers = 3;
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+
+  Animation* animations[kNumLayers];
+  for (int i = 0; i < kNumLayers; ++i) {
+    animations[i] = BuildAnimation(kNumJoints, i * 3.f);
+    ASSERT_TRUE(animations[i] != NULL);
+  }
+
+  // Bind pose is made of identity transforms.
+  ozz::Range<ozz::math::SoaTransform> bind_pose =
+    allocator->AllocateRange<ozz::math::SoaTransform>(kNumSoaJoints);
+  for (int i = 0; i < kNumSoaJoints; ++i) {
+    bind_pose.begin[i] = ozz::math::SoaTransform::identity();
+  }
+
+  // Last layer has per-joint weights, the second half of the joints is
+  // disabled, so the layer isn't sampled for these joints.
+  ozz::math::SimdFloat4* joint_weights =
+    allocator->Allocate<ozz::math::SimdFloat4>(kNumSoaJoints);
+  for (int i = 0; i < kNumSoaJoints; ++i) {
+    joint_weights[i] = i < kNumSoaJoints / 2 ?
+      ozz::math::simd_float4::Load(0.f, .3f, 1.f, .8f) :
+      ozz::math::simd_float4::zero();
+  }
+
+  ozz::Range<ozz::math::SoaTransform> locals[kNumLayers];
+  for (int i = 0; i < kNumLayers; ++i) {
+    locals[i] = allocator->AllocateRange<ozz::math::SoaTransform>(kNumSoaJoints);
+  }
+  ozz::Range<ozz::math::SoaTransform> expected_output =
+    allocator->AllocateRange<ozz::math::SoaTransform>(kNumSoaJoints);
+  ozz::Range<ozz::math::SoaTransform> output =
+    allocator->AllocateRange<ozz::math::SoaTransform>(kNumSoaJoints);
+
+  // Reference caches are used by the sampling job, the others by the fused
+  // job.
+  SamplingCache* reference_caches[kNumLayers];
+  SamplingCache* caches[kNumLayers];
+  for (int i = 0; i < kNumLayers; ++i) {
+    reference_caches[i] = allocator->New<SamplingCache>(kNumJoints);
+    caches[i] = allocator->New<SamplingCache>(kNumJoints);
+  }
+
+  // Weights sets, including a disabled layer and weights below threshold.
+  const float weights[][kNumLayers] = {
+    {1.f, 0.f, 0.f},
+    {.5f, .2f, 1.f},
+    {0.f, .7f, .6f},
+    {0.f, 0.f, 1.f},
+    {.02f, .03f, 0.f},
+    {0.f, 0.f, 0.f}};
+
+  for (int w = 0; w < static_cast<int>(OZZ_ARRAY_SIZE(weights)); ++w) {
+    for (int f = 0; f < 10; ++f) {
+      const float time = f * .37f - .5f;
+
+      // Reference sampling and blending.
+      BlendingJob::Layer blend_layers[kNumLayers];
+      for (int i = 0; i < kNumLayers; ++i) {
+        SamplingJob sampling_job;
+        sampling_job.animation = animations[i];
+        sampling_job.cache = reference_caches[i];
+        sampling_job.time = time + i * .1f;
+        sampling_job.loop = i != 0;
+        sampling_job.output = locals[i];
+        ASSERT_TRUE(sampling_job.Run());
+
+        blend_layers[i].transform = locals[i];
+        blend_layers[i].weight = weights[w][i];
+      }
+      blend_layers[kNumLayers - 1].joint_weights.begin = joint_weights;
+      blend_layers[kNumLayers - 1].joint_weights.end =
+        joint_weights + kNumSoaJoints;
+
+      BlendingJob blending_job;
+      blending_job.layers = blend_layers;
+      blending_job.bind_pose = bind_pose;
+      blending_job.output = expected_output;
+      ASSERT_TRUE(blending_job.Run());
+
+      // Fused job.
+      SamplingBlendingJob::Layer layers[kNumLayers];
+      for (int i = 0; i < kNumLayers; ++i) {
+        layers[i].animation = animations[i];
+        layers[i].cache = caches[i];
+        layers[i].time = time + i * .1f;
+        layers[i].loop = i != 0;
+        layers[i].weight = weights[w][i];
+      }
+      layers[kNumLayers - 1].joint_weights = joint_weights;
+      layers[kNumLayers - 1].joint_weights_size = kNumSoaJoints;
+
+      SamplingBlendingJob job;
+      job.layers = layers;
+      job.bind_pose = bind_pose;
+      job.output = output;
+      ASSERT_TRUE(job.Run());
+
+      ExpectNear(output.begin, expected_output.begin, kNumSoaJoints);
+    }
+  }
+
+  for (int i = 0; i < kNumLayers; ++i) {
+    allocator->Delete(reference_caches[i]);
+    allocator->Delete(caches[i]);
+    allocator->Deallocate(locals[i]);
+    allocator->Delete(animations[i]);
+  }
+  allocator->Deallocate(output);
+  allocator->Deallocate(expected_output);
+  allocator->Deallocate(joint_weights);
+  allocator->Deallocate(bind_pose);
+}
@@ -0,0 +1,167 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/sampling_cache_pool.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/animation_builder.h"
+
+using ozz::animation::Animation;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingCachePool;
+using ozz::animation::SamplingJob;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::AnimationBuilder;
+
+TEST(Construction, SamplingCachePool) {
+  SamplingCachePool pool(3, 7);
+  EXPECT_EQ(pool.num_caches(), 3);
+  EXPECT_EQ(pool.max_tracks(), 8);
+
+  SamplingCachePool::Handle handle;
+  EXPECT_FALSE(pool.assigned(handle));
+  SamplingCache* cache = pool.Acquire(&handle);
+  ASSERT_TRUE(cache != NULL);
+  EXPECT_EQ(cache->max_tracks(), 8);
+  EXPECT_TRUE(pool.assigned(handle));
+}
+
+TEST(LRU, SamplingCachePool) {
+  SamplingCachePool pool(3, 4);
+  SamplingCachePool::Handle handles[5];
+
+  // Assigns a different cache to each of the first 3 handles.
+  SamplingCache* caches[5];
+  for (int i = 0; i < 3; ++i) {
+    caches[i] = pool.Acquire(&handles[i]);
+    for (int j = 0; j < i; ++j) {
+      EXPECT_NE(caches[i], caches[j]);
+    }
+  }
+
+  // Same caches are returned as long as they're not evicted.
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(pool.Acquire(&handles[i]), caches[i]);
+  }
+
+  // Touches handle 0, so 1 is the least recently used.
+  EXPECT_EQ(pool.Acquire(&handles[0]), caches[0]);
+  caches[3] = pool.Acquire(&handles[3]);
+  EXPECT_EQ(caches[3], caches[1]);
+  EXPECT_FALSE(pool.assigned(handles[1]));
+  EXPECT_TRUE(pool.assigned(handles[0]));
+  EXPECT_TRUE(pool.assigned(handles[2]));
+  EXPECT_TRUE(pool.assigned(handles[3]));
+
+  // 2 is now the least recently used.
+  caches[4] = pool.Acquire(&handles[4]);
+  EXPECT_EQ(caches[4], caches[2]);
+  EXPECT_FALSE(pool.assigned(handles[2]));
+
+  // Evicted handle 1 gets the least recently used cache, 0.
+  EXPECT_EQ(pool.Acquire(&handles[1]), caches[0]);
+  EXPECT_FALSE(pool.assigned(handles[0]));
+
+  // Released cache is the first one to be assigned again.
+  pool.Release(&handles[4]);
+  EXPECT_FALSE(pool.assigned(handles[4]));
+  EXPECT_EQ(handles[4].cache, -1);
+  EXPECT_EQ(pool.Acquire(&handles[0]), caches[4]);
+  EXPECT_TRUE(pool.assigned(handles[3]));
+  EXPECT_TRUE(pool.assigned(handles[1]));
+
+  // Releasing an unassigned handle does nothing.
+  pool.Release(&handles[2]);
+  EXPECT_TRUE(pool.assigned(handles[0]));
+  EXPECT_TRUE(pool.assigned(handles[1]));
+  EXPECT_TRUE(pool.assigned(handles[3]));
+}
+
+TEST(Sampling, SamplingCachePool) {
+  // Builds 2 animations, with opposite translations.
+  Animation* animations[2];
+  for (int i = 0; i < 2; ++i) {
+    RawAnimation raw_animation;
+    raw_animation.duration = 1.f;
+    raw_animation.tracks.resize(1);
+    const float sign = i == 0 ? 1.f : -1.f;
+    for (int k = 0; k <= 10; ++k) {
+      const RawAnimation::TranslationKey key = {
+        k * .1f, ozz::math::Float3(sign * k, 0.f, 0.f)};
+      raw_animation.tracks[0].translations.push_back(key);
+    }
+    AnimationBuilder builder;
+    animations[i] = builder(raw_animation);
+    ASSERT_TRUE(animations[i] != NULL);
+  }
+
+  // Many instances share 2 caches, each one sampling its own animation and
+  // time.
+  SamplingCachePool pool(2, 1);
+  const int kNumInstances = 16;
+  SamplingCachePool::Handle handles[kNumInstances];
+  for (int frame = 0; frame < 10; ++frame) {
+    for (int i = 0; i < kNumInstances; ++i) {
+      // Some instances are updated more often than others.
+      if (frame % (1 + i % 3) != 0) {
+        continue;
+      }
+      const float time = (frame * .1f + i * .05f);
+      const float wrapped = time - static_cast<int>(time);
+      ozz::math::SoaTransform output[1];
+      SamplingJob job;
+      job.time = time;
+      job.loop = true;
+      job.animation = animations[i % 2];
+      job.cache = pool.Acquire(&handles[i]);
+      job.output = output;
+      ASSERT_TRUE(job.Run());
+      const float x = (i % 2 ? -10.f : 10.f) * wrapped;
+      EXPECT_SOAFLOAT3_EQ_EST(output[0].translation,
+                              x, 0.f, 0.f, 0.f,
+                              0.f, 0.f, 0.f, 0.f,
+                              0.f, 0.f, 0.f, 0.f);
+    }
+  }
+  for (int i = 0; i < kNumInstances; ++i) {
+    pool.Release(&handles[i]);
+  }
+
+  ozz::memory::default_allocator()->Delete(animations[0]);
+  ozz::memory::default_allocator()->Delete(animations[1]);
+}
@@ -32,6 +32,8 @@
 
 #include "gtest/gtest.h"
 
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
 #include "ozz/base/memory/allocator.h"
 #include "ozz/base/maths/gtest_math_helper.h"
 #include "ozz/base/maths/soa_transform.h"
@@ -43,6 +45,7 @@
 
 using ozz::animation::Animation;
 using ozz::animation::SamplingJob;
+using ozz::animation::BatchSamplingJob;
 using ozz::animation::SamplingCache;
 using ozz::animation::offline::RawAnimation;
 using ozz::animation::offline::AnimationBuilder;
@@ -690,3 +693,683 @@ TEST(SamplingCache, SamplingJob) {
   ozz::memory::default_allocator()->Delete(animations[0]);
   ozz::memory::default_allocator()->Delete(animations[1]);
 }
+
+TEST(SamplingCacheReload, SamplingJob) {
+  // Builds two animations with animated translations.
+  Animation* animations[2];
+  for (int i = 0; i < 2; ++i) {
+    RawAnimation raw_animation;
+    raw_animation.duration = 1.f;
+    raw_animation.tracks.resize(1);
+    const float sign = i == 0 ? 1.f : -1.f;
+    const RawAnimation::TranslationKey first = {
+      0.f, ozz::math::Float3(0.f, sign, 0.f)};
+    const RawAnimation::TranslationKey second = {
+      1.f, ozz::math::Float3(2.f * sign, sign, 4.f * sign)};
+    raw_animation.tracks[0].translations.push_back(first);
+    raw_animation.tracks[0].translations.push_back(second);
+    AnimationBuilder builder;
+    animations[i] = builder(raw_animation);
+    ASSERT_TRUE(animations[i] != NULL);
+  }
+  EXPECT_NE(animations[0]->generation(), 0u);
+  EXPECT_NE(animations[0]->generation(), animations[1]->generation());
+
+  SamplingCache cache(1);
+  ozz::math::SoaTransform output[1];
+  SamplingJob job;
+  job.time = .5f;
+  job.animation = animations[0];
+  job.cache = &cache;
+  job.output = output;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1.f, 0.f, 0.f, 0.f,
+                                                  1.f, 0.f, 0.f, 0.f,
+                                                  2.f, 0.f, 0.f, 0.f);
+
+  // Reloads the second animation in the first one, which keeps the same
+  // address. Cache must still detect that animation has changed.
+  const uint32_t generation = animations[0]->generation();
+  ozz::io::MemoryStream stream;
+  {
+    ozz::io::OArchive o(&stream);
+    o << *animations[1];
+  }
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  i >> *animations[0];
+  EXPECT_NE(animations[0]->generation(), generation);
+  EXPECT_NE(animations[0]->generation(), animations[1]->generation());
+
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, -1.f, 0.f, 0.f, 0.f,
+                                                  -1.f, 0.f, 0.f, 0.f,
+                                                  -2.f, 0.f, 0.f, 0.f);
+
+  ozz::memory::default_allocator()->Delete(animations[0]);
+  ozz::memory::default_allocator()->Delete(animations[1]);
+}
+
+TEST(SamplingConstant, SamplingJob) {
+  // Builds an animation with constant and animated tracks mixed in the same
+  // soa elements, and one made of constant tracks only.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(6);
+  for (int i = 0; i < 6; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      const float time = j * .3f;
+      const float value = i % 2 ? time : 1.f;  // Odd tracks are animated.
+      const RawAnimation::TranslationKey tkey =
+        {time, ozz::math::Float3(value, i * 1.f, 0.f)};
+      raw_animation.tracks[i].translations.push_back(tkey);
+      const RawAnimation::ScaleKey skey =
+        {time, ozz::math::Float3(1.f, i % 3 ? 2.f : value, 1.f)};
+      raw_animation.tracks[i].scales.push_back(skey);
+    }
+  }
+  AnimationBuilder builder;
+  builder.seek_interval = .4f;
+  Animation* animated = builder(raw_animation);
+  ASSERT_TRUE(animated != NULL);
+  EXPECT_EQ(animated->num_animated_translations(), 3);
+  EXPECT_EQ(animated->num_animated_scales(), 1);
+  EXPECT_EQ(animated->num_animated_rotations(), 0);
+
+  for (int i = 0; i < 6; ++i) {
+    raw_animation.tracks[i].translations.resize(1);
+    raw_animation.tracks[i].scales.clear();
+  }
+  Animation* constant = builder(raw_animation);
+  ASSERT_TRUE(constant != NULL);
+  EXPECT_EQ(constant->num_animated_translations(), 0);
+  EXPECT_TRUE(constant->translations().begin == constant->translations().end);
+
+  // Alternates both animations with the same cache, and compares with
+  // sampling from scratch.
+  const float times[] = {0.f, .5f, .2f, .9f, .1f, 1.f, .45f, .4f};
+  SamplingCache cache(6);
+  SamplingCache reference_cache(6);
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    for (int a = 0; a < 2; ++a) {
+      ozz::math::SoaTransform output[2];
+      SamplingJob job;
+      job.time = times[i];
+      job.animation = a ? constant : animated;
+      job.cache = &cache;
+      job.output.begin = output;
+      job.output.end = output + 2;
+      ASSERT_TRUE(job.Run());
+
+      ozz::math::SoaTransform expected[2];
+      reference_cache.Invalidate();
+      job.cache = &reference_cache;
+      job.output.begin = expected;
+      job.output.end = expected + 2;
+      ASSERT_TRUE(job.Run());
+
+      for (int j = 0; j < 2; ++j) {
+        EXPECT_EQ(memcmp(&expected[j], &output[j],
+                         sizeof(ozz::math::SoaTransform)), 0);
+      }
+
+      // Tests values of the first soa element.
+      const float t = times[i] < .9f ? times[i] : .9f;  // Last key at .9.
+      if (a) {
+        EXPECT_SOAFLOAT3_EQ(output[0].translation, 1.f, 0.f, 1.f, 0.f,
+                                                   0.f, 1.f, 2.f, 3.f,
+                                                   0.f, 0.f, 0.f, 0.f);
+      } else {
+        EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, 1.f, t, 1.f, t,
+                                                       0.f, 1.f, 2.f, 3.f,
+                                                       0.f, 0.f, 0.f, 0.f);
+        EXPECT_SOAFLOAT3_EQ_EST(output[0].scale, 1.f, 1.f, 1.f, 1.f,
+                                                 1.f, 2.f, 2.f, t,
+                                                 1.f, 1.f, 1.f, 1.f);
+      }
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(animated);
+  ozz::memory::default_allocator()->Delete(constant);
+}
+
+TEST(SamplingRotations, SamplingJob) {
+  // Builds an animation whose rotation keys largest component changes from a
+  // key to the next one, and whose compressed keys end up in opposite
+  // hemispheres.
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(4);
+  const ozz::math::Quaternion keys[4][2] = {
+    {ozz::math::Quaternion(.8f, -.6f, 0.f, 0.f),
+     ozz::math::Quaternion(.6f, -.8f, 0.f, 0.f)},
+    {ozz::math::Quaternion(0.f, .8f, -.6f, 0.f),
+     ozz::math::Quaternion(0.f, .6f, -.8f, 0.f)},
+    {ozz::math::Quaternion(0.f, 0.f, .8f, -.6f),
+     ozz::math::Quaternion(0.f, 0.f, .6f, -.8f)},
+    {ozz::math::Quaternion(-.6f, 0.f, 0.f, .8f),
+     ozz::math::Quaternion(-.8f, 0.f, 0.f, .6f)}};
+  for (int i = 0; i < 4; ++i) {
+    const RawAnimation::RotationKey key0 = {0.f, keys[i][0]};
+    raw_animation.tracks[i].rotations.push_back(key0);
+    const RawAnimation::RotationKey key1 = {1.f, keys[i][1]};
+    raw_animation.tracks[i].rotations.push_back(key1);
+  }
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache(4);
+  ozz::math::SoaTransform output[1];
+  SamplingJob job;
+  job.animation = animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 1;
+
+  job.time = 0.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation, .8f, 0.f, 0.f, -.6f,
+                                                  -.6f, .8f, 0.f, 0.f,
+                                                  0.f, -.6f, .8f, 0.f,
+                                                  0.f, 0.f, -.6f, .8f);
+
+  // Interpolation takes the shortest path.
+  job.time = .5f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation,
+                              .70710677f, 0.f, 0.f, -.70710677f,
+                              -.70710677f, .70710677f, 0.f, 0.f,
+                              0.f, -.70710677f, .70710677f, 0.f,
+                              0.f, 0.f, -.70710677f, .70710677f);
+
+  job.time = 1.f;
+  ASSERT_TRUE(job.Run());
+  EXPECT_SOAQUATERNION_EQ_EST(output[0].rotation, .6f, 0.f, 0.f, -.8f,
+                                                  -.8f, .6f, 0.f, 0.f,
+                                                  0.f, -.8f, .6f, 0.f,
+                                                  0.f, 0.f, -.8f, .6f);
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(JobValidity, BatchSamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(1);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache(1);
+  SamplingCache zero_cache(0);
+  ozz::math::SoaTransform output[2];
+
+  BatchSamplingJob::Instance instances[2];
+  instances[0].cache = &cache;
+  instances[0].output.begin = output;
+  instances[0].output.end = output + 1;
+  instances[1].cache = &cache;
+  instances[1].output.begin = output + 1;
+  instances[1].output.end = output + 2;
+
+  { // Empty/default job
+    BatchSamplingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid animation.
+    BatchSamplingJob job;
+    job.instances.begin = instances;
+    job.instances.end = instances + 2;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid instances range.
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.instances.begin = instances + 2;
+    job.instances.end = instances;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid instance cache.
+    BatchSamplingJob::Instance invalid[2] = {instances[0], instances[1]};
+    invalid[1].cache = &zero_cache;
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.instances.begin = invalid;
+    job.instances.end = invalid + 2;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Invalid instance output.
+    BatchSamplingJob::Instance invalid[2] = {instances[0], instances[1]};
+    invalid[0].output.end = output;
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.instances.begin = invalid;
+    job.instances.end = invalid + 2;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+
+  {  // Valid job with no instance.
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.instances.begin = instances;
+    job.instances.end = instances;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  {  // Valid job.
+    BatchSamplingJob job;
+    job.animation = animation;
+    job.instances.begin = instances;
+    job.instances.end = instances + 2;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Sampling, BatchSamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(6);
+
+  // Fills tracks with keys at different times, so that instances can or
+  // cannot share the same key frame interval.
+  for (int i = 0; i < 6; ++i) {
+    for (int j = 0; j <= i; ++j) {
+      const float time = (j + 1.f) / (i + 2.f);
+      const RawAnimation::TranslationKey tkey =
+        {time, ozz::math::Float3(i * 1.f, j * 2.f, time)};
+      raw_animation.tracks[i].translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey =
+        {time, ozz::math::Quaternion(0.f, time, 0.f, 1.f)};
+      raw_animation.tracks[i].rotations.push_back(rkey);
+    }
+    const RawAnimation::ScaleKey skey =
+      {1.f - i / 7.f, ozz::math::Float3(1.f, 2.f, i * 1.f)};
+    raw_animation.tracks[i].scales.push_back(skey);
+  }
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  // Unsorted times, with some instances sharing key frames intervals and
+  // some times outside of animation range.
+  const float times[] = {
+    -.1f, 0.f, .01f, .02f, .2f, .2f, .21f, .6f, .4f, .45f, .99f, 1.f, 2.f, .1f};
+  const int kNumInstances = OZZ_ARRAY_SIZE(times);
+
+  SamplingCache* caches[kNumInstances];
+  ozz::math::SoaTransform outputs[kNumInstances][2];
+  BatchSamplingJob::Instance instances[kNumInstances];
+  for (int i = 0; i < kNumInstances; ++i) {
+    caches[i] = ozz::memory::default_allocator()->New<SamplingCache>(6);
+    instances[i].time = times[i];
+    instances[i].cache = caches[i];
+    instances[i].output.begin = outputs[i];
+    instances[i].output.end = outputs[i] + 2;
+  }
+
+  BatchSamplingJob batch_job;
+  batch_job.animation = animation;
+  batch_job.instances.begin = instances;
+  batch_job.instances.end = instances + kNumInstances;
+
+  SamplingCache cache(6);
+  for (int loop = 0; loop < 3; ++loop) {
+    memset(outputs, 0xde, sizeof(outputs));
+    EXPECT_TRUE(batch_job.Validate());
+    EXPECT_TRUE(batch_job.Run());
+
+    // Compares with individually sampled instances.
+    for (int i = 0; i < kNumInstances; ++i) {
+      ozz::math::SoaTransform expected[2];
+      SamplingJob job;
+      job.time = instances[i].time;
+      job.animation = animation;
+      job.cache = &cache;
+      job.output.begin = expected;
+      job.output.end = expected + 2;
+      ASSERT_TRUE(job.Run());
+
+      for (int j = 0; j < 2; ++j) {
+        EXPECT_EQ(memcmp(&expected[j], &outputs[i][j],
+                         sizeof(ozz::math::SoaTransform)), 0);
+      }
+    }
+
+    // Moves instances forward.
+    for (int i = 0; i < kNumInstances; ++i) {
+      instances[i].time += .05f;
+    }
+  }
+
+  for (int i = 0; i < kNumInstances; ++i) {
+    ozz::memory::default_allocator()->Delete(caches[i]);
+  }
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(SeekIndex, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 4.f;
+  raw_animation.tracks.resize(6);
+
+  // Fills tracks with keys at different rates, so that seek index entries
+  // fall in between keys.
+  for (int i = 0; i < 6; ++i) {
+    const int num_keys = i * 7 + 1;
+    for (int j = 0; j < num_keys; ++j) {
+      const float time = raw_animation.duration * j / num_keys;
+      const RawAnimation::TranslationKey tkey =
+        {time, ozz::math::Float3(i * 1.f, j * 2.f, time)};
+      raw_animation.tracks[i].translations.push_back(tkey);
+      if (j % 2) {
+        const RawAnimation::RotationKey rkey =
+          {time, ozz::math::Quaternion(0.f, time, 0.f, 1.f)};
+        raw_animation.tracks[i].rotations.push_back(rkey);
+      }
+    }
+    const RawAnimation::ScaleKey skey =
+      {1.f + i / 2.f, ozz::math::Float3(1.f, 2.f, i * 1.f)};
+    raw_animation.tracks[i].scales.push_back(skey);
+  }
+
+  // Builds the same animation with and without seek index.
+  AnimationBuilder builder;
+  builder.seek_interval = .3f;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  EXPECT_FLOAT_EQ(animation->seek_interval(), .3f);
+  // 13 entries, 8 tracks, cursor + 2 keys per track.
+  EXPECT_EQ(animation->translation_seeks().Count(), 13u * (1 + 8 * 2));
+  EXPECT_EQ(animation->rotation_seeks().Count(), 13u * (1 + 8 * 2));
+  EXPECT_EQ(animation->scale_seeks().Count(), 13u * (1 + 8 * 2));
+
+  builder.seek_interval = 0.f;
+  Animation* reference = builder(raw_animation);
+  ASSERT_TRUE(reference != NULL);
+  EXPECT_FLOAT_EQ(reference->seek_interval(), 0.f);
+  EXPECT_EQ(reference->translation_seeks().Count(), 0u);
+  EXPECT_EQ(reference->rotation_seeks().Count(), 0u);
+  EXPECT_EQ(reference->scale_seeks().Count(), 0u);
+
+  // A tiny interval is enlarged, so the number of entries is capped.
+  builder.seek_interval = 1e-6f;
+  Animation* capped = builder(raw_animation);
+  ASSERT_TRUE(capped != NULL);
+  EXPECT_FLOAT_EQ(capped->seek_interval(),
+                  4.f / (AnimationBuilder::kMaxSeeks + 1));
+  EXPECT_EQ(capped->translation_seeks().Count(),
+            AnimationBuilder::kMaxSeeks * (1u + 8 * 2));
+
+  // Plays forward, backward, and jumps in time, including seek index entries
+  // times.
+  const float times[] = {
+    0.f, .1f, .3f, .31f, 3.f, 2.f, 2.1f, .9f, .6f, .6f, 3.9f, 4.f, 1.2f,
+    -1.f, 3.6f, 2.4f, 2.4f, .29f, .3f, 10.f, 1.5f, 1.51f, 3.61f};
+
+  SamplingCache cache(6);
+  SamplingCache capped_cache(6);
+  SamplingCache reference_cache(6);
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    ozz::math::SoaTransform output[2];
+    SamplingJob job;
+    job.time = times[i];
+    job.animation = animation;
+    job.cache = &cache;
+    job.output.begin = output;
+    job.output.end = output + 2;
+    ASSERT_TRUE(job.Run());
+
+    ozz::math::SoaTransform capped_output[2];
+    job.animation = capped;
+    job.cache = &capped_cache;
+    job.output.begin = capped_output;
+    job.output.end = capped_output + 2;
+    ASSERT_TRUE(job.Run());
+
+    ozz::math::SoaTransform expected[2];
+    job.animation = reference;
+    job.cache = &reference_cache;
+    job.output.begin = expected;
+    job.output.end = expected + 2;
+    ASSERT_TRUE(job.Run());
+
+    for (int j = 0; j < 2; ++j) {
+      EXPECT_EQ(memcmp(&expected[j], &output[j],
+                       sizeof(ozz::math::SoaTransform)), 0);
+      EXPECT_EQ(memcmp(&expected[j], &capped_output[j],
+                       sizeof(ozz::math::SoaTransform)), 0);
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(capped);
+  ozz::memory::default_allocator()->Delete(reference);
+}
+
+TEST(SamplingBackward, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(9);
+
+  // Fills tracks with keys at different rates, including sparse tracks.
+  for (int i = 0; i < 9; ++i) {
+    const int num_keys = (i % 3) * 11 + i;
+    for (int j = 0; j < num_keys; ++j) {
+      const float time = raw_animation.duration * (j + .5f) / num_keys;
+      const RawAnimation::TranslationKey tkey =
+        {time, ozz::math::Float3(i * 1.f, j * 2.f, time)};
+      raw_animation.tracks[i].translations.push_back(tkey);
+      if (j % 3) {
+        const RawAnimation::RotationKey rkey =
+          {time, ozz::math::Quaternion(time, 0.f, 0.f, 1.f)};
+        raw_animation.tracks[i].rotations.push_back(rkey);
+      }
+      if (i % 2) {
+        const RawAnimation::ScaleKey skey =
+          {time, ozz::math::Float3(1.f, time, j * 1.f)};
+        raw_animation.tracks[i].scales.push_back(skey);
+      }
+    }
+  }
+
+  // Tests with and without seek index.
+  const float seek_intervals[] = {0.f, .7f};
+  for (size_t s = 0; s < OZZ_ARRAY_SIZE(seek_intervals); ++s) {
+    AnimationBuilder builder;
+    builder.seek_interval = seek_intervals[s];
+    Animation* animation = builder(raw_animation);
+    ASSERT_TRUE(animation != NULL);
+
+    // Plays backward and forward at different speeds, with and without
+    // looping, so looping animations are rewound in both directions.
+    const float speeds[] = {-.01f, -.033f, -.1f, -.37f, .01f, .033f, .37f};
+    for (size_t sp = 0; sp < OZZ_ARRAY_SIZE(speeds); ++sp) {
+      for (int loop = 0; loop < 2; ++loop) {
+        SamplingCache cache(9);
+        SamplingCache reference_cache(9);
+        for (float time = speeds[sp] < 0.f ? 2.1f : -2.1f;
+             time >= -2.1f && time <= 2.1f;
+             time += speeds[sp]) {
+          ozz::math::SoaTransform output[3];
+          SamplingJob job;
+          job.time = time;
+          job.loop = loop != 0;
+          job.animation = animation;
+          job.cache = &cache;
+          job.output.begin = output;
+          job.output.end = output + 3;
+          ASSERT_TRUE(job.Run());
+
+          // Reference is sampled from scratch.
+          ozz::math::SoaTransform expected[3];
+          reference_cache.Invalidate();
+          job.cache = &reference_cache;
+          job.output.begin = expected;
+          job.output.end = expected + 3;
+          ASSERT_TRUE(job.Run());
+
+          for (int j = 0; j < 3; ++j) {
+            EXPECT_EQ(memcmp(&expected[j], &output[j],
+                             sizeof(ozz::math::SoaTransform)), 0);
+          }
+        }
+      }
+    }
+    ozz::memory::default_allocator()->Delete(animation);
+  }
+}
+
+TEST(SamplingLoop, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 2.f;
+  raw_animation.tracks.resize(1);
+  const RawAnimation::TranslationKey t_key0 = {
+    0.f, ozz::math::Float3(0.f, 0.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(t_key0);
+  const RawAnimation::TranslationKey t_key1 = {
+    2.f, ozz::math::Float3(2.f, 1.f, 0.f)};
+  raw_animation.tracks[0].translations.push_back(t_key1);
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache(1);
+  ozz::math::SoaTransform output[1];
+
+  SamplingJob job;
+  EXPECT_FALSE(job.loop);
+  job.animation = animation;
+  job.cache = &cache;
+  job.output.begin = output;
+  job.output.end = output + 1;
+
+  struct {
+    float time;
+    bool loop;
+    float x;
+  } samples[] = {{.5f, true, .5f},
+                 {2.5f, true, .5f},
+                 {2.5f, false, 2.f},
+                 {-.5f, true, 1.5f},
+                 {-.5f, false, 0.f},
+                 {-3.5f, true, .5f},
+                 {9.f, true, 1.f},
+                 {1.f, false, 1.f},
+                 {-2.f, true, 0.f},
+                 {4.f, true, 0.f}};
+
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(samples); ++i) {
+    job.time = samples[i].time;
+    job.loop = samples[i].loop;
+    ASSERT_TRUE(job.Run());
+    const float x = samples[i].x;
+    EXPECT_SOAFLOAT3_EQ_EST(output[0].translation, x, 0.f, 0.f, 0.f,
+                                                   x * .5f, 0.f, 0.f, 0.f,
+                                                   0.f, 0.f, 0.f, 0.f);
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(SamplingMask, SamplingJob) {
+  RawAnimation raw_animation;
+  raw_animation.duration = 1.f;
+  raw_animation.tracks.resize(10);  // 3 soa tracks.
+
+  for (int i = 0; i < 10; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      const float time = (j + i * .1f) / 4.f;
+      const RawAnimation::TranslationKey tkey =
+        {time, ozz::math::Float3(i * 1.f, j * 1.f, time)};
+      raw_animation.tracks[i].translations.push_back(tkey);
+      const RawAnimation::RotationKey rkey =
+        {time, ozz::math::Quaternion(0.f, time, 0.f, 1.f)};
+      raw_animation.tracks[i].rotations.push_back(rkey);
+      const RawAnimation::ScaleKey skey =
+        {time, ozz::math::Float3(1.f, time, j * 1.f)};
+      raw_animation.tracks[i].scales.push_back(skey);
+    }
+  }
+
+  AnimationBuilder builder;
+  Animation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache(10);
+  SamplingCache reference_cache(10);
+  ozz::math::SoaTransform output[3];
+  ozz::math::SoaTransform expected[3];
+
+  SamplingJob job;
+  job.animation = animation;
+  job.output.begin = output;
+  job.output.end = output + 3;
+  job.cache = &cache;
+
+  // Mask is too small.
+  bool mask[3] = {true, false, true};
+  job.mask.begin = mask;
+  job.mask.end = mask + 2;
+  EXPECT_FALSE(job.Validate());
+  job.mask.end = mask + 3;
+  EXPECT_TRUE(job.Validate());
+
+  // Samples with different masks, then with all tracks enabled.
+  const float times[] = {0.f, .3f, .6f, .2f, .9f, 1.f};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(times); ++i) {
+    mask[0] = i % 2 == 0;
+    mask[1] = i % 3 == 0;
+    mask[2] = i != 4;
+    for (int pass = 0; pass < 2; ++pass) {
+      memset(output, 0xde, sizeof(output));
+      job.time = times[i];
+      job.cache = &cache;
+      job.output.begin = output;
+      job.output.end = output + 3;
+      job.mask.begin = pass == 0 ? mask : NULL;
+      job.mask.end = pass == 0 ? mask + 3 : NULL;
+      ASSERT_TRUE(job.Run());
+
+      job.cache = &reference_cache;
+      job.output.begin = expected;
+      job.output.end = expected + 3;
+      job.mask.begin = NULL;
+      job.mask.end = NULL;
+      ASSERT_TRUE(job.Run());
+
+      for (int j = 0; j < 3; ++j) {
+        if (pass == 0 && !mask[j]) {
+          // Masked out tracks are left unchanged.
+          ozz::math::SoaTransform untouched;
+          memset(&untouched, 0xde, sizeof(untouched));
+          EXPECT_EQ(memcmp(&untouched, &output[j],
+                           sizeof(ozz::math::SoaTransform)), 0);
+        } else {
+          EXPECT_EQ(memcmp(&expected[j], &output[j],
+                           sizeof(ozz::math::SoaTransform)), 0);
+        }
+      }
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
@@ -0,0 +1,358 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/animation/runtime/segmented_sampling_job.h"
+
+#include <cstring>
+#include <string>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+#include "ozz/base/maths/soa_transform.h"
+#include "ozz/base/memory/allocator.h"
+
+#include "ozz/animation/runtime/animation.h"
+#include "ozz/animation/runtime/sampling_job.h"
+#include "ozz/animation/runtime/segmented_animation.h"
+#include "ozz/animation/offline/raw_animation.h"
+#include "ozz/animation/offline/animation_builder.h"
+#include "ozz/animation/offline/segmented_animation_builder.h"
+
+using ozz::animation::Animation;
+using ozz::animation::SamplingCache;
+using ozz::animation::SamplingJob;
+using ozz::animation::SegmentedAnimation;
+using ozz::animation::SegmentedSamplingJob;
+using ozz::animation::offline::RawAnimation;
+using ozz::animation::offline::AnimationBuilder;
+using ozz::animation::offline::SegmentedAnimationBuilder;
+
+namespace {
+// Builds a raw animation of 5 tracks, whose keys don't match segment
+// boundaries. Last track has no key.
+void BuildRawAnimation(RawAnimation* _raw_animation) {
+  _raw_animation->duration = 12.3f;
+  _raw_animation->tracks.resize(5);
+  for (int i = 0; i < 4; ++i) {
+    RawAnimation::JointTrack& track = _raw_animation->tracks[i];
+    for (float t = i * .1f; t <= 12.3f; t += .7f) {
+      const RawAnimation::TranslationKey key = {
+        t, ozz::math::Float3(t, i * 2.f, -t * .5f)};
+      track.translations.push_back(key);
+    }
+    for (float t = 0.f; t <= 12.3f; t += 1.3f) {
+      const RawAnimation::RotationKey key = {
+        t, ozz::math::Quaternion::FromAxisAngle(
+          ozz::math::Float4(0.f, 1.f, 0.f, t * .3f + i))};
+      track.rotations.push_back(key);
+    }
+  }
+  const RawAnimation::ScaleKey scale = {6.f, ozz::math::Float3(2.f)};
+  _raw_animation->tracks[1].scales.push_back(scale);
+}
+
+// Compares two SoaTransform ranges. Rotations are compared regardless of
+// their sign, as q and -q are the same rotation.
+void ExpectNear(const ozz::math::SoaTransform* _expected,
+                const ozz::math::SoaTransform* _output, int _count) {
+  for (int i = 0; i < _count; ++i) {
+    float expected[40];
+    float output[40];
+    std::memcpy(expected, &_expected[i], sizeof(expected));
+    std::memcpy(output, &_output[i], sizeof(output));
+    for (int j = 0; j < 4; ++j) {
+      float dot = 0.f;
+      for (int c = 0; c < 4; ++c) {
+        dot += expected[12 + c * 4 + j] * output[12 + c * 4 + j];
+      }
+      for (int c = 0; c < 4; ++c) {
+        expected[12 + c * 4 + j] *= dot < 0.f ? -1.f : 1.f;
+      }
+    }
+    for (int j = 0; j < 40; ++j) {
+      EXPECT_NEAR(expected[j], output[j], 2e-3f);
+    }
+  }
+}
+}  // namespace
+
+TEST(JobValidity, SegmentedSamplingJob) {
+  RawAnimation raw_animation;
+  BuildRawAnimation(&raw_animation);
+  SegmentedAnimationBuilder builder;
+  SegmentedAnimation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+
+  SamplingCache cache(5);
+  SamplingCache small_cache(1);
+  ozz::math::SoaTransform output[2];
+
+  {  // Default is invalid.
+    SegmentedSamplingJob job;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Invalid output.
+    SegmentedSamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.output.begin = output;
+    job.output.end = output + 1;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Invalid cache size.
+    SegmentedSamplingJob job;
+    job.animation = animation;
+    job.cache = &small_cache;
+    job.output = output;
+    EXPECT_FALSE(job.Validate());
+    EXPECT_FALSE(job.Run());
+  }
+  {  // Valid.
+    SegmentedSamplingJob job;
+    job.animation = animation;
+    job.cache = &cache;
+    job.output = output;
+    EXPECT_TRUE(job.Validate());
+    EXPECT_TRUE(job.Run());
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+}
+
+TEST(Sampling, SegmentedSamplingJob) {
+  RawAnimation raw_animation;
+  BuildRawAnimation(&raw_animation);
+  AnimationBuilder animation_builder;
+  Animation* reference = animation_builder(raw_animation);
+  ASSERT_TRUE(reference != NULL);
+  SegmentedAnimationBuilder builder;
+  builder.segment_duration = 5.f;
+  SegmentedAnimation* animation = builder(raw_animation);
+  ASSERT_TRUE(animation != NULL);
+  ASSERT_EQ(animation->num_segments(), 3);
+
+  SamplingCache reference_cache(5);
+  SamplingCache cache(5);
+  ozz::math::SoaTransform expected[2];
+  ozz::math::SoaTransform output[2];
+
+  for (int l = 0; l < 2; ++l) {
+    const bool loop = l != 0;
+    for (float time = -1.f; time < 26.f; time += .1f) {
+      SamplingJob reference_job;
+      reference_job.time = time;
+      reference_job.loop = loop;
+      reference_job.animation = reference;
+      reference_job.cache = &reference_cache;
+      reference_job.output = expected;
+      ASSERT_TRUE(reference_job.Run());
+
+      int segment = -2;
+      int next_segment = -2;
+      SegmentedSamplingJob job;
+      job.time = time;
+      job.loop = loop;
+      job.animation = animation;
+      job.cache = &cache;
+      job.output = output;
+      job.segment = &segment;
+      job.next_segment = &next_segment;
+      ASSERT_TRUE(job.Run());
+      ExpectNear(expected, output, 2);
+
+      EXPECT_EQ(segment, animation->FindSegment(time, loop));
+      if (segment < 2) {
+        EXPECT_EQ(next_segment, segment + 1);
+      } else {
+        EXPECT_EQ(next_segment, loop ? 0 : -1);
+      }
+    }
+  }
+
+  ozz::memory::default_allocator()->Delete(animation);
+  ozz::memory::default_allocator()->Delete(reference);
+}
+
+TEST(Streaming, SegmentedSamplingJob) {
+  RawAnimation raw_animation;
+  BuildRawAnimation(&raw_animation);
+  SegmentedAnimationBuilder builder;
+  builder.segment_duration = 2.f;
+  SegmentedAnimation* reference = builder(raw_animation);
+  ASSERT_TRUE(reference != NULL);
+  ASSERT_EQ(reference->num_segments(), 7);
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ozz::io::MemoryStream stream;
+    {
+      ozz::io::OArchive o(&stream, endianess);
+      o << *reference;
+    }
+
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+    SegmentedAnimation animation;
+    i >> animation;
+    EXPECT_FLOAT_EQ(animation.duration(), reference->duration());
+    EXPECT_FLOAT_EQ(animation.segment_duration(), 2.f);
+    EXPECT_EQ(animation.num_tracks(), 5);
+    ASSERT_EQ(animation.num_segments(), 7);
+
+    // Only the index is loaded.
+    for (int s = 0; s < animation.num_segments(); ++s) {
+      EXPECT_TRUE(animation.segment(s) == NULL);
+    }
+
+    SamplingCache reference_cache(5);
+    SamplingCache cache(5);
+    ozz::math::SoaTransform expected[2];
+    ozz::math::SoaTransform output[2];
+
+    // Plays the animation, keeping at most 2 segments loaded: the current one
+    // and the prefetched one.
+    int segment = -1;
+    int next_segment = -1;
+    SegmentedSamplingJob job;
+    job.animation = &animation;
+    job.cache = &cache;
+    job.output = output;
+    job.segment = &segment;
+    job.next_segment = &next_segment;
+
+    // Segment isn't loaded yet.
+    EXPECT_FALSE(job.Run());
+    EXPECT_EQ(segment, 0);
+    EXPECT_EQ(next_segment, 1);
+
+    for (float time = 0.f; time < 12.3f; time += .25f) {
+      job.time = time;
+      if (!job.Run()) {
+        ASSERT_TRUE(animation.LoadSegment(segment));
+        ASSERT_TRUE(job.Run());
+      }
+      if (next_segment >= 0) {
+        ASSERT_TRUE(animation.LoadSegment(next_segment));
+      }
+      for (int s = 0; s < animation.num_segments(); ++s) {
+        if (s != segment && s != next_segment && animation.segment(s)) {
+          animation.UnloadSegment(s);
+        }
+      }
+      int loaded = 0;
+      for (int s = 0; s < animation.num_segments(); ++s) {
+        loaded += animation.segment(s) != NULL;
+      }
+      EXPECT_LE(loaded, 2);
+
+      SegmentedSamplingJob reference_job;
+      reference_job.time = time;
+      reference_job.animation = reference;
+      reference_job.cache = &reference_cache;
+      reference_job.output = expected;
+      ASSERT_TRUE(reference_job.Run());
+      ExpectNear(expected, output, 2);
+    }
+
+    // Size only accounts for loaded segments.
+    EXPECT_LT(animation.size(), reference->size());
+    animation.UnloadAll();
+    EXPECT_TRUE(animation.segment(segment) == NULL);
+  }
+
+  ozz::memory::default_allocator()->Delete(reference);
+}
+
+TEST(Corrupted, SegmentedSamplingJob) {
+  RawAnimation raw_animation;
+  BuildRawAnimation(&raw_animation);
+  SegmentedAnimationBuilder builder;
+  SegmentedAnimation* reference = builder(raw_animation);
+  ASSERT_TRUE(reference != NULL);
+
+  ozz::io::MemoryStream stream;
+  {
+    ozz::io::OArchive o(&stream);
+    o << *reference;
+  }
+  ozz::memory::default_allocator()->Delete(reference);
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::IArchive i(&stream);
+  SegmentedAnimation animation;
+  i >> animation;
+
+  // Overwrites the tag of the last segment archive.
+  stream.Seek(0, ozz::io::Stream::kEnd);
+  const int size = stream.Tell();
+  stream.Seek(0, ozz::io::Stream::kSet);
+  std::string buffer(size, 0);
+  ASSERT_EQ(stream.Read(&buffer[0], size), static_cast<size_t>(size));
+  const size_t tag = buffer.rfind("ozz-animation");
+  ASSERT_NE(tag, std::string::npos);
+  stream.Seek(static_cast<int>(tag), ozz::io::Stream::kSet);
+  stream.Write("x", 1);
+
+  EXPECT_FALSE(animation.LoadSegment(animation.num_segments() - 1));
+  EXPECT_TRUE(animation.segment(animation.num_segments() - 1) == NULL);
+  EXPECT_TRUE(animation.LoadSegment(0));
+}
+
+TEST(CorruptedIndex, SegmentedSamplingJob) {
+  const uint32_t versions[] = {1, 2, 1, 1};
+  const int32_t num_tracks[] = {1, 1, -1, 1};
+  const int32_t num_segments[] = {1, 1, 1, -1};
+  for (size_t c = 0; c < OZZ_ARRAY_SIZE(versions); ++c) {
+    ozz::io::MemoryStream stream;
+    {
+      ozz::io::OArchive o(&stream);
+      ozz::io::internal::Tagger<const SegmentedAnimation>::Write(o);
+      o << versions[c];
+      o << 1.f;  // Duration.
+      o << num_tracks[c];
+      o << 1.f;  // Segment duration.
+      o << num_segments[c];
+      o << static_cast<uint32_t>(0);  // First segment offset.
+      o << static_cast<uint32_t>(0);  // First segment size.
+    }
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+    SegmentedAnimation animation;
+    i >> animation;
+
+    // Only the first case is valid, others are rejected and left empty.
+    EXPECT_EQ(animation.num_segments(), c == 0 ? 1 : 0);
+    EXPECT_EQ(animation.num_tracks(), c == 0 ? 1 : 0);
+  }
+}
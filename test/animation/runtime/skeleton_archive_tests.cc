@@ -33,6 +33,7 @@
 #include "gtest/gtest.h"
 
 #include "ozz/base/io/archive.h"
+#include "ozz/base/io/image.h"
 #include "ozz/base/io/stream.h"
 #include "ozz/base/maths/soa_transform.h"
 #include "ozz/base/memory/allocator.h"
@@ -187,3 +188,91 @@ TEST(AlreadyInitialized, SkeletonSerialize) {
   ozz::memory::default_allocator()->Delete(o_skeleton[0]);
   ozz::memory::default_allocator()->Delete(o_skeleton[1]);
 }
+
+TEST(Image, SkeletonSerialize) {
+  Skeleton* o_skeleton = NULL;
+  /* Builds output skeleton.
+   4 joints
+
+     *
+     |
+    root
+    / \
+   j0 j1
+   |
+   j2
+  */
+  {
+    RawSkeleton raw_skeleton;
+    raw_skeleton.roots.resize(1);
+    RawSkeleton::Joint& root = raw_skeleton.roots[0];
+    root.name = "root";
+    root.transform.translation = ozz::math::Float3(1.f, 2.f, 3.f);
+
+    root.children.resize(2);
+    root.children[0].name = "j0";
+    root.children[1].name = "j1";
+    root.children[0].children.resize(1);
+    root.children[0].children[0].name = "j2";
+
+    SkeletonBuilder builder;
+    o_skeleton = builder(raw_skeleton);
+    ASSERT_TRUE(o_skeleton != NULL);
+  }
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  const size_t size =
+    o_skeleton->SaveImage(NULL, 0, ozz::GetNativeEndianness());
+  ASSERT_NE(size, 0u);
+  void* image = allocator->Allocate(size, ozz::io::kImageAlignment);
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ASSERT_EQ(o_skeleton->SaveImage(image, size, endianess), size);
+
+    // Image is swapped the first time only.
+    for (int l = 0; l < 2; ++l) {
+      Skeleton i_skeleton;
+      ASSERT_TRUE(i_skeleton.LoadImage(image, size));
+
+      // Compares skeletons.
+      ASSERT_EQ(o_skeleton->num_joints(), i_skeleton.num_joints());
+      for (int i = 0; i < i_skeleton.num_joints(); ++i) {
+        EXPECT_EQ(i_skeleton.joint_properties().begin[i].parent,
+                  o_skeleton->joint_properties().begin[i].parent);
+        EXPECT_EQ(i_skeleton.joint_properties().begin[i].is_leaf,
+                  o_skeleton->joint_properties().begin[i].is_leaf);
+        EXPECT_STREQ(i_skeleton.joint_names()[i],
+                     o_skeleton->joint_names()[i]);
+      }
+      ASSERT_EQ(i_skeleton.bind_pose().Size(), o_skeleton->bind_pose().Size());
+      EXPECT_EQ(memcmp(i_skeleton.bind_pose().begin,
+                       o_skeleton->bind_pose().begin,
+                       o_skeleton->bind_pose().Size()), 0);
+    }
+  }
+
+  // Invalid images.
+  Skeleton i_skeleton;
+  EXPECT_FALSE(i_skeleton.LoadImage(image, size - 1));
+  EXPECT_EQ(i_skeleton.num_joints(), 0);
+  EXPECT_FALSE(i_skeleton.LoadImage(static_cast<char*>(image) + 4, size - 4));
+  EXPECT_FALSE(i_skeleton.LoadImage(NULL, size));
+
+  allocator->Deallocate(image);
+  allocator->Delete(o_skeleton);
+}
+
+TEST(EmptyImage, SkeletonSerialize) {
+  Skeleton o_skeleton;
+  const size_t size = o_skeleton.SaveImage(NULL, 0, ozz::kBigEndian);
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  void* image = allocator->Allocate(size, ozz::io::kImageAlignment);
+  ASSERT_EQ(o_skeleton.SaveImage(image, size, ozz::kBigEndian), size);
+
+  Skeleton i_skeleton;
+  EXPECT_TRUE(i_skeleton.LoadImage(image, size));
+  EXPECT_EQ(i_skeleton.num_joints(), 0);
+
+  allocator->Deallocate(image);
+}
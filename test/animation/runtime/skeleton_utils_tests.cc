@@ -37,6 +37,7 @@
 #include "ozz/base/gtest_helper.h"
 #include "ozz/base/maths/gtest_math_helper.h"
 
+#include "ozz/base/containers/vector.h"
 #include "ozz/base/memory/allocator.h"
 #include "ozz/animation/runtime/skeleton.h"
 #include "ozz/animation/runtime/skeleton_utils.h"
@@ -200,7 +201,9 @@ TEST(InterateDF, SkeletonUtils) {
   ASSERT_TRUE(skeleton != NULL);
   EXPECT_EQ(skeleton->num_joints(), 10);
 
+  uint16_t joints[10];
   ozz::animation::JointsIterator it;
+  it.joints = joints;
 
   ozz::animation::IterateJointsDF(*skeleton, -12, IterateDFFailTester());
   ozz::animation::IterateJointsDF(*skeleton, -12, &it);
@@ -212,7 +215,8 @@ TEST(InterateDF, SkeletonUtils) {
   ozz::animation::IterateJointsDF(
     *skeleton, ozz::animation::Skeleton::kNoParentIndex, &it);
   EXPECT_EQ(it.num_joints, 10);
-  EXPECT_EQ(std::memcmp(joints_df, it.joints, 10 * sizeof(uint16_t)), 0);
+  EXPECT_EQ(
+    std::memcmp(joints_df, it.joints.begin, 10 * sizeof(uint16_t)), 0);
 
   IterateDFTester fct_all = ozz::animation::IterateJointsDF(
     *skeleton,
@@ -222,7 +226,8 @@ TEST(InterateDF, SkeletonUtils) {
 
   ozz::animation::IterateJointsDF(*skeleton, 1, &it);
   EXPECT_EQ(it.num_joints, 1);
-  EXPECT_EQ(std::memcmp(joints_df + 9, it.joints, 1 * sizeof(uint16_t)), 0);
+  EXPECT_EQ(
+    std::memcmp(joints_df + 9, it.joints.begin, 1 * sizeof(uint16_t)), 0);
 
   IterateDFTester fct1 = ozz::animation::IterateJointsDF(
     *skeleton, 1, IterateDFTester(skeleton, 9));
@@ -230,7 +235,8 @@ TEST(InterateDF, SkeletonUtils) {
 
   ozz::animation::IterateJointsDF(*skeleton, 2, &it);
   EXPECT_EQ(it.num_joints, 3);
-  EXPECT_EQ(std::memcmp(joints_df + 1, it.joints, 1 * sizeof(uint16_t)), 0);
+  EXPECT_EQ(
+    std::memcmp(joints_df + 1, it.joints.begin, 1 * sizeof(uint16_t)), 0);
 
   IterateDFTester fct2 = ozz::animation::IterateJointsDF(
     *skeleton, 2, IterateDFTester(skeleton, 1));
@@ -238,7 +244,8 @@ TEST(InterateDF, SkeletonUtils) {
 
   ozz::animation::IterateJointsDF(*skeleton, 3, &it);
   EXPECT_EQ(it.num_joints, 4);
-  EXPECT_EQ(std::memcmp(joints_df + 4, it.joints, 4 * sizeof(uint16_t)), 0);
+  EXPECT_EQ(
+    std::memcmp(joints_df + 4, it.joints.begin, 4 * sizeof(uint16_t)), 0);
 
   IterateDFTester fct3 = ozz::animation::IterateJointsDF(
     *skeleton, 3, IterateDFTester(skeleton, 4));
@@ -246,12 +253,22 @@ TEST(InterateDF, SkeletonUtils) {
 
   ozz::animation::IterateJointsDF(*skeleton, 9, &it);
   EXPECT_EQ(it.num_joints, 1);
-  EXPECT_EQ(std::memcmp(joints_df + 7, it.joints, 1 * sizeof(uint16_t)), 0);
+  EXPECT_EQ(
+    std::memcmp(joints_df + 7, it.joints.begin, 1 * sizeof(uint16_t)), 0);
 
   IterateDFTester fct4 = ozz::animation::IterateJointsDF(
     *skeleton, 9, IterateDFTester(skeleton, 7));
   EXPECT_EQ(fct4.num_iterations(), 1);
 
+  // Traversal is truncated to the size of the joints buffer.
+  ozz::animation::JointsIterator it_small;
+  it_small.joints = ozz::Range<uint16_t>(joints, 4);
+  ozz::animation::IterateJointsDF(
+    *skeleton, ozz::animation::Skeleton::kNoParentIndex, &it_small);
+  EXPECT_EQ(it_small.num_joints, 4);
+  EXPECT_EQ(
+    std::memcmp(joints_df, it_small.joints.begin, 4 * sizeof(uint16_t)), 0);
+
   ozz::memory::default_allocator()->Delete(skeleton);
 }
 
@@ -270,12 +287,15 @@ TEST(InterateWorstBreadthDF, SkeletonUtils) {
   EXPECT_EQ(skeleton->num_joints(), Skeleton::kMaxJoints);
 
   ozz::animation::JointsIterator it;
+  it.joints = ozz::memory::default_allocator()->AllocateRange<uint16_t>(
+    Skeleton::kMaxJoints);
   ozz::animation::IterateJointsDF(*skeleton, Skeleton::kNoParentIndex, &it);
   EXPECT_EQ(it.num_joints, Skeleton::kMaxJoints);
 
   for (int i = 0; i < Skeleton::kMaxJoints; ++i) {
     EXPECT_EQ(it.joints[i], i);
   }
+  ozz::memory::default_allocator()->Deallocate(it.joints);
   ozz::memory::default_allocator()->Delete(skeleton);
 }
 
@@ -298,11 +318,130 @@ TEST(InterateWorstDepthDF, SkeletonUtils) {
   EXPECT_EQ(skeleton->num_joints(), Skeleton::kMaxJoints);
 
   ozz::animation::JointsIterator it;
+  it.joints = ozz::memory::default_allocator()->AllocateRange<uint16_t>(
+    Skeleton::kMaxJoints);
   ozz::animation::IterateJointsDF(*skeleton, Skeleton::kNoParentIndex, &it);
   EXPECT_EQ(it.num_joints, Skeleton::kMaxJoints);
 
   for (int i = 0; i < Skeleton::kMaxJoints; ++i) {
     EXPECT_EQ(it.joints[i], i);
   }
+  ozz::memory::default_allocator()->Deallocate(it.joints);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+namespace {
+// Builds a chain of _depth levels below _joint. Every level is made of two
+// joints, the first one being the parent of the next level.
+void BuildChain(RawSkeleton::Joint* _joint, int _depth) {
+  if (_depth == 0) {
+    return;
+  }
+  _joint->children.resize(2);
+  BuildChain(&_joint->children[0], _depth - 1);
+}
+
+// Appends to _joints the joints of the subtree of _joint, in depth-first order,
+// using a naive recursive implementation.
+void ReferenceDF(const Skeleton& _skeleton, int _joint,
+                 ozz::Vector<uint16_t>::Std* _joints) {
+  _joints->push_back(static_cast<uint16_t>(_joint));
+  for (int i = _joint + 1; i < _skeleton.num_joints(); ++i) {
+    if (_skeleton.joint_properties()[i].parent == _joint) {
+      ReferenceDF(_skeleton, i, _joints);
+    }
+  }
+}
+}  // namespace
+
+TEST(InterateWideDeepDF, SkeletonUtils) {
+  // Instantiates a builder objects with default parameters.
+  SkeletonBuilder builder;
+
+  // 2 roots, the first one having 64 children, each of them being the top of a
+  // 32 levels chain.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(2);
+  raw_skeleton.roots[0].children.resize(64);
+  for (int i = 0; i < 64; ++i) {
+    BuildChain(&raw_skeleton.roots[0].children[i], 32);
+  }
+  const int num_joints = 2 + 64 * (1 + 32 * 2);
+
+  EXPECT_TRUE(raw_skeleton.Validate());
+  EXPECT_EQ(raw_skeleton.num_joints(), num_joints);
+
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+  EXPECT_EQ(skeleton->num_joints(), num_joints);
+
+  ozz::Vector<uint16_t>::Std reference;
+  ReferenceDF(*skeleton, 0, &reference);
+  ReferenceDF(*skeleton, 1, &reference);
+  ASSERT_EQ(static_cast<int>(reference.size()), num_joints);
+
+  ozz::animation::JointsIterator it;
+  it.joints = ozz::memory::default_allocator()->AllocateRange<uint16_t>(
+    num_joints);
+  ozz::animation::IterateJointsDF(*skeleton, Skeleton::kNoParentIndex, &it);
+  ASSERT_EQ(it.num_joints, num_joints);
+  EXPECT_EQ(std::memcmp(&reference[0], it.joints.begin,
+                        num_joints * sizeof(uint16_t)), 0);
+
+  // Iterates from joints whose first child follows many joints, ie children
+  // of the first root and joints deep in their chains.
+  const int subtrees[] = {2, 40, 65, 500, 3000, num_joints - 1};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(subtrees); ++i) {
+    reference.clear();
+    ReferenceDF(*skeleton, subtrees[i], &reference);
+    ozz::animation::IterateJointsDF(*skeleton, subtrees[i], &it);
+    ASSERT_EQ(it.num_joints, static_cast<int>(reference.size()));
+    EXPECT_EQ(std::memcmp(&reference[0], it.joints.begin,
+                          reference.size() * sizeof(uint16_t)), 0);
+  }
+
+  ozz::memory::default_allocator()->Deallocate(it.joints);
+  ozz::memory::default_allocator()->Delete(skeleton);
+}
+
+TEST(SplitJoints, SkeletonUtils) {
+  // Instantiates a builder objects with default parameters.
+  SkeletonBuilder builder;
+
+  // A root with 12 children, all leaves but the 5th one that has a child.
+  // Chunks of the root children only depend on the chunk of the root.
+  RawSkeleton raw_skeleton;
+  raw_skeleton.roots.resize(1);
+  raw_skeleton.roots[0].children.resize(12);
+  raw_skeleton.roots[0].children[4].children.resize(1);
+  EXPECT_TRUE(raw_skeleton.Validate());
+  EXPECT_EQ(raw_skeleton.num_joints(), 14);
+
+  Skeleton* skeleton = builder(raw_skeleton);
+  ASSERT_TRUE(skeleton != NULL);
+
+  ozz::animation::JointsChunk chunks[5];
+
+  // Buffer is too small.
+  EXPECT_EQ(ozz::animation::SplitJoints(
+    *skeleton, 4, ozz::Range<ozz::animation::JointsChunk>(chunks, 3)), 0);
+
+  // Chunks size is rounded up to 4 joints.
+  EXPECT_EQ(ozz::animation::SplitJoints(
+    *skeleton, 3, ozz::Range<ozz::animation::JointsChunk>(chunks)), 4);
+  const int expected[4][3] = {{0, 4, 0}, {4, 8, 1}, {8, 12, 1}, {12, 14, 2}};
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(chunks[i].begin, expected[i][0]);
+    EXPECT_EQ(chunks[i].end, expected[i][1]);
+    EXPECT_EQ(chunks[i].stage, expected[i][2]);
+  }
+
+  // A single chunk.
+  EXPECT_EQ(ozz::animation::SplitJoints(
+    *skeleton, 100, ozz::Range<ozz::animation::JointsChunk>(chunks, 1)), 1);
+  EXPECT_EQ(chunks[0].begin, 0);
+  EXPECT_EQ(chunks[0].end, 14);
+  EXPECT_EQ(chunks[0].stage, 0);
+
   ozz::memory::default_allocator()->Delete(skeleton);
 }
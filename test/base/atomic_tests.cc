@@ -0,0 +1,44 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/atomic.h"
+
+#include "gtest/gtest.h"
+
+TEST(IncrementDecrement, Atomic) {
+  volatile long value = 0;
+  EXPECT_EQ(ozz::atomic::Increment(&value), 1);
+  EXPECT_EQ(ozz::atomic::Increment(&value), 2);
+  EXPECT_EQ(value, 2);
+  EXPECT_EQ(ozz::atomic::Decrement(&value), 1);
+  EXPECT_EQ(ozz::atomic::Decrement(&value), 0);
+  EXPECT_EQ(ozz::atomic::Decrement(&value), -1);
+  EXPECT_EQ(value, -1);
+}
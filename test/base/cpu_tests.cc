@@ -0,0 +1,77 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/cpu.h"
+
+#include "gtest/gtest.h"
+
+TEST(Detection, Cpu) {
+  // Baseline is always supported.
+  EXPECT_TRUE(ozz::cpu::IsSupported(ozz::cpu::kBaseline));
+
+  // Invalid instruction sets.
+  EXPECT_FALSE(ozz::cpu::IsSupported(ozz::cpu::kInstructionSetCount));
+
+  // The detected instruction set is the highest supported one.
+  const ozz::cpu::InstructionSet detected = ozz::cpu::Detect();
+  EXPECT_TRUE(ozz::cpu::IsSupported(detected));
+  for (int set = detected + 1; set < ozz::cpu::kInstructionSetCount; ++set) {
+    EXPECT_FALSE(ozz::cpu::IsSupported(static_cast<ozz::cpu::InstructionSet>(set)));
+  }
+
+  // Defaults to detected instruction set.
+  EXPECT_EQ(ozz::cpu::GetInstructionSet(), detected);
+}
+
+TEST(Override, Cpu) {
+  const ozz::cpu::InstructionSet detected = ozz::cpu::Detect();
+
+  // Overrides with every supported instruction set.
+  for (int i = 0; i < ozz::cpu::kInstructionSetCount; ++i) {
+    const ozz::cpu::InstructionSet set =
+      static_cast<ozz::cpu::InstructionSet>(i);
+    if (ozz::cpu::IsSupported(set)) {
+      EXPECT_TRUE(ozz::cpu::SetInstructionSet(set));
+      EXPECT_EQ(ozz::cpu::GetInstructionSet(), set);
+    } else {
+      EXPECT_FALSE(ozz::cpu::SetInstructionSet(set));
+      EXPECT_NE(ozz::cpu::GetInstructionSet(), set);
+    }
+  }
+
+  // Invalid instruction set doesn't change current one.
+  EXPECT_TRUE(ozz::cpu::SetInstructionSet(ozz::cpu::kBaseline));
+  EXPECT_FALSE(ozz::cpu::SetInstructionSet(ozz::cpu::kInstructionSetCount));
+  EXPECT_EQ(ozz::cpu::GetInstructionSet(), ozz::cpu::kBaseline);
+
+  // Restores automatic selection.
+  EXPECT_TRUE(ozz::cpu::SetInstructionSet(detected));
+  EXPECT_EQ(ozz::cpu::GetInstructionSet(), detected);
+}
@@ -104,4 +104,24 @@ TEST(Swap, Endianness) {
     EXPECT_EQ(uo[0], 0x1704191115279946ull);
     EXPECT_EQ(uo[1], 0x3507086946261458ull);
   }
+  {  // Long 2 bytes array swapping, that could be vectorized.
+    uint16_t uo[19];
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(uo); ++i) {
+      uo[i] = static_cast<uint16_t>(0x4600 + i);
+    }
+    ozz::EndianSwap(uo, OZZ_ARRAY_SIZE(uo));
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(uo); ++i) {
+      EXPECT_EQ(uo[i], static_cast<uint16_t>(i << 8 | 0x46));
+    }
+  }
+  {  // Long 4 bytes array swapping, that could be vectorized.
+    uint32_t uo[11];
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(uo); ++i) {
+      uo[i] = static_cast<uint32_t>(0x46992700 + i);
+    }
+    ozz::EndianSwap(uo, OZZ_ARRAY_SIZE(uo));
+    for (size_t i = 0; i < OZZ_ARRAY_SIZE(uo); ++i) {
+      EXPECT_EQ(uo[i], static_cast<uint32_t>(i << 24 | 0x279946));
+    }
+  }
 }
@@ -251,6 +251,59 @@ TEST(ClassArrays, Archive) {
   }
 }
 
+namespace {
+// POD structure made of 4 bytes words, that can use default PodSwapper.
+struct Pod {
+  int32_t i;
+  float f;
+  uint32_t u;
+};
+}  // namespace
+
+TEST(PodArrays, Archive) {
+  // Uses enough elements to be saved by chunks when swapping.
+  Pod po[301];
+  for (size_t j = 0; j < OZZ_ARRAY_SIZE(po); ++j) {
+    const Pod pod = {-static_cast<int32_t>(j), j * .5f,
+                     static_cast<uint32_t>(j << 16 | j)};
+    po[j] = pod;
+  }
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+
+    ozz::io::MemoryStream stream;
+    ASSERT_TRUE(stream.opened());
+
+    // Writes POD arrays.
+    ozz::io::OArchive o(&stream, endianess);
+    o << ozz::io::MakePodArray(po, OZZ_ARRAY_SIZE(po));
+    const Pod* po_null = NULL;
+    o << ozz::io::MakePodArray(po_null, 0);
+
+    // Writes the same array member by member.
+    for (size_t j = 0; j < OZZ_ARRAY_SIZE(po); ++j) {
+      o << po[j].i;
+      o << po[j].f;
+      o << po[j].u;
+    }
+
+    // Reads back POD arrays.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::IArchive i(&stream);
+    Pod pi[OZZ_ARRAY_SIZE(po)];
+    i >> ozz::io::MakePodArray(pi, OZZ_ARRAY_SIZE(pi));
+    EXPECT_EQ(std::memcmp(pi, po, sizeof(po)), 0);
+    Pod* pi_null = NULL;
+    i >> ozz::io::MakePodArray(pi_null, 0);
+
+    // Binary content must match member by member serialization.
+    Pod pm[OZZ_ARRAY_SIZE(po)];
+    i >> ozz::io::MakePodArray(pm, OZZ_ARRAY_SIZE(pm));
+    EXPECT_EQ(std::memcmp(pm, po, sizeof(po)), 0);
+  }
+}
+
 TEST(Tag, Archive) {
   ozz::io::MemoryStream stream;
   ASSERT_TRUE(stream.opened());
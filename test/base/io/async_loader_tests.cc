@@ -0,0 +1,222 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/io/async_loader.h"
+
+#include <cstdio>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/io/stream.h"
+
+namespace {
+// Defines a tagged object, whose content identifies the file it was loaded
+// from.
+struct Loadable {
+  Loadable()
+      : value(-1) {
+    for (int i = 0; i < kSize; ++i) {
+      data[i] = 0;
+    }
+  }
+  void Save(ozz::io::OArchive& _archive) const {
+    _archive << value;
+    _archive << ozz::io::MakeArray(data);
+  }
+  void Load(ozz::io::IArchive& _archive, uint32_t _version) {
+    (void)_version;
+    _archive >> value;
+    _archive >> ozz::io::MakeArray(data);
+  }
+  enum { kSize = 4096 };
+  int32_t value;
+  int32_t data[kSize];
+};
+
+// Defines another tagged type.
+struct Other {
+  void Save(ozz::io::OArchive& _archive) const { (void)_archive; }
+  void Load(ozz::io::IArchive& _archive, uint32_t _version) {
+    (void)_archive;
+    (void)_version;
+  }
+};
+}  // namespace
+
+namespace ozz {
+namespace io {
+OZZ_IO_TYPE_VERSION(1, Loadable)
+OZZ_IO_TYPE_TAG("loadable", Loadable)
+OZZ_IO_TYPE_NOT_VERSIONABLE(Other)
+OZZ_IO_TYPE_TAG("other", Other)
+}  // io
+}  // ozz
+
+namespace {
+const char* kFilenames[] = {
+  "async_loader_test0.ozz", "async_loader_test1.ozz",
+  "async_loader_test2.ozz", "async_loader_test3.ozz"};
+
+// Writes a Loadable object to every kFilenames, and an Other object to
+// _other.
+void WriteFiles(const char* _other) {
+  for (int i = 0; i < static_cast<int>(OZZ_ARRAY_SIZE(kFilenames)); ++i) {
+    ozz::io::File file(kFilenames[i], "wb");
+    ASSERT_TRUE(file.opened());
+    ozz::io::OArchive archive(&file);
+    Loadable object;
+    object.value = i;
+    for (int j = 0; j < Loadable::kSize; ++j) {
+      object.data[j] = i + j;
+    }
+    archive << object;
+  }
+  ozz::io::File file(_other, "wb");
+  ASSERT_TRUE(file.opened());
+  ozz::io::OArchive archive(&file);
+  archive << Other();
+}
+
+void RemoveFiles(const char* _other) {
+  for (int i = 0; i < static_cast<int>(OZZ_ARRAY_SIZE(kFilenames)); ++i) {
+    std::remove(kFilenames[i]);
+  }
+  std::remove(_other);
+}
+
+void ExpectLoaded(const Loadable& _object, int _value) {
+  EXPECT_EQ(_object.value, _value);
+  for (int j = 0; j < Loadable::kSize; ++j) {
+    if (_object.data[j] != _value + j) {
+      ADD_FAILURE() << "Unexpected content at " << j;
+      break;
+    }
+  }
+}
+}  // namespace
+
+TEST(Load, AsyncLoader) {
+  const char* other = "async_loader_test_other.ozz";
+  WriteFiles(other);
+
+  for (int t = 0; t < 4; ++t) {
+    ozz::io::AsyncLoader loader(t);
+    EXPECT_EQ(loader.num_threads(), t);
+
+    const int kCount = 32;
+    Loadable objects[kCount];
+    ozz::io::AsyncLoader::Handle handles[kCount];
+    const int num_files = static_cast<int>(OZZ_ARRAY_SIZE(kFilenames));
+    for (int i = 0; i < kCount; ++i) {
+      handles[i] = loader.Load(kFilenames[i % num_files], &objects[i]);
+      ASSERT_TRUE(handles[i] != NULL);
+    }
+    for (int i = 0; i < kCount; ++i) {
+      EXPECT_EQ(loader.Wait(handles[i]), ozz::io::AsyncLoader::kSucceeded);
+      EXPECT_EQ(loader.status(handles[i]), ozz::io::AsyncLoader::kSucceeded);
+      ExpectLoaded(objects[i], i % num_files);
+      loader.Release(handles[i]);
+    }
+  }
+
+  RemoveFiles(other);
+}
+
+TEST(Poll, AsyncLoader) {
+  const char* other = "async_loader_test_other_poll.ozz";
+  WriteFiles(other);
+
+  ozz::io::AsyncLoader loader(1);
+  Loadable object;
+  ozz::io::AsyncLoader::Handle handle = loader.Load(kFilenames[2], &object);
+  while (loader.status(handle) == ozz::io::AsyncLoader::kPending) {
+  }
+  EXPECT_EQ(loader.status(handle), ozz::io::AsyncLoader::kSucceeded);
+  ExpectLoaded(object, 2);
+  loader.Release(handle);
+
+  RemoveFiles(other);
+}
+
+TEST(Failure, AsyncLoader) {
+  const char* other = "async_loader_test_other_failure.ozz";
+  WriteFiles(other);
+
+  for (int t = 0; t < 2; ++t) {
+    ozz::io::AsyncLoader loader(t);
+    Loadable missing;
+    ozz::io::AsyncLoader::Handle missing_handle =
+      loader.Load("async_loader_test_missing.ozz", &missing);
+    Loadable wrong_tag;
+    ozz::io::AsyncLoader::Handle wrong_tag_handle =
+      loader.Load(other, &wrong_tag);
+    Other other_object;
+    ozz::io::AsyncLoader::Handle other_handle =
+      loader.Load(other, &other_object);
+
+    EXPECT_EQ(loader.Wait(missing_handle), ozz::io::AsyncLoader::kFailed);
+    EXPECT_EQ(missing.value, -1);
+    EXPECT_EQ(loader.Wait(wrong_tag_handle), ozz::io::AsyncLoader::kFailed);
+    EXPECT_EQ(wrong_tag.value, -1);
+    EXPECT_EQ(loader.Wait(other_handle), ozz::io::AsyncLoader::kSucceeded);
+
+    loader.Release(missing_handle);
+    loader.Release(wrong_tag_handle);
+    loader.Release(other_handle);
+  }
+
+  RemoveFiles(other);
+}
+
+TEST(Release, AsyncLoader) {
+  const char* other = "async_loader_test_other_release.ozz";
+  WriteFiles(other);
+
+  ozz::io::AsyncLoader loader(2);
+  const int kCount = 64;
+  Loadable objects[kCount];
+  ozz::io::AsyncLoader::Handle handles[kCount];
+  const int num_files = static_cast<int>(OZZ_ARRAY_SIZE(kFilenames));
+  for (int i = 0; i < kCount; ++i) {
+    handles[i] = loader.Load(kFilenames[i % num_files], &objects[i]);
+  }
+
+  // Releases requests in reverse order, so some are canceled before being
+  // processed. Released objects are either fully loaded or untouched.
+  for (int i = kCount - 1; i >= 0; --i) {
+    loader.Release(handles[i]);
+    if (objects[i].value != -1) {
+      ExpectLoaded(objects[i], i % num_files);
+    }
+  }
+
+  RemoveFiles(other);
+}
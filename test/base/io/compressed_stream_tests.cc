@@ -0,0 +1,318 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/io/compressed_stream.h"
+
+#include <cstdlib>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/io/archive.h"
+#include "ozz/base/memory/allocator.h"
+
+namespace {
+// Fills _buffer with data that compress well: repeated patterns with some
+// noise, and runs of the same byte.
+void FillCompressible(char* _buffer, size_t _size) {
+  std::srand(46);
+  for (size_t i = 0; i < _size; ++i) {
+    if ((i / 1024) % 3 == 2) {
+      _buffer[i] = 7;
+    } else {
+      _buffer[i] = static_cast<char>(i % 27 + (std::rand() % 16 == 0));
+    }
+  }
+}
+
+// Fills _buffer with data that can't be compressed.
+void FillRandom(char* _buffer, size_t _size) {
+  std::srand(27);
+  for (size_t i = 0; i < _size; ++i) {
+    _buffer[i] = static_cast<char>(std::rand());
+  }
+}
+
+void TestCodec(const char* _src, size_t _size) {
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  const size_t bound = ozz::io::CompressedStream::CompressBound(_size);
+  char* packed = allocator->Allocate<char>(bound);
+  char* unpacked = allocator->Allocate<char>(_size + 1);
+
+  const size_t packed_size =
+    ozz::io::CompressedStream::Compress(_src, _size, packed, bound);
+  ASSERT_GT(packed_size, 0u);
+  EXPECT_LE(packed_size, bound);
+  EXPECT_EQ(ozz::io::CompressedStream::Decompress(packed, packed_size,
+                                                  unpacked, _size), _size);
+  EXPECT_EQ(std::memcmp(_src, unpacked, _size), 0);
+
+  // Destination too small.
+  if (_size > 0) {
+    EXPECT_EQ(ozz::io::CompressedStream::Decompress(packed, packed_size,
+                                                    unpacked, _size - 1), 0u);
+  }
+
+  // Compression buffer too small.
+  EXPECT_EQ(ozz::io::CompressedStream::Compress(_src, _size, packed, bound - 1),
+            0u);
+
+  allocator->Deallocate(packed);
+  allocator->Deallocate(unpacked);
+}
+}  // namespace
+
+TEST(Codec, CompressedStream) {
+  const size_t kSize = 100000;
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  char* buffer = allocator->Allocate<char>(kSize);
+
+  FillCompressible(buffer, kSize);
+  TestCodec(buffer, 0);
+  TestCodec(buffer, 1);
+  TestCodec(buffer, 5);
+  TestCodec(buffer, 300);
+  TestCodec(buffer, kSize);
+
+  // Runs of the same byte produce overlapping back-references.
+  std::memset(buffer, 46, kSize);
+  TestCodec(buffer, kSize);
+  {
+    char packed[1024];
+    const size_t packed_size = ozz::io::CompressedStream::Compress(
+      buffer, 1000, packed, sizeof(packed));
+    EXPECT_LT(packed_size, 20u);
+  }
+
+  // Long literal runs.
+  FillRandom(buffer, kSize);
+  TestCodec(buffer, kSize);
+
+  allocator->Deallocate(buffer);
+}
+
+TEST(CodecCorrupted, CompressedStream) {
+  const size_t kSize = 10000;
+  char buffer[kSize];
+  FillCompressible(buffer, kSize);
+  char packed[kSize * 2];
+  const size_t packed_size = ozz::io::CompressedStream::Compress(
+    buffer, kSize, packed, sizeof(packed));
+  ASSERT_GT(packed_size, 0u);
+
+  // Decompressing any corrupted or truncated data must never overrun
+  // buffers.
+  char unpacked[kSize];
+  std::srand(46);
+  for (int i = 0; i < 1000; ++i) {
+    char corrupted[kSize * 2];
+    std::memcpy(corrupted, packed, packed_size);
+    corrupted[std::rand() % packed_size] = static_cast<char>(std::rand());
+    const size_t size = std::rand() % (packed_size + 1);
+    EXPECT_LE(ozz::io::CompressedStream::Decompress(corrupted, size,
+                                                    unpacked, kSize), kSize);
+  }
+}
+
+TEST(Stream, CompressedStream) {
+  const size_t kSize = 50000;
+  char data[kSize];
+
+  for (int d = 0; d < 2; ++d) {
+    if (d == 0) {
+      FillCompressible(data, kSize);
+    } else {
+      FillRandom(data, kSize);
+    }
+
+    ozz::io::MemoryStream stream;
+
+    // Compressed data don't need to be at the beginning of the stream.
+    const int32_t prefix = 46;
+    stream.Write(&prefix, sizeof(prefix));
+    {
+      ozz::io::CompressedStream compress(
+        &stream, ozz::io::CompressedStream::kCompress, 1000);
+      ASSERT_TRUE(compress.opened());
+      EXPECT_EQ(compress.mode(), ozz::io::CompressedStream::kCompress);
+      size_t written = 0;
+      for (size_t size = 1; written < kSize; size = size * 3 + 1) {
+        const size_t to_write = size < kSize - written ? size : kSize - written;
+        EXPECT_EQ(compress.Write(data + written, to_write), to_write);
+        written += to_write;
+        EXPECT_EQ(compress.Tell(), static_cast<int>(written));
+      }
+
+      // Only supports seeking to the current position.
+      EXPECT_EQ(compress.Seek(0, ozz::io::Stream::kCurrent), 0);
+      EXPECT_EQ(compress.Seek(0, ozz::io::Stream::kEnd), 0);
+      EXPECT_EQ(compress.Seek(0, ozz::io::Stream::kSet), -1);
+
+      // Can't read.
+      char byte;
+      EXPECT_EQ(compress.Read(&byte, 1), 0u);
+    }
+
+    // Compressible data are smaller.
+    const int compressed_size = stream.Tell() - static_cast<int>(sizeof(prefix));
+    if (d == 0) {
+      EXPECT_LT(compressed_size, static_cast<int>(kSize / 2));
+    } else {
+      EXPECT_LT(compressed_size, static_cast<int>(kSize + kSize / 50));
+    }
+
+    ASSERT_EQ(stream.Seek(sizeof(prefix), ozz::io::Stream::kSet), 0);
+    ozz::io::CompressedStream decompress(
+      &stream, ozz::io::CompressedStream::kDecompress);
+    ASSERT_TRUE(decompress.opened());
+    EXPECT_EQ(decompress.mode(), ozz::io::CompressedStream::kDecompress);
+    EXPECT_EQ(decompress.Tell(), 0);
+
+    // Can't write.
+    EXPECT_EQ(decompress.Write(data, 1), 0u);
+
+    // Sequential reads.
+    char read[kSize + 1];
+    size_t total = 0;
+    for (size_t size = 1; total < kSize; size = size * 2 + 3) {
+      const size_t to_read = size < kSize - total ? size : kSize - total;
+      ASSERT_EQ(decompress.Read(read + total, to_read), to_read);
+      total += to_read;
+      EXPECT_EQ(decompress.Tell(), static_cast<int>(total));
+    }
+    EXPECT_EQ(std::memcmp(data, read, kSize), 0);
+    EXPECT_EQ(decompress.Read(read, 1), 0u);
+
+    // Seeks.
+    EXPECT_EQ(decompress.Seek(0, ozz::io::Stream::kEnd), 0);
+    EXPECT_EQ(decompress.Tell(), static_cast<int>(kSize));
+    EXPECT_EQ(decompress.Read(read, 1), 0u);
+    EXPECT_EQ(decompress.Seek(-10, ozz::io::Stream::kEnd), 0);
+    EXPECT_EQ(decompress.Read(read, 20), 10u);
+    EXPECT_EQ(std::memcmp(data + kSize - 10, read, 10), 0);
+    EXPECT_NE(decompress.Seek(1, ozz::io::Stream::kEnd), 0);
+    EXPECT_NE(decompress.Seek(-1, ozz::io::Stream::kSet), 0);
+
+    std::srand(46);
+    for (int i = 0; i < 200; ++i) {
+      const int position = std::rand() % kSize;
+      if (i % 2) {
+        ASSERT_EQ(decompress.Seek(position, ozz::io::Stream::kSet), 0);
+      } else {
+        ASSERT_EQ(decompress.Seek(position - decompress.Tell(),
+                                  ozz::io::Stream::kCurrent), 0);
+      }
+      EXPECT_EQ(decompress.Tell(), position);
+      const size_t size = std::rand() % 3000;
+      const size_t expected = size < kSize - position ? size : kSize - position;
+      ASSERT_EQ(decompress.Read(read, size), expected);
+      EXPECT_EQ(std::memcmp(data + position, read, expected), 0);
+    }
+  }
+}
+
+TEST(Archive, CompressedStream) {
+  ozz::io::MemoryStream stream;
+  int32_t values[1000];
+  for (int i = 0; i < 1000; ++i) {
+    values[i] = i / 10;
+  }
+  {
+    ozz::io::CompressedStream compress(&stream,
+                                       ozz::io::CompressedStream::kCompress);
+    ozz::io::OArchive o(&compress, ozz::kBigEndian);
+    o << static_cast<int32_t>(46);
+    o << ozz::io::MakeArray(values);
+  }
+  EXPECT_LT(stream.Tell(), static_cast<int>(sizeof(values) / 4));
+
+  stream.Seek(0, ozz::io::Stream::kSet);
+  ozz::io::CompressedStream decompress(
+    &stream, ozz::io::CompressedStream::kDecompress);
+  ozz::io::IArchive i(&decompress);
+  int32_t value;
+  i >> value;
+  EXPECT_EQ(value, 46);
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  int32_t* loaded = allocator->Allocate<int32_t>(OZZ_ARRAY_SIZE(values));
+  i >> ozz::io::MakeArray(loaded, OZZ_ARRAY_SIZE(values));
+  EXPECT_EQ(std::memcmp(values, loaded, sizeof(values)), 0);
+  allocator->Deallocate(loaded);
+}
+
+TEST(Invalid, CompressedStream) {
+  {  // Empty stream.
+    ozz::io::MemoryStream stream;
+    ozz::io::CompressedStream decompress(
+      &stream, ozz::io::CompressedStream::kDecompress);
+    EXPECT_FALSE(decompress.opened());
+    char byte;
+    EXPECT_EQ(decompress.Read(&byte, 1), 0u);
+    EXPECT_EQ(decompress.Seek(0, ozz::io::Stream::kSet), -1);
+  }
+  {  // Not a compressed stream.
+    ozz::io::MemoryStream stream;
+    const char data[] = "not compressed data";
+    stream.Write(data, sizeof(data));
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::CompressedStream decompress(
+      &stream, ozz::io::CompressedStream::kDecompress);
+    EXPECT_FALSE(decompress.opened());
+  }
+  {  // Corrupted block.
+    ozz::io::MemoryStream stream;
+    char data[4000];
+    FillCompressible(data, sizeof(data));
+    {
+      ozz::io::CompressedStream compress(
+        &stream, ozz::io::CompressedStream::kCompress, 1000);
+      compress.Write(data, sizeof(data));
+    }
+
+    // Corrupts second block header.
+    stream.Seek(0, ozz::io::Stream::kSet);
+    {
+      ozz::io::CompressedStream decompress(
+        &stream, ozz::io::CompressedStream::kDecompress);
+      char read[1000];
+      ASSERT_EQ(decompress.Read(read, sizeof(read)), sizeof(read));
+    }
+    const uint32_t corrupted = 0xffffffff;
+    stream.Write(&corrupted, sizeof(corrupted));
+
+    stream.Seek(0, ozz::io::Stream::kSet);
+    ozz::io::CompressedStream decompress(
+      &stream, ozz::io::CompressedStream::kDecompress);
+    char read[4000];
+    EXPECT_EQ(decompress.Read(read, sizeof(read)), 1000u);
+    EXPECT_EQ(std::memcmp(data, read, 1000), 0);
+    EXPECT_NE(decompress.Seek(2500, ozz::io::Stream::kSet), 0);
+  }
+}
@@ -0,0 +1,207 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/io/image.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/platform.h"
+#include "ozz/base/memory/allocator.h"
+
+// Type whose image is written and read by the tests below.
+struct Imaged {
+};
+
+namespace ozz {
+namespace io {
+OZZ_IO_TYPE_VERSION(46, Imaged)
+OZZ_IO_TYPE_TAG("ozz-imaged", Imaged)
+}  // io
+}  // ozz
+
+namespace {
+// Writes an Imaged image to _buffer of _size bytes, and returns its size.
+size_t WriteImage(void* _buffer, size_t _size, ozz::Endianness _endianness) {
+  const float floats[] = {1.f, 2.f, 3.f};
+  const uint16_t shorts[] = {46, 93, 58};
+  const char chars[] = "ozz";
+
+  ozz::io::ImageWriter writer(_buffer, _size, _endianness);
+  writer.WriteHeader<Imaged>();
+  writer.Write(static_cast<int32_t>(-46));
+  writer.Write(ozz::Range<const float>(floats, OZZ_ARRAY_SIZE(floats)));
+  writer.Write(ozz::Range<const uint16_t>(shorts, OZZ_ARRAY_SIZE(shorts)));
+  writer.Write(ozz::Range<const char>(chars, sizeof(chars)));
+  writer.Write(ozz::Range<const float>());
+  writer.Write(99.f);
+  return _buffer ? writer.Finish() : writer.size();
+}
+
+// Reads back and checks an image written by WriteImage.
+void ReadImage(void* _image, size_t _size) {
+  ozz::io::ImageReader reader(_image, _size);
+  EXPECT_EQ(reader.ReadHeader<Imaged>(), 46u);
+
+  int32_t i = 0;
+  EXPECT_TRUE(reader.Read(&i));
+  EXPECT_EQ(i, -46);
+
+  ozz::Range<float> floats;
+  EXPECT_TRUE(reader.Read(&floats));
+  ASSERT_EQ(floats.Count(), 3u);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(floats.begin) %
+            ozz::io::kImageAlignment, 0u);
+  EXPECT_FLOAT_EQ(floats.begin[0], 1.f);
+  EXPECT_FLOAT_EQ(floats.begin[1], 2.f);
+  EXPECT_FLOAT_EQ(floats.begin[2], 3.f);
+
+  ozz::Range<uint16_t> shorts;
+  EXPECT_TRUE(reader.Read(&shorts));
+  ASSERT_EQ(shorts.Count(), 3u);
+  EXPECT_EQ(shorts.begin[0], 46);
+  EXPECT_EQ(shorts.begin[1], 93);
+  EXPECT_EQ(shorts.begin[2], 58);
+
+  ozz::Range<char> chars;
+  EXPECT_TRUE(reader.Read(&chars));
+  ASSERT_EQ(chars.Count(), 4u);
+  EXPECT_STREQ(chars.begin, "ozz");
+
+  ozz::Range<float> empty;
+  EXPECT_TRUE(reader.Read(&empty));
+  EXPECT_EQ(empty.Count(), 0u);
+
+  float f = 0.f;
+  EXPECT_TRUE(reader.Read(&f));
+  EXPECT_FLOAT_EQ(f, 99.f);
+
+  EXPECT_TRUE(reader.Finish());
+
+  // Reading past the end of the image fails.
+  EXPECT_FALSE(reader.Read(&f));
+  EXPECT_FALSE(reader.valid());
+}
+}  // namespace
+
+TEST(Image, Image) {
+  const size_t size = WriteImage(NULL, 0, ozz::GetNativeEndianness());
+  ASSERT_NE(size, 0u);
+  EXPECT_EQ(size % 4, 0u);
+  EXPECT_EQ(WriteImage(NULL, 0, ozz::kBigEndian), size);
+
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  char* image = static_cast<char*>(
+    allocator->Allocate(size + ozz::io::kImageAlignment,
+                        ozz::io::kImageAlignment));
+
+  // Buffer too small.
+  EXPECT_EQ(WriteImage(image, size - 1, ozz::kBigEndian), 0u);
+
+  for (int e = 0; e < 2; ++e) {
+    ozz::Endianness endianess = e == 0 ? ozz::kBigEndian : ozz::kLittleEndian;
+    ASSERT_EQ(WriteImage(image, size, endianess), size);
+    EXPECT_EQ(image[0], static_cast<char>(endianess));
+
+    // Image is swapped and marked native by the first read.
+    ReadImage(image, size);
+    EXPECT_EQ(image[0], static_cast<char>(ozz::GetNativeEndianness()));
+    ReadImage(image, size);
+
+    // Image size is read from the header, so a bigger buffer is valid.
+    ReadImage(image, size + ozz::io::kImageAlignment);
+  }
+
+  {  // Buffer smaller than the image.
+    ozz::io::ImageReader reader(image, size - 1);
+    EXPECT_EQ(reader.ReadHeader<Imaged>(), 0u);
+    EXPECT_FALSE(reader.Finish());
+  }
+
+  {  // Unaligned image.
+    std::memmove(image + 4, image, size);
+    ozz::io::ImageReader reader(image + 4, size);
+    EXPECT_EQ(reader.ReadHeader<Imaged>(), 0u);
+    std::memmove(image, image + 4, size);
+  }
+
+  {  // Invalid endianness.
+    const char endianness = image[0];
+    image[0] = 27;
+    ozz::io::ImageReader reader(image, size);
+    EXPECT_EQ(reader.ReadHeader<Imaged>(), 0u);
+    image[0] = endianness;
+  }
+
+  {  // Invalid tag.
+    image[13] = 'Z';
+    ozz::io::ImageReader reader(image, size);
+    EXPECT_EQ(reader.ReadHeader<Imaged>(), 0u);
+    EXPECT_FALSE(reader.valid());
+  }
+
+  allocator->Deallocate(image);
+}
+
+TEST(MappedFile, Image) {
+  {  // Non existing file.
+    ozz::io::MappedFile file("ozz_image_test_missing.bin");
+    EXPECT_FALSE(file.opened());
+    EXPECT_TRUE(file.data() == NULL);
+    EXPECT_EQ(file.size(), 0u);
+  }
+
+  const char* filename = "ozz_image_test.bin";
+  const size_t size = WriteImage(NULL, 0, ozz::kBigEndian);
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  void* image = allocator->Allocate(size, ozz::io::kImageAlignment);
+  ASSERT_EQ(WriteImage(image, size, ozz::kBigEndian), size);
+  {
+    std::FILE* file = std::fopen(filename, "wb");
+    ASSERT_TRUE(file != NULL);
+    EXPECT_EQ(std::fwrite(image, 1, size, file), size);
+    std::fclose(file);
+  }
+
+  for (int i = 0; i < 2; ++i) {
+    // Mapping is private, so the file is swapped again every time.
+    ozz::io::MappedFile file(filename);
+    ASSERT_TRUE(file.opened());
+    ASSERT_EQ(file.size(), size);
+    EXPECT_EQ(static_cast<char*>(file.data())[0],
+              static_cast<char>(ozz::kBigEndian));
+    ReadImage(file.data(), file.size());
+  }
+
+  allocator->Deallocate(image);
+  std::remove(filename);
+}
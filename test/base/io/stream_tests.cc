@@ -30,12 +30,14 @@
 
 #include "ozz/base/io/stream.h"
 
+#include <cstring>
 #include <limits>
 #include <stdint.h>
 
 #include "gtest/gtest.h"
 
 #include "ozz/base/platform.h"
+#include "ozz/base/memory/allocator.h"
 
 void TestStream(ozz::io::Stream* _stream) {
   ASSERT_TRUE(_stream->opened());
@@ -169,3 +171,90 @@ TEST(File, Stream) {
     TestSeek(&file);
   }
 }
+
+TEST(BufferedStream, Stream) {
+  const size_t buffer_sizes[] = {
+    1, 3, 16, ozz::io::BufferedStream::kDefaultBufferSize};
+  for (size_t i = 0; i < OZZ_ARRAY_SIZE(buffer_sizes); ++i) {
+    {
+      ozz::io::MemoryStream memory;
+      ozz::io::BufferedStream stream(&memory, buffer_sizes[i]);
+      TestStream(&stream);
+    }
+    {
+      ozz::io::MemoryStream memory;
+      ozz::io::BufferedStream stream(&memory, buffer_sizes[i]);
+      TestSeek(&stream);
+    }
+    {
+      ozz::io::MemoryStream memory;
+      ozz::io::BufferedStream stream(&memory, buffer_sizes[i]);
+      TestTooBigStream(&stream);
+    }
+    {
+      ozz::io::File file("test.bin", "w+b");
+      ozz::io::BufferedStream stream(&file, buffer_sizes[i]);
+      TestSeek(&stream);
+    }
+  }
+}
+
+TEST(BufferedStreamInterleaved, Stream) {
+  // Applies the same pseudo random sequence of reads, writes and seeks to a
+  // buffered and to a reference stream, which must behave the same.
+  ozz::io::MemoryStream reference;
+  ozz::io::MemoryStream memory;
+  {
+    ozz::io::BufferedStream stream(&memory, 7);
+    unsigned int seed = 46;
+    char data[32];
+    for (size_t i = 0; i < sizeof(data); ++i) {
+      data[i] = static_cast<char>(i + 1);
+    }
+    for (int i = 0; i < 1000; ++i) {
+      seed = seed * 1103515245u + 12345u;
+      const unsigned int random = seed >> 16;
+      const size_t size = random % sizeof(data);
+      switch (random % 3) {
+        case 0: {
+          EXPECT_EQ(stream.Write(data, size), reference.Write(data, size));
+          break;
+        }
+        case 1: {
+          char read[sizeof(data)];
+          char expected[sizeof(data)];
+          const size_t read_size = stream.Read(read, size);
+          ASSERT_EQ(read_size, reference.Read(expected, size));
+          EXPECT_EQ(std::memcmp(read, expected, read_size), 0);
+          break;
+        }
+        default: {
+          const ozz::io::Stream::Origin origin =
+            ozz::io::Stream::Origin((random >> 4) % 3);
+          const int offset = static_cast<int>(random % 64) - 32;
+          EXPECT_EQ(stream.Seek(offset, origin) == 0,
+                    reference.Seek(offset, origin) == 0);
+          break;
+        }
+      }
+      ASSERT_EQ(stream.Tell(), reference.Tell());
+    }
+  }
+
+  // Destroying the buffered stream flushed everything.
+  EXPECT_EQ(memory.Tell(), reference.Tell());
+  ASSERT_EQ(memory.Seek(0, ozz::io::Stream::kEnd), 0);
+  ASSERT_EQ(reference.Seek(0, ozz::io::Stream::kEnd), 0);
+  const int size = reference.Tell();
+  ASSERT_EQ(memory.Tell(), size);
+  ozz::memory::Allocator* allocator = ozz::memory::default_allocator();
+  char* content = allocator->Allocate<char>(size);
+  char* expected = allocator->Allocate<char>(size);
+  memory.Seek(0, ozz::io::Stream::kSet);
+  reference.Seek(0, ozz::io::Stream::kSet);
+  EXPECT_EQ(memory.Read(content, size), static_cast<size_t>(size));
+  EXPECT_EQ(reference.Read(expected, size), static_cast<size_t>(size));
+  EXPECT_EQ(std::memcmp(content, expected, size), 0);
+  allocator->Deallocate(content);
+  allocator->Deallocate(expected);
+}
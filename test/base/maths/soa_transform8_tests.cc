@@ -0,0 +1,229 @@
+//============================================================================//
+//                                                                            //
+// ozz-animation, 3d skeletal animation libraries and tools.                  //
+// https://code.google.com/p/ozz-animation/                                   //
+//                                                                            //
+//----------------------------------------------------------------------------//
+//                                                                            //
+// Copyright (c) 2012-2015 Guillaume Blanc                                    //
+//                                                                            //
+// This software is provided 'as-is', without any express or implied          //
+// warranty. In no event will the authors be held liable for any damages      //
+// arising from the use of this software.                                     //
+//                                                                            //
+// Permission is granted to anyone to use this software for any purpose,      //
+// including commercial applications, and to alter it and redistribute it     //
+// freely, subject to the following restrictions:                             //
+//                                                                            //
+// 1. The origin of this software must not be misrepresented; you must not    //
+// claim that you wrote the original software. If you use this software       //
+// in a product, an acknowledgment in the product documentation would be      //
+// appreciated but is not required.                                           //
+//                                                                            //
+// 2. Altered source versions must be plainly marked as such, and must not be //
+// misrepresented as being the original software.                             //
+//                                                                            //
+// 3. This notice may not be removed or altered from any source               //
+// distribution.                                                              //
+//                                                                            //
+//============================================================================//
+
+#include "ozz/base/maths/soa_transform8.h"
+
+#include "gtest/gtest.h"
+
+#include "ozz/base/maths/gtest_math_helper.h"
+
+// 8-wide structures are only available with AVX2 instructions set.
+#ifdef OZZ_HAS_AVX2
+
+using ozz::math::SimdFloat4;
+using ozz::math::SimdFloat8;
+using ozz::math::SoaFloat3;
+using ozz::math::SoaFloat3_8;
+using ozz::math::SoaQuaternion;
+using ozz::math::SoaQuaternion8;
+using ozz::math::SoaTransform;
+using ozz::math::SoaTransform8;
+using ozz::math::SoaFloat4x4;
+
+namespace {
+// Expects _a and _b to be bitwise equal, as 8-wide computations must match
+// 4-wide ones.
+void ExpectSimdFloatEq(SimdFloat4 _a, SimdFloat4 _b) {
+  float a[4], b[4];
+  ozz::math::StorePtrU(_a, a);
+  ozz::math::StorePtrU(_b, b);
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(a[i], b[i]);
+  }
+}
+
+void ExpectSoaFloat3Eq(const SoaFloat3& _a, const SoaFloat3& _b) {
+  ExpectSimdFloatEq(_a.x, _b.x);
+  ExpectSimdFloatEq(_a.y, _b.y);
+  ExpectSimdFloatEq(_a.z, _b.z);
+}
+
+void ExpectSoaQuaternionEq(const SoaQuaternion& _a, const SoaQuaternion& _b) {
+  ExpectSimdFloatEq(_a.x, _b.x);
+  ExpectSimdFloatEq(_a.y, _b.y);
+  ExpectSimdFloatEq(_a.z, _b.z);
+  ExpectSimdFloatEq(_a.w, _b.w);
+}
+
+const SoaTransform kTransforms[4] = {
+  {{ozz::math::simd_float4::Load(0.f, 1.f, -2.f, 3.f),
+    ozz::math::simd_float4::Load(4.f, -5.f, 6.f, 7.f),
+    ozz::math::simd_float4::Load(8.f, 9.f, 10.f, -11.f)},
+   {ozz::math::simd_float4::Load(.70710677f, 0.f, 0.f, .382683432f),
+    ozz::math::simd_float4::Load(0.f, 0.f, .70710677f, 0.f),
+    ozz::math::simd_float4::Load(0.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(.70710677f, 1.f, .70710677f, .9238795f)},
+   {ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 4.f),
+    ozz::math::simd_float4::Load(-1.f, 1.f, 2.f, 3.f),
+    ozz::math::simd_float4::Load(1.f, .5f, .25f, 4.f)}},
+  {{ozz::math::simd_float4::Load(12.f, -13.f, 14.f, 15.f),
+    ozz::math::simd_float4::Load(16.f, 17.f, -18.f, 19.f),
+    ozz::math::simd_float4::Load(-20.f, 21.f, 22.f, 23.f)},
+   {ozz::math::simd_float4::Load(0.f, -.70710677f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(.382683432f, 0.f, 0.f, -1.f),
+    ozz::math::simd_float4::Load(0.f, 0.f, .70710677f, 0.f),
+    ozz::math::simd_float4::Load(.9238795f, .70710677f, .70710677f, 0.f)},
+   {ozz::math::simd_float4::Load(2.f, 1.f, 1.f, 1.f),
+    ozz::math::simd_float4::Load(1.f, 3.f, 1.f, 1.f),
+    ozz::math::simd_float4::Load(1.f, 1.f, -4.f, 1.f)}},
+  {{ozz::math::simd_float4::Load(1.f, 1.f, 2.f, 4.f),
+    ozz::math::simd_float4::Load(0.f, -1.f, 2.f, 3.f),
+    ozz::math::simd_float4::Load(2.f, 1.f, 0.f, 3.f)},
+   {ozz::math::simd_float4::Load(0.f, 0.f, 0.f, -.70710677f),
+    ozz::math::simd_float4::Load(0.f, .382683432f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(-.70710677f, 0.f, 1.f, 0.f),
+    ozz::math::simd_float4::Load(.70710677f, -.9238795f, 0.f, .70710677f)},
+   {ozz::math::simd_float4::Load(1.f, 1.f, 1.f, 1.f),
+    ozz::math::simd_float4::Load(1.f, 2.f, 1.f, 1.f),
+    ozz::math::simd_float4::Load(1.f, 1.f, 3.f, 1.f)}},
+  {{ozz::math::simd_float4::Load(-1.f, 5.f, 2.f, 7.f),
+    ozz::math::simd_float4::Load(3.f, 4.f, -2.f, 3.f),
+    ozz::math::simd_float4::Load(2.f, 8.f, 9.f, 3.f)},
+   {ozz::math::simd_float4::Load(1.f, 0.f, 0.f, 0.f),
+    ozz::math::simd_float4::Load(0.f, 1.f, 0.f, .70710677f),
+    ozz::math::simd_float4::Load(0.f, 0.f, 1.f, 0.f),
+    ozz::math::simd_float4::Load(0.f, 0.f, 0.f, .70710677f)},
+   {ozz::math::simd_float4::Load(3.f, 1.f, 1.f, 2.f),
+    ozz::math::simd_float4::Load(1.f, 1.f, 5.f, 2.f),
+    ozz::math::simd_float4::Load(1.f, 7.f, 1.f, 2.f)}}};
+}  // namespace
+
+TEST(SimdFloat8LoadStore, ozz_math) {
+  const SimdFloat4 low = ozz::math::simd_float4::Load(0.f, 1.f, 2.f, 3.f);
+  const SimdFloat4 high = ozz::math::simd_float4::Load(4.f, 5.f, 6.f, 7.f);
+  const SimdFloat8 v = ozz::math::simd_float8::Load(low, high);
+  EXPECT_SIMDFLOAT_EQ(ozz::math::GetLow(v), 0.f, 1.f, 2.f, 3.f);
+  EXPECT_SIMDFLOAT_EQ(ozz::math::GetHigh(v), 4.f, 5.f, 6.f, 7.f);
+
+  const SimdFloat8 one = ozz::math::simd_float8::one();
+  EXPECT_SIMDFLOAT_EQ(ozz::math::GetLow(one), 1.f, 1.f, 1.f, 1.f);
+  EXPECT_SIMDFLOAT_EQ(ozz::math::GetHigh(one), 1.f, 1.f, 1.f, 1.f);
+
+  const SimdFloat8 zero = ozz::math::simd_float8::zero();
+  EXPECT_SIMDFLOAT_EQ(ozz::math::GetLow(zero), 0.f, 0.f, 0.f, 0.f);
+  EXPECT_SIMDFLOAT_EQ(ozz::math::GetHigh(zero), 0.f, 0.f, 0.f, 0.f);
+
+  const SimdFloat8 l1 = ozz::math::simd_float8::Load1(46.f);
+  EXPECT_SIMDFLOAT_EQ(ozz::math::GetLow(l1), 46.f, 46.f, 46.f, 46.f);
+  EXPECT_SIMDFLOAT_EQ(ozz::math::GetHigh(l1), 46.f, 46.f, 46.f, 46.f);
+}
+
+TEST(SimdFloat8Arithmetic, ozz_math) {
+  const SimdFloat4 a[2] = {ozz::math::simd_float4::Load(.5f, 1.f, 2.f, 3.f),
+                           ozz::math::simd_float4::Load(4.f, -5.f, 6.f, 7.f)};
+  const SimdFloat4 b[2] = {ozz::math::simd_float4::Load(-1.f, 1.f, 8.f, 3.f),
+                           ozz::math::simd_float4::Load(2.f, 5.f, -6.f, 9.f)};
+  const SimdFloat4 f = ozz::math::simd_float4::Load(0.f, .25f, .5f, 1.f);
+  const SimdFloat8 a8 = ozz::math::simd_float8::Load(a[0], a[1]);
+  const SimdFloat8 b8 = ozz::math::simd_float8::Load(b[0], b[1]);
+  const SimdFloat8 f8 = ozz::math::simd_float8::Load(f, f);
+
+  for (int i = 0; i < 2; ++i) {
+    SimdFloat4 (*get)(ozz::math::_SimdFloat8) = &ozz::math::GetLow;
+    if (i == 1) {
+      get = &ozz::math::GetHigh;
+    }
+    ExpectSimdFloatEq(get(a8 + b8), a[i] + b[i]);
+    ExpectSimdFloatEq(get(a8 - b8), a[i] - b[i]);
+    ExpectSimdFloatEq(get(-a8), -a[i]);
+    ExpectSimdFloatEq(get(a8 * b8), a[i] * b[i]);
+    ExpectSimdFloatEq(get(a8 / b8), a[i] / b[i]);
+    ExpectSimdFloatEq(get(ozz::math::Min(a8, b8)), ozz::math::Min(a[i], b[i]));
+    ExpectSimdFloatEq(get(ozz::math::Max(a8, b8)), ozz::math::Max(a[i], b[i]));
+    ExpectSimdFloatEq(get(ozz::math::Max0(b8)), ozz::math::Max0(b[i]));
+    ExpectSimdFloatEq(get(ozz::math::Lerp(a8, b8, f8)),
+                      ozz::math::Lerp(a[i], b[i], f));
+    ExpectSimdFloatEq(get(ozz::math::Xor(b8, ozz::math::Sign(a8))),
+                      ozz::math::Xor(b[i], ozz::math::Sign(a[i])));
+    const SimdFloat8 abs8 = ozz::math::Max(a8, -a8);
+    const SimdFloat4 abs4 = ozz::math::Max(a[i], -a[i]);
+    ExpectSimdFloatEq(get(ozz::math::Sqrt(abs8)), ozz::math::Sqrt(abs4));
+    EXPECT_SIMDFLOAT_EQ_EST(get(ozz::math::RcpEst(a8)),
+                            1.f / ozz::math::GetX(a[i]),
+                            1.f / ozz::math::GetY(a[i]),
+                            1.f / ozz::math::GetZ(a[i]),
+                            1.f / ozz::math::GetW(a[i]));
+    ExpectSimdFloatEq(get(ozz::math::RSqrtEstNR(abs8)),
+                      ozz::math::RSqrtEstNR(abs4));
+  }
+}
+
+TEST(SoaTransform8LoadStore, ozz_math) {
+  const SoaTransform8 t8 = SoaTransform8::Load(kTransforms[0], kTransforms[1]);
+  const SoaTransform low = ozz::math::GetLow(t8);
+  const SoaTransform high = ozz::math::GetHigh(t8);
+  ExpectSoaFloat3Eq(low.translation, kTransforms[0].translation);
+  ExpectSoaQuaternionEq(low.rotation, kTransforms[0].rotation);
+  ExpectSoaFloat3Eq(low.scale, kTransforms[0].scale);
+  ExpectSoaFloat3Eq(high.translation, kTransforms[1].translation);
+  ExpectSoaQuaternionEq(high.rotation, kTransforms[1].rotation);
+  ExpectSoaFloat3Eq(high.scale, kTransforms[1].scale);
+}
+
+TEST(SoaTransform8Interpolation, ozz_math) {
+  const SimdFloat4 f[2] = {ozz::math::simd_float4::Load(0.f, .2f, .5f, 1.f),
+                           ozz::math::simd_float4::Load(.7f, .1f, .9f, .3f)};
+  const SimdFloat8 f8 = ozz::math::simd_float8::Load(f[0], f[1]);
+  const SoaTransform8 a = SoaTransform8::Load(kTransforms[0], kTransforms[1]);
+  const SoaTransform8 b = SoaTransform8::Load(kTransforms[2], kTransforms[3]);
+
+  const SoaFloat3_8 t = Lerp(a.translation, b.translation, f8);
+  const SoaQuaternion8 r = NLerpEst(a.rotation, b.rotation, f8);
+  const SoaFloat3_8 s = a.scale + b.scale * f8;
+
+  for (int i = 0; i < 2; ++i) {
+    const SoaTransform& ta = kTransforms[i];
+    const SoaTransform& tb = kTransforms[i + 2];
+    const SoaFloat3 t4 = i == 0 ? GetLow(t) : GetHigh(t);
+    const SoaQuaternion r4 = i == 0 ? GetLow(r) : GetHigh(r);
+    const SoaFloat3 s4 = i == 0 ? GetLow(s) : GetHigh(s);
+    ExpectSoaFloat3Eq(t4, Lerp(ta.translation, tb.translation, f[i]));
+    ExpectSoaQuaternionEq(r4, NLerpEst(ta.rotation, tb.rotation, f[i]));
+    ExpectSoaFloat3Eq(s4, ta.scale + tb.scale * f[i]);
+  }
+}
+
+TEST(SoaTransform8ToAffine, ozz_math) {
+  const SoaTransform8 t8 = SoaTransform8::Load(kTransforms[2], kTransforms[3]);
+  SoaFloat4x4 m[2];
+  ToAffine(t8, &m[0], &m[1]);
+  for (int i = 0; i < 2; ++i) {
+    const SoaTransform& t = kTransforms[i + 2];
+    const SoaFloat4x4 expected =
+      SoaFloat4x4::FromAffine(t.translation, t.rotation, t.scale);
+    for (int c = 0; c < 4; ++c) {
+      ExpectSimdFloatEq(m[i].cols[c].x, expected.cols[c].x);
+      ExpectSimdFloatEq(m[i].cols[c].y, expected.cols[c].y);
+      ExpectSimdFloatEq(m[i].cols[c].z, expected.cols[c].z);
+      ExpectSimdFloatEq(m[i].cols[c].w, expected.cols[c].w);
+    }
+  }
+}
+#endif  // OZZ_HAS_AVX2
@@ -30,8 +30,11 @@
 
 #include "ozz/geometry/runtime/skinning_job.h"
 
+#include <cstring>
+
 #include "gtest/gtest.h"
 
+#include "ozz/base/cpu.h"
 #include "ozz/base/log.h"
 #include "ozz/base/memory/allocator.h"
 #include "ozz/base/maths/simd_math.h"
@@ -1132,6 +1135,64 @@ struct BenchVertexOut {
   float tangents[3];
 };
 
+TEST(InstructionSets, SkinningJob) {
+  ozz::math::Float4x4 matrices[4] = {
+    ozz::math::Float4x4::Scaling(ozz::math::simd_float4::Load(-1.f, 2.f, .5f, 0.f)),
+    ozz::math::Float4x4::Translation(ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f)),
+    ozz::math::Float4x4::Scaling(ozz::math::simd_float4::Load(1.f, 2.f, 3.f, 0.f)),
+    ozz::math::Float4x4::Translation(ozz::math::simd_float4::Load(-3.f, 2.f, 1.f, 0.f))
+  };
+  uint16_t joint_indices[9] = {0, 1, 2, 3, 0, 3, 2, 1, 0};
+  float joint_weights[6] = {.5f, .25f, .1f, .3f, .25f, .6f};
+  float in_positions[9] = {1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f, 8.f, 9.f};
+  float in_normals[9] = {.1f, .2f, .3f, .4f, .5f, .6f, .7f, .8f, .9f};
+  float in_tangents[9] = {.01f, .02f, .03f, .04f, .05f, .06f, .07f, .08f, .09f};
+  float expected[3][9];
+  float out[3][9];
+
+  SkinningJob job;
+  job.vertex_count = 3;
+  job.influences_count = 3;
+  job.joint_matrices = matrices;
+  job.joint_inverse_transpose_matrices = matrices;
+  job.joint_indices = joint_indices;
+  job.joint_indices_stride = sizeof(uint16_t) * 3;
+  job.joint_weights = joint_weights;
+  job.joint_weights_stride = sizeof(float) * 2;
+  job.in_positions = in_positions;
+  job.in_positions_stride = sizeof(float) * 3;
+  job.in_normals = in_normals;
+  job.in_normals_stride = sizeof(float) * 3;
+  job.in_tangents = in_tangents;
+  job.in_tangents_stride = sizeof(float) * 3;
+  job.out_positions_stride = sizeof(float) * 3;
+  job.out_normals_stride = sizeof(float) * 3;
+  job.out_tangents_stride = sizeof(float) * 3;
+
+  // Computes expected output with baseline kernels.
+  job.out_positions = expected[0];
+  job.out_normals = expected[1];
+  job.out_tangents = expected[2];
+  const ozz::cpu::InstructionSet detected = ozz::cpu::Detect();
+  ASSERT_TRUE(ozz::cpu::SetInstructionSet(ozz::cpu::kBaseline));
+  EXPECT_TRUE(job.Run());
+
+  // Every supported instruction set must output the same result.
+  job.out_positions = out[0];
+  job.out_normals = out[1];
+  job.out_tangents = out[2];
+  for (int set = 0; set < ozz::cpu::kInstructionSetCount; ++set) {
+    if (!ozz::cpu::SetInstructionSet(
+          static_cast<ozz::cpu::InstructionSet>(set))) {
+      continue;
+    }
+    memset(out, 0, sizeof(out));
+    EXPECT_TRUE(job.Run());
+    EXPECT_EQ(memcmp(out, expected, sizeof(out)), 0);
+  }
+  EXPECT_TRUE(ozz::cpu::SetInstructionSet(detected));
+}
+
 TEST(Benchmark, SkinningJob) {
 
   const int vertex_count = 10000;